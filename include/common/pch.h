@@ -9,6 +9,7 @@
 // Containers
 #include <array>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <unordered_map>
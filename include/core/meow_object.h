@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 namespace meow::memory {
 struct GCVisitor;
 }
@@ -20,16 +22,35 @@ enum class ObjectType : uint8_t {
     MODULE
 };
 
-struct MeowObject {
+/**
+ * @brief Common 8-byte header of every heap object
+ * @note There is no vtable: trace() and destroy() dispatch on `type` to the concrete class,
+ * so every new ObjectType must be added to both switches in objects.cpp. The 8-byte alignment
+ * leaves the low pointer bits free for the NaN-box object tags (see Value)
+ */
+struct alignas(8) MeowObject {
+    static constexpr uint8_t GC_MARKED = 1 << 0;
+
     const ObjectType type;
+    mutable uint8_t gc_bits = 0;
+    uint16_t flags = 0;
+    uint32_t hash = 0;
 
     explicit MeowObject(ObjectType type_tag) noexcept : type(type_tag) {}
-    
-    virtual ~MeowObject() = default;
-    virtual void trace(meow::memory::GCVisitor& visitor) const noexcept = 0;
 
     [[nodiscard]] inline ObjectType get_type() const noexcept { return type; }
+
+    // --- GC bits ---
+    [[nodiscard]] inline bool is_marked() const noexcept { return gc_bits & GC_MARKED; }
+    inline void set_marked() const noexcept { gc_bits |= GC_MARKED; }
+    inline void clear_marked() const noexcept { gc_bits &= static_cast<uint8_t>(~GC_MARKED); }
+
+    /// @brief Traces the concrete object's children. Dispatched by `type`
+    void trace(meow::memory::GCVisitor& visitor) const noexcept;
+    /// @brief Runs the concrete destructor and frees the object. Dispatched by `type`
+    static void destroy(const MeowObject* object) noexcept;
 };
+static_assert(sizeof(MeowObject) == 8, "MeowObject header must stay 8 bytes");
 
 template <ObjectType type_tag>
 struct ObjBase : public MeowObject {
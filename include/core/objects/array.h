@@ -16,134 +16,255 @@
 #include "memory/gc_visitor.h"
 
 namespace meow::core::objects {
+
+/// @brief Storage representation of an array's elements
+enum class ElementKind : uint8_t {
+    INT,    // packed int64_t, every element is an int
+    FLOAT,  // packed double, every element is a float
+    VALUE   // generic Value, any element type
+};
+
 class ObjArray : public meow::core::ObjBase<ObjectType::ARRAY> {
    private:
     using container_t = std::vector<meow::core::value_t>;
     using visitor_t = meow::memory::GCVisitor;
 
-    container_t elements_;
+    // Chỉ thành viên ứng với kind() còn sống. kind() nằm trong trường flags của header,
+    // nên mảng chỉ tốn header 8 byte cộng một vector như trước khi có packed storage
+    union {
+        std::vector<meow::core::int_t> ints_;
+        std::vector<meow::core::float_t> floats_;
+        container_t elements_;
+    };
+
+    inline void set_kind(ElementKind kind) noexcept {
+        flags = static_cast<uint16_t>(kind);
+    }
+    /// @brief Adopts the kind of `value` if the array is empty, otherwise widens to VALUE if `value` does not fit
+    inline void prepare_for(meow::core::param_t value) {
+        ElementKind current = kind();
+        if (current == ElementKind::VALUE) return;
+        if (current == ElementKind::INT && value.is_int()) return;
+        if (current == ElementKind::FLOAT && value.is_float()) return;
+        if (size() == 0) {
+            adopt_kind(value.is_int() ? ElementKind::INT : value.is_float() ? ElementKind::FLOAT : ElementKind::VALUE);
+        } else {
+            transition_to_values();
+        }
+    }
+    void adopt_kind(ElementKind kind);
+    void transition_to_values();
+    /// @brief Ends the lifetime of the live storage member
+    void destroy_storage() noexcept;
 
    public:
     // --- Constructors & destructor ---
-    ObjArray() = default;
-    explicit ObjArray(const container_t& elements) : elements_(elements) {
+    ObjArray() noexcept : ints_() {
+    }
+    explicit ObjArray(const container_t& elements);
+    explicit ObjArray(container_t&& elements);
+    explicit ObjArray(std::initializer_list<meow::core::value_t> elements) : ObjArray(container_t(elements)) {
     }
-    explicit ObjArray(container_t&& elements) noexcept : elements_(std::move(elements)) {
+    explicit ObjArray(std::vector<meow::core::int_t>&& elements) noexcept : ints_(std::move(elements)) {
     }
-    explicit ObjArray(std::initializer_list<meow::core::value_t> elements) : elements_(elements) {
+    explicit ObjArray(std::vector<meow::core::float_t>&& elements) noexcept : floats_(std::move(elements)) {
+        set_kind(ElementKind::FLOAT);
     }
 
     // --- Rule of 5 ---
     ObjArray(const ObjArray&) = delete;
-    ObjArray(ObjArray&&) = default;
+    ObjArray(ObjArray&& other) noexcept;
     ObjArray& operator=(const ObjArray&) = delete;
     ObjArray& operator=(ObjArray&&) = delete;
-    ~ObjArray() override = default;
+    ~ObjArray() noexcept {
+        destroy_storage();
+    }
+
+    // --- Storage kind ---
+    [[nodiscard]] inline ElementKind kind() const noexcept {
+        return static_cast<ElementKind>(flags);
+    }
+    [[nodiscard]] inline bool is_packed() const noexcept {
+        return kind() != ElementKind::VALUE;
+    }
 
-    // --- Iterator types ---
-    using iterator = container_t::iterator;
-    using const_iterator = container_t::const_iterator;
-    using reverse_iterator = container_t::reverse_iterator;
-    using const_reverse_iterator = container_t::const_reverse_iterator;
+    /// @brief Raw packed storage, nullptr unless kind() == ElementKind::INT
+    [[nodiscard]] inline meow::core::int_t* int_data() noexcept {
+        return kind() == ElementKind::INT ? ints_.data() : nullptr;
+    }
+    [[nodiscard]] inline const meow::core::int_t* int_data() const noexcept {
+        return kind() == ElementKind::INT ? ints_.data() : nullptr;
+    }
+    /// @brief Raw packed storage, nullptr unless kind() == ElementKind::FLOAT
+    [[nodiscard]] inline meow::core::float_t* float_data() noexcept {
+        return kind() == ElementKind::FLOAT ? floats_.data() : nullptr;
+    }
+    [[nodiscard]] inline const meow::core::float_t* float_data() const noexcept {
+        return kind() == ElementKind::FLOAT ? floats_.data() : nullptr;
+    }
+    /// @brief Raw generic storage, nullptr unless kind() == ElementKind::VALUE
+    [[nodiscard]] inline const meow::core::value_t* value_data() const noexcept {
+        return kind() == ElementKind::VALUE ? elements_.data() : nullptr;
+    }
 
     // --- Element access ---
 
     /// @brief Unchecked element access. For performance-critical code
     [[nodiscard]] inline meow::core::return_t get(size_t index) const noexcept {
-        return elements_[index];
+        switch (kind()) {
+            case ElementKind::INT:
+                return meow::core::value_t(ints_[index]);
+            case ElementKind::FLOAT:
+                return meow::core::value_t(floats_[index]);
+            default:
+                return elements_[index];
+        }
     }
-    /// @brief Unchecked element modification. For performance-critical code
-    template <typename T>
-    inline void set(size_t index, T&& value) noexcept {
-        elements_[index] = std::forward<T>(value);
+    /// @brief Unchecked element modification. Widens the storage kind if `value` does not fit
+    inline void set(size_t index, meow::core::param_t value) {
+        prepare_for(value);
+        switch (kind()) {
+            case ElementKind::INT:
+                ints_[index] = value.as_int();
+                break;
+            case ElementKind::FLOAT:
+                floats_[index] = value.as_float();
+                break;
+            default:
+                elements_[index] = value;
+                break;
+        }
     }
     /// @brief Checked element access. Throws if index is OOB
     [[nodiscard]] inline meow::core::return_t at(size_t index) const {
-        return elements_.at(index);
+        if (index >= size()) throw std::out_of_range("ObjArray::at");
+        return get(index);
     }
     inline meow::core::return_t operator[](size_t index) const noexcept {
-        return elements_[index];
-    }
-    inline meow::core::mutable_t operator[](size_t index) noexcept {
-        return elements_[index];
+        return get(index);
     }
     [[nodiscard]] inline meow::core::return_t front() const noexcept {
-        return elements_.front();
-    }
-    [[nodiscard]] inline meow::core::mutable_t front() noexcept {
-        return elements_.front();
+        return get(0);
     }
     [[nodiscard]] inline meow::core::return_t back() const noexcept {
-        return elements_.back();
-    }
-    [[nodiscard]] inline meow::core::mutable_t back() noexcept {
-        return elements_.back();
+        return get(size() - 1);
     }
 
     // --- Capacity ---
     [[nodiscard]] inline size_t size() const noexcept {
-        return elements_.size();
+        switch (kind()) {
+            case ElementKind::INT:
+                return ints_.size();
+            case ElementKind::FLOAT:
+                return floats_.size();
+            default:
+                return elements_.size();
+        }
     }
     [[nodiscard]] inline bool empty() const noexcept {
-        return elements_.empty();
+        return size() == 0;
     }
     [[nodiscard]] inline size_t capacity() const noexcept {
-        return elements_.capacity();
+        switch (kind()) {
+            case ElementKind::INT:
+                return ints_.capacity();
+            case ElementKind::FLOAT:
+                return floats_.capacity();
+            default:
+                return elements_.capacity();
+        }
     }
 
     // --- Modifiers ---
-    template <typename T>
-    inline void push(T&& value) {
-        elements_.emplace_back(std::forward<T>(value));
+    inline void push(meow::core::param_t value) {
+        prepare_for(value);
+        switch (kind()) {
+            case ElementKind::INT:
+                ints_.push_back(value.as_int());
+                break;
+            case ElementKind::FLOAT:
+                floats_.push_back(value.as_float());
+                break;
+            default:
+                elements_.push_back(value);
+                break;
+        }
     }
     inline void pop() noexcept {
-        elements_.pop_back();
+        switch (kind()) {
+            case ElementKind::INT:
+                ints_.pop_back();
+                break;
+            case ElementKind::FLOAT:
+                floats_.pop_back();
+                break;
+            default:
+                elements_.pop_back();
+                break;
+        }
     }
     template <typename... Args>
     inline void emplace(Args&&... args) {
-        elements_.emplace_back(std::forward<Args>(args)...);
+        push(meow::core::value_t(std::forward<Args>(args)...));
     }
+    /// @brief Growing fills the new slots with null, which widens a packed array to VALUE
     inline void resize(size_t size) {
-        elements_.resize(size);
+        if (size > this->size()) transition_to_values();
+        switch (kind()) {
+            case ElementKind::INT:
+                ints_.resize(size);
+                break;
+            case ElementKind::FLOAT:
+                floats_.resize(size);
+                break;
+            default:
+                elements_.resize(size);
+                break;
+        }
     }
     inline void reserve(size_t capacity) {
-        elements_.reserve(capacity);
+        switch (kind()) {
+            case ElementKind::INT:
+                ints_.reserve(capacity);
+                break;
+            case ElementKind::FLOAT:
+                floats_.reserve(capacity);
+                break;
+            default:
+                elements_.reserve(capacity);
+                break;
+        }
     }
     inline void shrink() {
-        elements_.shrink_to_fit();
-    }
-    inline void clear() {
-        elements_.clear();
-    }
-
-    // --- Iterators ---
-    inline iterator begin() noexcept {
-        return elements_.begin();
-    }
-    inline iterator end() noexcept {
-        return elements_.end();
-    }
-    inline const_iterator begin() const noexcept {
-        return elements_.begin();
-    }
-    inline const_iterator end() const noexcept {
-        return elements_.end();
-    }
-    inline reverse_iterator rbegin() noexcept {
-        return elements_.rbegin();
-    }
-    inline reverse_iterator rend() noexcept {
-        return elements_.rend();
-    }
-    inline const_reverse_iterator rbegin() const noexcept {
-        return elements_.rbegin();
+        switch (kind()) {
+            case ElementKind::INT:
+                ints_.shrink_to_fit();
+                break;
+            case ElementKind::FLOAT:
+                floats_.shrink_to_fit();
+                break;
+            default:
+                elements_.shrink_to_fit();
+                break;
+        }
     }
-    inline const_reverse_iterator rend() const noexcept {
-        return elements_.rend();
+    inline void clear() noexcept {
+        switch (kind()) {
+            case ElementKind::INT:
+                ints_.clear();
+                break;
+            case ElementKind::FLOAT:
+                floats_.clear();
+                break;
+            default:
+                elements_.clear();
+                break;
+        }
     }
 
-    void trace(visitor_t& visitor) const noexcept override;
+    void trace(visitor_t& visitor) const noexcept;
 };
+static_assert(sizeof(ObjArray) == sizeof(MeowObject) + sizeof(std::vector<meow::core::value_t>), "ObjArray must stay one header plus one vector");
 }  // namespace meow::core::objects
 
 // /**
@@ -201,7 +322,7 @@ class ObjArray : public meow::core::ObjBase<ObjectType::ARRAY> {
 //     ObjArray(ObjArray&&) noexcept = default;
 //     ObjArray& operator=(const ObjArray&) = delete;
 //     ObjArray& operator=(ObjArray&&) noexcept = default;
-//     ~ObjArray() override = default;
+//     ~ObjArray() = default;
 
 //     // --- Element access ---
 
@@ -307,7 +428,7 @@ class ObjArray : public meow::core::ObjBase<ObjectType::ARRAY> {
 //     }
 
 //     // --- GC tracing ---
-//     void trace(visitor_t& visitor) const noexcept override;
+//     void trace(visitor_t& visitor) const noexcept;
 // };
 
 // } // namespace meow::core::objects
@@ -16,6 +16,12 @@
 #include "core/value.h"
 #include "memory/gc_visitor.h"
 #include "runtime/chunk.h"
+#include "runtime/feedback.h"
+
+namespace meow::jit {
+class CompiledCode;
+struct LoopTraces;
+}
 
 namespace meow::core::objects {
 struct UpvalueDesc {
@@ -25,6 +31,25 @@ struct UpvalueDesc {
     }
 };
 
+/// @brief Static try region: an error raised by an instruction in [start, end) resumes at `handler`
+struct ExceptionRegion {
+    uint32_t start_;
+    uint32_t end_;
+    uint32_t handler_;
+};
+
+class ObjFunctionProto;
+
+/// @brief Reads the bodies of stub protos on first call, see loader::BinaryLoader
+class ProtoBodySource {
+   public:
+    virtual ~ProtoBodySource() = default;
+    /// @brief Fills in the constants and code of `proto`, the proto with index `index` in its module
+    virtual void load_body(ObjFunctionProto* proto, uint32_t index) = 0;
+    /// @brief `proto`, the proto with index `index`, is being freed
+    virtual void forget(const ObjFunctionProto* proto, uint32_t index) noexcept = 0;
+};
+
 class ObjUpvalue : public meow::core::ObjBase<ObjectType::UPVALUE> {
    private:
     using visitor_t = meow::memory::GCVisitor;
@@ -51,7 +76,7 @@ class ObjUpvalue : public meow::core::ObjBase<ObjectType::UPVALUE> {
         return index_;
     }
 
-    void trace(visitor_t& visitor) const noexcept override;
+    void trace(visitor_t& visitor) const noexcept;
 };
 
 class ObjFunctionProto : public meow::core::ObjBase<ObjectType::PROTO> {
@@ -65,6 +90,16 @@ class ObjFunctionProto : public meow::core::ObjBase<ObjectType::PROTO> {
     string_t name_;
     chunk_t chunk_;
     std::vector<UpvalueDesc> upvalue_descs_;
+    std::vector<ExceptionRegion> exception_table_;
+    uint32_t hotness_ = 0;
+    uint32_t loop_hotness_ = 0;
+    uint32_t warmup_ = 0;  ///< Entries before the feedback vector exists
+    const meow::jit::CompiledCode* jit_code_ = nullptr;
+    meow::jit::LoopTraces* loop_traces_ = nullptr;
+    std::unique_ptr<meow::runtime::FeedbackVector> feedback_;
+    std::shared_ptr<ProtoBodySource> body_source_;  ///< Set on every proto of a lazily loaded module
+    uint32_t body_index_ = 0;
+    bool body_pending_ = false;                     ///< Stub: constants and code not read yet
 
    public:
     explicit ObjFunctionProto(size_t registers, size_t upvalues, string_t name, chunk_t&& chunk) noexcept : num_registers_(registers), num_upvalues_(upvalues), name_(name), chunk_(std::move(chunk)) {
@@ -72,6 +107,9 @@ class ObjFunctionProto : public meow::core::ObjBase<ObjectType::PROTO> {
     explicit ObjFunctionProto(size_t registers, size_t upvalues, string_t name, chunk_t&& chunk, std::vector<UpvalueDesc>&& descs) noexcept
         : num_registers_(registers), num_upvalues_(upvalues), name_(name), chunk_(std::move(chunk)), upvalue_descs_(std::move(descs)) {
     }
+    ObjFunctionProto(const ObjFunctionProto&) = delete;
+    ObjFunctionProto& operator=(const ObjFunctionProto&) = delete;
+    ~ObjFunctionProto() noexcept;
 
     /// @brief Unchecked upvalue desc access. For performance-critical code
     [[nodiscard]] inline const UpvalueDesc& get_desc(size_t index) const noexcept {
@@ -84,6 +122,10 @@ class ObjFunctionProto : public meow::core::ObjBase<ObjectType::PROTO> {
     [[nodiscard]] inline size_t get_num_registers() const noexcept {
         return num_registers_;
     }
+    /// @brief Resizes the frame after inlining or register compaction. Only valid before the proto is executed
+    inline void set_num_registers(size_t registers) noexcept {
+        num_registers_ = registers;
+    }
     [[nodiscard]] inline size_t get_num_upvalues() const noexcept {
         return num_upvalues_;
     }
@@ -93,13 +135,105 @@ class ObjFunctionProto : public meow::core::ObjBase<ObjectType::PROTO> {
     [[nodiscard]] inline const chunk_t& get_chunk() const noexcept {
         return chunk_;
     }
+    /// @brief Mutable chunk for load-time passes. Only valid before the proto is executed
+    [[nodiscard]] inline chunk_t& get_chunk() noexcept {
+        return chunk_;
+    }
     [[nodiscard]] inline size_t desc_size() const noexcept {
         return upvalue_descs_.size();
     }
 
-    void trace(visitor_t& visitor) const noexcept override;
+    // --- Exception table ---
+    /// @brief Replaces the try regions, sorted by start and non-overlapping. Only valid before the proto is executed
+    inline void set_exception_table(std::vector<ExceptionRegion>&& table) noexcept {
+        exception_table_ = std::move(table);
+    }
+    [[nodiscard]] inline const std::vector<ExceptionRegion>& get_exception_table() const noexcept {
+        return exception_table_;
+    }
+    /// @brief Region covering the instruction at `pc`, or nullptr if errors there leave the frame
+    [[nodiscard]] inline const ExceptionRegion* find_exception_region(size_t pc) const noexcept {
+        auto it = std::upper_bound(exception_table_.begin(), exception_table_.end(), pc, [](size_t value, const ExceptionRegion& region) { return value < region.start_; });
+        if (it == exception_table_.begin() || pc >= std::prev(it)->end_) return nullptr;
+        return &*std::prev(it);
+    }
+
+    // --- Tiering ---
+    /// @brief Counts one call
+    /// @return true exactly when the count reaches `threshold`
+    inline bool tick_hotness(uint32_t threshold) noexcept {
+        return ++hotness_ == threshold;
+    }
+    /// @brief Counts one loop back-edge, so a proto that is entered once and loops (a module's main) still gets compiled
+    /// @return true exactly when the count reaches `threshold`
+    inline bool tick_loop_hotness(uint32_t threshold) noexcept {
+        return ++loop_hotness_ == threshold;
+    }
+    /// @brief Native code of the proto, or nullptr while it is interpreted
+    [[nodiscard]] inline const meow::jit::CompiledCode* get_jit_code() const noexcept {
+        return jit_code_;
+    }
+    /// @brief Attaches native code. The JIT owns it, not the proto
+    inline void set_jit_code(const meow::jit::CompiledCode* code) noexcept {
+        jit_code_ = code;
+    }
+    /// @brief Loop counters and traces of the tracing tier, or nullptr before its first back-edge. The JIT owns them
+    [[nodiscard]] inline meow::jit::LoopTraces* get_loop_traces() const noexcept {
+        return loop_traces_;
+    }
+    inline void set_loop_traces(meow::jit::LoopTraces* traces) noexcept {
+        loop_traces_ = traces;
+    }
+
+    // --- Lazy loading ---
+    /// @brief Ties the proto to the module it was loaded from; a `pending` proto is a stub whose body `source` reads
+    /// on first call
+    inline void set_body_source(std::shared_ptr<ProtoBodySource> source, uint32_t index, bool pending) noexcept {
+        body_source_ = std::move(source);
+        body_index_ = index;
+        body_pending_ = pending;
+    }
+    [[nodiscard]] inline bool is_body_pending() const noexcept {
+        return body_pending_;
+    }
+    [[nodiscard]] inline uint32_t get_body_index() const noexcept {
+        return body_index_;
+    }
+    /// @brief Reads the body of a stub. Must run before the proto's frame is set up, the load-time passes may resize it
+    inline void ensure_body() {
+        if (body_pending_) [[unlikely]] load_body();
+    }
+    /// @brief Installs the body read by the ProtoBodySource
+    inline void set_body(chunk_t&& chunk) noexcept {
+        chunk_ = std::move(chunk);
+        body_pending_ = false;
+    }
+
+    // --- Type feedback ---
+    /// @brief Counts one entry (call or loop back-edge) and creates the profile when the count reaches `threshold`.
+    /// Must not be used before load-time passes are done
+    /// @return The profile, or nullptr while the proto is cold; always nullptr when `threshold` is 0
+    [[nodiscard]] inline meow::runtime::FeedbackVector* profile(uint32_t threshold) {
+        if (feedback_) [[likely]] return feedback_.get();
+        if (threshold == 0 || ++warmup_ < threshold) return nullptr;
+        create_feedback();
+        return feedback_.get();
+    }
+    /// @brief Profile of the proto, or nullptr if it never got warm
+    [[nodiscard]] inline const meow::runtime::FeedbackVector* get_feedback() const noexcept {
+        return feedback_.get();
+    }
+
+    void trace(visitor_t& visitor) const noexcept;
+
+   private:
+    void create_feedback();
+    void load_body();
 };
 
+/// @brief `main` and every proto reachable through constant pools, depth-first, each once
+[[nodiscard]] std::vector<meow::core::proto_t> collect_protos(meow::core::proto_t main);
+
 class ObjClosure : public meow::core::ObjBase<ObjectType::FUNCTION> {
    private:
     using proto_t = meow::core::proto_t;
@@ -129,6 +263,6 @@ class ObjClosure : public meow::core::ObjBase<ObjectType::FUNCTION> {
         return upvalues_.at(index);
     }
 
-    void trace(visitor_t& visitor) const noexcept override;
+    void trace(visitor_t& visitor) const noexcept;
 };
 }  // namespace meow::core::objects
\ No newline at end of file
@@ -38,7 +38,7 @@ class ObjHashTable : public meow::core::ObjBase<ObjectType::HASH_TABLE> {
     ObjHashTable(ObjHashTable&&) = delete;
     ObjHashTable& operator=(const ObjHashTable&) = delete;
     ObjHashTable& operator=(ObjHashTable&&) = delete;
-    ~ObjHashTable() override = default;
+    ~ObjHashTable() = default;
 
     // --- Iterator types ---
     using iterator = map_t::iterator;
@@ -85,6 +85,19 @@ class ObjHashTable : public meow::core::ObjBase<ObjectType::HASH_TABLE> {
         return fields_.end();
     }
 
-    void trace(visitor_t& visitor) const noexcept override;
+    // --- Buckets ---
+    // Cho phép duyệt bằng con trỏ (bucket, vị trí) lưu trong register, không cần giữ iterator
+    using const_local_iterator = map_t::const_local_iterator;
+    [[nodiscard]] inline size_t bucket_count() const noexcept {
+        return fields_.bucket_count();
+    }
+    [[nodiscard]] inline size_t bucket_size(size_t bucket) const noexcept {
+        return fields_.bucket_size(bucket);
+    }
+    inline const_local_iterator begin(size_t bucket) const noexcept {
+        return fields_.begin(bucket);
+    }
+
+    void trace(visitor_t& visitor) const noexcept;
 };
 }  // namespace meow::core::objects
\ No newline at end of file
@@ -21,20 +21,34 @@ class ObjModule : public meow::core::ObjBase<ObjectType::MODULE> {
    private:
     using string_t = meow::core::string_t;
     using proto_t = meow::core::proto_t;
+    using module_t = meow::core::module_t;
     using module_map = std::unordered_map<string_t, value_t>;
+    using slot_map = std::unordered_map<string_t, uint32_t>;
     using visitor_t = meow::memory::GCVisitor;
 
-    enum class State { EXECUTING, EXECUTED };
+    enum class State { PENDING, EXECUTING, EXECUTED };
+
+    /// @brief Slot bound to a slot of another module by IMPORT_ALL; module is nullptr for own exports
+    struct ExportLink {
+        module_t module = nullptr;
+        uint32_t slot = 0;
+    };
 
     module_map globals_;
-    module_map exports_;
+    slot_map export_slots_;
+    std::vector<string_t> export_names_;
+    std::vector<value_t> export_values_;
+    std::vector<ExportLink> export_links_;
+    std::vector<module_t> star_imports_;
     string_t file_name_;
     string_t file_path_;
     proto_t main_proto_;
 
-    State state;
+    State state = State::PENDING;
 
    public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
     explicit ObjModule(string_t file_name, string_t file_path, proto_t main_proto = nullptr) noexcept : file_name_(file_name), file_path_(file_path), main_proto_(main_proto) {
     }
 
@@ -54,21 +68,58 @@ class ObjModule : public meow::core::ObjBase<ObjectType::MODULE> {
         }
     }
 
+    // --- Export slots ---
+
+    /// @brief Slot of an export of this module, own or bound by IMPORT_ALL, or npos. Slots are stable for the module's lifetime
+    [[nodiscard]] inline size_t find_export(string_t name) const noexcept {
+        auto it = export_slots_.find(name);
+        return (it != export_slots_.end()) ? it->second : npos;
+    }
+    /// @brief Unchecked slot access, following bound slots to their owner. For performance-critical code
+    [[nodiscard]] inline meow::core::return_t get_export_slot(size_t slot) const noexcept {
+        const ObjModule* module = this;
+        while (module->export_links_[slot].module != nullptr) {
+            const ExportLink& link = module->export_links_[slot];
+            module = link.module;
+            slot = link.slot;
+        }
+        return module->export_values_[slot];
+    }
+    /// @brief True if `slot` is a valid slot of this module and holds `name`. Used to validate cached slots
+    [[nodiscard]] inline bool is_export_slot(size_t slot, string_t name) const noexcept {
+        return slot < export_names_.size() && export_names_[slot] == name;
+    }
+    [[nodiscard]] inline size_t export_size() const noexcept {
+        return export_names_.size();
+    }
+
+    /// @brief Slot of `name` in this module, or npos. A name an IMPORT_ALL source exported after the import
+    /// is looked up through the sources (latest first) and bound here, so the next lookup is a find_export
+    [[nodiscard]] size_t resolve_export(string_t name) noexcept;
+
     // --- Exports ---
     [[nodiscard]] inline meow::core::return_t get_export(string_t name) noexcept {
-        return exports_[name];
+        size_t slot = resolve_export(name);
+        return (slot != npos) ? get_export_slot(slot) : meow::core::value_t();
     }
+    /// @brief Own export: also replaces a slot that IMPORT_ALL bound to another module
     inline void set_export(string_t name, meow::core::param_t value) noexcept {
-        exports_[name] = value;
-    }
-    [[nodiscard]] inline bool has_export(string_t name) {
-        return exports_.find(name) != exports_.end();
-    }
-    inline void import_all_export(const module_t other) noexcept {
-        for (const auto& [key, value] : other->exports_) {
-            exports_[key] = value;
+        auto [it, inserted] = export_slots_.try_emplace(name, static_cast<uint32_t>(export_names_.size()));
+        if (inserted) {
+            export_names_.push_back(name);
+            export_values_.push_back(value);
+            export_links_.emplace_back();
+        } else {
+            export_values_[it->second] = value;
+            export_links_[it->second] = ExportLink{};
         }
     }
+    [[nodiscard]] inline bool has_export(string_t name) noexcept {
+        return resolve_export(name) != npos;
+    }
+    /// @brief Binds every export of `other` to a slot of this module by reference: reads see `other`'s current
+    /// values, own exports keep precedence, and among IMPORT_ALL sources the latest wins
+    void import_all_export(const module_t other) noexcept;
 
     // --- File info ---
     inline string_t get_file_name() const noexcept {
@@ -77,6 +128,9 @@ class ObjModule : public meow::core::ObjBase<ObjectType::MODULE> {
     inline string_t get_file_path() const noexcept {
         return file_path_;
     }
+    inline void set_file_path(string_t file_path) noexcept {
+        file_path_ = file_path;
+    }
 
     // --- Main proto ---
     inline proto_t get_main_proto() const noexcept {
@@ -103,6 +157,10 @@ class ObjModule : public meow::core::ObjBase<ObjectType::MODULE> {
         return state == State::EXECUTED;
     }
 
-    void trace(visitor_t& visitor) const noexcept override;
+    void trace(visitor_t& visitor) const noexcept;
+
+   private:
+    /// @brief Points `name` at `source`'s slot unless it is an own export or the link would loop back here
+    size_t link_export(string_t name, module_t source, uint32_t source_slot) noexcept;
 };
 }  // namespace meow::core::objects
\ No newline at end of file
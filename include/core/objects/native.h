@@ -54,7 +54,7 @@ class ObjNativeFunction : public meow::core::ObjBase<ObjectType::NATIVE_FN> {
         return meow::core::value_t();
     }
 
-    void trace(visitor_t&) const noexcept override {
+    void trace(visitor_t&) const noexcept {
     }
 };
 }  // namespace meow::core::objects
\ No newline at end of file
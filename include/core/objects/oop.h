@@ -54,7 +54,7 @@ class ObjClass : public meow::core::ObjBase<ObjectType::CLASS> {
         methods_[name] = value;
     }
 
-    void trace(visitor_t& visitor) const noexcept override;
+    void trace(visitor_t& visitor) const noexcept;
 };
 
 class ObjInstance : public meow::core::ObjBase<ObjectType::INSTANCE> {
@@ -89,8 +89,11 @@ class ObjInstance : public meow::core::ObjBase<ObjectType::INSTANCE> {
     [[nodiscard]] inline bool has_field(string_t name) const {
         return fields_.find(name) != fields_.end();
     }
+    [[nodiscard]] inline const field_map& get_fields() const noexcept {
+        return fields_;
+    }
 
-    void trace(visitor_t& visitor) const noexcept override;
+    void trace(visitor_t& visitor) const noexcept;
 };
 
 class ObjBoundMethod : public meow::core::ObjBase<ObjectType::BOUND_METHOD> {
@@ -113,6 +116,6 @@ class ObjBoundMethod : public meow::core::ObjBase<ObjectType::BOUND_METHOD> {
         return function_;
     }
 
-    void trace(visitor_t& visitor) const noexcept override;
+    void trace(visitor_t& visitor) const noexcept;
 };
 }  // namespace meow::core::objects
\ No newline at end of file
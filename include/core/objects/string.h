@@ -11,6 +11,7 @@
 
 #include "common/pch.h"
 #include "core/meow_object.h"
+#include "utils/string/string_hash.h"
 
 namespace meow::core::objects {
 class ObjString : public meow::core::ObjBase<ObjectType::STRING> {
@@ -18,19 +19,26 @@ private:
     using storage_t = std::string;
     using visitor_t = meow::memory::GCVisitor;
     storage_t data_;
+
+    // String là bất biến, nên hash được tính một lần và giữ trong header
+    inline void cache_hash() noexcept {
+        hash = static_cast<uint32_t>(meow::utils::string::hash_string(data_));
+    }
 public:
     // --- Constructors & destructor ---
-    ObjString() = default;
-    explicit ObjString(const storage_t& data) : data_(data) {}
-    explicit ObjString(storage_t&& data) noexcept : data_(std::move(data)) {}
-    explicit ObjString(const char* data) : data_(data) {}
+    ObjString() { cache_hash(); }
+    explicit ObjString(const storage_t& data) : data_(data) { cache_hash(); }
+    explicit ObjString(storage_t&& data) noexcept : data_(std::move(data)) { cache_hash(); }
+    explicit ObjString(const char* data) : data_(data) { cache_hash(); }
+    /// @brief `text_hash` must be hash_string(data), e.g. already computed by the string pool
+    ObjString(storage_t&& data, uint64_t text_hash) noexcept : data_(std::move(data)) { hash = static_cast<uint32_t>(text_hash); }
 
     // --- Rule of 5 ---
     ObjString(const ObjString&) = delete;
     ObjString(ObjString&&) = default;
     ObjString& operator=(const ObjString&) = delete;
     ObjString& operator=(ObjString&&) = delete;
-    ~ObjString() override = default;
+    ~ObjString() = default;
 
     // --- Assignments ---
     inline ObjString operator+(const ObjString& other) const noexcept {
@@ -63,6 +71,10 @@ public:
     [[nodiscard]] inline const char* c_str() const noexcept {
         return data_.c_str();
     }
+    /// @brief Content hash, computed once at construction
+    [[nodiscard]] inline uint32_t get_hash() const noexcept {
+        return hash;
+    }
 
     // --- Capacity ---
     [[nodiscard]] inline size_t size() const noexcept {
@@ -86,6 +98,6 @@ public:
         return data_.rend();
     }
 
-    inline void trace(visitor_t&) const noexcept override {}
+    inline void trace(visitor_t&) const noexcept {}
 };
 }  // namespace meow::core::objects
\ No newline at end of file
@@ -81,6 +81,34 @@ enum class OpCode : unsigned char {
     EXPORT,
     GET_EXPORT,
     IMPORT_ALL,
+    // --- Fused compare & branch ---
+    JUMP_IF_EQ,
+    JUMP_IF_NEQ,
+    JUMP_IF_LT,
+    JUMP_IF_LE,
+    JUMP_IF_NOT_LT,
+    JUMP_IF_NOT_LE,
+    // --- Loops ---
+    FOR_PREP,
+    FOR_LOOP,
+    FOR_IN,
+    // --- Iterators ---
+    ITER_NEW,
+    ITER_NEXT,
+    // --- Tail calls ---
+    TAIL_CALL,
+    // --- Compact encodings ---
+    LOAD_SMALLINT,
+    // --- Inlining (internal, emitted by the optimizer) ---
+    GUARD_CALLEE,
+    // --- Operand width prefix: the next instruction has u16 operands and an i32 jump, see runtime/bytecode.h ---
+    WIDE,
+    // --- Superinstructions (internal, formed at load time). Must stay last, see superinstructions.h ---
+#define MEOW_SUPERINSTRUCTION(NAME, A, B) SI_##NAME,
+#define MEOW_SUPERINSTRUCTION3(NAME, A, B, C) SI_##NAME,
+#include "core/superinstructions.def"
+#undef MEOW_SUPERINSTRUCTION
+#undef MEOW_SUPERINSTRUCTION3
     // --- Metadata ---
     TOTAL_OPCODES
 };
@@ -0,0 +1,52 @@
+/**
+ * @file superinstructions.h
+ * @brief Superinstructions: a common opcode sequence executed by one handler with a single dispatch
+ *
+ * A superinstruction only replaces the opcode byte of its first component. Operands and the opcode
+ * bytes of the following components stay in place, so the encoded length, jump targets and any
+ * jump into the middle of the sequence are unaffected.
+ */
+
+#pragma once
+
+#include "common/pch.h"
+#include "core/op_codes.h"
+
+namespace meow::core {
+
+struct Superinstruction {
+    OpCode op;
+    uint8_t length;                  ///< Number of component instructions (2 or 3)
+    std::array<OpCode, 3> parts;
+};
+
+inline constexpr size_t NUM_SUPERINSTRUCTIONS = 0
+#define MEOW_SUPERINSTRUCTION(NAME, A, B) + 1
+#define MEOW_SUPERINSTRUCTION3(NAME, A, B, C) + 1
+#include "core/superinstructions.def"
+#undef MEOW_SUPERINSTRUCTION
+#undef MEOW_SUPERINSTRUCTION3
+    ;
+
+/// @brief Superinstructions occupy the last opcodes of the enum
+inline constexpr size_t FIRST_SUPERINSTRUCTION = static_cast<size_t>(OpCode::TOTAL_OPCODES) - NUM_SUPERINSTRUCTIONS;
+
+/// @brief Superinstructions in table order. Unused slots of a pair hold TOTAL_OPCODES
+inline constexpr std::array<Superinstruction, NUM_SUPERINSTRUCTIONS> SUPERINSTRUCTIONS = {{
+#define MEOW_SUPERINSTRUCTION(NAME, A, B) {OpCode::SI_##NAME, 2, {OpCode::A, OpCode::B, OpCode::TOTAL_OPCODES}},
+#define MEOW_SUPERINSTRUCTION3(NAME, A, B, C) {OpCode::SI_##NAME, 3, {OpCode::A, OpCode::B, OpCode::C}},
+#include "core/superinstructions.def"
+#undef MEOW_SUPERINSTRUCTION
+#undef MEOW_SUPERINSTRUCTION3
+}};
+
+inline constexpr bool is_superinstruction(OpCode op) noexcept {
+    return static_cast<size_t>(op) >= FIRST_SUPERINSTRUCTION && op < OpCode::TOTAL_OPCODES;
+}
+
+/// @brief Opcode whose operands follow the opcode byte: the first component of a superinstruction, `op` itself otherwise
+inline constexpr OpCode superinstruction_head(OpCode op) noexcept {
+    if (!is_superinstruction(op)) return op;
+    return SUPERINSTRUCTIONS[static_cast<size_t>(op) - FIRST_SUPERINSTRUCTION].parts[0];
+}
+}  // namespace meow::core
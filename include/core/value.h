@@ -9,15 +9,61 @@
 namespace meow::core {
 
 using base_t = meow::variant<null_t, bool_t, int_t, float_t, object_t>;
+static_assert(base_t::has_pointer_tags == (MEOW_CAN_USE_NAN_BOXING != 0), "Value's object sub-tags follow MEOW_CAN_USE_NAN_BOXING");
+
+/// @brief Object sub-tag stored in the low pointer bits of a boxed object. Hot types get their own tag
+enum class ObjectTag : uint8_t {
+    OTHER = 0,  // type must be read from the object header
+    STRING,
+    ARRAY,
+    HASH_TABLE,
+    INSTANCE,
+    FUNCTION
+};
+
+[[nodiscard]] inline constexpr ObjectTag object_tag_of(ObjectType type) noexcept {
+    switch (type) {
+        case ObjectType::STRING:
+            return ObjectTag::STRING;
+        case ObjectType::ARRAY:
+            return ObjectTag::ARRAY;
+        case ObjectType::HASH_TABLE:
+            return ObjectTag::HASH_TABLE;
+        case ObjectType::INSTANCE:
+            return ObjectTag::INSTANCE;
+        case ObjectType::FUNCTION:
+            return ObjectTag::FUNCTION;
+        default:
+            return ObjectTag::OTHER;
+    }
+}
 
 class Value {
 private:
     base_t data_;
     [[nodiscard]] inline meow::core::MeowObject* get_object_ptr() const noexcept {
-        if (auto obj_ptr = data_.get_if<object_t>()) {
-            return *obj_ptr;
-        }
-        return nullptr;
+        return data_.holds<object_t>() ? data_.get<object_t>() : nullptr;
+    }
+    // Backend không có tag phụ (không NaN-boxing) thì đọc kiểu từ header của object như cũ
+    [[nodiscard]] inline bool holds_tag(ObjectTag tag) const noexcept {
+#if MEOW_CAN_USE_NAN_BOXING
+        return data_.holds_tagged<object_t>(static_cast<uint8_t>(tag));
+#else
+        const MeowObject* obj = get_object_ptr();
+        return obj && object_tag_of(obj->get_type()) == tag;
+#endif
+    }
+    /// @brief A null pointer always gets ObjectTag::OTHER, so no is_<type>() holds for it
+    inline void set_object(object_t v, ObjectTag tag) noexcept {
+        data_ = v;
+#if MEOW_CAN_USE_NAN_BOXING
+        data_.set_pointer_tag<object_t>(static_cast<uint8_t>(v ? tag : ObjectTag::OTHER));
+#else
+        (void)tag;
+#endif
+    }
+    inline void set_object(object_t v) noexcept {
+        set_object(v, v ? object_tag_of(v->get_type()) : ObjectTag::OTHER);
     }
 
 public:
@@ -27,7 +73,14 @@ public:
     inline Value(bool_t v) noexcept : data_(v) {}
     inline Value(int_t v) noexcept : data_(v) {}
     inline Value(float_t v) noexcept : data_(v) {}
-    inline Value(object_t v) noexcept : data_(v) {}
+    inline Value(object_t v) noexcept { set_object(v); }
+
+    // Hot object types: the tag is known statically, no header load
+    inline Value(string_t v) noexcept { set_object(reinterpret_cast<object_t>(const_cast<objects::ObjString*>(v)), ObjectTag::STRING); }
+    inline Value(array_t v) noexcept { set_object(reinterpret_cast<object_t>(v), ObjectTag::ARRAY); }
+    inline Value(hash_table_t v) noexcept { set_object(reinterpret_cast<object_t>(v), ObjectTag::HASH_TABLE); }
+    inline Value(instance_t v) noexcept { set_object(reinterpret_cast<object_t>(v), ObjectTag::INSTANCE); }
+    inline Value(function_t v) noexcept { set_object(reinterpret_cast<object_t>(v), ObjectTag::FUNCTION); }
 
     // --- Rule of five ---
     inline Value(const Value& other) noexcept : data_(other.data_) {}
@@ -50,7 +103,12 @@ public:
     inline Value& operator=(bool_t v) noexcept { data_ = v; return *this; }
     inline Value& operator=(int_t v) noexcept { data_ = v; return *this; }
     inline Value& operator=(float_t v) noexcept { data_ = v; return *this; }
-    inline Value& operator=(object_t v) noexcept { data_ = v; return *this; }
+    inline Value& operator=(object_t v) noexcept { set_object(v); return *this; }
+    inline Value& operator=(string_t v) noexcept { return *this = Value(v); }
+    inline Value& operator=(array_t v) noexcept { return *this = Value(v); }
+    inline Value& operator=(hash_table_t v) noexcept { return *this = Value(v); }
+    inline Value& operator=(instance_t v) noexcept { return *this = Value(v); }
+    inline Value& operator=(function_t v) noexcept { return *this = Value(v); }
 
     inline constexpr size_t index() const noexcept {
         return data_.index();
@@ -70,18 +128,9 @@ public:
     }
 
     // --- Specific object type ---
-    [[nodiscard]] inline bool is_array() const noexcept {
-        const MeowObject* obj = get_object_ptr();
-        return (obj && obj->get_type() == ObjectType::ARRAY);
-    }
-    [[nodiscard]] inline bool is_string() const noexcept {
-        const MeowObject* obj = get_object_ptr();
-        return (obj && obj->get_type() == ObjectType::STRING);
-    }
-    [[nodiscard]] inline bool is_hash_table() const noexcept {
-        const MeowObject* obj = get_object_ptr();
-        return (obj && obj->get_type() == ObjectType::HASH_TABLE);
-    }
+    [[nodiscard]] inline bool is_array() const noexcept { return holds_tag(ObjectTag::ARRAY); }
+    [[nodiscard]] inline bool is_string() const noexcept { return holds_tag(ObjectTag::STRING); }
+    [[nodiscard]] inline bool is_hash_table() const noexcept { return holds_tag(ObjectTag::HASH_TABLE); }
     [[nodiscard]] inline bool is_upvalue() const noexcept {
         const MeowObject* obj = get_object_ptr();
         return (obj && obj->get_type() == ObjectType::UPVALUE);
@@ -90,10 +139,7 @@ public:
         const MeowObject* obj = get_object_ptr();
         return (obj && obj->get_type() == ObjectType::PROTO);
     }
-    [[nodiscard]] inline bool is_function() const noexcept {
-        const MeowObject* obj = get_object_ptr();
-        return (obj && obj->get_type() == ObjectType::FUNCTION);
-    }
+    [[nodiscard]] inline bool is_function() const noexcept { return holds_tag(ObjectTag::FUNCTION); }
     [[nodiscard]] inline bool is_native_fn() const noexcept {
         const MeowObject* obj = get_object_ptr();
         return (obj && obj->get_type() == ObjectType::NATIVE_FN);
@@ -102,10 +148,7 @@ public:
         const MeowObject* obj = get_object_ptr();
         return (obj && obj->get_type() == ObjectType::CLASS);
     }
-    [[nodiscard]] inline bool is_instance() const noexcept {
-        const MeowObject* obj = get_object_ptr();
-        return (obj && obj->get_type() == ObjectType::INSTANCE);
-    }
+    [[nodiscard]] inline bool is_instance() const noexcept { return holds_tag(ObjectTag::INSTANCE); }
     [[nodiscard]] inline bool is_bound_method() const noexcept {
         const MeowObject* obj = get_object_ptr();
         return (obj && obj->get_type() == ObjectType::BOUND_METHOD);
@@ -115,6 +158,28 @@ public:
         return (obj && obj->get_type() == ObjectType::MODULE);
     }
 
+    /// @brief Heap type of an object value. Tagged types are resolved without touching the object
+    [[nodiscard]] inline ObjectType get_object_type() const noexcept {
+#if !MEOW_CAN_USE_NAN_BOXING
+        return as_object()->get_type();
+#else
+        switch (static_cast<ObjectTag>(data_.pointer_tag())) {
+            case ObjectTag::STRING:
+                return ObjectType::STRING;
+            case ObjectTag::ARRAY:
+                return ObjectType::ARRAY;
+            case ObjectTag::HASH_TABLE:
+                return ObjectType::HASH_TABLE;
+            case ObjectTag::INSTANCE:
+                return ObjectType::INSTANCE;
+            case ObjectTag::FUNCTION:
+                return ObjectType::FUNCTION;
+            default:
+                return as_object()->get_type();
+        }
+#endif
+    }
+
     // === Accessors ===
     [[nodiscard]] inline bool as_bool() const noexcept { return data_.get<bool_t>(); }
     [[nodiscard]] inline int64_t as_int() const noexcept { return data_.get<int_t>(); }
@@ -168,56 +233,26 @@ public:
 
     // Array
     [[nodiscard]] inline array_t as_if_array() noexcept {
-        if (auto obj = get_object_ptr()) {
-            if (obj->get_type() == ObjectType::ARRAY) {
-                return reinterpret_cast<array_t>(obj);
-            }
-        }
-        return nullptr;
+        return is_array() ? as_array() : nullptr;
     }
     [[nodiscard]] inline array_t as_if_array() const noexcept {
-        if (auto obj = get_object_ptr()) {
-            if (obj->get_type() == ObjectType::ARRAY) {
-                return reinterpret_cast<array_t>(obj);
-            }
-        }
-        return nullptr;
+        return is_array() ? as_array() : nullptr;
     }
 
     // String
     [[nodiscard]] inline string_t as_if_string() noexcept {
-        if (auto obj = get_object_ptr()) {
-            if (obj->get_type() == ObjectType::STRING) {
-                return reinterpret_cast<string_t>(obj);
-            }
-        }
-        return nullptr;
+        return is_string() ? as_string() : nullptr;
     }
     [[nodiscard]] inline string_t as_if_string() const noexcept {
-        if (auto obj = get_object_ptr()) {
-            if (obj->get_type() == ObjectType::STRING) {
-                return reinterpret_cast<string_t>(obj);
-            }
-        }
-        return nullptr;
+        return is_string() ? as_string() : nullptr;
     }
 
     // Hash table
     [[nodiscard]] inline hash_table_t as_if_hash_table() noexcept {
-        if (auto obj = get_object_ptr()) {
-            if (obj->get_type() == ObjectType::HASH_TABLE) {
-                return reinterpret_cast<hash_table_t>(obj);
-            }
-        }
-        return nullptr;
+        return is_hash_table() ? as_hash_table() : nullptr;
     }
     [[nodiscard]] inline hash_table_t as_if_hash_table() const noexcept {
-        if (auto obj = get_object_ptr()) {
-            if (obj->get_type() == ObjectType::HASH_TABLE) {
-                return reinterpret_cast<hash_table_t>(obj);
-            }
-        }
-        return nullptr;
+        return is_hash_table() ? as_hash_table() : nullptr;
     }
 
     // Upvalue
@@ -258,20 +293,10 @@ public:
 
     // Function
     [[nodiscard]] inline function_t as_if_function() noexcept {
-        if (auto obj = get_object_ptr()) {
-            if (obj->get_type() == ObjectType::FUNCTION) {
-                return reinterpret_cast<function_t>(obj);
-            }
-        }
-        return nullptr;
+        return is_function() ? as_function() : nullptr;
     }
     [[nodiscard]] inline function_t as_if_function() const noexcept {
-        if (auto obj = get_object_ptr()) {
-            if (obj->get_type() == ObjectType::FUNCTION) {
-                return reinterpret_cast<function_t>(obj);
-            }
-        }
-        return nullptr;
+        return is_function() ? as_function() : nullptr;
     }
 
     // Native function
@@ -312,20 +337,10 @@ public:
 
     // Instance
     [[nodiscard]] inline instance_t as_if_instance() noexcept {
-        if (auto obj = get_object_ptr()) {
-            if (obj->get_type() == ObjectType::INSTANCE) {
-                return reinterpret_cast<instance_t>(obj);
-            }
-        }
-        return nullptr;
+        return is_instance() ? as_instance() : nullptr;
     }
     [[nodiscard]] inline instance_t as_if_instance() const noexcept {
-        if (auto obj = get_object_ptr()) {
-            if (obj->get_type() == ObjectType::INSTANCE) {
-                return reinterpret_cast<instance_t>(obj);
-            }
-        }
-        return nullptr;
+        return is_instance() ? as_instance() : nullptr;
     }
 
     // Bound method
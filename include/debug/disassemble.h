@@ -4,7 +4,9 @@
 #include "core/definitions.h"
 #include "core/objects.h"
 #include "core/op_codes.h"
+#include "core/superinstructions.h"
 #include "core/value.h"
+#include "runtime/bytecode.h"
 #include "runtime/chunk.h"
 
 namespace meow::debug {
@@ -21,44 +23,20 @@ static constexpr std::array<std::string_view, static_cast<size_t>(meow::core::Op
     "GET_INDEX",  "SET_INDEX",     "GET_KEYS",      "GET_VALUES", "NEW_CLASS",  "NEW_INSTANCE", "GET_PROP",    "SET_PROP",  "SET_METHOD",
     "INHERIT",    "GET_SUPER",     "BIT_AND",       "BIT_OR",     "BIT_XOR",    "BIT_NOT",      "LSHIFT",      "RSHIFT",    "THROW",
     "SETUP_TRY",  "POP_TRY",       "IMPORT_MODULE", "EXPORT",     "GET_EXPORT", "IMPORT_ALL",
+    "JUMP_IF_EQ", "JUMP_IF_NEQ",   "JUMP_IF_LT",    "JUMP_IF_LE", "JUMP_IF_NOT_LT", "JUMP_IF_NOT_LE",
+    "FOR_PREP",   "FOR_LOOP",      "FOR_IN",        "ITER_NEW",   "ITER_NEXT",
+    "TAIL_CALL",  "LOAD_SMALLINT", "GUARD_CALLEE",  "WIDE",
+#define MEOW_SUPERINSTRUCTION(NAME, A, B) "SI_" #NAME,
+#define MEOW_SUPERINSTRUCTION3(NAME, A, B, C) "SI_" #NAME,
+#include "core/superinstructions.def"
+#undef MEOW_SUPERINSTRUCTION
+#undef MEOW_SUPERINSTRUCTION3
 };
 
 inline static std::string_view opcode_to_string(OpCode op) noexcept {
     return opcode_strings[static_cast<size_t>(op)];
 }
 
-static inline uint16_t read_u16_le(const uint8_t* code, size_t& ip, size_t code_size) noexcept {
-    if (ip + 2 > code_size) {
-        ip = code_size;
-        return 0;
-    }
-    uint16_t val = static_cast<uint16_t>(code[ip]) | (static_cast<uint16_t>(code[ip + 1]) << 8);
-    ip += 2;
-    return val;
-}
-
-static inline uint64_t read_u64_le(const uint8_t* code, size_t& ip, size_t code_size) noexcept {
-    if (ip + 8 > code_size) {
-        ip = code_size;
-        return 0;
-    }
-    uint64_t val = 0;
-    for (int i = 0; i < 8; ++i) {
-        val |= (static_cast<uint64_t>(code[ip + i]) << (i * 8));
-    }
-    ip += 8;
-    return val;
-}
-
-static inline int64_t read_i64_le(const uint8_t* code, size_t& ip, size_t code_size) noexcept {
-    return std::bit_cast<int64_t>(read_u64_le(code, ip, code_size));
-}
-
-static inline double read_f64_le(const uint8_t* code, size_t& ip, size_t code_size) noexcept {
-    return std::bit_cast<double>(read_u64_le(code, ip, code_size));
-}
-
-
 inline std::string disassemble_chunk(const Chunk& chunk) noexcept {
     std::ostringstream os;
     const uint8_t* code = chunk.get_code();
@@ -107,43 +85,69 @@ inline std::string disassemble_chunk(const Chunk& chunk) noexcept {
     os << "  - Bytecode:\n";
     for (size_t ip = 0; ip < code_size;) {
         size_t inst_offset = ip;
-        uint8_t raw_opcode = code[ip++];
-        OpCode op = static_cast<OpCode>(raw_opcode);
-
         os << "     " << std::right << std::setw(4) << static_cast<int>(inst_offset) << ": ";
-        std::string op_name = std::string(opcode_to_string(op));
+        meow::runtime::Instruction instruction;
+        if (!meow::runtime::decode_instruction(code, code_size, ip, instruction)) {
+            os << "<invalid byte " << static_cast<int>(code[ip]) << ">\n";
+            break;
+        }
+        ip += instruction.size;
+        OpCode op = instruction.op();
+        // Toán hạng lấy lần lượt từ lệnh đã giải mã: ADDR là offset tuyệt đối, IMM64 là 8 byte thô
+        size_t operand_index = 0;
+        auto next_operand = [&]() -> uint64_t {
+            size_t k = operand_index++;
+            if (k >= instruction.layout().operand_count) return 0;
+            switch (instruction.layout().operands[k]) {
+                case meow::runtime::OperandKind::ADDR:
+                    return instruction.address();
+                case meow::runtime::OperandKind::IMM64:
+                    return instruction.imm64();
+                default:
+                    return instruction.operand(k);
+            }
+        };
+
+        std::string op_name = (instruction.wide ? "WIDE " : "") + std::string(opcode_to_string(op));
         os << std::left << std::setw(12) << op_name;
 
-        switch (op) {
+        // Superinstruction mang toán hạng của lệnh đầu, các lệnh sau vẫn được in như bình thường
+        switch (meow::core::superinstruction_head(op)) {
             case OpCode::MOVE: {
-                uint16_t dst = read_u16_le(code, ip, code_size);
-                uint16_t src = read_u16_le(code, ip, code_size);
+                uint16_t dst = static_cast<uint16_t>(next_operand());
+                uint16_t src = static_cast<uint16_t>(next_operand());
                 os << "  args=[dst=" << dst << ", src=" << src << "]";
                 break;
             }
             case OpCode::LOAD_CONST: {
-                uint16_t dst = read_u16_le(code, ip, code_size);
-                uint16_t cidx = read_u16_le(code, ip, code_size);
+                uint16_t dst = static_cast<uint16_t>(next_operand());
+                uint16_t cidx = static_cast<uint16_t>(next_operand());
                 std::string val_str = (cidx < chunk.get_pool_size()) ? value_to_string(chunk.get_constant(cidx)) : "<const_oob>";
                 os << "  args=[dst=" << dst << ", cidx=" << cidx << " -> " << val_str << "]";
                 break;
             }
             case OpCode::LOAD_INT: {
-                uint16_t dst = read_u16_le(code, ip, code_size);
-                int64_t val = read_i64_le(code, ip, code_size);
+                uint16_t dst = static_cast<uint16_t>(next_operand());
+                int64_t val = std::bit_cast<int64_t>(next_operand());
+                os << "  args=[dst=" << dst << ", val=" << val << "]";
+                break;
+            }
+            case OpCode::LOAD_SMALLINT: {
+                uint16_t dst = static_cast<uint16_t>(next_operand());
+                int16_t val = static_cast<int16_t>(next_operand());
                 os << "  args=[dst=" << dst << ", val=" << val << "]";
                 break;
             }
             case OpCode::LOAD_FLOAT: {
-                uint16_t dst = read_u16_le(code, ip, code_size);
-                double val = read_f64_le(code, ip, code_size);
+                uint16_t dst = static_cast<uint16_t>(next_operand());
+                double val = std::bit_cast<double>(next_operand());
                 os << "  args=[dst=" << dst << ", val=" << val << "]";
                 break;
             }
             case OpCode::LOAD_NULL:
             case OpCode::LOAD_TRUE:
             case OpCode::LOAD_FALSE: {
-                uint16_t dst = read_u16_le(code, ip, code_size);
+                uint16_t dst = static_cast<uint16_t>(next_operand());
                 os << "  args=[dst=" << dst << "]";
                 break;
             }
@@ -164,49 +168,49 @@ inline std::string disassemble_chunk(const Chunk& chunk) noexcept {
             case OpCode::BIT_XOR:
             case OpCode::LSHIFT:
             case OpCode::RSHIFT: {
-                uint16_t dst = read_u16_le(code, ip, code_size);
-                uint16_t r1 = read_u16_le(code, ip, code_size);
-                uint16_t r2 = read_u16_le(code, ip, code_size);
+                uint16_t dst = static_cast<uint16_t>(next_operand());
+                uint16_t r1 = static_cast<uint16_t>(next_operand());
+                uint16_t r2 = static_cast<uint16_t>(next_operand());
                 os << "  args=[dst=" << dst << ", r1=" << r1 << ", r2=" << r2 << "]";
                 break;
             }
             case OpCode::NEG:
             case OpCode::NOT:
             case OpCode::BIT_NOT: {
-                uint16_t dst = read_u16_le(code, ip, code_size);
-                uint16_t src = read_u16_le(code, ip, code_size);
+                uint16_t dst = static_cast<uint16_t>(next_operand());
+                uint16_t src = static_cast<uint16_t>(next_operand());
                 os << "  args=[dst=" << dst << ", src=" << src << "]";
                 break;
             }
             case OpCode::GET_GLOBAL: {
-                uint16_t dst = read_u16_le(code, ip, code_size);
-                uint16_t cidx = read_u16_le(code, ip, code_size);
+                uint16_t dst = static_cast<uint16_t>(next_operand());
+                uint16_t cidx = static_cast<uint16_t>(next_operand());
                 std::string name = (cidx < chunk.get_pool_size()) ? value_to_string(chunk.get_constant(cidx)) : "<bad_name>";
                 os << "  args=[dst=" << dst << ", name_idx=" << cidx << " -> " << name << "]";
                 break;
             }
             case OpCode::SET_GLOBAL: {
-                uint16_t name_idx = read_u16_le(code, ip, code_size);
-                uint16_t src = read_u16_le(code, ip, code_size);
+                uint16_t name_idx = static_cast<uint16_t>(next_operand());
+                uint16_t src = static_cast<uint16_t>(next_operand());
                 std::string name = (name_idx < chunk.get_pool_size()) ? value_to_string(chunk.get_constant(name_idx)) : "<bad_name>";
                 os << "  args=[name_idx=" << name_idx << " -> " << name << ", src=" << src << "]";
                 break;
             }
             case OpCode::GET_UPVALUE: {
-                uint16_t dst = read_u16_le(code, ip, code_size);
-                uint16_t uv = read_u16_le(code, ip, code_size);
+                uint16_t dst = static_cast<uint16_t>(next_operand());
+                uint16_t uv = static_cast<uint16_t>(next_operand());
                 os << "  args=[dst=" << dst << ", uv_index=" << uv << "]";
                 break;
             }
             case OpCode::SET_UPVALUE: {
-                uint16_t uv = read_u16_le(code, ip, code_size);
-                uint16_t src = read_u16_le(code, ip, code_size);
+                uint16_t uv = static_cast<uint16_t>(next_operand());
+                uint16_t src = static_cast<uint16_t>(next_operand());
                 os << "  args=[uv_index=" << uv << ", src=" << src << "]";
                 break;
             }
             case OpCode::CLOSURE: {
-                uint16_t dst = read_u16_le(code, ip, code_size);
-                uint16_t proto_idx = read_u16_le(code, ip, code_size);
+                uint16_t dst = static_cast<uint16_t>(next_operand());
+                uint16_t proto_idx = static_cast<uint16_t>(next_operand());
                 os << "  args=[dst=" << dst << ", proto_idx=" << proto_idx;
 
                 if (proto_idx < chunk.get_pool_size() && chunk.get_constant(proto_idx).is_proto()) {
@@ -227,40 +231,82 @@ inline std::string disassemble_chunk(const Chunk& chunk) noexcept {
                 break;
             }
             case OpCode::CLOSE_UPVALUES: {
-                uint16_t start_slot = read_u16_le(code, ip, code_size);
+                uint16_t start_slot = static_cast<uint16_t>(next_operand());
                 os << "  args=[start_slot=" << start_slot << "]";
                 break;
             }
             case OpCode::JUMP:
             case OpCode::SETUP_TRY: {
-                uint16_t target = read_u16_le(code, ip, code_size);
+                uint32_t target = static_cast<uint32_t>(next_operand());
                 os << "  args=[target=" << target << "]";
                 break;
             }
             case OpCode::JUMP_IF_FALSE:
             case OpCode::JUMP_IF_TRUE: {
-                uint16_t reg = read_u16_le(code, ip, code_size);
-                uint16_t target = read_u16_le(code, ip, code_size);
+                uint16_t reg = static_cast<uint16_t>(next_operand());
+                uint32_t target = static_cast<uint32_t>(next_operand());
                 os << "  args=[reg=" << reg << ", target=" << target << "]";
                 break;
             }
+            case OpCode::JUMP_IF_EQ:
+            case OpCode::JUMP_IF_NEQ:
+            case OpCode::JUMP_IF_LT:
+            case OpCode::JUMP_IF_LE:
+            case OpCode::JUMP_IF_NOT_LT:
+            case OpCode::JUMP_IF_NOT_LE: {
+                uint16_t r1 = static_cast<uint16_t>(next_operand());
+                uint16_t r2 = static_cast<uint16_t>(next_operand());
+                uint32_t target = static_cast<uint32_t>(next_operand());
+                os << "  args=[r1=" << r1 << ", r2=" << r2 << ", target=" << target << "]";
+                break;
+            }
+            case OpCode::FOR_PREP:
+            case OpCode::FOR_LOOP:
+            case OpCode::FOR_IN: {
+                uint16_t base = static_cast<uint16_t>(next_operand());
+                uint32_t target = static_cast<uint32_t>(next_operand());
+                os << "  args=[base=" << base << ", target=" << target << "]";
+                break;
+            }
+            case OpCode::ITER_NEW: {
+                uint16_t iter = static_cast<uint16_t>(next_operand());
+                uint16_t src_reg = static_cast<uint16_t>(next_operand());
+                os << "  args=[iter=" << iter << ", src=" << src_reg << "]";
+                break;
+            }
+            case OpCode::ITER_NEXT: {
+                uint16_t iter = static_cast<uint16_t>(next_operand());
+                uint16_t key = static_cast<uint16_t>(next_operand());
+                uint16_t value = static_cast<uint16_t>(next_operand());
+                uint32_t target = static_cast<uint32_t>(next_operand());
+                os << "  args=[iter=" << iter << ", key=" << key << ", value=" << value << ", target=" << target << "]";
+                break;
+            }
+            case OpCode::GUARD_CALLEE: {
+                uint16_t fn_reg = static_cast<uint16_t>(next_operand());
+                uint16_t proto_idx = static_cast<uint16_t>(next_operand());
+                uint32_t target = static_cast<uint32_t>(next_operand());
+                os << "  args=[fn_reg=" << fn_reg << ", proto_idx=" << proto_idx << ", fallback=" << target << "]";
+                break;
+            }
             case OpCode::CALL: {
-                uint16_t dst = read_u16_le(code, ip, code_size);
-                uint16_t fn_reg = read_u16_le(code, ip, code_size);
-                uint16_t arg_start = read_u16_le(code, ip, code_size);
-                uint16_t argc = read_u16_le(code, ip, code_size);
+                uint16_t dst = static_cast<uint16_t>(next_operand());
+                uint16_t fn_reg = static_cast<uint16_t>(next_operand());
+                uint16_t arg_start = static_cast<uint16_t>(next_operand());
+                uint16_t argc = static_cast<uint16_t>(next_operand());
                 os << "  args=[dst=" << dst << ", fn_reg=" << fn_reg << ", arg_start=" << arg_start << ", argc=" << argc << "]";
                 break;
             }
-            case OpCode::CALL_VOID: {
-                uint16_t fn_reg = read_u16_le(code, ip, code_size);
-                uint16_t arg_start = read_u16_le(code, ip, code_size);
-                uint16_t argc = read_u16_le(code, ip, code_size);
+            case OpCode::CALL_VOID:
+            case OpCode::TAIL_CALL: {
+                uint16_t fn_reg = static_cast<uint16_t>(next_operand());
+                uint16_t arg_start = static_cast<uint16_t>(next_operand());
+                uint16_t argc = static_cast<uint16_t>(next_operand());
                 os << "  args=[fn_reg=" << fn_reg << ", arg_start=" << arg_start << ", argc=" << argc << "]";
                 break;
             }
             case OpCode::RETURN: {
-                uint16_t ret_reg = read_u16_le(code, ip, code_size);
+                uint16_t ret_reg = static_cast<uint16_t>(next_operand());
                 os << "  args=[ret_reg=" << ret_reg << ((ret_reg == 0xFFFF) ? " (void)" : "") << "]";
                 break;
             }
@@ -271,111 +317,109 @@ inline std::string disassemble_chunk(const Chunk& chunk) noexcept {
             }
             case OpCode::NEW_ARRAY:
             case OpCode::NEW_HASH: {
-                uint16_t dst = read_u16_le(code, ip, code_size);
-                uint16_t start_idx = read_u16_le(code, ip, code_size);
-                uint16_t count = read_u16_le(code, ip, code_size);
+                uint16_t dst = static_cast<uint16_t>(next_operand());
+                uint16_t start_idx = static_cast<uint16_t>(next_operand());
+                uint16_t count = static_cast<uint16_t>(next_operand());
                 os << "  args=[dst=" << dst << ", start_idx=" << start_idx << ", count=" << count << "]";
                 break;
             }
             case OpCode::GET_INDEX: {
-                uint16_t dst = read_u16_le(code, ip, code_size);
-                uint16_t src_reg = read_u16_le(code, ip, code_size);
-                uint16_t key_reg = read_u16_le(code, ip, code_size);
+                uint16_t dst = static_cast<uint16_t>(next_operand());
+                uint16_t src_reg = static_cast<uint16_t>(next_operand());
+                uint16_t key_reg = static_cast<uint16_t>(next_operand());
                 os << "  args=[dst=" << dst << ", src=" << src_reg << ", key=" << key_reg << "]";
                 break;
             }
             case OpCode::SET_INDEX: {
-                uint16_t src_reg = read_u16_le(code, ip, code_size);
-                uint16_t key_reg = read_u16_le(code, ip, code_size);
-                uint16_t val_reg = read_u16_le(code, ip, code_size);
+                uint16_t src_reg = static_cast<uint16_t>(next_operand());
+                uint16_t key_reg = static_cast<uint16_t>(next_operand());
+                uint16_t val_reg = static_cast<uint16_t>(next_operand());
                 os << "  args=[src=" << src_reg << ", key=" << key_reg << ", val=" << val_reg << "]";
                 break;
             }
             case OpCode::GET_KEYS:
             case OpCode::GET_VALUES: {
-                uint16_t dst = read_u16_le(code, ip, code_size);
-                uint16_t src_reg = read_u16_le(code, ip, code_size);
+                uint16_t dst = static_cast<uint16_t>(next_operand());
+                uint16_t src_reg = static_cast<uint16_t>(next_operand());
                 os << "  args=[dst=" << dst << ", src=" << src_reg << "]";
                 break;
             }
             case OpCode::IMPORT_MODULE: {
-                uint16_t dst = read_u16_le(code, ip, code_size);
-                uint16_t path_idx = read_u16_le(code, ip, code_size);
+                uint16_t dst = static_cast<uint16_t>(next_operand());
+                uint16_t path_idx = static_cast<uint16_t>(next_operand());
                 os << "  args=[dst=" << dst << ", path_idx=" << path_idx << "]";
                 break;
             }
             case OpCode::EXPORT: {
-                uint16_t name_idx = read_u16_le(code, ip, code_size);
-                uint16_t src_reg = read_u16_le(code, ip, code_size);
+                uint16_t name_idx = static_cast<uint16_t>(next_operand());
+                uint16_t src_reg = static_cast<uint16_t>(next_operand());
                 os << "  args=[name_idx=" << name_idx << ", src=" << src_reg << "]";
                 break;
             }
             case OpCode::GET_EXPORT: {
-                uint16_t dst = read_u16_le(code, ip, code_size);
-                uint16_t module_reg = read_u16_le(code, ip, code_size);
-                uint16_t name_idx = read_u16_le(code, ip, code_size);
+                uint16_t dst = static_cast<uint16_t>(next_operand());
+                uint16_t module_reg = static_cast<uint16_t>(next_operand());
+                uint16_t name_idx = static_cast<uint16_t>(next_operand());
                 os << "  args=[dst=" << dst << ", module_reg=" << module_reg << ", name_idx=" << name_idx << "]";
                 break;
             }
             case OpCode::IMPORT_ALL: {
-                uint16_t module_reg = read_u16_le(code, ip, code_size);
+                uint16_t module_reg = static_cast<uint16_t>(next_operand());
                 os << "  args=[module_reg=" << module_reg << "]";
                 break;
             }
             case OpCode::NEW_CLASS: {
-                uint16_t dst = read_u16_le(code, ip, code_size);
-                uint16_t name_idx = read_u16_le(code, ip, code_size);
+                uint16_t dst = static_cast<uint16_t>(next_operand());
+                uint16_t name_idx = static_cast<uint16_t>(next_operand());
                 os << "  args=[dst=" << dst << ", name_idx=" << name_idx << "]";
                 break;
             }
             case OpCode::NEW_INSTANCE: {
-                uint16_t dst = read_u16_le(code, ip, code_size);
-                uint16_t class_reg = read_u16_le(code, ip, code_size);
+                uint16_t dst = static_cast<uint16_t>(next_operand());
+                uint16_t class_reg = static_cast<uint16_t>(next_operand());
                 os << "  args=[dst=" << dst << ", class_reg=" << class_reg << "]";
                 break;
             }
             case OpCode::GET_PROP: {
-                uint16_t dst = read_u16_le(code, ip, code_size);
-                uint16_t obj_reg = read_u16_le(code, ip, code_size);
-                uint16_t name_idx = read_u16_le(code, ip, code_size);
+                uint16_t dst = static_cast<uint16_t>(next_operand());
+                uint16_t obj_reg = static_cast<uint16_t>(next_operand());
+                uint16_t name_idx = static_cast<uint16_t>(next_operand());
                 os << "  args=[dst=" << dst << ", obj_reg=" << obj_reg << ", name_idx=" << name_idx << "]";
                 break;
             }
             case OpCode::SET_PROP: {
-                uint16_t obj_reg = read_u16_le(code, ip, code_size);
-                uint16_t name_idx = read_u16_le(code, ip, code_size);
-                uint16_t val_reg = read_u16_le(code, ip, code_size);
+                uint16_t obj_reg = static_cast<uint16_t>(next_operand());
+                uint16_t name_idx = static_cast<uint16_t>(next_operand());
+                uint16_t val_reg = static_cast<uint16_t>(next_operand());
                 os << "  args=[obj_reg=" << obj_reg << ", name_idx=" << name_idx << ", val_reg=" << val_reg << "]";
                 break;
             }
             case OpCode::SET_METHOD: {
-                uint16_t class_reg = read_u16_le(code, ip, code_size);
-                uint16_t name_idx = read_u16_le(code, ip, code_size);
-                uint16_t method_reg = read_u16_le(code, ip, code_size);
+                uint16_t class_reg = static_cast<uint16_t>(next_operand());
+                uint16_t name_idx = static_cast<uint16_t>(next_operand());
+                uint16_t method_reg = static_cast<uint16_t>(next_operand());
                 os << "  args=[class_reg=" << class_reg << ", name_idx=" << name_idx << ", method_reg=" << method_reg << "]";
                 break;
             }
             case OpCode::INHERIT: {
-                uint16_t sub_class_reg = read_u16_le(code, ip, code_size);
-                uint16_t super_class_reg = read_u16_le(code, ip, code_size);
+                uint16_t sub_class_reg = static_cast<uint16_t>(next_operand());
+                uint16_t super_class_reg = static_cast<uint16_t>(next_operand());
                 os << "  args=[sub_class_reg=" << sub_class_reg << ", super_class_reg=" << super_class_reg << "]";
                 break;
             }
             case OpCode::GET_SUPER: {
-                uint16_t dst = read_u16_le(code, ip, code_size);
-                uint16_t name_idx = read_u16_le(code, ip, code_size);
+                uint16_t dst = static_cast<uint16_t>(next_operand());
+                uint16_t name_idx = static_cast<uint16_t>(next_operand());
                 os << "  args=[dst=" << dst << ", name_idx=" << name_idx << "]";
                 break;
             }
             case OpCode::THROW: {
-                uint16_t reg = read_u16_le(code, ip, code_size);
+                uint16_t reg = static_cast<uint16_t>(next_operand());
                 os << "  args=[reg=" << reg << "]";
                 break;
             }
             default: {
                 os << "  args=[<unparsed>]";
-                // Cố gắng nhảy qua các tham số nếu không biết
-                // (Đây là phỏng đoán, có thể không chính xác)
                 break;
             }
         }
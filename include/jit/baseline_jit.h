@@ -0,0 +1,132 @@
+#pragma once
+
+#include "common/pch.h"
+#include "core/op_codes.h"
+#include "core/type.h"
+#include "jit/code_memory.h"
+#include "jit/stencil_abi.h"
+
+namespace meow::core {
+class Value;
+}
+
+namespace meow::jit {
+
+/// @brief How the baseline tier generates machine code
+enum class JitBackend : uint8_t {
+    ASSEMBLER,  ///< Hand-written x86-64 templates (x64_assembler.h)
+    STENCILS,   ///< Copy-and-patch of compiler-generated stencils (stencil_jit.h), x86-64 and AArch64
+};
+
+struct JitOptions {
+    bool enabled = true;                        ///< Compile hot protos at all
+    uint32_t threshold = 1000;                  ///< Calls a proto runs interpreted before it is compiled
+    uint32_t osr_threshold = 1000;              ///< Loop back-edges a proto runs interpreted before it is compiled and entered mid-loop
+    JitBackend backend = JitBackend::ASSEMBLER; ///< Preferred backend; the other one is used if this one is not built
+    bool tracing = true;                        ///< Record and compile traces of hot loops (TraceJit)
+    uint32_t trace_threshold = 56;              ///< Back-edges to a loop header before its first iteration is recorded
+
+    /// @brief Defaults, disabled when $MEOW_NO_JIT is set to anything but "0"; $MEOW_JIT_THRESHOLD and
+    /// $MEOW_OSR_THRESHOLD override the thresholds and $MEOW_JIT_BACKEND ("assembler" or "stencils") the backend. $MEOW_NO_TRACE turns tracing off
+    /// alone and $MEOW_TRACE_THRESHOLD overrides its threshold
+    [[nodiscard]] static JitOptions from_environment() noexcept;
+};
+
+/// @brief Native code of one proto. Every instruction the translator handles is also an entry point
+class CompiledCode {
+public:
+    static constexpr uint32_t NO_ENTRY = static_cast<uint32_t>(-1);
+    using entry_t = uint32_t (*)(core::Value* registers);
+    /// @brief See BaselineJit::CalloutFn
+    using callout_t = core::Value* (*)(void* context, uint32_t pc) noexcept;
+    /// @brief A proto compiled ahead of time by meow-aotc (module/aot_module.h): one function for the whole
+    /// proto, entered at any instruction
+    using native_t = uint32_t (*)(core::Value* registers, uint32_t pc, void* context, callout_t callout);
+
+    CompiledCode(CodeMemory&& memory, std::vector<uint32_t>&& entries) noexcept : memory_(std::move(memory)), entries_(std::move(entries)) {
+    }
+    CompiledCode(native_t native, void* context, callout_t callout) noexcept : native_(native), context_(context), callout_(callout) {
+    }
+
+    /// @brief Runs from the instruction at `pc` with `registers` pointing at R0 of the frame, until an
+    /// instruction the native code leaves to the interpreter
+    /// @return Offset of the instruction to resume at, possibly or'ed with PENDING_ERROR
+    [[nodiscard]] inline uint32_t enter(core::Value* registers, size_t pc) const noexcept {
+        if (native_ != nullptr) return native_(registers, static_cast<uint32_t>(pc), context_, callout_);
+        uint32_t entry = pc < entries_.size() ? entries_[pc] : NO_ENTRY;
+        if (entry == NO_ENTRY) return static_cast<uint32_t>(pc);
+        return reinterpret_cast<entry_t>(memory_.data() + entry)(registers);
+    }
+
+    [[nodiscard]] inline size_t code_size() const noexcept {
+        return memory_.size();
+    }
+
+private:
+    CodeMemory memory_;
+    std::vector<uint32_t> entries_;  ///< Bytecode offset -> offset in memory_, NO_ENTRY if not enterable
+    native_t native_ = nullptr;      ///< Set instead of the two above for ahead-of-time code
+    void* context_ = nullptr;
+    callout_t callout_ = nullptr;
+};
+
+/// @brief Straight-line opcodes the compiled code runs by calling back into the interpreter's handler
+[[nodiscard]] bool is_callout_opcode(core::OpCode op) noexcept;
+
+/// @brief Header of the loop the instruction at `pc` jumps back to, or CompiledCode::NO_ENTRY if it is not a back-edge the
+/// interpreter counts (JUMP, conditional and compare-jumps and FOR_LOOP with a target before `pc`)
+[[nodiscard]] uint32_t back_edge_target(const uint8_t* code, size_t pc) noexcept;
+
+/**
+ * @brief Baseline tier: translates a hot proto's bytecode 1:1 into machine code, with the int/float fast paths
+ * of arithmetic, comparisons, branches and numeric loops inline and the registers kept in the frame
+ *
+ * Straight-line object operations (GET_PROP, GET_INDEX, GET_GLOBAL...) call back into the interpreter's
+ * handlers. Everything else (calls, returns, throws, generic operator overloads, a fast path whose type
+ * guard fails) returns to the interpreter at that instruction; it re-enters the native code at the next
+ * loop back-edge, call or return into the proto.
+ *
+ * On-stack replacement needs no frame transfer: the code runs on the interpreter's register window in place
+ * and every instruction it handles is an entry point, so a proto compiled at a back-edge is entered right at
+ * the loop header, in the middle of the activation that made it hot.
+ * @note Needs the NaN-boxed Value and either x86-64 System V (assembler) or stencils generated by the build,
+ * create() returns nullptr elsewhere
+ */
+class BaselineJit {
+public:
+    /// @brief Runs the callout instruction at `pc` of the current frame
+    /// @return R0 of the current frame (the register file may have moved), or nullptr if the handler raised an
+    /// error, which the interpreter then raises at `pc`
+    using CalloutFn = CompiledCode::callout_t;
+
+    BaselineJit(const JitOptions& options, JitBackend backend, void* context, CalloutFn callout) noexcept
+        : options_(options), backend_(backend), context_(context), callout_(callout) {
+    }
+
+    /// @brief nullptr if the options disable the JIT or the platform cannot run its code
+    [[nodiscard]] static std::unique_ptr<BaselineJit> create(const JitOptions& options, void* context, CalloutFn callout);
+
+    [[nodiscard]] inline uint32_t get_threshold() const noexcept {
+        return options_.threshold;
+    }
+    [[nodiscard]] inline uint32_t get_osr_threshold() const noexcept {
+        return options_.osr_threshold;
+    }
+    [[nodiscard]] inline JitBackend get_backend() const noexcept {
+        return backend_;
+    }
+
+    /// @brief Translates `proto` and attaches the code to it
+    /// @param loop_flags TraceJit::loop_flags() of the proto, or nullptr: the code then returns to the
+    /// interpreter at a back-edge whose header has a trace, so the trace runs instead
+    /// @return nullptr if the proto cannot be translated; it then stays interpreted
+    const CompiledCode* compile(core::proto_t proto, const uint8_t* loop_flags = nullptr);
+
+private:
+    JitOptions options_;
+    JitBackend backend_;  ///< The one actually used
+    void* context_;
+    CalloutFn callout_;
+    std::vector<std::unique_ptr<CompiledCode>> compiled_;  ///< Owned here so code outlives any frame running it
+};
+}  // namespace meow::jit
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "common/pch.h"
+
+namespace meow::jit {
+
+/**
+ * @brief Executable mapping of one block of machine code. The pages are writable only while the code is
+ * copied in and executable only afterwards (W^X), never both
+ */
+class CodeMemory {
+public:
+    CodeMemory() = default;
+    CodeMemory(const CodeMemory&) = delete;
+    CodeMemory& operator=(const CodeMemory&) = delete;
+    CodeMemory(CodeMemory&& other) noexcept;
+    CodeMemory& operator=(CodeMemory&& other) noexcept;
+    ~CodeMemory() noexcept;
+
+    /// @brief Copies `code` into fresh pages and seals them read+execute
+    /// @return std::nullopt if the platform refuses the mapping
+    [[nodiscard]] static std::optional<CodeMemory> map(const std::vector<uint8_t>& code) noexcept;
+
+    [[nodiscard]] inline const uint8_t* data() const noexcept {
+        return data_;
+    }
+    [[nodiscard]] inline size_t size() const noexcept {
+        return size_;
+    }
+
+private:
+    CodeMemory(uint8_t* data, size_t size) noexcept : data_(data), size_(size) {
+    }
+
+    uint8_t* data_ = nullptr;
+    size_t size_ = 0;  ///< Mapped size, a multiple of the page size
+};
+}  // namespace meow::jit
@@ -0,0 +1,85 @@
+#pragma once
+
+// Shared by the stencil sources (compiled on their own by the build, without the VM headers), the
+// generated stencil table and the copy-and-patch backend, so it only uses <cstdint>
+#include <cstdint>
+
+namespace meow::jit {
+
+/// @brief Flag in the offset returned by compiled code: a callout raised an error at that instruction
+inline constexpr uint32_t PENDING_ERROR = 1u << 31;
+
+/// @brief Values patched into a stencil. Each is an extern symbol `meow_hole_<name>` the stencil takes the address of
+#define MEOW_STENCIL_VALUE_HOLES(X) \
+    X(A)           /* byte offset of the first register operand from R0 */ \
+    X(B)           /* second register operand */ \
+    X(C)           /* third register operand */ \
+    X(PC)          /* bytecode offset of the instruction, returned when it leaves to the interpreter */ \
+    X(BITS)        /* bits of the Value a LOAD stores */ \
+    X(INDEX)       /* type index of that Value */ \
+    X(NULL_INDEX)  /* layout of the NaN-boxed Value, probed at startup */ \
+    X(BOOL_INDEX) \
+    X(INT_INDEX) \
+    X(FLOAT_INDEX) \
+    X(INT_TAG) \
+    X(NAN_BITS) \
+    X(CONTEXT)     /* first argument of the callout */ \
+    X(CALLOUT)     /* BaselineJit::CalloutFn */ \
+    X(FLAG)        /* address of the loop's TraceJit flag, see LOOP_CHECK */
+
+/// @brief Code a stencil tail-calls. Each is a hidden function `meow_hole_<name>` so the compiler emits a direct jump
+#define MEOW_STENCIL_CODE_HOLES(X) \
+    X(CONTINUE)  /* next instruction; the jump is dropped when it ends the stencil */ \
+    X(JUMP)      /* branch target */
+
+/// @brief Every stencil, one extern "C" function `meow_stencil_<name>`
+#define MEOW_STENCILS(X) \
+    X(LOAD) \
+    X(MOVE) \
+    X(ADD) \
+    X(JUMP) \
+    X(JUMP_IF_FALSE) \
+    X(JUMP_IF_TRUE) \
+    X(JUMP_IF_EQ) \
+    X(JUMP_IF_NEQ) \
+    X(JUMP_IF_LT) \
+    X(JUMP_IF_LE) \
+    X(JUMP_IF_NOT_LT) \
+    X(JUMP_IF_NOT_LE) \
+    X(FOR_LOOP) \
+    X(CALLOUT) \
+    X(LOOP_CHECK) /* before a back-edge: leaves if the loop has a trace */ \
+    X(LEAVE)
+
+enum class Hole : uint8_t {
+#define MEOW_HOLE_ENUM(name) name,
+    MEOW_STENCIL_VALUE_HOLES(MEOW_HOLE_ENUM) MEOW_STENCIL_CODE_HOLES(MEOW_HOLE_ENUM)
+#undef MEOW_HOLE_ENUM
+};
+
+/// @brief Relocation kinds the stencil generator keeps, mapped from the object file's ELF types. A branch to a
+/// value hole (a call to the callout) goes through a veneer the backend appends after the code
+enum class RelocKind : uint8_t {
+    ABS64,           ///< 64-bit absolute: hole + addend
+    X64_REL32,       ///< rel32 of an x86-64 call/jmp/jcc: target + addend - place
+    ARM64_BRANCH26,  ///< imm26 of an AArch64 B/BL: (target + addend - place) / 4
+    ARM64_MOVW0,     ///< imm16 of an AArch64 MOVZ/MOVK: bits 0-15 of hole + addend
+    ARM64_MOVW1,     ///< bits 16-31
+    ARM64_MOVW2,     ///< bits 32-47
+    ARM64_MOVW3,     ///< bits 48-63
+};
+
+struct StencilReloc {
+    uint32_t offset;  ///< Place to patch, from the start of the stencil
+    RelocKind kind;
+    Hole hole;
+    int64_t addend;
+};
+
+struct Stencil {
+    const uint8_t* code;
+    uint32_t size;  ///< Without the trailing jump to `continue`, if there was one
+    const StencilReloc* relocs;
+    uint32_t reloc_count;
+};
+}  // namespace meow::jit
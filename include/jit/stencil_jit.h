@@ -0,0 +1,25 @@
+#pragma once
+
+#include "common/pch.h"
+#include "core/type.h"
+#include "jit/baseline_jit.h"
+#include "jit/value_layout.h"
+
+namespace meow::jit {
+
+/// @brief Whether the build generated stencils for the target this binary runs on
+[[nodiscard]] bool stencils_available() noexcept;
+
+/**
+ * @brief Copy-and-patch backend of the baseline tier: each instruction becomes a copy of the stencil the
+ * compiler generated for it (src/jit/stencils/stencils.cpp), with its holes patched to the operands and its
+ * tail jumps to the next instruction or the branch target. Covers the same instructions as the x86-64
+ * assembler and returns to the interpreter in the same places
+ * @param loop_flags See BaselineJit::compile()
+ * @param out Machine code, position independent as long as it is mapped at a page boundary
+ * @param entries Bytecode offset -> offset in `out`, CompiledCode::NO_ENTRY if not enterable
+ * @return false if the proto cannot be translated
+ */
+[[nodiscard]] bool translate_stencils(const ValueLayout& layout, core::proto_t proto, void* context, BaselineJit::CalloutFn callout,
+                                      const uint8_t* loop_flags, std::vector<uint8_t>& out, std::vector<uint32_t>& entries);
+}  // namespace meow::jit
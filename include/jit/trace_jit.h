@@ -0,0 +1,106 @@
+#pragma once
+
+#include "common/pch.h"
+#include "core/type.h"
+#include "jit/baseline_jit.h"
+#include "jit/code_memory.h"
+#include "jit/value_layout.h"
+
+namespace meow::core {
+class Value;
+}
+
+namespace meow::jit {
+
+/// @brief Native code of one loop, entered at its header with R0 of the frame
+class Trace {
+public:
+    using entry_t = uint32_t (*)(core::Value* registers);
+
+    explicit Trace(uint32_t header) noexcept : header_(header) {
+    }
+
+    /// @brief Installs the code once it is compiled; the code refers to iterations() so the Trace comes first
+    inline void attach(CodeMemory&& memory) noexcept {
+        memory_ = std::move(memory);
+    }
+
+    /// @brief Runs iterations until a guard fails
+    /// @return Offset of the instruction the interpreter resumes at, with the registers written back
+    [[nodiscard]] inline uint32_t enter(core::Value* registers) noexcept {
+        ++entries_;
+        return reinterpret_cast<entry_t>(memory_.data())(registers);
+    }
+
+    [[nodiscard]] inline uint32_t get_header() const noexcept {
+        return header_;
+    }
+    [[nodiscard]] inline uint64_t get_entries() const noexcept {
+        return entries_;
+    }
+    /// @brief Counter the code bumps on every back-edge
+    [[nodiscard]] inline uint64_t& iterations() noexcept {
+        return iterations_;
+    }
+    /// @brief Iterations run since the previous call
+    [[nodiscard]] inline uint64_t take_recent_iterations() noexcept {
+        return iterations_ - std::exchange(reviewed_iterations_, iterations_);
+    }
+
+private:
+    CodeMemory memory_;
+    uint32_t header_;
+    uint64_t entries_ = 0;
+    uint64_t iterations_ = 0;
+    uint64_t reviewed_iterations_ = 0;
+};
+
+/// @brief Per-proto state of the tracing tier, indexed by the bytecode offset of a loop header
+struct LoopTraces {
+    std::vector<uint16_t> hotness;             ///< Back-edges taken to the header; TraceJit::BLACKLISTED once given up on
+    std::vector<uint8_t> attempts;             ///< Recordings that failed
+    std::vector<uint8_t> has_trace;            ///< Non-zero while a trace exists; baseline code tests it at its back-edges
+    std::vector<std::unique_ptr<Trace>> traces;
+};
+
+/**
+ * @brief Tracing tier for hot loops: after `JitOptions::trace_threshold` back-edges to the same header, records
+ * one iteration of the loop (the path actually taken, with the types actually seen), turns it into a typed SSA
+ * IR and compiles it into a native loop that keeps values in machine registers
+ *
+ * The IR gets constant folding, copy propagation, guard elimination (types are checked once at entry; branch
+ * guards that repeat or have constant operands disappear) and loop-invariant code motion before linear-scan
+ * register allocation. A failing guard leaves through a side exit that boxes the live values back into the
+ * frame's registers and returns the offset of the instruction to resume at; the frame and its ip are never
+ * left inconsistent because a trace never spans calls.
+ *
+ * Only the numeric core is traced: loads, MOVE, int/float ADD, compare-jumps, truthiness jumps and the int
+ * FOR_LOOP. Anything else aborts the recording and the loop stays with the baseline tier.
+ * @note Shares the x86-64 assembler of the baseline tier, create() returns nullptr elsewhere
+ */
+class TraceJit {
+public:
+    static constexpr uint16_t BLACKLISTED = std::numeric_limits<uint16_t>::max();
+
+    TraceJit(const JitOptions& options, const ValueLayout& layout) noexcept : options_(options), layout_(layout) {
+    }
+
+    /// @brief nullptr if the options disable tracing or the platform cannot run its code
+    [[nodiscard]] static std::unique_ptr<TraceJit> create(const JitOptions& options);
+
+    /// @brief Called on every back-edge the interpreter takes, with `header` the offset it jumps to and `registers`
+    /// R0 of the current frame. Counts, records, compiles and runs the loop's trace as needed
+    /// @return Offset to continue at: `header` if no trace ran, otherwise where the trace left
+    uint32_t run_loop(core::proto_t proto, uint32_t header, core::Value* registers);
+
+    /// @brief The `has_trace` flags of `proto`, created on demand so their address is stable for baseline code
+    [[nodiscard]] const uint8_t* loop_flags(core::proto_t proto);
+
+private:
+    JitOptions options_;
+    ValueLayout layout_;
+    std::vector<std::unique_ptr<LoopTraces>> loops_;  ///< Owned here, outliving any frame of the proto
+
+    LoopTraces& loops_of(core::proto_t proto);
+};
+}  // namespace meow::jit
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "common/pch.h"
+
+namespace meow::core {
+class Value;
+}
+namespace meow::runtime {
+class Chunk;
+}
+
+namespace meow::jit {
+
+inline constexpr int32_t VALUE_SIZE = 16;
+inline constexpr int32_t INDEX_OFFSET = 8;  ///< Type index byte of the NaN-boxed Value, right after its 8 bits
+inline constexpr uint64_t PAYLOAD_MASK = (uint64_t{1} << 48) - 1;
+
+struct ValueBits {
+    uint64_t bits;
+    uint8_t index;
+};
+
+/// @brief Encoding of the values the generated code builds or tests without calling C++
+struct ValueLayout {
+    ValueBits null;
+    ValueBits false_;
+    uint8_t int_index;
+    uint8_t float_index;
+    uint64_t int_tag;   ///< Bits of int 0, or'ed with a 48-bit payload
+    uint64_t nan_bits;  ///< The one NaN a float Value may hold
+};
+
+/// @brief Raw bits and type index of a NaN-boxed Value
+[[nodiscard]] ValueBits bits_of(const core::Value& value) noexcept;
+
+/// @brief Bits of the Value the LOAD_NULL/TRUE/FALSE/INT/SMALLINT/FLOAT/CONST instruction at `pc` stores
+/// @return std::nullopt if its constant index is out of range
+[[nodiscard]] std::optional<ValueBits> loaded_value(const runtime::Chunk& chunk, size_t pc) noexcept;
+
+/// @brief Measures the encoding actually compiled in, std::nullopt if it is not the one the JIT backends assume
+[[nodiscard]] std::optional<ValueLayout> probe_layout() noexcept;
+}  // namespace meow::jit
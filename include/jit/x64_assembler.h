@@ -0,0 +1,120 @@
+#pragma once
+
+#include "common/pch.h"
+#include "utils/types/variant.h"
+
+/// @brief Whether this build can run the code X64Assembler produces: x86-64 System V with the NaN-boxed Value
+#if defined(__x86_64__) && (defined(__unix__) || defined(__APPLE__)) && MEOW_CAN_USE_NAN_BOXING
+#define MEOW_JIT_X64 1
+#else
+#define MEOW_JIT_X64 0
+#endif
+
+namespace meow::jit {
+
+enum class Reg : uint8_t { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+enum class Xmm : uint8_t { XMM0, XMM1, XMM2, XMM3, XMM4, XMM5, XMM6, XMM7, XMM8, XMM9, XMM10, XMM11, XMM12, XMM13, XMM14, XMM15 };
+
+/// @brief Condition codes, in the encoding order of Jcc/SETcc
+enum class Cond : uint8_t { O, NO, B, AE, E, NE, BE, A, S, NS, P, NP, L, GE, LE, G };
+
+[[nodiscard]] inline constexpr Cond invert(Cond cond) noexcept {
+    return static_cast<Cond>(static_cast<uint8_t>(cond) ^ 1);
+}
+
+/// @brief `[base + disp]`
+struct Mem {
+    Reg base;
+    int32_t disp;
+};
+
+struct Label {
+    uint32_t id;
+};
+
+/**
+ * @brief Minimal x86-64 encoder for the JIT: just the instructions the translator emits, every memory
+ * operand as [base + disp32] and every branch as rel32
+ */
+class X64Assembler {
+public:
+    [[nodiscard]] Label new_label();
+    void bind(Label label);
+    [[nodiscard]] inline size_t offset() const noexcept {
+        return code_.size();
+    }
+
+    // --- Integer ---
+    void mov(Reg dst, Reg src);
+    void mov(Reg dst, Mem src);
+    void mov(Mem dst, Reg src);
+    void mov(Reg dst, uint64_t imm);
+    void mov8(Mem dst, uint8_t imm);
+    void cmp8(Mem lhs, uint8_t imm);
+    void test8(Mem lhs, uint8_t imm);
+    void add(Reg dst, Reg src);
+    void sub(Reg dst, Reg src);
+    void and_(Reg dst, Reg src);
+    void or_(Reg dst, Reg src);
+    void xor_(Reg dst, Reg src);
+    void cmp(Reg lhs, Reg rhs);
+    void test(Reg lhs, Reg rhs);
+    void imul(Reg dst, Reg src);
+    void neg(Reg reg);
+    void shl(Reg reg, uint8_t count);
+    void shr(Reg reg, uint8_t count);
+    void sar(Reg reg, uint8_t count);
+    void add_rsp(int8_t imm);
+    void inc(Mem dst);
+    void push(Reg reg);
+    void pop(Reg reg);
+    /// @brief `dst = zero-extended (cond ? 1 : 0)`
+    void set(Cond cond, Reg dst);
+
+    // --- SSE2 double ---
+    void movsd(Xmm dst, Mem src);
+    void movsd(Xmm dst, Xmm src);
+    void addsd(Xmm dst, Xmm src);
+    void addsd(Xmm dst, Mem src);
+    void subsd(Xmm dst, Mem src);
+    void mulsd(Xmm dst, Mem src);
+    void divsd(Xmm dst, Mem src);
+    void ucomisd(Xmm lhs, Xmm rhs);
+    void movq(Reg dst, Xmm src);
+    void movq(Xmm dst, Reg src);
+
+    // --- Control flow ---
+    void jmp(Label target);
+    void j(Cond cond, Label target);
+    void call(Reg target);
+    void ret();
+
+    /// @brief Patches every branch and hands over the machine code
+    /// @return false if a branch targets a label that was never bound
+    [[nodiscard]] bool finish(std::vector<uint8_t>& out);
+
+private:
+    static constexpr uint32_t UNBOUND = static_cast<uint32_t>(-1);
+
+    struct Fixup {
+        size_t at;  ///< Offset of the rel32 field
+        uint32_t label;
+    };
+
+    std::vector<uint8_t> code_;
+    std::vector<uint32_t> labels_;
+    std::vector<Fixup> fixups_;
+
+    void emit8(uint8_t byte);
+    void emit32(uint32_t value);
+    void emit64(uint64_t value);
+    void rex(bool w, uint8_t reg, uint8_t base, bool force = false);
+    void modrm_mem(uint8_t reg, Mem mem);
+    void modrm_reg(uint8_t reg, uint8_t rm);
+    void alu(uint8_t opcode, Reg dst, Reg src);
+    void shift(uint8_t ext, Reg reg, uint8_t count);
+    void sse(uint8_t prefix, uint8_t opcode, uint8_t reg, Mem mem);
+    void sse(uint8_t prefix, uint8_t opcode, uint8_t reg, uint8_t rm);
+    void rel32(Label target);
+};
+}  // namespace meow::jit
@@ -11,10 +11,6 @@ struct BuiltinRegistry;
 }  // namespace meow::runtime
 
 namespace meow::memory {
-struct GCMetadata {
-    bool is_marked_ = false;
-};
-
 class MarkSweepGC : public GarbageCollector, public GCVisitor {
 public:
     explicit MarkSweepGC(meow::runtime::ExecutionContext* context, meow::runtime::BuiltinRegistry* builtins) noexcept : context_(context), builtins_(builtins) {
@@ -29,7 +25,8 @@ public:
     void visit_value(meow::core::param_t value) noexcept override;
     void visit_object(const meow::core::MeowObject* object) noexcept override;
 private:
-    std::unordered_map<const meow::core::MeowObject*, GCMetadata> metadata_;
+    // Mark bit nằm trong header của object, nên chỉ cần một danh sách phẳng
+    std::vector<const meow::core::MeowObject*> objects_;
     meow::runtime::ExecutionContext* context_ = nullptr;
     meow::runtime::BuiltinRegistry* builtins_ = nullptr;
 
@@ -4,6 +4,7 @@
 #include "core/objects.h"
 #include "core/type.h"
 #include "memory/garbage_collector.h"
+#include "utils/string/string_hash.h"
 
 namespace meow::memory {
 class MemoryManager {
@@ -11,9 +12,17 @@ public:
     explicit MemoryManager(std::unique_ptr<meow::memory::GarbageCollector> gc) noexcept;
     ~MemoryManager() noexcept;
     [[nodiscard]] meow::core::array_t new_array(const std::vector<meow::core::Value>& elements = {}) noexcept;
+    [[nodiscard]] meow::core::array_t new_array(std::vector<meow::core::int_t>&& elements) noexcept;
+    [[nodiscard]] meow::core::array_t new_array(std::vector<meow::core::float_t>&& elements) noexcept;
     // [[nodiscard]] meow::core::string_t new_string(const std::string& string) noexcept;
     [[nodiscard]] meow::core::string_t new_string(std::string_view str_view) noexcept;
     [[nodiscard]] meow::core::string_t new_string(const char* chars, size_t length) noexcept;
+    /// @brief Like new_string, without hashing when the string is already interned
+    /// @return nullptr if `str.hash` is not the hash of `str.text`
+    [[nodiscard]] meow::core::string_t new_string(const meow::utils::string::PrehashedString& str) noexcept;
+    /// @brief Interns a whole string table at once (a .meowb module's)
+    /// @return One string per entry, in order, nullptr where the hash is wrong
+    [[nodiscard]] std::vector<meow::core::string_t> intern_strings(std::span<const meow::utils::string::PrehashedString> strings) noexcept;
     [[nodiscard]] meow::core::hash_table_t new_hash(const std::unordered_map<meow::core::string_t, meow::core::Value>& fields = {}) noexcept;
     [[nodiscard]] meow::core::upvalue_t new_upvalue(size_t index) noexcept;
     [[nodiscard]] meow::core::proto_t new_proto(size_t registers, size_t upvalues, meow::core::string_t name, meow::runtime::Chunk&& chunk) noexcept;
@@ -32,20 +41,18 @@ public:
     inline void disable_gc() noexcept {
         gc_enabled_ = false;
     }
+    [[nodiscard]] inline bool is_gc_enabled() const noexcept {
+        return gc_enabled_;
+    }
     inline void collect() noexcept {
         object_allocated_ = gc_->collect();
     }
 private:
-    struct StringHash {
-        using is_transparent = void;
-        
-        size_t operator()(const char* txt) const { return std::hash<std::string_view>{}(txt); }
-        size_t operator()(std::string_view txt) const { return std::hash<std::string_view>{}(txt); }
-        size_t operator()(const std::string& txt) const { return std::hash<std::string>{}(txt); }
-    };
+    using StringHash = meow::utils::string::StringHash;
 
     std::unique_ptr<meow::memory::GarbageCollector> gc_;
-    std::unordered_map<std::string, meow::core::string_t, StringHash, std::equal_to<>> string_pool_;
+    // Key giữ sẵn hash: tra cứu bằng PrehashedString, thêm và rehash pool đều không phải hash lại nội dung
+    std::unordered_map<meow::utils::string::HashedString, meow::core::string_t, StringHash, std::equal_to<>> string_pool_;
 
     size_t gc_threshold_;
     size_t object_allocated_;
@@ -63,6 +70,9 @@ private:
         return new_object;
     }
 
+    /// @brief Creates and pools a string known not to be interned yet, `str.hash` being its verified hash
+    [[nodiscard]] meow::core::string_t intern_new_string(const meow::utils::string::PrehashedString& str) noexcept;
+
     inline void register_object(const meow::core::MeowObject* object) noexcept {
         if (!object) return;
         if (object_allocated_ >= gc_threshold_ && gc_enabled_) {
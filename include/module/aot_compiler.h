@@ -0,0 +1,17 @@
+#pragma once
+
+#include "common/pch.h"
+#include "core/type.h"
+
+namespace meow::module {
+
+/**
+ * @brief C++ source of a native module for a .meowb file, see module/aot_module.h. Every proto becomes one
+ * function running its bytecode with the fast paths of the baseline JIT inline; instructions without one
+ * (calls, returns, generic operators, object constants...) return to the interpreter, straight-line object
+ * operations call back into its handlers
+ * @param main Main proto of `bytecode`, loaded with aot_optimizer_options()
+ * @param name File name recorded in the module
+ */
+[[nodiscard]] std::string generate_aot_source(core::proto_t main, const std::vector<uint8_t>& bytecode, const std::string& name);
+}  // namespace meow::module
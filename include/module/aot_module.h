@@ -0,0 +1,98 @@
+#pragma once
+
+#include "common/pch.h"
+#include "core/type.h"
+#include "core/value.h"
+#include "jit/stencil_abi.h"
+#include "runtime/optimizer.h"
+#include "vm/meow_engine.h"
+
+namespace meow::memory {
+class MemoryManager;
+}
+
+namespace meow::module {
+
+/// @brief Bumped whenever the interface below changes; native modules built for another version are refused
+inline constexpr uint32_t AOT_ABI_VERSION = 1;
+
+/// @brief One proto of an AOT module, in core::objects::collect_protos() order
+struct AotProto {
+    uint64_t code_hash;  ///< hash_proto() of the proto meow-aotc translated
+    vm::MeowEngine::NativeEntry entry;
+};
+
+/// @brief What a native module generated by meow-aotc hands to load_aot_module()
+struct AotModule {
+    uint32_t abi_version;
+    const char* name;          ///< File name of the .meowb it was built from
+    const uint8_t* bytecode;   ///< That .meowb, embedded whole
+    size_t bytecode_size;
+    const AotProto* protos;
+    size_t proto_count;
+};
+
+/// @brief Fixed options for loading the embedded bytecode, so the protos meow-aotc saw are the ones the module gets
+[[nodiscard]] runtime::OptimizerOptions aot_optimizer_options() noexcept;
+
+/// @brief FNV-1a of a proto's final bytecode, frame size and constant pool; native code is only attached to a proto whose hash matches
+[[nodiscard]] uint64_t hash_proto(core::proto_t proto) noexcept;
+
+/// @brief Loads the embedded bytecode like a .meowb module and attaches the native code of every proto that
+/// still matches. The module's main proto runs on import like any bytecode module
+/// @throws std::runtime_error if the module was built for another AOT_ABI_VERSION
+[[nodiscard]] core::module_t load_aot_module(vm::MeowEngine* engine, memory::MemoryManager* heap, const AotModule& module);
+
+/// @brief Fast paths the generated code inlines, the same ones the interpreter and the baseline JIT have.
+/// Each returns -1 (or false) when the operands need the interpreter
+namespace aot {
+[[nodiscard]] inline bool add(core::Value& dst, const core::Value& lhs, const core::Value& rhs) noexcept {
+    if (lhs.is_int() && rhs.is_int()) {
+        dst = core::Value(lhs.as_int() + rhs.as_int());
+        return true;
+    }
+    if (lhs.is_float() && rhs.is_float()) {
+        dst = core::Value(lhs.as_float() + rhs.as_float());
+        return true;
+    }
+    return false;
+}
+
+[[nodiscard]] inline int truthy(const core::Value& value) noexcept {
+    if (value.is_null()) return 0;
+    if (value.is_bool()) return value.as_bool() ? 1 : 0;
+    if (value.is_int()) return value.as_int() != 0 ? 1 : 0;
+    return -1;
+}
+
+[[nodiscard]] inline int equal(const core::Value& lhs, const core::Value& rhs) noexcept {
+    if (lhs.is_int() && rhs.is_int()) return lhs.as_int() == rhs.as_int() ? 1 : 0;
+    if (lhs.is_float() && rhs.is_float()) return lhs.as_float() == rhs.as_float() ? 1 : 0;
+    return -1;
+}
+[[nodiscard]] inline int less(const core::Value& lhs, const core::Value& rhs) noexcept {
+    if (lhs.is_int() && rhs.is_int()) return lhs.as_int() < rhs.as_int() ? 1 : 0;
+    if (lhs.is_float() && rhs.is_float()) return lhs.as_float() < rhs.as_float() ? 1 : 0;
+    return -1;
+}
+[[nodiscard]] inline int less_equal(const core::Value& lhs, const core::Value& rhs) noexcept {
+    if (lhs.is_int() && rhs.is_int()) return lhs.as_int() <= rhs.as_int() ? 1 : 0;
+    if (lhs.is_float() && rhs.is_float()) return lhs.as_float() <= rhs.as_float() ? 1 : 0;
+    return -1;
+}
+
+/// @brief FOR_LOOP over the block at `loop`: 1 to go on with the body, 0 when done
+[[nodiscard]] inline int for_loop(core::Value* loop) noexcept {
+    if (!loop[0].is_int() || !loop[1].is_int() || !loop[2].is_int()) return -1;
+    int64_t i = loop[0].as_int(), limit = loop[1].as_int(), step = loop[2].as_int();
+    // Cùng công thức unsigned với op_for_loop
+    if (step > 0 ? i > limit : i < limit) return 0;
+    uint64_t remaining = step > 0 ? static_cast<uint64_t>(limit) - static_cast<uint64_t>(i) : static_cast<uint64_t>(i) - static_cast<uint64_t>(limit);
+    uint64_t stride = step > 0 ? static_cast<uint64_t>(step) : uint64_t{0} - static_cast<uint64_t>(step);
+    if (remaining < stride) return 0;
+    loop[0] = core::Value(i + step);
+    loop[3] = loop[0];
+    return 1;
+}
+}  // namespace aot
+}  // namespace meow::module
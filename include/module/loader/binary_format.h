@@ -0,0 +1,31 @@
+#pragma once
+
+#include "common/pch.h"
+
+namespace meow::loader {
+
+inline constexpr uint32_t MAGIC_NUMBER = 0x4D454F57;  // "MEOW"
+inline constexpr uint32_t FORMAT_VERSION = 5;
+inline constexpr uint32_t MIN_FORMAT_VERSION = 1;
+/// @brief From v2: code in the compact encoding of runtime::encode_code. v1 files hold fixed-width code,
+/// re-encoded when the proto is loaded
+inline constexpr uint32_t COMPACT_CODE_VERSION = 2;
+inline constexpr uint32_t OFFSET_TABLE_VERSION = 3;  ///< From v3: offset of every proto record right after the proto count
+inline constexpr uint32_t STRING_TABLE_VERSION = 4;  ///< From v4: the module's string table right after the offset table
+inline constexpr uint32_t FLAGS_VERSION = 5;         ///< From v5: a flags word right after the version
+
+/// @brief The code is optimize_proto() output and every record ends with the proto's exception table. The
+/// flags word is then followed by the OPTIMIZED_CODE_VERSION the file was written for
+inline constexpr uint32_t FLAG_OPTIMIZED = 1u << 0;
+/// @brief Bumped whenever opcodes or the optimizer's output change; pre-optimized files of another version are refused
+inline constexpr uint32_t OPTIMIZED_CODE_VERSION = 1;
+
+enum class ConstantTag : uint8_t {
+    NULL_T,
+    INT_T,
+    FLOAT_T,
+    STRING_T,
+    PROTO_REF_T,
+    STRING_REF_T  ///< Index into the module's string table (v4)
+};
+}  // namespace meow::loader
@@ -4,6 +4,9 @@
 #include "core/type.h"
 #include "runtime/chunk.h"
 #include "core/objects/function.h"
+#include "runtime/optimizer.h"
+#include "module/loader/mapped_file.h"
+#include "utils/string/string_hash.h"
 
 namespace meow::memory { class MemoryManager; }
 
@@ -14,16 +17,65 @@ public:
     explicit BinaryLoaderError(const std::string& msg) : std::runtime_error(msg) {}
 };
 
+class LazyBodies;
+
+/**
+ * @brief Reads a .meowb module: magic, version, main proto index, proto count, then (from format v3) a table
+ * with the file offset of every proto record, then (from v4) the module's string table, then the records
+ *
+ * The v4 string table holds every distinct string once with its utils::string::hash_string(); constants refer
+ * to it by index and an eager load interns it in one pass. From v5 a flags word follows the version; a file
+ * with FLAG_OPTIMIZED holds optimizer output and is not optimized again, so mapped code is never copied.
+ *
+ * A v3 file loaded lazily only reads the main proto up front. Every other proto starts as a stub (frame size,
+ * upvalues, name) whose constants and code are read, linked and optimized on its first call
+ */
 class BinaryLoader {
 public:
-    BinaryLoader(meow::memory::MemoryManager* heap, const std::vector<uint8_t>& data);
+    /// @param data Must outlive the loader; the loaded chunks copy their code out of it
+    BinaryLoader(meow::memory::MemoryManager* heap, std::span<const uint8_t> data, const meow::runtime::OptimizerOptions& options = {});
+    /// @brief Loads from `file` without copying code: chunks run it in place and keep the file alive
+    /// @param lazy Load proto bodies on first call if the file has a proto offset table
+    BinaryLoader(meow::memory::MemoryManager* heap, std::shared_ptr<const MappedFile> file, const meow::runtime::OptimizerOptions& options = {}, bool lazy = false);
     meow::core::proto_t load_module();
+
+    /// @brief true unless $MEOW_EAGER_LOAD is set to anything but "0"
+    [[nodiscard]] static bool lazy_from_environment() noexcept;
 private:
+    friend class LazyBodies;
+
+    /// @brief PROTO_REF constant: slot `constant` of the pool gets proto `proto` once every proto exists
+    struct ProtoRelocation {
+        uint32_t constant;
+        uint32_t proto;
+    };
+    /// @brief One proto record; bytecode points into the file
+    struct PrototypeRecord {
+        uint32_t num_registers;
+        uint32_t num_upvalues;
+        meow::core::string_t name;
+        std::vector<meow::core::Value> constants;  ///< PROTO_REF slots hold null until linked
+        std::vector<ProtoRelocation> relocations;
+        std::vector<meow::core::objects::UpvalueDesc> upvalue_descs;
+        std::span<const uint8_t> bytecode;
+        std::vector<meow::core::objects::ExceptionRegion> exception_table;  ///< Only in pre-optimized files
+    };
+
     meow::memory::MemoryManager* heap_;
-    const std::vector<uint8_t>& data_;
+    std::span<const uint8_t> data_;
+    std::shared_ptr<const MappedFile> file_;  ///< Owner of data_ when loading in place, nullptr otherwise
     size_t cursor_ = 0;
+    meow::runtime::OptimizerOptions options_;
+    bool fixed_width_code_ = false;  ///< v1 file, make_chunk() re-encodes its code
+    bool lazy_ = false;
+    bool optimized_ = false;  ///< FLAG_OPTIMIZED: the code is used as-is, see write_optimized_module()
+    std::shared_ptr<LazyBodies> bodies_;  ///< Stub table of the module when loading lazily
+    /// @brief String table of a v4 file, text pointing into the file
+    std::shared_ptr<const std::vector<meow::utils::string::PrehashedString>> strings_;
+    std::vector<meow::core::string_t> interned_;  ///< strings_ interned in bulk; empty when loading lazily
 
     std::vector<meow::core::proto_t> loaded_protos_;
+    std::vector<std::pair<meow::core::proto_t, ProtoRelocation>> relocations_;  ///< Of every proto read, patched by link_prototypes
 
     void check_can_read(size_t bytes);
     uint8_t  read_u8();
@@ -32,10 +84,20 @@ private:
     uint64_t read_u64();
     double   read_f64();
     meow::core::string_t read_string();
+    void read_string_table();
+    meow::core::string_t string_at(uint32_t index);
     
-    meow::core::Value read_constant();
+    meow::core::Value read_constant(uint32_t slot, std::vector<ProtoRelocation>& relocations);
+    void skip_constant();
+    PrototypeRecord read_record();
+    meow::runtime::Chunk make_chunk(PrototypeRecord& record);
+    void add_relocations(meow::core::proto_t proto, const PrototypeRecord& record);
     meow::core::proto_t read_prototype();
-    void check_magic();
+    meow::core::proto_t read_stub();
+    uint32_t check_magic();
+    void read_flags();
+    std::vector<uint32_t> read_offsets(uint32_t prototype_count);
+    meow::core::proto_t resolve_proto(uint32_t index);
     void link_prototypes();
 };
 
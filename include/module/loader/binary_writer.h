@@ -0,0 +1,15 @@
+#pragma once
+
+#include "common/pch.h"
+#include "core/type.h"
+
+namespace meow::loader {
+
+/**
+ * @brief Writes `main_proto` and every proto it reaches as a v5 .meowb with FLAG_OPTIMIZED set: the code of
+ * each proto as it is now, its frame size and its exception table. Meant for protos that went through
+ * optimize_proto(), so that BinaryLoader maps the file and runs the code in place without optimizing again
+ * @throws BinaryLoaderError if a constant has a type the format cannot hold
+ */
+[[nodiscard]] std::vector<uint8_t> write_optimized_module(meow::core::proto_t main_proto);
+}  // namespace meow::loader
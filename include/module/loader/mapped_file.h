@@ -0,0 +1,43 @@
+#pragma once
+
+#include "common/pch.h"
+
+namespace meow::loader {
+
+/**
+ * @brief Read-only view of a whole file, mapped into memory where the platform allows it so that processes
+ * running the same bytecode share its pages. Chunks loaded from it keep it alive and run their code in place
+ * @note Falls back to reading the file into a private buffer when it cannot be mapped
+ */
+class MappedFile {
+public:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() noexcept;
+
+    /// @return nullptr if the file cannot be opened or read
+    [[nodiscard]] static std::shared_ptr<const MappedFile> open(const std::filesystem::path& path);
+
+    [[nodiscard]] inline const uint8_t* data() const noexcept {
+        return data_;
+    }
+    [[nodiscard]] inline size_t size() const noexcept {
+        return size_;
+    }
+    [[nodiscard]] inline std::span<const uint8_t> bytes() const noexcept {
+        return {data_, size_};
+    }
+    /// @brief false when the contents were read into a buffer instead
+    [[nodiscard]] inline bool is_mapped() const noexcept {
+        return mapped_;
+    }
+
+private:
+    MappedFile() = default;
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<uint8_t> buffer_;  ///< Contents when the file is not mapped
+};
+}  // namespace meow::loader
@@ -4,6 +4,7 @@
 #include "core/op_codes.h"
 #include "core/type.h"
 #include "loader/tokens.h"
+#include "runtime/bytecode.h"
 #include "runtime/chunk.h"
 #include "core/objects/function.h"
 
@@ -81,11 +82,12 @@ class TextParser {
         std::string name;
         size_t nreg = 0;
         size_t nup = 0;
-        std::vector<uint8_t> code;
+        std::vector<meow::runtime::Instruction> code;  ///< ADDR operands are instruction indices, see runtime::encode_code
         std::vector<meow::core::value_t> tmp_consts;
         std::vector<meow::core::objects::UpvalueDesc> updesc;
-        std::unordered_map<std::string_view, size_t> labels;
-        std::vector<std::tuple<size_t, size_t, std::string_view>> pending;
+        std::unordered_map<std::string_view, size_t> labels;  ///< Label -> index of the instruction after it
+        std::vector<std::pair<size_t, std::string_view>> pending;  ///< Instruction index, label of its jump target
+        size_t next_operand = 0;
         bool regs_defined = false;
         bool up_defined = false;
         size_t dir_line = 0;
@@ -96,23 +98,22 @@ class TextParser {
             return i;
         }
         void wb(uint8_t b) {
-            code.push_back(b);
+            code.emplace_back(static_cast<meow::core::OpCode>(b));
+            next_operand = 0;
         }
         void wu16(uint16_t x) {
-            code.push_back(uint8_t(x & 0xFF));
-            code.push_back(uint8_t((x >> 8) & 0xFF));
+            code.back().set_operand(next_operand++, x);
         }
         void wu64(uint64_t x) {
-            for (int i = 0; i < 8; ++i) code.push_back(uint8_t((x >> (i * 8)) & 0xFF));
+            code.back().set_imm64(x);
+            ++next_operand;
         }
         void wf64(double d) {
             wu64(std::bit_cast<uint64_t>(d));
         }
-        bool patch_u16(size_t ofs, uint16_t v) {
-            if (ofs + 1 >= code.size()) return false;
-            code[ofs] = uint8_t(v & 0xFF);
-            code[ofs + 1] = uint8_t((v >> 8) & 0xFF);
-            return true;
+        void waddr(uint32_t index) {
+            code.back().set_address(index);
+            ++next_operand;
         }
     };
 
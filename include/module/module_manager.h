@@ -26,15 +26,29 @@ class ModuleManager {
         module_cache_.clear();
     }
 
+    /// @brief Path of the entry module: imports it makes resolve from its directory
+    inline void set_entry_path(meow::core::string_t entry_path) noexcept {
+        entry_path_ = entry_path;
+    }
+
     inline void add_cache(meow::core::string_t name, const meow::core::module_t& mod) {
         module_cache_[name] = mod;
     }
 
+    /// @brief Every cached module once, whatever the number of paths it is cached under
+    [[nodiscard]] inline std::vector<meow::core::module_t> get_modules() const {
+        std::vector<meow::core::module_t> modules;
+        for (const auto& [path, mod] : module_cache_) {
+            if (std::find(modules.begin(), modules.end(), mod) == modules.end()) modules.push_back(mod);
+        }
+        return modules;
+    }
+
    private:
     std::unordered_map<meow::core::string_t, meow::core::module_t> module_cache_;
-    meow::core::string_t entry_path_;
+    meow::core::string_t entry_path_ = nullptr;
 
-    meow::memory::MemoryManager* heap_;
-    meow::vm::MeowEngine* engine_;
+    meow::memory::MemoryManager* heap_ = nullptr;
+    meow::vm::MeowEngine* engine_ = nullptr;
 };
 }  // namespace meow::module
\ No newline at end of file
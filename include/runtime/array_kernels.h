@@ -0,0 +1,48 @@
+#pragma once
+
+#include "common/pch.h"
+
+namespace meow::runtime {
+
+/**
+ * @brief Bulk kernels over packed array storage
+ * @note One table per instruction set, picked once at startup from CPUID. Float reductions may
+ * associate differently from a sequential loop, so results can differ in the last bits
+ */
+struct ArrayKernels {
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    const char* name;
+
+    int64_t (*sum_i64)(const int64_t* data, size_t n) noexcept;
+    double (*sum_f64)(const double* data, size_t n) noexcept;
+    int64_t (*min_i64)(const int64_t* data, size_t n) noexcept;
+    double (*min_f64)(const double* data, size_t n) noexcept;
+    int64_t (*max_i64)(const int64_t* data, size_t n) noexcept;
+    double (*max_f64)(const double* data, size_t n) noexcept;
+    int64_t (*dot_i64)(const int64_t* a, const int64_t* b, size_t n) noexcept;
+    double (*dot_f64)(const double* a, const double* b, size_t n) noexcept;
+
+    void (*fill_i64)(int64_t* data, size_t n, int64_t value) noexcept;
+    void (*fill_f64)(double* data, size_t n, double value) noexcept;
+    size_t (*index_of_i64)(const int64_t* data, size_t n, int64_t value) noexcept;
+    size_t (*index_of_f64)(const double* data, size_t n, double value) noexcept;
+    /// @brief First index where a[i] != b[i] (NaN never matches), npos if none
+    size_t (*mismatch_i64)(const int64_t* a, const int64_t* b, size_t n) noexcept;
+    size_t (*mismatch_f64)(const double* a, const double* b, size_t n) noexcept;
+
+    void (*add_i64)(int64_t* out, const int64_t* in, size_t n, int64_t scalar) noexcept;
+    void (*add_f64)(double* out, const double* in, size_t n, double scalar) noexcept;
+    void (*mul_i64)(int64_t* out, const int64_t* in, size_t n, int64_t scalar) noexcept;
+    void (*mul_f64)(double* out, const double* in, size_t n, double scalar) noexcept;
+};
+
+/// @brief Best kernel table supported by the running CPU (AVX2, SSE2 or scalar)
+[[nodiscard]] const ArrayKernels& get_array_kernels() noexcept;
+
+/// @brief Portable fallback, also used to check the SIMD tables
+[[nodiscard]] const ArrayKernels& get_scalar_array_kernels() noexcept;
+
+/// @brief Every table the running CPU can execute, scalar first, so tests can check each one against it
+[[nodiscard]] std::vector<const ArrayKernels*> get_supported_array_kernels();
+}  // namespace meow::runtime
@@ -1,15 +1,21 @@
 #pragma once
 
 #include "common/pch.h"
+#include "core/objects/module.h"
 #include "core/objects/string.h"
 #include "core/type.h"
 #include "core/value.h"
 #include "memory/gc_visitor.h"
 
+namespace meow::memory {
+class MemoryManager;
+}
+
 namespace meow::runtime {
 struct BuiltinRegistry {
     std::unordered_map<meow::core::string_t, std::unordered_map<meow::core::string_t, meow::core::Value>> methods_;
     std::unordered_map<meow::core::string_t, std::unordered_map<meow::core::string_t, meow::core::Value>> getters_;
+    std::unordered_map<meow::core::string_t, meow::core::module_t> modules_;
 
     inline void trace(meow::memory::GCVisitor& visitor) const noexcept {
         for (const auto& [name, method] : methods_) {
@@ -27,6 +33,14 @@ struct BuiltinRegistry {
                 visitor.visit_value(value);
             }
         }
+
+        for (const auto& [name, module] : modules_) {
+            visitor.visit_object(name);
+            visitor.visit_object(module);
+        }
     }
 };
+
+/// @brief Registers the bulk array natives (sum, dot, index_of, ...) into `registry.methods_["array"]`
+void register_array_natives(BuiltinRegistry& registry, meow::memory::MemoryManager* heap);
 }  // namespace meow::runtime
\ No newline at end of file
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "common/pch.h"
+#include "core/op_codes.h"
+
+namespace meow::runtime {
+
+/// @brief Role of one operand. See Instruction for the decoded widths and encode_code for the encoded ones
+enum class OperandKind : uint8_t {
+    REG,    ///< Register read by the instruction (0xFFFF means none)
+    DST,    ///< Register written by the instruction (0xFFFF means none)
+    RANGE,  ///< First register of a contiguous block read by the instruction, sized by the next COUNT
+    COUNT,  ///< Plain number: element count, upvalue index, slot...
+    CONST,  ///< Constant pool index
+    ADDR,   ///< Jump target inside the same chunk, encoded relative to the start of the instruction
+    IMM16,  ///< 2-byte signed immediate
+    IMM64   ///< 8-byte immediate
+};
+
+/// @brief Static operand list of one opcode
+struct OpcodeLayout {
+    uint8_t operand_count;
+    std::array<OperandKind, 4> operands;
+};
+
+inline constexpr uint32_t NO_OFFSET = static_cast<uint32_t>(-1);
+
+/// @brief Layout of a raw opcode byte, or nullptr if the byte is not a valid opcode (WIDE is a prefix, not an opcode)
+[[nodiscard]] const OpcodeLayout* get_opcode_layout(uint8_t opcode) noexcept;
+
+/// @brief Byte offset of operand `index` inside Instruction::bytes, counted from the opcode byte
+[[nodiscard]] size_t get_operand_offset(const OpcodeLayout& layout, size_t index) noexcept;
+
+/// @brief Encoded size of an instruction with this layout, WIDE prefix included when `wide`
+[[nodiscard]] size_t get_encoded_size(const OpcodeLayout& layout, bool wide) noexcept;
+
+[[nodiscard]] inline uint16_t read_operand_u16(const uint8_t* at) noexcept {
+    return static_cast<uint16_t>(at[0] | (at[1] << 8));
+}
+
+inline void write_operand_u16(uint8_t* at, uint16_t value) noexcept {
+    at[0] = static_cast<uint8_t>(value & 0xFF);
+    at[1] = static_cast<uint8_t>((value >> 8) & 0xFF);
+}
+
+/**
+ * @brief One instruction at full width, the form every pass reads and rewrites
+ *
+ * `bytes` holds the opcode, then each operand little-endian: REG/DST/RANGE/COUNT/CONST and IMM16 as u16,
+ * ADDR as u32, IMM64 as 8 bytes. What the ADDR means depends on the producer: a byte offset in the chunk
+ * for decode_instruction, an instruction index for decode_code/encode_code
+ */
+struct Instruction {
+    std::array<uint8_t, 16> bytes{};
+    uint8_t size = 0;   ///< Encoded size in bytes, WIDE prefix included. 0 until the instruction is decoded
+    bool wide = false;  ///< Encoded behind a WIDE prefix
+
+    Instruction() = default;
+    explicit Instruction(core::OpCode op) noexcept { bytes[0] = static_cast<uint8_t>(op); }
+
+    [[nodiscard]] core::OpCode op() const noexcept { return static_cast<core::OpCode>(bytes[0]); }
+    [[nodiscard]] const OpcodeLayout& layout() const noexcept { return *get_opcode_layout(bytes[0]); }
+    /// @brief Operand `index` of any kind but ADDR and IMM64
+    [[nodiscard]] uint16_t operand(size_t index) const noexcept { return read_operand_u16(bytes.data() + get_operand_offset(layout(), index)); }
+    void set_operand(size_t index, uint16_t value) noexcept { write_operand_u16(bytes.data() + get_operand_offset(layout(), index), value); }
+    [[nodiscard]] uint64_t imm64() const noexcept;
+    void set_imm64(uint64_t bits) noexcept;
+    /// @brief The ADDR operand. Only valid if the opcode has one, see get_jump_target
+    [[nodiscard]] uint32_t address() const noexcept;
+    void set_address(uint32_t address) noexcept;
+};
+
+/// @brief Decodes the instruction at `offset`, ADDR as a byte offset in `code`
+/// @return false if it is not a valid instruction, runs past `size` or jumps outside [0, 2^32)
+[[nodiscard]] bool decode_instruction(const uint8_t* code, size_t size, size_t offset, Instruction& out) noexcept;
+
+/// @brief Unchecked decode_instruction, for code that already went through decode_instructions
+[[nodiscard]] Instruction decode_instruction(const uint8_t* code, size_t offset) noexcept;
+
+/// @brief Offsets of every instruction in `code`
+/// @return false if the code holds an unknown opcode or a truncated instruction
+[[nodiscard]] bool decode_instructions(const uint8_t* code, size_t size, std::vector<size_t>& offsets);
+
+/// @brief Decodes a whole chunk, ADDR as the index of the target instruction (`out.size()` for the end of the chunk)
+/// @return false if the code does not decode or some jump lands inside an instruction
+[[nodiscard]] bool decode_code(const uint8_t* code, size_t size, std::vector<Instruction>& out);
+
+/// @brief Same as decode_code for the fixed-width encoding of .meowb format 4 and older:
+/// every operand but IMM64 a u16, ADDR an absolute u16 offset, no WIDE prefix
+[[nodiscard]] bool decode_fixed_width_code(const uint8_t* code, size_t size, std::vector<Instruction>& out);
+
+/**
+ * @brief Encodes `instructions` (ADDR as instruction indices, like decode_code) into the compact encoding
+ *
+ * Narrow form: REG/DST/RANGE/COUNT/CONST take 1 byte (0xFF is the REG/DST "none"), ADDR is an i16
+ * relative to the first byte of the instruction. Behind a WIDE prefix they take 2 bytes and ADDR an i32.
+ * An instruction is wide only when some operand does not fit: jumps start narrow and are widened until
+ * every displacement fits. A superinstruction is demoted to its first component if it, or one of the
+ * instructions it runs, comes out wide
+ * @param offsets If not null, receives the encoded offset of every instruction plus the final code size
+ * @return false if an ADDR is past the end or the code would not fit in 4 GiB
+ */
+[[nodiscard]] bool encode_code(const std::vector<Instruction>& instructions, std::vector<uint8_t>& out, std::vector<uint32_t>* offsets = nullptr);
+
+/// @brief Contiguous block of registers `[first, first + count)`
+struct RegisterRange {
+    uint16_t first;
+    uint32_t count;
+};
+
+/// @brief Register blocks the instruction may read, implicit reads (R0, loop and iterator blocks) included
+/// @return Number of ranges written to `out`
+size_t get_read_ranges(const Instruction& instruction, std::array<RegisterRange, 4>& out) noexcept;
+
+/// @brief Register blocks the instruction may overwrite, conditional and implicit writes included
+/// @note Unlike writes_register this over-approximates, use it to invalidate facts about registers
+size_t get_write_ranges(const Instruction& instruction, std::array<RegisterRange, 4>& out) noexcept;
+
+/// @brief Whether `instruction` may read register `reg` of the current frame
+/// @note A superinstruction is described by its first component only, see core/superinstructions.h
+/// @note Registers captured by CLOSURE are not tracked here, callers must treat them as always live
+[[nodiscard]] bool reads_register(const Instruction& instruction, uint16_t reg) noexcept;
+
+/// @brief Whether `instruction` overwrites register `reg`
+[[nodiscard]] bool writes_register(const Instruction& instruction, uint16_t reg) noexcept;
+
+/// @brief Target of a jump, conditional jump, loop or SETUP_TRY instruction
+[[nodiscard]] std::optional<uint32_t> get_jump_target(const Instruction& instruction) noexcept;
+
+/// @brief Instructions after which execution never falls through to the next one
+[[nodiscard]] bool is_block_terminator(core::OpCode op) noexcept;
+}  // namespace meow::runtime
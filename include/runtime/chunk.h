@@ -3,6 +3,7 @@
 #include "common/pch.h"
 #include "core/definitions.h"
 #include "core/value.h"
+#include "runtime/liveness.h"
 
 namespace meow::loader {
 class TextParser;
@@ -13,7 +14,24 @@ class Chunk {
    public:
     Chunk() = default;
     Chunk(std::vector<uint8_t>&& code, std::vector<meow::core::Value>&& constants) noexcept : code_(std::move(code)), constant_pool_(std::move(constants)) {
+        sync_code();
     }
+    /// @brief Runs `code` in place instead of copying it; `owner` keeps the bytes alive (a loader::MappedFile).
+    /// The first modification copies the code into the chunk
+    Chunk(std::span<const uint8_t> code, std::shared_ptr<const void> owner, std::vector<meow::core::Value>&& constants) noexcept
+        : code_owner_(std::move(owner)), code_data_(code.data()), code_size_(code.size()), constant_pool_(std::move(constants)) {
+    }
+    Chunk(const Chunk& other)
+        : code_(other.code_), code_owner_(other.code_owner_), code_data_(other.code_data_), code_size_(other.code_size_), constant_pool_(other.constant_pool_),
+          slot_cache_(other.slot_cache_), liveness_(other.liveness_) {
+        if (!code_owner_) sync_code();
+    }
+    Chunk(Chunk&&) noexcept = default;
+    Chunk& operator=(const Chunk& other) {
+        if (this != &other) *this = Chunk(other);
+        return *this;
+    }
+    Chunk& operator=(Chunk&&) noexcept = default;
 
     // inline void write_byte(uint8_t byte) {
     //     code_.push_back(byte);
@@ -66,22 +84,29 @@ class Chunk {
 
     // --- Modifiers ---
     inline void write_byte(uint8_t byte) {
+        own_code();
         code_.push_back(byte);
+        sync_code();
     }
 
     inline void write_u16(uint16_t value) {
+        own_code();
         code_.push_back(static_cast<uint8_t>(value & 0xFF));
         code_.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+        sync_code();
     }
 
     inline void write_u32(uint32_t value) {
+        own_code();
         code_.push_back(static_cast<uint8_t>(value & 0xFF));
         code_.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
         code_.push_back(static_cast<uint8_t>((value >> 16) & 0xFF));
         code_.push_back(static_cast<uint8_t>((value >> 24) & 0xFF));
+        sync_code();
     }
 
     inline void write_u64(uint64_t value) {
+        own_code();
         code_.push_back(static_cast<uint8_t>(value & 0xFF));
         code_.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
         code_.push_back(static_cast<uint8_t>((value >> 16) & 0xFF));
@@ -90,20 +115,41 @@ class Chunk {
         code_.push_back(static_cast<uint8_t>((value >> 40) & 0xFF));
         code_.push_back(static_cast<uint8_t>((value >> 48) & 0xFF));
         code_.push_back(static_cast<uint8_t>((value >> 56) & 0xFF));
+        sync_code();
     }
 
     inline void write_f64(double value) {
         write_u64(std::bit_cast<uint64_t>(value));
     }
+
+    /// @brief Replaces the whole code buffer. Only valid before any frame points into the chunk
+    inline void set_code(std::vector<uint8_t>&& code) noexcept {
+        code_ = std::move(code);
+        code_owner_.reset();
+        sync_code();
+        liveness_ = RegisterLiveness{};
+    }
+    /// @brief true while the code is borrowed from a mapped file rather than owned
+    [[nodiscard]] inline bool is_code_borrowed() const noexcept {
+        return code_owner_ != nullptr;
+    }
+
+    // --- Register liveness (for GC) ---
+    inline void set_liveness(RegisterLiveness&& liveness) noexcept {
+        liveness_ = std::move(liveness);
+    }
+    [[nodiscard]] inline const RegisterLiveness& get_liveness() const noexcept {
+        return liveness_;
+    }
     // --- Code buffer ---
     [[nodiscard]] inline const uint8_t* get_code() const noexcept {
-        return code_.data();
+        return code_data_;
     }
     [[nodiscard]] inline size_t get_code_size() const noexcept {
-        return code_.size();
+        return code_size_;
     }
     [[nodiscard]] inline bool is_code_empty() const noexcept {
-        return code_.empty();
+        return code_size_ == 0;
     }
 
     // --- Constant pool ---
@@ -124,11 +170,24 @@ class Chunk {
         return constant_pool_[index];
     }
     [[nodiscard]] inline const uint8_t* get_code_buffer_ptr() const noexcept {
-        return code_.data();
+        return code_data_;
+    }
+
+    // --- Inline caches ---
+    static constexpr uint32_t NO_SLOT = static_cast<uint32_t>(-1);
+
+    /// @brief Slot hint for a name-keyed lookup site, indexed by the name's constant index.
+    /// @note The hint is only a guess and must be validated by the caller before use
+    [[nodiscard]] inline uint32_t& get_slot_cache(size_t index) const {
+        if (index >= slot_cache_.size()) {
+            slot_cache_.resize(std::max(index + 1, constant_pool_.size()), NO_SLOT);
+        }
+        return slot_cache_[index];
     }
 
-    inline bool patch_u16(size_t offset, uint16_t value) noexcept {
-        if (offset + 1 >= code_.size()) return false;
+    inline bool patch_u16(size_t offset, uint16_t value) {
+        if (offset + 1 >= code_size_) return false;
+        own_code();
 
         code_[offset] = static_cast<uint8_t>(value & 0xFF);
         code_[offset + 1] = static_cast<uint8_t>((value >> 8) & 0xFF);
@@ -137,7 +196,24 @@ class Chunk {
     }
 
    private:
-    std::vector<uint8_t> code_;
+    std::vector<uint8_t> code_;                  ///< Owned code, unused while the code is borrowed
+    std::shared_ptr<const void> code_owner_;     ///< Keeps borrowed code alive, nullptr when the code is owned
+    const uint8_t* code_data_ = nullptr;         ///< The code the chunk runs: code_ or the borrowed bytes
+    size_t code_size_ = 0;
     std::vector<meow::core::Value> constant_pool_;
+    mutable std::vector<uint32_t> slot_cache_;
+    RegisterLiveness liveness_;
+
+    inline void sync_code() noexcept {
+        code_data_ = code_.data();
+        code_size_ = code_.size();
+    }
+    // Copy-on-write: bytes của tệp được map là chỉ đọc
+    inline void own_code() {
+        if (!code_owner_) return;
+        code_.assign(code_data_, code_data_ + code_size_);
+        code_owner_.reset();
+        sync_code();
+    }
 };
 }  // namespace meow::runtime
\ No newline at end of file
@@ -13,6 +13,7 @@ struct CallFrame {
     size_t start_reg_;
     size_t ret_reg_;
     const uint8_t* ip_;
+    FeedbackVector* feedback_ = nullptr;  ///< Profile of the running proto, nullptr while it is cold
     CallFrame(meow::core::function_t function, meow::core::module_t module, size_t start_reg, size_t ret_reg, const uint8_t* ip)
         : function_(function), module_(module), start_reg_(start_reg), ret_reg_(ret_reg), ip_(ip) {
     }
@@ -42,10 +43,31 @@ struct ExecutionContext {
         exception_handlers_.clear();
     }
 
+    /// @brief Registers of a frame that are dead at its current instruction are skipped, see RegisterLiveness
     inline void trace(meow::memory::GCVisitor& visitor) const noexcept {
-        for (const auto& reg : registers_) {
-            visitor.visit_value(reg);
+        size_t traced = 0;
+        for (size_t i = 0; i < call_stack_.size(); ++i) {
+            const CallFrame& frame = call_stack_[i];
+            // Closure đang chạy có thể chỉ còn nằm trong một register đã chết của frame gọi nó
+            if (frame.function_) visitor.visit_object(frame.function_);
+            if (frame.module_) visitor.visit_object(frame.module_);
+
+            size_t end = i + 1 < call_stack_.size() ? call_stack_[i + 1].start_reg_ : registers_.size();
+            end = std::min(end, registers_.size());
+            for (; traced < frame.start_reg_ && traced < end; ++traced) visitor.visit_value(registers_[traced]);
+
+            const uint64_t* live = nullptr;
+            const RegisterLiveness* liveness = nullptr;
+            if (frame.function_ && frame.ip_) {
+                const Chunk& chunk = frame.function_->get_proto()->get_chunk();
+                liveness = &chunk.get_liveness();
+                if (!liveness->empty() && frame.ip_ >= chunk.get_code()) live = liveness->at(static_cast<size_t>(frame.ip_ - chunk.get_code()));
+            }
+            for (; traced < end; ++traced) {
+                if (live == nullptr || liveness->is_live(live, traced - frame.start_reg_)) visitor.visit_value(registers_[traced]);
+            }
         }
+        for (; traced < registers_.size(); ++traced) visitor.visit_value(registers_[traced]);
         for (const auto& upvalue : open_upvalues_) {
             visitor.visit_object(upvalue);
         }
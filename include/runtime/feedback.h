@@ -0,0 +1,132 @@
+#pragma once
+
+#include "common/pch.h"
+#include "core/definitions.h"
+#include "core/value.h"
+#include "runtime/chunk.h"
+#include "runtime/operator_dispatcher.h"
+
+namespace meow::memory {
+class GCVisitor;
+}
+
+namespace meow::runtime {
+
+/// @brief Set of core::ValueType, one bit per type
+using type_set_t = uint16_t;
+static_assert(NUM_VALUE_TYPES <= 16, "type_set_t has one bit per ValueType");
+
+[[nodiscard]] inline type_set_t type_bit(meow::core::param_t value) noexcept {
+    return static_cast<type_set_t>(1u << +get_value_type(value));
+}
+
+/// @brief What a feedback slot observes
+enum class SiteKind : uint8_t {
+    ARITHMETIC,  ///< Binary/unary operators: operand types
+    COMPARE,     ///< Compare-and-jump: operand types
+    PROPERTY,    ///< GET_PROP/SET_PROP: receiver type, receiver class
+    INDEX,       ///< GET_INDEX/SET_INDEX: container and key types
+    CALL,        ///< CALL/CALL_VOID/TAIL_CALL: callee type, call target
+};
+
+/// @brief When the interpreter starts profiling a proto
+struct FeedbackOptions {
+    uint32_t threshold = 64;  ///< Entries (calls or loop back-edges) a proto runs unprofiled; 0 never profiles
+
+    /// @brief Defaults, with the threshold taken from $MEOW_FEEDBACK_THRESHOLD if set
+    [[nodiscard]] static FeedbackOptions from_environment() noexcept;
+};
+
+/// @brief What one instruction has seen since its proto first ran
+struct FeedbackSlot {
+    static constexpr size_t MAX_TARGETS = 4;
+
+    uint32_t pc_;
+    meow::core::OpCode op_;               ///< Opcode of the instruction, superinstruction heads resolved
+    SiteKind kind_;
+    bool megamorphic_ = false;            ///< More than MAX_TARGETS distinct targets, the list stopped growing
+    std::array<type_set_t, 2> types_{};   ///< Operand type sets: lhs/rhs, receiver/key, callee/-
+    uint32_t count_ = 0;                  ///< Times recorded, saturating
+    /// @brief Receiver classes (PROPERTY) or callee protos/classes/natives (CALL), in order of first sight
+    std::array<const meow::core::MeowObject*, MAX_TARGETS> targets_{};
+
+    FeedbackSlot(uint32_t pc, meow::core::OpCode op, SiteKind kind) noexcept : pc_(pc), op_(op), kind_(kind) {
+    }
+
+    inline void record(meow::core::param_t value) noexcept {
+        types_[0] |= type_bit(value);
+        count_ += count_ != std::numeric_limits<uint32_t>::max();
+    }
+    inline void record(meow::core::param_t lhs, meow::core::param_t rhs) noexcept {
+        types_[1] |= type_bit(rhs);
+        record(lhs);
+    }
+    /// @brief Adds `target` to the targets seen, nullptr is ignored
+    inline void record_target(const meow::core::MeowObject* target) noexcept {
+        if (target == nullptr || megamorphic_) return;
+        for (const meow::core::MeowObject*& seen : targets_) {
+            if (seen == target) return;
+            if (seen == nullptr) {
+                seen = target;
+                return;
+            }
+        }
+        megamorphic_ = true;
+    }
+    /// @brief Distinct targets seen; 0 uninitialized, 1 monomorphic, up to MAX_TARGETS polymorphic
+    [[nodiscard]] inline size_t target_count() const noexcept {
+        return static_cast<size_t>(std::count_if(targets_.begin(), targets_.end(), [](const meow::core::MeowObject* target) { return target != nullptr; }));
+    }
+};
+
+/**
+ * @brief Per-proto runtime profile: one slot per arithmetic, compare-and-jump, property, index and call
+ * instruction, plus invocation and back-edge counters. The interpreter fills it; later tiers read it
+ *
+ * Created once the proto is warm (see FeedbackOptions), so load-time passes have already settled the bytecode
+ * and cold code records nothing. Counters start at that point. Targets are strong references: a proto keeps
+ * the classes and callees its sites saw alive.
+ */
+class FeedbackVector {
+public:
+    static constexpr uint16_t NO_SLOT = std::numeric_limits<uint16_t>::max();
+
+    explicit FeedbackVector(const Chunk& chunk);
+
+    /// @brief Slot of the instruction whose opcode byte is at `instruction`, nullptr if it has none
+    /// @note Keyed by address so the interpreter does not have to reload the chunk; the code never moves once it runs
+    [[nodiscard]] inline FeedbackSlot* slot_at(const uint8_t* instruction) noexcept {
+        size_t pc = static_cast<size_t>(instruction - code_);
+        if (pc >= slot_of_.size() || slot_of_[pc] == NO_SLOT) return nullptr;
+        return &slots_[slot_of_[pc]];
+    }
+    [[nodiscard]] inline const std::vector<FeedbackSlot>& get_slots() const noexcept {
+        return slots_;
+    }
+
+    inline void count_invocation() noexcept {
+        ++invocations_;
+    }
+    inline void count_backedge() noexcept {
+        ++backedges_;
+    }
+    [[nodiscard]] inline uint64_t get_invocations() const noexcept {
+        return invocations_;
+    }
+    [[nodiscard]] inline uint64_t get_backedges() const noexcept {
+        return backedges_;
+    }
+
+    /// @brief Human-readable dump, one line per counter and per slot that has been reached
+    void dump(std::ostream& os, std::string_view name) const;
+
+    void trace(meow::memory::GCVisitor& visitor) const noexcept;
+
+private:
+    const uint8_t* code_;
+    std::vector<uint16_t> slot_of_;  ///< Bytecode offset -> index in slots_, NO_SLOT if none
+    std::vector<FeedbackSlot> slots_;
+    uint64_t invocations_ = 0;
+    uint64_t backedges_ = 0;
+};
+}  // namespace meow::runtime
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "common/pch.h"
+
+namespace meow::runtime {
+
+/**
+ * @brief Registers that may hold a needed value at each instruction of a chunk, so the GC can skip
+ * dead registers of a frame
+ * @note A register counts as live at an instruction if it is live before or after it: handlers may
+ * write their destination and allocate afterwards
+ */
+class RegisterLiveness {
+public:
+    RegisterLiveness() = default;
+    RegisterLiveness(std::vector<uint32_t>&& offsets, std::vector<uint64_t>&& bits, size_t num_registers) noexcept
+        : offsets_(std::move(offsets)), bits_(std::move(bits)), num_registers_(num_registers), words_((num_registers + 63) / 64) {
+    }
+
+    [[nodiscard]] inline bool empty() const noexcept {
+        return offsets_.empty();
+    }
+
+    [[nodiscard]] inline size_t get_num_registers() const noexcept {
+        return num_registers_;
+    }
+
+    /// @brief Live set of the instruction starting at `offset`, or nullptr if no instruction starts there
+    [[nodiscard]] inline const uint64_t* at(size_t offset) const noexcept {
+        auto it = std::lower_bound(offsets_.begin(), offsets_.end(), offset);
+        if (it == offsets_.end() || *it != offset) return nullptr;
+        return bits_.data() + static_cast<size_t>(it - offsets_.begin()) * words_;
+    }
+
+    /// @brief Whether `reg` is live in a set returned by at(). Registers past the table count as live
+    [[nodiscard]] inline bool is_live(const uint64_t* live, size_t reg) const noexcept {
+        if (reg >= num_registers_) return true;
+        return (live[reg / 64] >> (reg % 64)) & 1;
+    }
+
+private:
+    std::vector<uint32_t> offsets_;
+    std::vector<uint64_t> bits_;
+    size_t num_registers_ = 0;
+    size_t words_ = 0;
+};
+}  // namespace meow::runtime
@@ -26,7 +26,7 @@ inline meow::core::ValueType get_value_type(meow::core::param_t value) noexcept
     using namespace meow::core;
     ValueType type = static_cast<ValueType>(value.index());
     if (type == ValueType::Object) {
-        return static_cast<ValueType>(value.as_object()->get_type());
+        return static_cast<ValueType>(value.get_object_type());
     }
     return type;
 }
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "common/pch.h"
+#include "core/type.h"
+
+namespace meow::runtime {
+class Chunk;
+
+struct OptimizerOptions {
+    bool enabled = true;  ///< Run the pipeline at all
+    bool verify = true;   ///< Verify input and output; a proto whose output fails keeps its original code
+    bool inline_calls = true;  ///< Splice small callees into their call sites behind a GUARD_CALLEE
+#ifdef MEOW_PROFILE_OPCODES
+    bool superinstructions = false;  ///< Profiling builds must see the plain opcode stream
+#else
+    bool superinstructions = true;
+#endif
+
+    /// @brief Defaults, with the whole pipeline disabled when $MEOW_NO_OPTIMIZE is set to anything but "0"
+    [[nodiscard]] static OptimizerOptions from_environment() noexcept;
+};
+
+struct OptimizerStats {
+    size_t folded = 0;             ///< Constant arithmetic replaced by a LOAD_INT/LOAD_FLOAT
+    size_t propagated = 0;         ///< Register operands rewritten through a MOVE chain
+    size_t dead_stores = 0;        ///< LOAD_*/MOVE whose result is never read
+    size_t threaded = 0;           ///< Jumps retargeted past a JUMP, or removed
+    size_t unreachable = 0;        ///< Instructions no path reaches
+    size_t fused_branches = 0;     ///< See fuse_compare_branches
+    size_t superinstructions = 0;  ///< See form_superinstructions
+    size_t registers_saved = 0;    ///< Frame slots freed by register renumbering
+    size_t inlined = 0;            ///< Call sites given a guarded copy of the callee
+    size_t tail_calls = 0;         ///< CALL + RETURN pairs turned into TAIL_CALL
+    size_t shrunk = 0;             ///< LOAD_INT re-encoded as LOAD_SMALLINT
+    size_t try_markers = 0;        ///< SETUP_TRY/POP_TRY replaced by the proto's static exception table
+    bool reverted = false;         ///< The output failed verification and the original code was kept
+};
+
+/**
+ * @brief Structural check of a chunk: every instruction decodes, register operands fit in the frame,
+ * constant and upvalue indices are in range, jump targets land on instruction boundaries and
+ * superinstructions match the instructions that follow them
+ * @return Description of the first problem, or std::nullopt if the chunk is well-formed
+ */
+[[nodiscard]] std::optional<std::string> verify_chunk(const Chunk& chunk, size_t num_registers, size_t num_upvalues);
+
+/// @brief Global name -> proto, for globals of a module assigned exactly once, straight from a CLOSURE
+using InlineCandidates = std::unordered_map<std::string, core::proto_t>;
+
+/// @brief Scans every proto of a module for globals that are good guesses for a call's target
+[[nodiscard]] InlineCandidates find_inline_candidates(const std::vector<core::proto_t>& protos);
+
+/**
+ * @brief Load-time pipeline run once on each proto before it is executed: guarded inlining of small
+ * callees (a local CLOSURE or a global in `globals`), tail call formation, constant folding, copy
+ * propagation, dead store elimination, jump threading and unreachable code removal, compact
+ * immediates, register renumbering, then compare/branch fusion and superinstruction formation.
+ * Finally turns structured try regions into the proto's static exception table and attaches the
+ * register liveness table the GC uses to skip dead registers
+ * @note Protos that fail verification on input are left untouched
+ */
+OptimizerStats optimize_proto(core::proto_t proto, const OptimizerOptions& options, const InlineCandidates& globals = {});
+
+/// @brief Load-time setup of a proto whose code and exception table are already optimize_proto() output, read
+/// back from a pre-optimized module: verifies them and attaches the liveness table, leaving the code untouched
+/// @return Description of the first problem, or std::nullopt if the proto is ready to run
+[[nodiscard]] std::optional<std::string> adopt_optimized_proto(core::proto_t proto);
+}  // namespace meow::runtime
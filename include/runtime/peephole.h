@@ -0,0 +1,29 @@
+#pragma once
+
+#include "common/pch.h"
+
+namespace meow::runtime {
+class Chunk;
+
+/// @brief Registers captured by some CLOSURE of the chunk, indexed by register. Such registers can be
+/// read or written through an upvalue at any call, so passes must treat them as always live
+/// @note Every register counts as captured if a CLOSURE operand is not a linked proto
+std::vector<bool> captured_registers(const Chunk& chunk);
+
+/**
+ * @brief Fuses `EQ/NEQ/LT/LE/GT/GE t, a, b` followed by `JUMP_IF_FALSE/JUMP_IF_TRUE t, L` into one
+ * `JUMP_IF_<cmp> a, b, L`, then relocates every jump target in the chunk
+ * @note A pair is only fused when `t` is never read again, is not captured by a closure and the
+ * conditional jump is not itself a jump target
+ * @return Number of fused pairs
+ */
+size_t fuse_compare_branches(Chunk& chunk);
+
+/**
+ * @brief Rewrites the opcode byte of every sequence listed in core/superinstructions.def into its
+ * superinstruction. Lengths and jump targets do not change, so this must run after every pass that
+ * relocates code
+ * @return Number of superinstructions formed
+ */
+size_t form_superinstructions(Chunk& chunk);
+}  // namespace meow::runtime
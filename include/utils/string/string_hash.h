@@ -3,11 +3,44 @@
 #include "common/pch.h"
 
 namespace meow::utils::string {
+    /// @brief FNV-1a, 64-bit. Stable across builds and platforms, so .meowb string tables can store it
+    [[nodiscard]] inline constexpr uint64_t hash_string(std::string_view text) noexcept {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (char c : text) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    /// @brief Text whose hash_string() is already known, for pool lookups that skip hashing
+    struct PrehashedString {
+        std::string_view text;
+        uint64_t hash;
+    };
+    [[nodiscard]] inline bool operator==(const std::string& lhs, const PrehashedString& rhs) noexcept {
+        return lhs == rhs.text;
+    }
+
+    /// @brief Owning string pool key that keeps its hash_string(), so inserting and rehashing the pool never hash the text again
+    struct HashedString {
+        std::string text;
+        uint64_t hash;
+    };
+    [[nodiscard]] inline bool operator==(const HashedString& lhs, const HashedString& rhs) noexcept {
+        return lhs.hash == rhs.hash && lhs.text == rhs.text;
+    }
+    [[nodiscard]] inline bool operator==(const HashedString& lhs, const PrehashedString& rhs) noexcept {
+        return lhs.hash == rhs.hash && lhs.text == rhs.text;
+    }
+
     struct StringHash {
         using is_transparent = void;
         
-        size_t operator()(const char* txt) const { return std::hash<std::string_view>{}(txt); }
-        size_t operator()(std::string_view txt) const { return std::hash<std::string_view>{}(txt); }
-        size_t operator()(const std::string& txt) const { return std::hash<std::string>{}(txt); }
+        size_t operator()(const char* txt) const { return static_cast<size_t>(hash_string(txt)); }
+        size_t operator()(std::string_view txt) const { return static_cast<size_t>(hash_string(txt)); }
+        size_t operator()(const std::string& txt) const { return static_cast<size_t>(hash_string(txt)); }
+        size_t operator()(const PrehashedString& txt) const { return static_cast<size_t>(txt.hash); }
+        size_t operator()(const HashedString& txt) const { return static_cast<size_t>(txt.hash); }
     };
-}
\ No newline at end of file
+}
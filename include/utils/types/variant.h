@@ -74,6 +74,9 @@ class variant {
     using variant_inner_list_t = typename utils::detail::variant_inner_list<std::decay_t<V>>::type;
 
    public:
+    /// @brief true when the backend is NaNBoxedVariant, the only one with pointer sub-tags
+    static constexpr bool has_pointer_tags = detail_backend::select_backend_impl<flattened_list_t>::use_nanbox;
+
     // --- Constructors / assignment ---
     variant() = default;
     variant(const variant&) = default;
@@ -203,6 +206,25 @@ class variant {
     [[nodiscard]] std::size_t index() const noexcept {
         return storage_.index();
     }
+
+    // --- Pointer sub-tags (NaN-boxing backend only, see has_pointer_tags) ---
+    template <typename T>
+    [[nodiscard]] bool holds_tagged(uint8_t tag) const noexcept
+        requires has_pointer_tags
+    {
+        return storage_.template holds_tagged<T>(tag);
+    }
+    [[nodiscard]] uint8_t pointer_tag() const noexcept
+        requires has_pointer_tags
+    {
+        return storage_.pointer_tag();
+    }
+    template <typename T>
+    void set_pointer_tag(uint8_t tag) noexcept
+        requires has_pointer_tags
+    {
+        storage_.template set_pointer_tag<T>(tag);
+    }
     [[nodiscard]] bool valueless() const noexcept {
         return storage_.valueless();
     }
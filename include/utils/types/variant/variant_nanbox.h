@@ -76,6 +76,18 @@ struct is_bool_like {
     static constexpr bool value = std::is_same<std::decay_t<T>, bool>::value;
 };
 
+// Con trỏ tới kiểu căn lề >= 8 có 3 bit thấp luôn bằng 0, có thể dùng làm tag phụ
+template <typename P, typename = void>
+struct pointee_alignment : std::integral_constant<std::size_t, 1> {};
+template <typename P>
+struct pointee_alignment<P, std::enable_if_t<!std::is_void<P>::value && !std::is_function<P>::value>> : std::integral_constant<std::size_t, alignof(P)> {};
+
+template <typename T>
+struct pointer_tag_capacity {
+    using pointee = std::remove_cv_t<std::remove_pointer_t<std::decay_t<T>>>;
+    static constexpr bool value = std::is_pointer<std::decay_t<T>>::value && pointee_alignment<pointee>::value >= 8;
+};
+
 // ---------------------- all_nanboxable_impl dùng
 // meow::utils::detail::type_list ----------
 template <typename List>
@@ -96,6 +108,7 @@ static constexpr uint64_t MEOW_QNAN_PREFIX = (MEOW_EXP_MASK | MEOW_QNAN_BIT);
 static constexpr unsigned MEOW_TAG_SHIFT = 48;
 static constexpr uint64_t MEOW_TAG_MASK = (0x7ULL << MEOW_TAG_SHIFT);
 static constexpr uint64_t MEOW_PAYLOAD_MASK = ((1ULL << MEOW_TAG_SHIFT) - 1ULL);
+static constexpr uint64_t MEOW_POINTER_TAG_MASK = 0x7ULL;
 
 // ---------------------- Fast primitives ----------------------
 MEOW_ALWAYS_INLINE MEOW_PURE MEOW_HOT uint64_t meow_bitcast_double_to_u64(double d) noexcept {
@@ -294,6 +307,27 @@ class NaNBoxedVariant {
         o.index_ = ix;
     }
 
+    // --- Pointer sub-tags ---
+    // Với alternative con trỏ đủ căn lề, 3 bit thấp của payload chứa một tag phụ (ví dụ loại object),
+    // nên có thể kiểm tra kiểu mà không cần đọc bộ nhớ. get()/visit() luôn trả về con trỏ đã xóa tag
+
+    /// @brief True if the active alternative is T and its sub-tag equals `tag`. Register-only test
+    template <typename T>
+    [[nodiscard]] MEOW_ALWAYS_INLINE bool holds_tagged(uint8_t tag) const noexcept {
+        static_assert(pointer_tag_capacity<T>::value, "holds_tagged requires a pointer to a type aligned to at least 8 bytes");
+        constexpr std::size_t idx = detail::type_list_index_of<std::decay_t<T>, flat_list>::value;
+        return index_ == static_cast<index_t>(idx) && (bits_ & MEOW_POINTER_TAG_MASK) == tag;
+    }
+    /// @brief Sub-tag of the active pointer alternative. Only meaningful if a tagged pointer is held
+    [[nodiscard]] MEOW_ALWAYS_INLINE uint8_t pointer_tag() const noexcept {
+        return static_cast<uint8_t>(bits_ & MEOW_POINTER_TAG_MASK);
+    }
+    template <typename T>
+    MEOW_ALWAYS_INLINE void set_pointer_tag(uint8_t tag) noexcept {
+        static_assert(pointer_tag_capacity<T>::value, "set_pointer_tag requires a pointer to a type aligned to at least 8 bytes");
+        bits_ = (bits_ & ~MEOW_POINTER_TAG_MASK) | (static_cast<uint64_t>(tag) & MEOW_POINTER_TAG_MASK);
+    }
+
     [[nodiscard]] MEOW_ALWAYS_INLINE uint64_t get_raw_bits() const noexcept {
         return bits_;
     }
@@ -363,7 +397,9 @@ class NaNBoxedVariant {
 
     template <typename T>
     MEOW_ALWAYS_INLINE static T decode_payload_to_value(uint64_t payload) noexcept {
-        if constexpr (is_pointer_like<T>::value) {
+        if constexpr (pointer_tag_capacity<T>::value) {
+            return reinterpret_cast<T>(meow_ptr_from_payload(payload & ~MEOW_POINTER_TAG_MASK));
+        } else if constexpr (is_pointer_like<T>::value) {
             return reinterpret_cast<T>(meow_ptr_from_payload(payload));
         } else if constexpr (is_integral_like<T>::value) {
             uint64_t mask = (1ULL << 48) - 1ULL;
@@ -1,7 +1,20 @@
 #pragma once
 
+#include "core/type.h"
+
+namespace meow::core {
+class Value;
+}
+
 namespace meow::vm {
 class MeowEngine {
    public:
+    /// @brief jit::CompiledCode::native_t: a proto compiled ahead of time by meow-aotc
+    using NativeEntry = uint32_t (*)(meow::core::Value* registers, uint32_t pc, void* context, meow::core::Value* (*callout)(void* context, uint32_t pc) noexcept);
+
+    virtual ~MeowEngine() = default;
+
+    /// @brief Runs `proto` through `entry` from now on, the way baseline JIT code runs. Ignored when native code is disabled
+    virtual void attach_native_code(meow::core::proto_t proto, NativeEntry entry) = 0;
 };
-}  // namespace meow::vm
\ No newline at end of file
+}  // namespace meow::vm
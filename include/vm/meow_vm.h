@@ -2,6 +2,9 @@
 
 #include "common/pch.h"
 #include "vm/meow_engine.h"
+#ifdef MEOW_PROFILE_OPCODES
+#include "vm/opcode_profile.h"
+#endif
 
 namespace meow::runtime {
     struct ExecutionContext;
@@ -10,6 +13,8 @@ namespace meow::runtime {
 }
 namespace meow::memory { class MemoryManager; }
 namespace meow::module { class ModuleManager; }
+namespace meow::jit { class BaselineJit; class TraceJit; class CompiledCode; }
+namespace meow::core { class Value; }
 
 namespace meow::vm {
 struct VMError : public std::runtime_error {
@@ -34,6 +39,16 @@ public:
 
     // --- Public API ---
     void interpret() noexcept;
+    /**
+     * @brief Loads the .meowb module at `path` as the entry module and runs its main proto to completion
+     * @return What the main proto returned, or R0 if it halted
+     * @throws VMError with the message of an error nothing caught, std::runtime_error if the module cannot be loaded
+     */
+    meow::core::Value run_module(const std::string& path);
+    [[nodiscard]] inline meow::core::module_t get_entry_module() const noexcept {
+        return entry_module_;
+    }
+    void attach_native_code(meow::core::proto_t proto, NativeEntry entry) override;
 private:
     // --- Subsystems ---
     std::unique_ptr<meow::runtime::ExecutionContext> context_;
@@ -44,46 +59,81 @@ private:
 
     // --- Runtime arguments ---
     VMArgs args_;
+    meow::core::module_t entry_module_ = nullptr;
+    std::optional<std::string> uncaught_error_;  ///< Set by handle_error() when nothing catches, see run_module()
+    uint32_t feedback_threshold_ = 0;  ///< See runtime::FeedbackOptions
+
+    // --- Baseline JIT (nullptr when disabled or unsupported) ---
+    std::unique_ptr<meow::jit::BaselineJit> jit_;
+    std::exception_ptr jit_error_;  ///< Raised by a callout, rethrown by run() at the faulting instruction
+    std::unique_ptr<meow::jit::TraceJit> tracer_;  ///< Tracing tier for hot loops, nullptr when disabled
+    std::vector<std::unique_ptr<meow::jit::CompiledCode>> aot_code_;  ///< Protos of meow-aotc modules, see attach_native_code()
+
+#ifdef MEOW_PROFILE_OPCODES
+    // --- Superinstruction profiling ---
+    OpcodeProfile opcode_profile_;
+#endif
 
     // --- Execution internals ---
     void prepare() noexcept;
     void run();
 
+    /// @brief Appends the type feedback of every profiled proto to the file named by $MEOW_FEEDBACK_DUMP, if set
+    void dump_feedback() const;
+    /// @brief Reads the body of a stub proto before its first frame, raising a VM error if that fails
+    void load_proto_body(meow::core::proto_t proto);
+
     // --- Error helpers ---
     [[noreturn]] inline void throw_vm_error(const std::string& message) {
         throw VMError(message);
     }
+    /// @brief Resumes at the innermost handler for an error raised at the current instruction: a SETUP_TRY
+    /// record of the frame, else the static exception table of its proto, else the caller's
+    /// @return false if nothing catches the error
+    inline bool handle_error(const std::string& message, const uint8_t*& ip);
+
+    // --- JIT callouts ---
+    /// @brief jit::BaselineJit::CalloutFn: runs one straight-line instruction of the current frame for compiled code
+    static meow::core::Value* jit_callout(void* vm, uint32_t pc) noexcept;
+    meow::core::Value* jit_step(uint32_t pc) noexcept;
 
     // --- OpCode Handlers (Helpers) ---
-    inline void op_load_const(const uint8_t*& ip);
-    inline void op_load_null(const uint8_t*& ip);
-    inline void op_load_true(const uint8_t*& ip);
-    inline void op_load_false(const uint8_t*& ip);
-    inline void op_load_int(const uint8_t*& ip);
-    inline void op_load_float(const uint8_t*& ip);
-    inline void op_move(const uint8_t*& ip);
-    inline void op_get_global(const uint8_t*& ip);
-    inline void op_set_global(const uint8_t*& ip);
-    inline void op_get_upvalue(const uint8_t*& ip);
-    inline void op_set_upvalue(const uint8_t*& ip);
-    inline void op_closure(const uint8_t*& ip);
-    inline void op_close_upvalues(const uint8_t*& ip);
-    inline void op_new_array(const uint8_t*& ip);
-    inline void op_new_hash(const uint8_t*& ip);
-    inline void op_get_index(const uint8_t*& ip);
-    inline void op_set_index(const uint8_t*& ip);
-    inline void op_get_keys(const uint8_t*& ip);
-    inline void op_get_values(const uint8_t*& ip);
-    inline void op_new_class(const uint8_t*& ip);
-    inline void op_new_instance(const uint8_t*& ip);
-    inline void op_get_prop(const uint8_t*& ip);
-    inline void op_set_prop(const uint8_t*& ip);
-    inline void op_set_method(const uint8_t*& ip);
-    inline void op_inherit(const uint8_t*& ip);
-    inline void op_get_super(const uint8_t*& ip);
+    // `Wide`: the instruction sits behind a WIDE prefix, see runtime/bytecode.h
+    template <bool Wide> inline void op_load_const(const uint8_t*& ip);
+    template <bool Wide> inline void op_load_null(const uint8_t*& ip);
+    template <bool Wide> inline void op_load_true(const uint8_t*& ip);
+    template <bool Wide> inline void op_load_false(const uint8_t*& ip);
+    template <bool Wide> inline void op_load_int(const uint8_t*& ip);
+    template <bool Wide> inline void op_load_smallint(const uint8_t*& ip);
+    template <bool Wide> inline void op_load_float(const uint8_t*& ip);
+    template <bool Wide> inline void op_move(const uint8_t*& ip);
+    template <bool Wide> inline void op_get_global(const uint8_t*& ip);
+    template <bool Wide> inline void op_set_global(const uint8_t*& ip);
+    template <bool Wide> inline void op_get_upvalue(const uint8_t*& ip);
+    template <bool Wide> inline void op_set_upvalue(const uint8_t*& ip);
+    template <bool Wide> inline void op_closure(const uint8_t*& ip);
+    template <bool Wide> inline void op_close_upvalues(const uint8_t*& ip);
+    template <bool Wide> inline void op_new_array(const uint8_t*& ip);
+    template <bool Wide> inline void op_new_hash(const uint8_t*& ip);
+    template <bool Wide> inline void op_get_index(const uint8_t*& ip);
+    template <bool Wide> inline void op_set_index(const uint8_t*& ip);
+    template <bool Wide> inline void op_get_keys(const uint8_t*& ip);
+    template <bool Wide> inline void op_get_values(const uint8_t*& ip);
+    template <bool Wide> inline void op_new_class(const uint8_t*& ip);
+    template <bool Wide> inline void op_new_instance(const uint8_t*& ip);
+    template <bool Wide> inline void op_get_prop(const uint8_t*& ip);
+    template <bool Wide> inline void op_set_prop(const uint8_t*& ip);
+    template <bool Wide> inline void op_set_method(const uint8_t*& ip);
+    template <bool Wide> inline void op_inherit(const uint8_t*& ip);
+    template <bool Wide> inline void op_get_super(const uint8_t*& ip);
     inline void op_pop_try();  // Không cần 'ip'
-    inline void op_export(const uint8_t*& ip);
-    inline void op_get_export(const uint8_t*& ip);
-    inline void op_import_all(const uint8_t*& ip);
+    template <bool Wide> inline void op_export(const uint8_t*& ip);
+    template <bool Wide> inline void op_get_export(const uint8_t*& ip);
+    template <bool Wide> inline void op_import_all(const uint8_t*& ip);
+    template <bool Wide> inline void op_for_prep(const uint8_t*& ip);
+    template <bool Wide> inline void op_for_loop(const uint8_t*& ip);
+    template <bool Wide> inline void op_for_in(const uint8_t*& ip);
+    template <bool Wide> inline void op_iter_new(const uint8_t*& ip);
+    template <bool Wide> inline void op_iter_next(const uint8_t*& ip);
 };
 }  // namespace meow::vm
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "common/pch.h"
+#include "core/op_codes.h"
+
+namespace meow::vm {
+
+/**
+ * @brief Counts consecutive opcode pairs and triples as they are dispatched
+ *
+ * Only compiled into the dispatch loop when MEOW_PROFILE_OPCODES is defined. The dump is the input of
+ * scripts/gen_superinstructions.py, which picks the sequences that become superinstructions.
+ */
+class OpcodeProfile {
+public:
+    OpcodeProfile() : pairs_(NUM_OPCODES * NUM_OPCODES, 0), triples_(NUM_OPCODES * NUM_OPCODES * NUM_OPCODES, 0) {}
+
+    inline void record(uint8_t opcode) noexcept {
+        if (opcode >= NUM_OPCODES) return;
+        // Lệnh có tiền tố WIDE không bao giờ nằm trong superinstruction, xem runtime::encode_code
+        if (opcode == static_cast<uint8_t>(core::OpCode::WIDE)) {
+            break_sequence();
+            return;
+        }
+        if (prev_ < NUM_OPCODES) {
+            ++pairs_[prev_ * NUM_OPCODES + opcode];
+            if (prev2_ < NUM_OPCODES) ++triples_[(prev2_ * NUM_OPCODES + prev_) * NUM_OPCODES + opcode];
+        }
+        prev2_ = prev_;
+        prev_ = opcode;
+    }
+
+    /// @brief Forgets the previous opcodes, e.g. after an exception unwinds to a handler
+    inline void break_sequence() noexcept { prev_ = prev2_ = NO_OPCODE; }
+
+    /// @brief Text dump, one `pair A B count` or `triple A B C count` per line, most frequent first
+    void dump(std::ostream& os) const;
+
+    /// @brief Appends the dump to the file named by $MEOW_OPCODE_PROFILE, if set
+    void flush() const;
+
+private:
+    static constexpr size_t NUM_OPCODES = static_cast<size_t>(core::OpCode::TOTAL_OPCODES);
+    static constexpr size_t NO_OPCODE = NUM_OPCODES;
+
+    size_t prev_ = NO_OPCODE;
+    size_t prev2_ = NO_OPCODE;
+    std::vector<uint64_t> pairs_;
+    std::vector<uint64_t> triples_;
+};
+}  // namespace meow::vm
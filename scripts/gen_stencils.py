@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""Extract the copy-and-patch JIT stencils from a compiled object file into a C++ table.
+
+The build compiles src/jit/stencils/stencils.cpp to an ELF object (x86-64 or AArch64) and runs
+
+    scripts/gen_stencils.py stencils.o generated/jit/stencils.inc
+
+Every `meow_stencil_<NAME>` function becomes a byte array plus the list of places ("holes") the JIT patches:
+relocations against `meow_hole_<NAME>` symbols, which include/jit/stencil_abi.h declares. Anything else the
+code refers to (constant pools, other functions, the stack protector...) is an error, since the copied bytes
+could not reach it.
+"""
+
+import argparse
+import pathlib
+import re
+import struct
+import sys
+
+ROOT = pathlib.Path(__file__).resolve().parent.parent
+ABI_HEADER = ROOT / "include" / "jit" / "stencil_abi.h"
+
+EM_X86_64 = 62
+EM_AARCH64 = 183
+SHT_SYMTAB = 2
+SHT_RELA = 4
+
+# ELF relocation type -> (RelocKind, is a branch)
+X64_RELOCS = {
+    1: ("ABS64", False),      # R_X86_64_64
+    2: ("X64_REL32", True),   # R_X86_64_PC32
+    4: ("X64_REL32", True),   # R_X86_64_PLT32
+}
+ARM64_RELOCS = {
+    257: ("ABS64", False),           # R_AARCH64_ABS64
+    263: ("ARM64_MOVW0", False),     # R_AARCH64_MOVW_UABS_G0
+    264: ("ARM64_MOVW0", False),     # R_AARCH64_MOVW_UABS_G0_NC
+    265: ("ARM64_MOVW1", False),     # R_AARCH64_MOVW_UABS_G1
+    266: ("ARM64_MOVW1", False),     # R_AARCH64_MOVW_UABS_G1_NC
+    267: ("ARM64_MOVW2", False),     # R_AARCH64_MOVW_UABS_G2
+    268: ("ARM64_MOVW2", False),     # R_AARCH64_MOVW_UABS_G2_NC
+    269: ("ARM64_MOVW3", False),     # R_AARCH64_MOVW_UABS_G3
+    282: ("ARM64_BRANCH26", True),   # R_AARCH64_JUMP26
+    283: ("ARM64_BRANCH26", True),   # R_AARCH64_CALL26
+}
+ARM64_CALL26 = 283
+
+
+def fail(message):
+    sys.exit(f"gen_stencils: {message}")
+
+
+def load_abi():
+    text = ABI_HEADER.read_text()
+
+    def names(macro):
+        match = re.search(rf"#define {macro}\(X\)((?:.*\\\n)*.*)", text)
+        if not match:
+            fail(f"{macro} not found in {ABI_HEADER}")
+        return re.findall(r"X\((\w+)\)", match.group(1))
+
+    return names("MEOW_STENCIL_VALUE_HOLES"), names("MEOW_STENCIL_CODE_HOLES"), names("MEOW_STENCILS")
+
+
+class ElfObject:
+    def __init__(self, data):
+        if data[:4] != b"\x7fELF" or data[4] != 2 or data[5] != 1:
+            fail("expected a little-endian ELF64 object")
+        self.data = data
+        (self.machine,) = struct.unpack_from("<H", data, 18)
+        shoff, = struct.unpack_from("<Q", data, 40)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 58)
+        self.sections = []
+        for i in range(shnum):
+            name, kind, _, _, offset, size, link, info, _, entsize = struct.unpack_from("<IIQQQQIIQQ", data, shoff + i * shentsize)
+            self.sections.append({"name": name, "type": kind, "offset": offset, "size": size, "link": link, "info": info, "entsize": entsize})
+        names = self.sections[shstrndx]
+        for section in self.sections:
+            section["name"] = self.string(names, section["name"])
+        self.symbols = []
+        for section in self.sections:
+            if section["type"] == SHT_SYMTAB:
+                strings = self.sections[section["link"]]
+                for at in range(section["offset"], section["offset"] + section["size"], section["entsize"]):
+                    name, info, _, shndx, value, size = struct.unpack_from("<IBBHQQ", data, at)
+                    self.symbols.append({"name": self.string(strings, name), "type": info & 0xF, "shndx": shndx, "value": value, "size": size})
+
+    def string(self, section, offset):
+        start = section["offset"] + offset
+        return self.data[start:self.data.index(b"\0", start)].decode()
+
+    def contents(self, section):
+        return self.data[section["offset"]:section["offset"] + section["size"]]
+
+    def relocations(self, index):
+        for section in self.sections:
+            if section["type"] == SHT_RELA and section["info"] == index:
+                for at in range(section["offset"], section["offset"] + section["size"], section["entsize"]):
+                    offset, info, addend = struct.unpack_from("<QQq", self.data, at)
+                    yield offset, info & 0xFFFFFFFF, self.symbols[info >> 32], addend
+
+
+def extract(elf, name, value_holes, code_holes):
+    index = next((i for i, s in enumerate(elf.sections) if s["name"] == f".text.meow_stencil_{name}"), None)
+    if index is None:
+        fail(f"meow_stencil_{name} not found (was the object compiled with -ffunction-sections?)")
+    code = bytearray(elf.contents(elf.sections[index]))
+    x64 = elf.machine == EM_X86_64
+    table = X64_RELOCS if x64 else ARM64_RELOCS
+
+    relocs = []
+    for offset, kind, symbol, addend in elf.relocations(index):
+        hole = symbol["name"].removeprefix("meow_hole_")
+        if not symbol["name"].startswith("meow_hole_") or hole not in value_holes + code_holes:
+            fail(f"{name}: reference to {symbol['name'] or 'a local section'} at +{offset:#x}, stencils may only use meow_hole_* symbols")
+        if kind not in table:
+            fail(f"{name}: unsupported relocation type {kind} against {symbol['name']} at +{offset:#x}")
+        reloc_kind, branch = table[kind]
+        if hole in code_holes:
+            if not branch:
+                fail(f"{name}: {symbol['name']} is used as a value, it may only be tail-called")
+            called = code[offset - 1] == 0xE8 if x64 else kind == ARM64_CALL26
+            if called:
+                fail(f"{name}: {symbol['name']} is called instead of tail-called, check the optimization flags")
+        if x64 and branch and not (code[offset - 1] in (0xE8, 0xE9) or (code[offset - 2] == 0x0F and 0x80 <= code[offset - 1] <= 0x8F)):
+            fail(f"{name}: rel32 to {symbol['name']} at +{offset:#x} is not a call or jump")
+        relocs.append((offset, reloc_kind, hole, addend))
+    relocs.sort()
+
+    # Jump tới lệnh kế tiếp ở cuối stencil: bỏ đi để chạy thẳng xuống stencil sau
+    if relocs:
+        offset, kind, hole, _ = relocs[-1]
+        if hole == "CONTINUE" and ((x64 and offset == len(code) - 4 and code[offset - 1] == 0xE9) or (not x64 and offset == len(code) - 4)):
+            del code[offset - (1 if x64 else 0):]
+            relocs.pop()
+    return bytes(code), relocs
+
+
+def render(stencils, machine, source):
+    arch = "X64" if machine == EM_X86_64 else "ARM64"
+    lines = [
+        f"// Generated by scripts/gen_stencils.py from {source.name}, do not edit",
+        "#pragma once",
+        "",
+        '#include "jit/stencil_abi.h"',
+        "",
+        f"#define MEOW_STENCILS_{arch} 1",
+        "",
+        "namespace meow::jit::stencils {",
+    ]
+    for name, (code, relocs) in stencils.items():
+        body = ", ".join(f"0x{byte:02x}" for byte in code)
+        lines.append(f"inline constexpr uint8_t {name}_CODE[] = {{{body}}};")
+        if relocs:
+            entries = ", ".join(f"{{{offset}, RelocKind::{kind}, Hole::{hole}, {addend}}}" for offset, kind, hole, addend in relocs)
+            lines.append(f"inline constexpr StencilReloc {name}_RELOCS[] = {{{entries}}};")
+            lines.append(f"inline constexpr Stencil {name}{{{name}_CODE, {len(code)}, {name}_RELOCS, {len(relocs)}}};")
+        else:
+            lines.append(f"inline constexpr Stencil {name}{{{name}_CODE, {len(code)}, nullptr, 0}};")
+    lines.append("}  // namespace meow::jit::stencils")
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("object", type=pathlib.Path, help="stencils compiled to an ELF object")
+    parser.add_argument("output", type=pathlib.Path, help="C++ table to write")
+    args = parser.parse_args()
+
+    value_holes, code_holes, names = load_abi()
+    elf = ElfObject(args.object.read_bytes())
+    if elf.machine not in (EM_X86_64, EM_AARCH64):
+        fail(f"unsupported machine {elf.machine}, stencils exist for x86-64 and AArch64")
+    stencils = {name: extract(elf, name, value_holes, code_holes) for name in names}
+    table = render(stencils, elf.machine, args.object)
+    args.output.parent.mkdir(parents=True, exist_ok=True)
+    args.output.write_text(table)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""Pick superinstructions from opcode profiles and regenerate include/core/superinstructions.def.
+
+Profiles come from a VM built with -DMEOW_PROFILE_OPCODES=ON and run with
+MEOW_OPCODE_PROFILE=<file>; several files (or several runs appended to one file) are summed.
+
+    scripts/gen_superinstructions.py profiles/*.txt
+    scripts/gen_superinstructions.py --pairs 12 --triples 4 --dry-run run.txt
+"""
+
+import argparse
+import collections
+import pathlib
+import re
+import sys
+
+ROOT = pathlib.Path(__file__).resolve().parent.parent
+VM_SOURCE = ROOT / "src" / "vm" / "meow_vm.cpp"
+OUTPUT = ROOT / "include" / "core" / "superinstructions.def"
+
+# Opcodes that change control flow never appear in the middle of a sequence, so they are only
+# allowed as the last component. The others must have a SUPER_STEP_<OP> in the dispatch loop.
+STEP_RE = re.compile(r"^#define SUPER_STEP_(\w+) ", re.MULTILINE)
+
+
+def load_steps():
+    return set(STEP_RE.findall(VM_SOURCE.read_text()))
+
+
+def load_profiles(paths):
+    counts = collections.Counter()
+    for path in paths:
+        for line_no, line in enumerate(pathlib.Path(path).read_text().splitlines(), 1):
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            kind, *fields = line.split()
+            if kind not in ("pair", "triple") or len(fields) != (3 if kind == "pair" else 4):
+                sys.exit(f"{path}:{line_no}: malformed line: {line}")
+            *ops, count = fields
+            counts[tuple(ops)] += int(count)
+    return counts
+
+
+def select(counts, steps, max_pairs, max_triples, min_share):
+    total = sum(count for ops, count in counts.items() if len(ops) == 2) or 1
+    chosen = {2: [], 3: []}
+    # Every occurrence saves (length - 1) dispatches
+    for ops, count in sorted(counts.items(), key=lambda item: item[1] * (len(item[0]) - 1), reverse=True):
+        if any(op.startswith("SI_") for op in ops) or not all(op in steps for op in ops[:-1]):
+            continue
+        if count / total < min_share:
+            continue
+        limit = max_pairs if len(ops) == 2 else max_triples
+        if len(chosen[len(ops)]) < limit:
+            chosen[len(ops)].append((ops, count))
+    return chosen, total
+
+
+def render(chosen, total, sources):
+    lines = [
+        "// Superinstruction table, consumed as an X-macro. Do not add include guards.",
+        "//",
+        f"// Generated by scripts/gen_superinstructions.py from {len(sources)} profile(s), {total} dispatched pairs.",
+        "// Every component except the last must have a SUPER_STEP_<OP> in src/vm/meow_vm.cpp.",
+        "//",
+        "//   MEOW_SUPERINSTRUCTION(NAME, FIRST, SECOND)",
+        "//   MEOW_SUPERINSTRUCTION3(NAME, FIRST, SECOND, THIRD)",
+        "//",
+        "// Patterns are tried in the order below, triples before pairs.",
+        "",
+    ]
+    for ops, count in chosen[3]:
+        lines.append(f"MEOW_SUPERINSTRUCTION3({'_'.join(ops)}, {', '.join(ops)})  // {count / total:.2%}")
+    if chosen[3]:
+        lines.append("")
+    for ops, count in chosen[2]:
+        lines.append(f"MEOW_SUPERINSTRUCTION({'_'.join(ops)}, {', '.join(ops)})  // {count / total:.2%}")
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("profiles", nargs="+", help="profile dumps written by the VM")
+    parser.add_argument("--pairs", type=int, default=16, help="maximum number of pair superinstructions")
+    parser.add_argument("--triples", type=int, default=8, help="maximum number of triple superinstructions")
+    parser.add_argument("--min-share", type=float, default=0.005, help="minimum share of all dispatched pairs")
+    parser.add_argument("--dry-run", action="store_true", help="print the table instead of writing it")
+    args = parser.parse_args()
+
+    steps = load_steps()
+    if not steps:
+        sys.exit(f"no SUPER_STEP_ definitions found in {VM_SOURCE}")
+    chosen, total = select(load_profiles(args.profiles), steps, args.pairs, args.triples, args.min_share)
+    table = render(chosen, total, args.profiles)
+    if args.dry_run:
+        sys.stdout.write(table)
+    else:
+        OUTPUT.write_text(table)
+        print(f"==> wrote {len(chosen[2])} pairs, {len(chosen[3])} triples to {OUTPUT.relative_to(ROOT)}")
+
+
+if __name__ == "__main__":
+    main()
@@ -3,7 +3,101 @@
 
 namespace meow::core::objects {
 
+ObjArray::ObjArray(const container_t& elements) : ObjArray(container_t(elements)) {
+}
+
+ObjArray::ObjArray(container_t&& elements) {
+    bool all_ints = true, all_floats = true;
+    for (const auto& element : elements) {
+        all_ints = all_ints && element.is_int();
+        all_floats = all_floats && element.is_float();
+    }
+    if (elements.empty()) {
+        new (&ints_) std::vector<int_t>();
+        return;
+    }
+    if (!all_ints && !all_floats) {
+        set_kind(ElementKind::VALUE);
+        new (&elements_) container_t(std::move(elements));
+        return;
+    }
+    if (all_ints) {
+        new (&ints_) std::vector<int_t>();
+        ints_.reserve(elements.size());
+        for (const auto& element : elements) ints_.push_back(element.as_int());
+    } else {
+        set_kind(ElementKind::FLOAT);
+        new (&floats_) std::vector<float_t>();
+        floats_.reserve(elements.size());
+        for (const auto& element : elements) floats_.push_back(element.as_float());
+    }
+}
+
+ObjArray::ObjArray(ObjArray&& other) noexcept {
+    set_kind(other.kind());
+    switch (kind()) {
+        case ElementKind::INT:
+            new (&ints_) std::vector<int_t>(std::move(other.ints_));
+            break;
+        case ElementKind::FLOAT:
+            new (&floats_) std::vector<float_t>(std::move(other.floats_));
+            break;
+        default:
+            new (&elements_) container_t(std::move(other.elements_));
+            break;
+    }
+}
+
+void ObjArray::destroy_storage() noexcept {
+    switch (kind()) {
+        case ElementKind::INT:
+            ints_.~vector();
+            break;
+        case ElementKind::FLOAT:
+            floats_.~vector();
+            break;
+        default:
+            elements_.~vector();
+            break;
+    }
+}
+
+void ObjArray::adopt_kind(ElementKind kind) {
+    // Mảng rỗng: chỉ chuyển capacity đã reserve sang storage mới
+    size_t reserved = capacity();
+    destroy_storage();
+    set_kind(kind);
+    switch (kind) {
+        case ElementKind::INT:
+            new (&ints_) std::vector<int_t>();
+            break;
+        case ElementKind::FLOAT:
+            new (&floats_) std::vector<float_t>();
+            break;
+        default:
+            new (&elements_) container_t();
+            break;
+    }
+    reserve(reserved);
+}
+
+void ObjArray::transition_to_values() {
+    if (kind() == ElementKind::VALUE) return;
+    container_t values;
+    values.reserve(capacity());
+    if (kind() == ElementKind::INT) {
+        for (auto i : ints_) values.emplace_back(i);
+    } else {
+        for (auto f : floats_) values.emplace_back(f);
+    }
+    destroy_storage();
+    set_kind(ElementKind::VALUE);
+    new (&elements_) container_t(std::move(values));
+}
+
 void ObjArray::trace(meow::memory::GCVisitor& visitor) const noexcept {
+    // Mảng packed không chứa object nào
+    if (kind() != ElementKind::VALUE) return;
     for (const auto& element : elements_) {
         visitor.visit_value(element);
     }
@@ -47,6 +141,42 @@ void ObjFunctionProto::trace(meow::memory::GCVisitor& visitor) const noexcept {
     for (size_t i = 0; i < chunk_.get_pool_size(); ++i) {
         visitor.visit_value(chunk_.get_constant(i));
     }
+    if (feedback_) feedback_->trace(visitor);
+}
+
+ObjFunctionProto::~ObjFunctionProto() noexcept {
+    if (body_source_) body_source_->forget(this, body_index_);
+}
+
+void ObjFunctionProto::load_body() {
+    // Giữ source sống suốt lúc đọc: nó có thể là tham chiếu cuối cùng tới tệp
+    std::shared_ptr<ProtoBodySource> source = body_source_;
+    source->load_body(this, body_index_);
+}
+
+void ObjFunctionProto::create_feedback() {
+    feedback_ = std::make_unique<meow::runtime::FeedbackVector>(chunk_);
+}
+
+std::vector<proto_t> collect_protos(proto_t main) {
+    std::vector<proto_t> protos;
+    if (!main) return protos;
+    std::unordered_map<proto_t, bool> seen{{main, true}};
+    std::vector<proto_t> pending{main};
+    while (!pending.empty()) {
+        proto_t proto = pending.back();
+        pending.pop_back();
+        protos.push_back(proto);
+        const auto& chunk = proto->get_chunk();
+        // Duyệt ngược để proto con được lấy ra theo đúng thứ tự trong bảng hằng số
+        for (size_t i = chunk.get_pool_size(); i-- > 0;) {
+            const Value& constant = chunk.get_constant(i);
+            if (!constant.is_proto()) continue;
+            proto_t child = constant.as_proto();
+            if (seen.try_emplace(child, true).second) pending.push_back(child);
+        }
+    }
+    return protos;
 }
 
 void ObjClosure::trace(meow::memory::GCVisitor& visitor) const noexcept {
@@ -63,11 +193,155 @@ void ObjModule::trace(meow::memory::GCVisitor& visitor) const noexcept {
         visitor.visit_object(key);
         visitor.visit_value(value);
     }
-    for (const auto& [key, value] : exports_) {
-        visitor.visit_object(key);
+    for (const auto& name : export_names_) {
+        visitor.visit_object(name);
+    }
+    for (const auto& value : export_values_) {
         visitor.visit_value(value);
     }
+    for (const auto& link : export_links_) {
+        if (link.module != nullptr) visitor.visit_object(link.module);
+    }
+    for (const auto& module : star_imports_) {
+        visitor.visit_object(module);
+    }
     visitor.visit_object(main_proto_);
 }
 
-}  // namespace meow::core::objects
\ No newline at end of file
+size_t ObjModule::link_export(string_t name, module_t source, uint32_t source_slot) noexcept {
+    // Liên kết chỉ trỏ tới slot đã có nên không tạo chu trình, trừ khi đổi hướng một slot sang chuỗi đi qua
+    // chính module này (hai module IMPORT_ALL lẫn nhau): khi đó giữ liên kết cũ
+    const ObjModule* module = source;
+    uint32_t slot = source_slot;
+    while (module != nullptr) {
+        if (module == this) return find_export(name);
+        const ExportLink& link = module->export_links_[slot];
+        module = link.module;
+        slot = link.slot;
+    }
+
+    auto [it, inserted] = export_slots_.try_emplace(name, static_cast<uint32_t>(export_names_.size()));
+    if (inserted) {
+        export_names_.push_back(name);
+        export_values_.emplace_back();
+        export_links_.emplace_back();
+    } else if (export_links_[it->second].module == nullptr) {
+        // Export của chính module luôn được ưu tiên
+        return it->second;
+    }
+    export_links_[it->second] = ExportLink{source, source_slot};
+    return it->second;
+}
+
+void ObjModule::import_all_export(const module_t other) noexcept {
+    if (other == this) return;
+    if (std::find(star_imports_.begin(), star_imports_.end(), other) != star_imports_.end()) return;
+    star_imports_.push_back(other);
+    for (size_t slot = 0; slot < other->export_size(); ++slot) {
+        link_export(other->export_names_[slot], other, static_cast<uint32_t>(slot));
+    }
+}
+
+size_t ObjModule::resolve_export(string_t name) noexcept {
+    if (size_t slot = find_export(name); slot != npos) return slot;
+    if (star_imports_.empty()) return npos;
+
+    // Tên được export sau lúc IMPORT_ALL: tìm theo chiều rộng (đồ thị có thể có chu trình) rồi gắn vào đây
+    std::vector<module_t> visited{this};
+    for (size_t i = 0; i < visited.size(); ++i) {
+        const auto& imports = visited[i]->star_imports_;
+        for (auto it = imports.rbegin(); it != imports.rend(); ++it) {
+            module_t candidate = *it;
+            if (std::find(visited.begin(), visited.end(), candidate) != visited.end()) continue;
+            if (size_t slot = candidate->find_export(name); slot != npos) {
+                return link_export(name, candidate, static_cast<uint32_t>(slot));
+            }
+            visited.push_back(candidate);
+        }
+    }
+    return npos;
+}
+
+}  // namespace meow::core::objects
+
+namespace meow::core {
+using namespace meow::core::objects;
+
+// Header không có vtable, nên trace/destroy phải chọn lớp cụ thể theo tag
+void MeowObject::trace(meow::memory::GCVisitor& visitor) const noexcept {
+    switch (type) {
+        case ObjectType::ARRAY:
+            static_cast<const ObjArray*>(this)->trace(visitor);
+            break;
+        case ObjectType::STRING:
+            static_cast<const ObjString*>(this)->trace(visitor);
+            break;
+        case ObjectType::HASH_TABLE:
+            static_cast<const ObjHashTable*>(this)->trace(visitor);
+            break;
+        case ObjectType::INSTANCE:
+            static_cast<const ObjInstance*>(this)->trace(visitor);
+            break;
+        case ObjectType::CLASS:
+            static_cast<const ObjClass*>(this)->trace(visitor);
+            break;
+        case ObjectType::BOUND_METHOD:
+            static_cast<const ObjBoundMethod*>(this)->trace(visitor);
+            break;
+        case ObjectType::UPVALUE:
+            static_cast<const ObjUpvalue*>(this)->trace(visitor);
+            break;
+        case ObjectType::PROTO:
+            static_cast<const ObjFunctionProto*>(this)->trace(visitor);
+            break;
+        case ObjectType::FUNCTION:
+            static_cast<const ObjClosure*>(this)->trace(visitor);
+            break;
+        case ObjectType::NATIVE_FN:
+            static_cast<const ObjNativeFunction*>(this)->trace(visitor);
+            break;
+        case ObjectType::MODULE:
+            static_cast<const ObjModule*>(this)->trace(visitor);
+            break;
+    }
+}
+
+void MeowObject::destroy(const MeowObject* object) noexcept {
+    if (object == nullptr) return;
+    switch (object->type) {
+        case ObjectType::ARRAY:
+            delete static_cast<const ObjArray*>(object);
+            break;
+        case ObjectType::STRING:
+            delete static_cast<const ObjString*>(object);
+            break;
+        case ObjectType::HASH_TABLE:
+            delete static_cast<const ObjHashTable*>(object);
+            break;
+        case ObjectType::INSTANCE:
+            delete static_cast<const ObjInstance*>(object);
+            break;
+        case ObjectType::CLASS:
+            delete static_cast<const ObjClass*>(object);
+            break;
+        case ObjectType::BOUND_METHOD:
+            delete static_cast<const ObjBoundMethod*>(object);
+            break;
+        case ObjectType::UPVALUE:
+            delete static_cast<const ObjUpvalue*>(object);
+            break;
+        case ObjectType::PROTO:
+            delete static_cast<const ObjFunctionProto*>(object);
+            break;
+        case ObjectType::FUNCTION:
+            delete static_cast<const ObjClosure*>(object);
+            break;
+        case ObjectType::NATIVE_FN:
+            delete static_cast<const ObjNativeFunction*>(object);
+            break;
+        case ObjectType::MODULE:
+            delete static_cast<const ObjModule*>(object);
+            break;
+    }
+}
+}  // namespace meow::core
@@ -0,0 +1,499 @@
+#include "jit/baseline_jit.h"
+#include "core/objects/function.h"
+#include "core/superinstructions.h"
+#include "core/value.h"
+#include "jit/stencil_jit.h"
+#include "jit/value_layout.h"
+#include "jit/x64_assembler.h"
+#include "runtime/bytecode.h"
+
+namespace meow::jit {
+using namespace meow::core;
+using namespace meow::runtime;
+
+JitOptions JitOptions::from_environment() noexcept {
+    JitOptions options;
+#ifdef MEOW_PROFILE_OPCODES
+    // Profile phải thấy mọi opcode được dispatch
+    options.enabled = false;
+#endif
+    const char* disable = std::getenv("MEOW_NO_JIT");
+    if (disable != nullptr && *disable != '\0' && std::string_view(disable) != "0") options.enabled = false;
+    const char* backend = std::getenv("MEOW_JIT_BACKEND");
+    if (backend != nullptr && std::string_view(backend) == "stencils") options.backend = JitBackend::STENCILS;
+    const char* threshold = std::getenv("MEOW_JIT_THRESHOLD");
+    if (threshold != nullptr && *threshold != '\0') {
+        unsigned long value = std::strtoul(threshold, nullptr, 10);
+        if (value > 0 && value <= std::numeric_limits<uint32_t>::max()) options.threshold = static_cast<uint32_t>(value);
+    }
+    const char* osr_threshold = std::getenv("MEOW_OSR_THRESHOLD");
+    if (osr_threshold != nullptr && *osr_threshold != '\0') {
+        unsigned long value = std::strtoul(osr_threshold, nullptr, 10);
+        if (value > 0 && value <= std::numeric_limits<uint32_t>::max()) options.osr_threshold = static_cast<uint32_t>(value);
+    }
+    const char* no_trace = std::getenv("MEOW_NO_TRACE");
+    if (no_trace != nullptr && *no_trace != '\0' && std::string_view(no_trace) != "0") options.tracing = false;
+    const char* trace_threshold = std::getenv("MEOW_TRACE_THRESHOLD");
+    if (trace_threshold != nullptr && *trace_threshold != '\0') {
+        unsigned long value = std::strtoul(trace_threshold, nullptr, 10);
+        // Bộ đếm của từng vòng lặp là uint16_t, giá trị lớn nhất dành cho đánh dấu bỏ qua
+        if (value > 0 && value < std::numeric_limits<uint16_t>::max()) options.trace_threshold = static_cast<uint32_t>(value);
+    }
+    return options;
+}
+
+uint32_t back_edge_target(const uint8_t* code, size_t pc) noexcept {
+    Instruction instruction = decode_instruction(code, pc);
+    switch (superinstruction_head(instruction.op())) {
+        case OpCode::JUMP:
+        case OpCode::FOR_LOOP:
+        case OpCode::JUMP_IF_FALSE:
+        case OpCode::JUMP_IF_TRUE:
+        case OpCode::JUMP_IF_EQ:
+        case OpCode::JUMP_IF_NEQ:
+        case OpCode::JUMP_IF_LT:
+        case OpCode::JUMP_IF_LE:
+        case OpCode::JUMP_IF_NOT_LT:
+        case OpCode::JUMP_IF_NOT_LE:
+            break;
+        default:
+            return CompiledCode::NO_ENTRY;
+    }
+    uint32_t target = instruction.address();
+    return target < pc ? target : CompiledCode::NO_ENTRY;
+}
+
+bool is_callout_opcode(OpCode op) noexcept {
+    switch (op) {
+        case OpCode::GET_GLOBAL:
+        case OpCode::SET_GLOBAL:
+        case OpCode::GET_UPVALUE:
+        case OpCode::SET_UPVALUE:
+        case OpCode::CLOSURE:
+        case OpCode::CLOSE_UPVALUES:
+        case OpCode::NEW_ARRAY:
+        case OpCode::NEW_HASH:
+        case OpCode::GET_INDEX:
+        case OpCode::SET_INDEX:
+        case OpCode::GET_KEYS:
+        case OpCode::GET_VALUES:
+        case OpCode::NEW_CLASS:
+        case OpCode::NEW_INSTANCE:
+        case OpCode::GET_PROP:
+        case OpCode::SET_PROP:
+        case OpCode::SET_METHOD:
+        case OpCode::INHERIT:
+        case OpCode::GET_SUPER:
+        case OpCode::EXPORT:
+        case OpCode::GET_EXPORT:
+        case OpCode::IMPORT_ALL:
+        case OpCode::ITER_NEW:
+            return true;
+        default:
+            return false;
+    }
+}
+
+#if MEOW_JIT_X64
+namespace {
+/// @brief One proto's bytecode to x86-64. `rdi` holds R0 of the frame for the whole run
+class Translator {
+public:
+    Translator(const ValueLayout& layout, proto_t proto, void* context, BaselineJit::CalloutFn callout, const uint8_t* loop_flags) noexcept
+        : layout_(layout),
+          chunk_(proto->get_chunk()),
+          code_(chunk_.get_code()),
+          size_(chunk_.get_code_size()),
+          num_registers_(proto->get_num_registers()),
+          context_(context),
+          callout_(callout),
+          loop_flags_(loop_flags) {
+    }
+
+    bool translate(std::vector<uint8_t>& out, std::vector<uint32_t>& entries) {
+        std::vector<size_t> offsets;
+        if (!decode_instructions(code_, size_, offsets) || size_ >= PENDING_ERROR) return false;
+        index_of_.assign(size_ + 1, NO_OFFSET);
+        for (size_t i = 0; i < offsets.size(); ++i) index_of_[offsets[i]] = static_cast<uint32_t>(i);
+        index_of_[size_] = static_cast<uint32_t>(offsets.size());
+        for (size_t i = 0; i <= offsets.size(); ++i) labels_.push_back(a_.new_label());
+
+        entries.assign(size_, CompiledCode::NO_ENTRY);
+        for (size_t i = 0; i < offsets.size(); ++i) {
+            uint32_t pc = static_cast<uint32_t>(offsets[i]);
+            a_.bind(labels_[i]);
+            size_t start = a_.offset();
+            next_ = labels_[i + 1];
+            check_trace(pc);
+            switch (emit(pc)) {
+                case Result::NATIVE:
+                    entries[pc] = static_cast<uint32_t>(start);
+                    break;
+                case Result::LEAVE:
+                    // Lệnh để lại cho interpreter: code khác nhảy tới đây thì trả về ngay
+                    leave(pc);
+                    break;
+                case Result::FAIL:
+                    return false;
+            }
+        }
+        // Chạy quá lệnh cuối: interpreter tự return ngầm định
+        a_.bind(labels_[offsets.size()]);
+        leave(static_cast<uint32_t>(size_));
+
+        for (const Exit& exit : exits_) {
+            a_.bind(exit.label);
+            leave(exit.result);
+        }
+        return a_.finish(out);
+    }
+
+private:
+    enum class Result { NATIVE, LEAVE, FAIL };
+
+    struct Exit {
+        Label label;
+        uint32_t result;
+    };
+
+    const ValueLayout& layout_;
+    const Chunk& chunk_;
+    const uint8_t* code_;
+    size_t size_;
+    size_t num_registers_;
+    void* context_;
+    BaselineJit::CalloutFn callout_;
+    const uint8_t* loop_flags_;
+
+    X64Assembler a_;
+    std::vector<uint32_t> index_of_;  ///< Bytecode offset -> instruction index
+    std::vector<Label> labels_;       ///< Per instruction, plus one for the end of the chunk
+    std::vector<Exit> exits_;         ///< Cold stubs, emitted after the body
+    Label next_{};                    ///< Instruction after the one being emitted
+
+    static Mem bits(uint32_t reg) noexcept {
+        return {Reg::RDI, static_cast<int32_t>(reg) * VALUE_SIZE};
+    }
+    static Mem index(uint32_t reg) noexcept {
+        return {Reg::RDI, static_cast<int32_t>(reg) * VALUE_SIZE + INDEX_OFFSET};
+    }
+    uint16_t operand(uint32_t pc, size_t i) const noexcept {
+        return decode_instruction(code_, pc).operand(i);
+    }
+    bool registers_fit(uint32_t first, uint32_t count) const noexcept {
+        return first + count <= num_registers_;
+    }
+    /// @brief Label of the jump target of the instruction at `pc`
+    bool target(uint32_t pc, Label& out) const noexcept {
+        uint32_t offset = decode_instruction(code_, pc).address();
+        if (offset > size_ || index_of_[offset] == NO_OFFSET) return false;
+        out = labels_[index_of_[offset]];
+        return true;
+    }
+
+    void leave(uint32_t result) {
+        a_.mov(Reg::RAX, uint64_t{result});
+        a_.ret();
+    }
+    /// @brief Stub returning to the interpreter at `pc`, before the instruction has any effect
+    Label side_exit(uint32_t pc, uint32_t flags = 0) {
+        Label label = a_.new_label();
+        exits_.push_back({label, pc | flags});
+        return label;
+    }
+
+    // Vòng lặp đã có trace thì về interpreter ngay trước cạnh quay lại, để nó chạy trace
+    void check_trace(uint32_t pc) {
+        if (loop_flags_ == nullptr) return;
+        uint32_t header = back_edge_target(code_, pc);
+        if (header == CompiledCode::NO_ENTRY) return;
+        a_.mov(Reg::RAX, reinterpret_cast<uint64_t>(loop_flags_ + header));
+        a_.cmp8(Mem{Reg::RAX, 0}, 0);
+        a_.j(Cond::NE, side_exit(pc));
+    }
+
+    void store(uint16_t dst, ValueBits value) {
+        a_.mov(Reg::RAX, value.bits);
+        a_.mov(bits(dst), Reg::RAX);
+        a_.mov8(index(dst), value.index);
+    }
+    void guard(uint16_t reg, uint8_t type_index, Label fail) {
+        a_.cmp8(index(reg), type_index);
+        a_.j(Cond::NE, fail);
+    }
+    /// @brief Sign-extended 48-bit payload of an int register
+    void load_int(Reg out, uint16_t reg) {
+        a_.mov(out, bits(reg));
+        a_.shl(out, 16);
+        a_.sar(out, 16);
+    }
+    /// @brief Boxes the low 48 bits of `value` like Value(int_t). Clobbers rcx
+    void store_int(uint16_t dst, Reg value) {
+        a_.shl(value, 16);
+        a_.shr(value, 16);
+        a_.mov(Reg::RCX, layout_.int_tag);
+        a_.or_(value, Reg::RCX);
+        a_.mov(bits(dst), value);
+        a_.mov8(index(dst), layout_.int_index);
+    }
+    /// @brief Boxes xmm0 like Value(float_t): every NaN becomes the canonical one. Clobbers rax
+    void store_float(uint16_t dst) {
+        Label nan = a_.new_label();
+        Label done = a_.new_label();
+        a_.ucomisd(Xmm::XMM0, Xmm::XMM0);
+        a_.j(Cond::P, nan);
+        a_.movq(Reg::RAX, Xmm::XMM0);
+        a_.jmp(done);
+        a_.bind(nan);
+        a_.mov(Reg::RAX, layout_.nan_bits);
+        a_.bind(done);
+        a_.mov(bits(dst), Reg::RAX);
+        a_.mov8(index(dst), layout_.float_index);
+    }
+
+    Result emit(uint32_t pc) {
+        OpCode op = superinstruction_head(decode_instruction(code_, pc).op());
+        if (is_callout_opcode(op)) return emit_callout(pc);
+        switch (op) {
+            case OpCode::LOAD_NULL:
+            case OpCode::LOAD_TRUE:
+            case OpCode::LOAD_FALSE:
+            case OpCode::LOAD_INT:
+            case OpCode::LOAD_SMALLINT:
+            case OpCode::LOAD_FLOAT:
+            case OpCode::LOAD_CONST:
+                return emit_load(pc);
+            case OpCode::MOVE: {
+                uint16_t dst = operand(pc, 0), src = operand(pc, 1);
+                if (!registers_fit(dst, 1) || !registers_fit(src, 1)) return Result::FAIL;
+                a_.mov(Reg::RAX, bits(src));
+                a_.mov(Reg::RCX, index(src));
+                a_.mov(bits(dst), Reg::RAX);
+                a_.mov(index(dst), Reg::RCX);
+                return Result::NATIVE;
+            }
+            case OpCode::ADD:
+                return emit_add(pc);
+            case OpCode::JUMP: {
+                Label to;
+                if (!target(pc, to)) return Result::FAIL;
+                a_.jmp(to);
+                return Result::NATIVE;
+            }
+            case OpCode::JUMP_IF_FALSE:
+            case OpCode::JUMP_IF_TRUE:
+                return emit_truthy_jump(pc, op == OpCode::JUMP_IF_TRUE);
+            case OpCode::JUMP_IF_EQ:
+            case OpCode::JUMP_IF_NEQ:
+            case OpCode::JUMP_IF_LT:
+            case OpCode::JUMP_IF_LE:
+            case OpCode::JUMP_IF_NOT_LT:
+            case OpCode::JUMP_IF_NOT_LE:
+                return emit_compare_jump(pc, op);
+            case OpCode::FOR_LOOP:
+                return emit_for_loop(pc);
+            default:
+                return Result::LEAVE;
+        }
+    }
+
+    Result emit_load(uint32_t pc) {
+        uint16_t dst = operand(pc, 0);
+        std::optional<ValueBits> value = loaded_value(chunk_, pc);
+        if (!registers_fit(dst, 1) || !value) return Result::FAIL;
+        store(dst, *value);
+        return Result::NATIVE;
+    }
+
+    // Chỉ có những nhánh nhanh mà dispatcher của interpreter có: int + int và float + float
+    Result emit_add(uint32_t pc) {
+        uint16_t dst = operand(pc, 0), lhs = operand(pc, 1), rhs = operand(pc, 2);
+        if (!registers_fit(dst, 1) || !registers_fit(lhs, 1) || !registers_fit(rhs, 1)) return Result::FAIL;
+        Label exit = side_exit(pc);
+        Label not_int = a_.new_label();
+        Label done = a_.new_label();
+        guard(lhs, layout_.int_index, not_int);
+        guard(rhs, layout_.int_index, not_int);
+        a_.mov(Reg::RAX, bits(lhs));
+        a_.mov(Reg::RCX, bits(rhs));
+        a_.add(Reg::RAX, Reg::RCX);
+        store_int(dst, Reg::RAX);
+        a_.jmp(done);
+        a_.bind(not_int);
+        guard(lhs, layout_.float_index, exit);
+        guard(rhs, layout_.float_index, exit);
+        a_.movsd(Xmm::XMM0, bits(lhs));
+        a_.addsd(Xmm::XMM0, bits(rhs));
+        store_float(dst);
+        a_.bind(done);
+        return Result::NATIVE;
+    }
+
+    // Giống is_truthy cho null, bool và int; kiểu khác quay về interpreter
+    Result emit_truthy_jump(uint32_t pc, bool jump_if_true) {
+        uint16_t reg = operand(pc, 0);
+        Label to;
+        if (!registers_fit(reg, 1) || !target(pc, to)) return Result::FAIL;
+        Label exit = side_exit(pc);
+        Label not_bool = a_.new_label();
+        Label not_null = a_.new_label();
+        Cond taken = jump_if_true ? Cond::NE : Cond::E;
+
+        guard(reg, layout_.false_.index, not_bool);
+        a_.test8(bits(reg), 1);
+        a_.j(taken, to);
+        a_.jmp(next_);
+
+        a_.bind(not_bool);
+        guard(reg, layout_.null.index, not_null);
+        a_.jmp(jump_if_true ? next_ : to);
+
+        a_.bind(not_null);
+        guard(reg, layout_.int_index, exit);
+        a_.mov(Reg::RAX, bits(reg));
+        a_.shl(Reg::RAX, 16);
+        a_.test(Reg::RAX, Reg::RAX);
+        a_.j(taken, to);
+        return Result::NATIVE;
+    }
+
+    // Cùng quy tắc với COMPARE_JUMP_HANDLER: int với int, float với float, còn lại để dispatcher của interpreter lo
+    Result emit_compare_jump(uint32_t pc, OpCode op) {
+        uint16_t lhs = operand(pc, 0), rhs = operand(pc, 1);
+        Label to;
+        if (!registers_fit(lhs, 1) || !registers_fit(rhs, 1) || !target(pc, to)) return Result::FAIL;
+        bool equality = op == OpCode::JUMP_IF_EQ || op == OpCode::JUMP_IF_NEQ;
+        bool jump_when = op == OpCode::JUMP_IF_EQ || op == OpCode::JUMP_IF_LT || op == OpCode::JUMP_IF_LE;
+        bool inclusive = op == OpCode::JUMP_IF_LE || op == OpCode::JUMP_IF_NOT_LE;
+        Label exit = side_exit(pc);
+        Label not_int = a_.new_label();
+
+        guard(lhs, layout_.int_index, not_int);
+        guard(rhs, layout_.int_index, not_int);
+        load_int(Reg::RAX, lhs);
+        load_int(Reg::RCX, rhs);
+        a_.cmp(Reg::RAX, Reg::RCX);
+        Cond cond = equality ? Cond::E : (inclusive ? Cond::LE : Cond::L);
+        a_.j(jump_when ? cond : invert(cond), to);
+        a_.jmp(next_);
+
+        a_.bind(not_int);
+        guard(lhs, layout_.float_index, exit);
+        guard(rhs, layout_.float_index, exit);
+        a_.movsd(Xmm::XMM0, bits(lhs));
+        a_.movsd(Xmm::XMM1, bits(rhs));
+        if (equality) {
+            // Bằng nhau khi ZF = 1 và không có NaN (PF = 0)
+            a_.ucomisd(Xmm::XMM0, Xmm::XMM1);
+            if (jump_when) {
+                a_.j(Cond::P, next_);
+                a_.j(Cond::E, to);
+            } else {
+                a_.j(Cond::P, to);
+                a_.j(Cond::NE, to);
+            }
+            return Result::NATIVE;
+        }
+        // lhs < rhs <=> rhs "above" lhs; NaN bật CF nên mọi phép so sánh đều sai, và phủ định thì đúng
+        a_.ucomisd(Xmm::XMM1, Xmm::XMM0);
+        cond = inclusive ? Cond::AE : Cond::A;
+        a_.j(jump_when ? cond : invert(cond), to);
+        return Result::NATIVE;
+    }
+
+    // Nhánh int của op_for_loop; vòng lặp float quay về interpreter
+    Result emit_for_loop(uint32_t pc) {
+        uint16_t base = operand(pc, 0);
+        Label body;
+        if (!registers_fit(base, 4) || !target(pc, body)) return Result::FAIL;
+        Label exit = side_exit(pc);
+        Label negative = a_.new_label();
+        Label compare = a_.new_label();
+
+        // Thân vòng lặp có thể ghi đè giới hạn/bước nhảy: sai kiểu thì interpreter báo lỗi
+        guard(base, layout_.int_index, exit);
+        guard(base + 1, layout_.int_index, exit);
+        guard(base + 2, layout_.int_index, exit);
+        load_int(Reg::RAX, base);
+        load_int(Reg::RCX, base + 1);
+        load_int(Reg::RDX, base + 2);
+        // Chỉ số đã vượt giới hạn (thân vòng lặp hạ giới hạn) thì thoát; còn lại tính khoảng còn lại và độ dài bước
+        // bằng unsigned, như interpreter, để i + s không tràn
+        a_.test(Reg::RDX, Reg::RDX);
+        a_.j(Cond::LE, negative);
+        a_.cmp(Reg::RAX, Reg::RCX);
+        a_.j(Cond::G, next_);
+        a_.mov(Reg::R8, Reg::RCX);
+        a_.sub(Reg::R8, Reg::RAX);
+        a_.mov(Reg::R9, Reg::RDX);
+        a_.jmp(compare);
+        a_.bind(negative);
+        a_.cmp(Reg::RAX, Reg::RCX);
+        a_.j(Cond::L, next_);
+        a_.mov(Reg::R8, Reg::RAX);
+        a_.sub(Reg::R8, Reg::RCX);
+        a_.mov(Reg::R9, Reg::RDX);
+        a_.neg(Reg::R9);
+        a_.bind(compare);
+        a_.cmp(Reg::R8, Reg::R9);
+        a_.j(Cond::B, next_);
+
+        a_.add(Reg::RAX, Reg::RDX);
+        store_int(base, Reg::RAX);
+        a_.mov(bits(base + 3), Reg::RAX);
+        a_.mov8(index(base + 3), layout_.int_index);
+        a_.jmp(body);
+        return Result::NATIVE;
+    }
+
+    // Stack đang lệch 8 byte (địa chỉ trả về), trừ thêm 8 cho đúng căn lề 16 của System V
+    Result emit_callout(uint32_t pc) {
+        Label error = side_exit(pc, PENDING_ERROR);
+        a_.add_rsp(-8);
+        a_.mov(Reg::RDI, reinterpret_cast<uint64_t>(context_));
+        a_.mov(Reg::RSI, uint64_t{pc});
+        a_.mov(Reg::RAX, reinterpret_cast<uint64_t>(callout_));
+        a_.call(Reg::RAX);
+        a_.add_rsp(8);
+        a_.test(Reg::RAX, Reg::RAX);
+        a_.j(Cond::E, error);
+        a_.mov(Reg::RDI, Reg::RAX);
+        return Result::NATIVE;
+    }
+};
+}  // namespace
+#endif
+
+std::unique_ptr<BaselineJit> BaselineJit::create(const JitOptions& options, void* context, CalloutFn callout) {
+    if (!options.enabled || !probe_layout()) return nullptr;
+    bool assembler = MEOW_JIT_X64 != 0;
+    bool stencils = stencils_available();
+    if (!assembler && !stencils) return nullptr;
+    JitBackend backend = options.backend;
+    if (backend == JitBackend::ASSEMBLER && !assembler) backend = JitBackend::STENCILS;
+    if (backend == JitBackend::STENCILS && !stencils) backend = JitBackend::ASSEMBLER;
+    return std::make_unique<BaselineJit>(options, backend, context, callout);
+}
+
+const CompiledCode* BaselineJit::compile(proto_t proto, const uint8_t* loop_flags) {
+    if (proto->get_jit_code() != nullptr) return proto->get_jit_code();
+    static const std::optional<ValueLayout> layout = probe_layout();
+    if (!layout) return nullptr;
+    std::vector<uint8_t> machine_code;
+    std::vector<uint32_t> entries;
+    bool translated = false;
+    if (backend_ == JitBackend::STENCILS) {
+        translated = translate_stencils(*layout, proto, context_, callout_, loop_flags, machine_code, entries);
+    } else {
+#if MEOW_JIT_X64
+        translated = Translator(*layout, proto, context_, callout_, loop_flags).translate(machine_code, entries);
+#endif
+    }
+    if (!translated) return nullptr;
+    std::optional<CodeMemory> memory = CodeMemory::map(machine_code);
+    if (!memory) return nullptr;
+    compiled_.push_back(std::make_unique<CompiledCode>(std::move(*memory), std::move(entries)));
+    proto->set_jit_code(compiled_.back().get());
+    return compiled_.back().get();
+}
+}  // namespace meow::jit
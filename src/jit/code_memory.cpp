@@ -0,0 +1,54 @@
+#include "jit/code_memory.h"
+
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define MEOW_HAS_MMAP 1
+#else
+#define MEOW_HAS_MMAP 0
+#endif
+
+namespace meow::jit {
+
+CodeMemory::CodeMemory(CodeMemory&& other) noexcept : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {
+}
+
+CodeMemory& CodeMemory::operator=(CodeMemory&& other) noexcept {
+    if (this != &other) {
+        CodeMemory old(std::move(*this));
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+CodeMemory::~CodeMemory() noexcept {
+#if MEOW_HAS_MMAP
+    if (data_ != nullptr) munmap(data_, size_);
+#endif
+}
+
+std::optional<CodeMemory> CodeMemory::map(const std::vector<uint8_t>& code) noexcept {
+#if MEOW_HAS_MMAP
+    if (code.empty()) return std::nullopt;
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t size = (code.size() + page - 1) / page * page;
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) return std::nullopt;
+    std::memcpy(memory, code.data(), code.size());
+    // AArch64 không tự đồng bộ instruction cache với dữ liệu vừa ghi; trên x86-64 lệnh này không làm gì
+    __builtin___clear_cache(static_cast<char*>(memory), static_cast<char*>(memory) + code.size());
+    // Ghi xong mới cho chạy, và từ đây không ghi được nữa
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, size);
+        return std::nullopt;
+    }
+    return CodeMemory(static_cast<uint8_t*>(memory), size);
+#else
+    (void)code;
+    return std::nullopt;
+#endif
+}
+}  // namespace meow::jit
@@ -0,0 +1,340 @@
+#include "jit/stencil_jit.h"
+#include "core/objects/function.h"
+#include "core/superinstructions.h"
+#include "core/value.h"
+#include "runtime/bytecode.h"
+
+#ifdef MEOW_HAVE_STENCILS
+// Sinh lúc build bởi scripts/gen_stencils.py, xem MEOW_STENCIL_JIT trong CMakeLists.txt
+#include "jit/stencils.inc"
+#endif
+
+#if defined(MEOW_HAVE_STENCILS) && (defined(__unix__) || defined(__APPLE__)) && MEOW_CAN_USE_NAN_BOXING && \
+    ((defined(MEOW_STENCILS_X64) && defined(__x86_64__)) || (defined(MEOW_STENCILS_ARM64) && defined(__aarch64__)))
+#define MEOW_JIT_STENCILS 1
+#else
+#define MEOW_JIT_STENCILS 0
+#endif
+
+namespace meow::jit {
+using namespace meow::core;
+using namespace meow::runtime;
+
+bool stencils_available() noexcept {
+    return MEOW_JIT_STENCILS != 0;
+}
+
+#if MEOW_JIT_STENCILS
+namespace {
+/// @brief One instruction's copy: which stencil, and what its holes are patched to
+struct Piece {
+    const Stencil* stencil;
+    uint32_t pc;
+    bool native;             ///< Entry point for the interpreter; false for LEAVE
+    uint64_t a = 0, b = 0, c = 0;
+    const uint8_t* flag = nullptr;
+    ValueBits value{};
+    uint32_t jump = NO_OFFSET;  ///< Instruction index of the branch target
+    size_t at = 0;              ///< Offset of the copy in the code
+};
+
+class StencilTranslator {
+public:
+    StencilTranslator(const ValueLayout& layout, proto_t proto, void* context, BaselineJit::CalloutFn callout, const uint8_t* loop_flags) noexcept
+        : layout_(layout),
+          chunk_(proto->get_chunk()),
+          code_(chunk_.get_code()),
+          size_(chunk_.get_code_size()),
+          num_registers_(proto->get_num_registers()),
+          context_(context),
+          callout_(callout),
+          loop_flags_(loop_flags) {
+    }
+
+    bool translate(std::vector<uint8_t>& out, std::vector<uint32_t>& entries) {
+        std::vector<size_t> offsets;
+        if (!decode_instructions(code_, size_, offsets) || size_ >= PENDING_ERROR) return false;
+        index_of_.assign(size_ + 1, NO_OFFSET);
+        for (size_t i = 0; i < offsets.size(); ++i) index_of_[offsets[i]] = static_cast<uint32_t>(i);
+        index_of_[size_] = static_cast<uint32_t>(offsets.size());
+
+        for (size_t offset : offsets) {
+            uint32_t pc = static_cast<uint32_t>(offset);
+            first_piece_.push_back(pieces_.size());
+            uint32_t header = loop_flags_ != nullptr ? back_edge_target(code_, pc) : CompiledCode::NO_ENTRY;
+            if (header != CompiledCode::NO_ENTRY) {
+                Piece check{&stencils::LOOP_CHECK, pc, true};
+                check.flag = loop_flags_ + header;
+                pieces_.push_back(check);
+            }
+            pieces_.push_back({});
+            if (!select(pc, pieces_.back())) return false;
+        }
+        // Chạy quá lệnh cuối: interpreter tự return ngầm định
+        first_piece_.push_back(pieces_.size());
+        pieces_.push_back({&stencils::LEAVE, static_cast<uint32_t>(size_), false});
+
+        // Copy trước để biết vị trí từng lệnh, vá sau vì CONTINUE/JUMP có thể trỏ tới lệnh phía sau
+        entries.assign(size_, CompiledCode::NO_ENTRY);
+        for (Piece& piece : pieces_) {
+            piece.at = out.size();
+            out.insert(out.end(), piece.stencil->code, piece.stencil->code + piece.stencil->size);
+            if (piece.native && entries[piece.pc] == CompiledCode::NO_ENTRY) entries[piece.pc] = static_cast<uint32_t>(piece.at);
+        }
+        for (size_t i = 0; i < pieces_.size(); ++i) {
+            const Stencil& stencil = *pieces_[i].stencil;
+            for (uint32_t r = 0; r < stencil.reloc_count; ++r) {
+                if (!patch(out, i, stencil.relocs[r])) return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    const ValueLayout& layout_;
+    const Chunk& chunk_;
+    const uint8_t* code_;
+    size_t size_;
+    size_t num_registers_;
+    void* context_;
+    BaselineJit::CalloutFn callout_;
+    const uint8_t* loop_flags_;
+
+    std::vector<uint32_t> index_of_;     ///< Bytecode offset -> instruction index
+    std::vector<Piece> pieces_;          ///< Per instruction (two before a back-edge), plus the LEAVE at the end of the chunk
+    std::vector<size_t> first_piece_;    ///< Instruction index -> its first piece
+    std::vector<std::pair<uint64_t, size_t>> veneers_;  ///< Branch target outside the code -> its veneer
+
+    uint16_t operand(uint32_t pc, size_t i) const noexcept {
+        return decode_instruction(code_, pc).operand(i);
+    }
+    bool registers_fit(uint32_t first, uint32_t count) const noexcept {
+        return first + count <= num_registers_;
+    }
+    static uint64_t slot(uint16_t reg) noexcept {
+        return uint64_t{reg} * VALUE_SIZE;
+    }
+    /// @brief Instruction index of the jump target of the instruction at `pc`
+    bool target(uint32_t pc, uint32_t& out) const noexcept {
+        uint32_t offset = decode_instruction(code_, pc).address();
+        if (offset > size_ || index_of_[offset] == NO_OFFSET) return false;
+        out = index_of_[offset];
+        return true;
+    }
+
+    // Cùng tập lệnh với baseline x86-64: lệnh nào không có stencil thì để lại cho interpreter
+    bool select(uint32_t pc, Piece& piece) const {
+        piece.pc = pc;
+        piece.native = true;
+        OpCode op = superinstruction_head(decode_instruction(code_, pc).op());
+        if (is_callout_opcode(op)) {
+            piece.stencil = &stencils::CALLOUT;
+            return true;
+        }
+        switch (op) {
+            case OpCode::LOAD_NULL:
+            case OpCode::LOAD_TRUE:
+            case OpCode::LOAD_FALSE:
+            case OpCode::LOAD_INT:
+            case OpCode::LOAD_SMALLINT:
+            case OpCode::LOAD_FLOAT:
+            case OpCode::LOAD_CONST: {
+                std::optional<ValueBits> value = loaded_value(chunk_, pc);
+                if (!registers_fit(operand(pc, 0), 1) || !value) return false;
+                piece.stencil = &stencils::LOAD;
+                piece.a = slot(operand(pc, 0));
+                piece.value = *value;
+                return true;
+            }
+            case OpCode::MOVE:
+                if (!registers_fit(operand(pc, 0), 1) || !registers_fit(operand(pc, 1), 1)) return false;
+                piece.stencil = &stencils::MOVE;
+                piece.a = slot(operand(pc, 0));
+                piece.b = slot(operand(pc, 1));
+                return true;
+            case OpCode::ADD:
+                for (size_t i = 0; i < 3; ++i) {
+                    if (!registers_fit(operand(pc, i), 1)) return false;
+                }
+                piece.stencil = &stencils::ADD;
+                piece.a = slot(operand(pc, 0));
+                piece.b = slot(operand(pc, 1));
+                piece.c = slot(operand(pc, 2));
+                return true;
+            case OpCode::JUMP:
+                piece.stencil = &stencils::JUMP;
+                return target(pc, piece.jump);
+            case OpCode::JUMP_IF_FALSE:
+            case OpCode::JUMP_IF_TRUE:
+                if (!registers_fit(operand(pc, 0), 1)) return false;
+                piece.stencil = op == OpCode::JUMP_IF_TRUE ? &stencils::JUMP_IF_TRUE : &stencils::JUMP_IF_FALSE;
+                piece.a = slot(operand(pc, 0));
+                return target(pc, piece.jump);
+            case OpCode::JUMP_IF_EQ:
+            case OpCode::JUMP_IF_NEQ:
+            case OpCode::JUMP_IF_LT:
+            case OpCode::JUMP_IF_LE:
+            case OpCode::JUMP_IF_NOT_LT:
+            case OpCode::JUMP_IF_NOT_LE:
+                if (!registers_fit(operand(pc, 0), 1) || !registers_fit(operand(pc, 1), 1)) return false;
+                piece.stencil = compare_stencil(op);
+                piece.a = slot(operand(pc, 0));
+                piece.b = slot(operand(pc, 1));
+                return target(pc, piece.jump);
+            case OpCode::FOR_LOOP:
+                if (!registers_fit(operand(pc, 0), 4)) return false;
+                piece.stencil = &stencils::FOR_LOOP;
+                piece.a = slot(operand(pc, 0));
+                return target(pc, piece.jump);
+            default:
+                piece.stencil = &stencils::LEAVE;
+                piece.native = false;
+                return true;
+        }
+    }
+
+    static const Stencil* compare_stencil(OpCode op) noexcept {
+        switch (op) {
+            case OpCode::JUMP_IF_EQ:
+                return &stencils::JUMP_IF_EQ;
+            case OpCode::JUMP_IF_NEQ:
+                return &stencils::JUMP_IF_NEQ;
+            case OpCode::JUMP_IF_LT:
+                return &stencils::JUMP_IF_LT;
+            case OpCode::JUMP_IF_LE:
+                return &stencils::JUMP_IF_LE;
+            case OpCode::JUMP_IF_NOT_LT:
+                return &stencils::JUMP_IF_NOT_LT;
+            default:
+                return &stencils::JUMP_IF_NOT_LE;
+        }
+    }
+
+    uint64_t value_of(const Piece& piece, Hole hole) const noexcept {
+        switch (hole) {
+            case Hole::A:
+                return piece.a;
+            case Hole::B:
+                return piece.b;
+            case Hole::C:
+                return piece.c;
+            case Hole::PC:
+                return piece.pc;
+            case Hole::BITS:
+                return piece.value.bits;
+            case Hole::INDEX:
+                return piece.value.index;
+            case Hole::NULL_INDEX:
+                return layout_.null.index;
+            case Hole::BOOL_INDEX:
+                return layout_.false_.index;
+            case Hole::INT_INDEX:
+                return layout_.int_index;
+            case Hole::FLOAT_INDEX:
+                return layout_.float_index;
+            case Hole::INT_TAG:
+                return layout_.int_tag;
+            case Hole::NAN_BITS:
+                return layout_.nan_bits;
+            case Hole::CONTEXT:
+                return reinterpret_cast<uint64_t>(context_);
+            case Hole::CALLOUT:
+                return reinterpret_cast<uint64_t>(callout_);
+            case Hole::FLAG:
+                return reinterpret_cast<uint64_t>(piece.flag);
+            default:
+                return 0;
+        }
+    }
+
+    /// @brief Offset in the code a branch to `hole` lands on: the next instruction, the branch target, or a
+    /// veneer jumping to an absolute address out of reach of the branch
+    size_t branch_target(std::vector<uint8_t>& out, size_t index, Hole hole) {
+        if (hole == Hole::CONTINUE) return pieces_[index + 1].at;
+        if (hole == Hole::JUMP) return pieces_[first_piece_[pieces_[index].jump]].at;
+        uint64_t address = value_of(pieces_[index], hole);
+        for (const auto& [to, at] : veneers_) {
+            if (to == address) return at;
+        }
+        size_t at = out.size();
+#if defined(MEOW_STENCILS_X64)
+        // jmp [rip + 0], địa chỉ 8 byte ngay sau
+        out.insert(out.end(), {0xFF, 0x25, 0x00, 0x00, 0x00, 0x00});
+#else
+        // ldr x16, #8; br x16, địa chỉ 8 byte ngay sau
+        append(out, uint32_t{0x58000050});
+        append(out, uint32_t{0xD61F0200});
+#endif
+        append(out, address);
+        veneers_.push_back({address, at});
+        return at;
+    }
+
+    template <typename T>
+    static void append(std::vector<uint8_t>& out, T value) {
+        for (size_t i = 0; i < sizeof(T); ++i) out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+    template <typename T>
+    static T read(const std::vector<uint8_t>& out, size_t at) noexcept {
+        T value = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) value |= static_cast<T>(out[at + i]) << (8 * i);
+        return value;
+    }
+    template <typename T>
+    static void write(std::vector<uint8_t>& out, size_t at, T value) noexcept {
+        for (size_t i = 0; i < sizeof(T); ++i) out[at + i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+
+    bool patch(std::vector<uint8_t>& out, size_t index, const StencilReloc& reloc) {
+        const Piece& piece = pieces_[index];
+        size_t place = piece.at + reloc.offset;
+        switch (reloc.kind) {
+            case RelocKind::ABS64:
+                write(out, place, value_of(piece, reloc.hole) + static_cast<uint64_t>(reloc.addend));
+                return true;
+            case RelocKind::X64_REL32: {
+                int64_t rel = static_cast<int64_t>(branch_target(out, index, reloc.hole)) + reloc.addend - static_cast<int64_t>(place);
+                if (rel < std::numeric_limits<int32_t>::min() || rel > std::numeric_limits<int32_t>::max()) return false;
+                write(out, place, static_cast<uint32_t>(rel));
+                return true;
+            }
+            case RelocKind::ARM64_BRANCH26: {
+                int64_t rel = static_cast<int64_t>(branch_target(out, index, reloc.hole)) + reloc.addend - static_cast<int64_t>(place);
+                if ((rel & 3) != 0 || rel < -(int64_t{1} << 27) || rel >= (int64_t{1} << 27)) return false;
+                uint32_t insn = read<uint32_t>(out, place);
+                write(out, place, (insn & ~0x03FFFFFFu) | (static_cast<uint32_t>(rel >> 2) & 0x03FFFFFFu));
+                return true;
+            }
+            case RelocKind::ARM64_MOVW0:
+            case RelocKind::ARM64_MOVW1:
+            case RelocKind::ARM64_MOVW2:
+            case RelocKind::ARM64_MOVW3: {
+                unsigned shift = 16 * (static_cast<unsigned>(reloc.kind) - static_cast<unsigned>(RelocKind::ARM64_MOVW0));
+                uint64_t value = value_of(piece, reloc.hole) + static_cast<uint64_t>(reloc.addend);
+                uint32_t insn = read<uint32_t>(out, place);
+                write(out, place, (insn & ~(0xFFFFu << 5)) | (static_cast<uint32_t>((value >> shift) & 0xFFFF) << 5));
+                return true;
+            }
+        }
+        return false;
+    }
+};
+}  // namespace
+#endif
+
+bool translate_stencils(const ValueLayout& layout, proto_t proto, void* context, BaselineJit::CalloutFn callout, const uint8_t* loop_flags,
+                        std::vector<uint8_t>& out, std::vector<uint32_t>& entries) {
+#if MEOW_JIT_STENCILS
+    return StencilTranslator(layout, proto, context, callout, loop_flags).translate(out, entries);
+#else
+    (void)layout;
+    (void)proto;
+    (void)context;
+    (void)callout;
+    (void)loop_flags;
+    (void)out;
+    (void)entries;
+    return false;
+#endif
+}
+}  // namespace meow::jit
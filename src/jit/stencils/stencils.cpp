@@ -0,0 +1,210 @@
+// Stencils of the copy-and-patch JIT backend. This file is NOT part of the VM: the build compiles it on its
+// own (see MEOW_STENCIL_JIT in CMakeLists.txt) and scripts/gen_stencils.py turns the object code into the
+// table src/jit/stencil_jit.cpp copies from.
+//
+// Mỗi stencil là nhánh nhanh của một handler trong src/vm/handlers/*.inl viết lại trên register thô. Toán
+// hạng, hằng số và layout của Value đều là "lỗ" (địa chỉ của symbol meow_hole_*), lệnh kế tiếp và đích nhảy
+// là tail call tới meow_hole_CONTINUE / meow_hole_JUMP. Khi copy, JIT vá các lỗ bằng giá trị thật.
+// Trường hợp nào không xử lý được thì trả về PC để interpreter chạy tiếp đúng lệnh đó, như baseline JIT.
+
+#include "jit/stencil_abi.h"
+
+#include <bit>
+
+namespace meow::jit::stencil {
+/// @brief A register as the stencils see it: the NaN-boxed bits and the type index byte after them
+struct Slot {
+    uint64_t bits;
+    uint8_t index;
+};
+static_assert(sizeof(Slot) == 16, "stencils address registers as 16-byte NaN-boxed values");
+
+using Callout = Slot* (*)(void* context, uint32_t pc) noexcept;
+}  // namespace meow::jit::stencil
+
+using meow::jit::stencil::Slot;
+
+// Mảng không rõ kích thước: với -mcmodel=medium trình biên dịch coi là dữ liệu lớn và nạp địa chỉ bằng một
+// immediate 64 bit (movabs), nên giá trị vá vào nằm ngay trong lệnh
+#define MEOW_DECLARE_VALUE_HOLE(name) extern "C" char meow_hole_##name[];
+MEOW_STENCIL_VALUE_HOLES(MEOW_DECLARE_VALUE_HOLE)
+#undef MEOW_DECLARE_VALUE_HOLE
+
+// Hidden để là jump trực tiếp thay vì đi qua PLT/GOT
+#define MEOW_DECLARE_CODE_HOLE(name) extern "C" __attribute__((visibility("hidden"))) uint32_t meow_hole_##name(Slot* registers);
+MEOW_STENCIL_CODE_HOLES(MEOW_DECLARE_CODE_HOLE)
+#undef MEOW_DECLARE_CODE_HOLE
+
+#define HOLE(name) reinterpret_cast<uint64_t>(meow_hole_##name)
+#define HOLE_INDEX(name) static_cast<uint8_t>(HOLE(name))
+#define REGISTER(name) reinterpret_cast<Slot*>(reinterpret_cast<char*>(registers) + HOLE(name))
+#define LEAVE() return static_cast<uint32_t>(HOLE(PC))
+#define CONTINUE() return meow_hole_CONTINUE(registers)
+#define JUMP() return meow_hole_JUMP(registers)
+
+namespace {
+inline int64_t int_of(const Slot* slot) noexcept {
+    return static_cast<int64_t>(slot->bits << 16) >> 16;
+}
+inline double float_of(const Slot* slot) noexcept {
+    return std::bit_cast<double>(slot->bits);
+}
+inline void store_int(Slot* dst, uint64_t value) noexcept {
+    dst->bits = (value & ((uint64_t{1} << 48) - 1)) | HOLE(INT_TAG);
+    dst->index = HOLE_INDEX(INT_INDEX);
+}
+inline void store_float(Slot* dst, double value) noexcept {
+    dst->bits = value != value ? HOLE(NAN_BITS) : std::bit_cast<uint64_t>(value);
+    dst->index = HOLE_INDEX(FLOAT_INDEX);
+}
+
+enum class Compare { EQ, NEQ, LT, LE, NOT_LT, NOT_LE };
+
+template <typename T>
+inline bool compare(Compare kind, T lhs, T rhs) noexcept {
+    switch (kind) {
+        case Compare::EQ:
+            return lhs == rhs;
+        case Compare::NEQ:
+            return !(lhs == rhs);
+        case Compare::LT:
+            return lhs < rhs;
+        case Compare::LE:
+            return lhs <= rhs;
+        case Compare::NOT_LT:
+            return !(lhs < rhs);
+        case Compare::NOT_LE:
+            return !(lhs <= rhs);
+    }
+    return false;
+}
+
+// Cùng quy tắc với COMPARE_JUMP_HANDLER: int với int, float với float
+template <Compare kind>
+inline uint32_t compare_jump(Slot* registers) noexcept {
+    const Slot* lhs = REGISTER(A);
+    const Slot* rhs = REGISTER(B);
+    bool taken;
+    if (lhs->index == HOLE_INDEX(INT_INDEX) && rhs->index == HOLE_INDEX(INT_INDEX)) {
+        taken = compare(kind, int_of(lhs), int_of(rhs));
+    } else if (lhs->index == HOLE_INDEX(FLOAT_INDEX) && rhs->index == HOLE_INDEX(FLOAT_INDEX)) {
+        taken = compare(kind, float_of(lhs), float_of(rhs));
+    } else {
+        LEAVE();
+    }
+    if (taken) JUMP();
+    CONTINUE();
+}
+
+// Giống is_truthy cho null, bool và int
+template <bool jump_if>
+inline uint32_t truthy_jump(Slot* registers) noexcept {
+    const Slot* value = REGISTER(A);
+    bool truthy;
+    if (value->index == HOLE_INDEX(BOOL_INDEX)) {
+        truthy = (value->bits & 1) != 0;
+    } else if (value->index == HOLE_INDEX(NULL_INDEX)) {
+        truthy = false;
+    } else if (value->index == HOLE_INDEX(INT_INDEX)) {
+        truthy = (value->bits << 16) != 0;
+    } else {
+        LEAVE();
+    }
+    if (truthy == jump_if) JUMP();
+    CONTINUE();
+}
+}  // namespace
+
+extern "C" {
+uint32_t meow_stencil_LOAD(Slot* registers) noexcept {
+    Slot* dst = REGISTER(A);
+    dst->bits = HOLE(BITS);
+    dst->index = HOLE_INDEX(INDEX);
+    CONTINUE();
+}
+
+uint32_t meow_stencil_MOVE(Slot* registers) noexcept {
+    *REGISTER(A) = *REGISTER(B);
+    CONTINUE();
+}
+
+// Chỉ có những nhánh nhanh mà dispatcher của interpreter có: int + int và float + float
+uint32_t meow_stencil_ADD(Slot* registers) noexcept {
+    const Slot* lhs = REGISTER(B);
+    const Slot* rhs = REGISTER(C);
+    if (lhs->index == HOLE_INDEX(INT_INDEX) && rhs->index == HOLE_INDEX(INT_INDEX)) {
+        store_int(REGISTER(A), lhs->bits + rhs->bits);
+    } else if (lhs->index == HOLE_INDEX(FLOAT_INDEX) && rhs->index == HOLE_INDEX(FLOAT_INDEX)) {
+        store_float(REGISTER(A), float_of(lhs) + float_of(rhs));
+    } else {
+        LEAVE();
+    }
+    CONTINUE();
+}
+
+uint32_t meow_stencil_JUMP(Slot* registers) noexcept {
+    JUMP();
+}
+
+uint32_t meow_stencil_JUMP_IF_FALSE(Slot* registers) noexcept {
+    return truthy_jump<false>(registers);
+}
+uint32_t meow_stencil_JUMP_IF_TRUE(Slot* registers) noexcept {
+    return truthy_jump<true>(registers);
+}
+
+uint32_t meow_stencil_JUMP_IF_EQ(Slot* registers) noexcept {
+    return compare_jump<Compare::EQ>(registers);
+}
+uint32_t meow_stencil_JUMP_IF_NEQ(Slot* registers) noexcept {
+    return compare_jump<Compare::NEQ>(registers);
+}
+uint32_t meow_stencil_JUMP_IF_LT(Slot* registers) noexcept {
+    return compare_jump<Compare::LT>(registers);
+}
+uint32_t meow_stencil_JUMP_IF_LE(Slot* registers) noexcept {
+    return compare_jump<Compare::LE>(registers);
+}
+uint32_t meow_stencil_JUMP_IF_NOT_LT(Slot* registers) noexcept {
+    return compare_jump<Compare::NOT_LT>(registers);
+}
+uint32_t meow_stencil_JUMP_IF_NOT_LE(Slot* registers) noexcept {
+    return compare_jump<Compare::NOT_LE>(registers);
+}
+
+// Nhánh int của op_for_loop: khoảng còn lại và độ dài bước tính bằng unsigned để i + s không tràn
+uint32_t meow_stencil_FOR_LOOP(Slot* registers) noexcept {
+    Slot* loop = REGISTER(A);
+    if (loop[0].index != HOLE_INDEX(INT_INDEX) || loop[1].index != HOLE_INDEX(INT_INDEX) || loop[2].index != HOLE_INDEX(INT_INDEX)) LEAVE();
+    int64_t i = int_of(&loop[0]);
+    int64_t limit = int_of(&loop[1]);
+    int64_t step = int_of(&loop[2]);
+    if (step > 0 ? i > limit : i < limit) CONTINUE();
+    uint64_t remaining = step > 0 ? static_cast<uint64_t>(limit) - static_cast<uint64_t>(i) : static_cast<uint64_t>(i) - static_cast<uint64_t>(limit);
+    uint64_t stride = step > 0 ? static_cast<uint64_t>(step) : uint64_t{0} - static_cast<uint64_t>(step);
+    if (remaining < stride) CONTINUE();
+    uint64_t next = static_cast<uint64_t>(i) + static_cast<uint64_t>(step);
+    store_int(&loop[0], next);
+    loop[3] = loop[0];
+    JUMP();
+}
+
+// Lệnh đối tượng chạy bằng chính handler của interpreter; register file có thể đã bị cấp phát lại
+uint32_t meow_stencil_CALLOUT(Slot* registers) noexcept {
+    auto callout = reinterpret_cast<meow::jit::stencil::Callout>(meow_hole_CALLOUT);
+    Slot* moved = callout(meow_hole_CONTEXT, static_cast<uint32_t>(HOLE(PC)));
+    if (moved == nullptr) return static_cast<uint32_t>(HOLE(PC)) | meow::jit::PENDING_ERROR;
+    return meow_hole_CONTINUE(moved);
+}
+
+uint32_t meow_stencil_LOOP_CHECK(Slot* registers) noexcept {
+    // Cờ do tầng tracing bật/tắt trong lúc code này đã được dịch, nên phải đọc lại mỗi lần
+    if (*reinterpret_cast<const volatile uint8_t*>(HOLE(FLAG)) != 0) LEAVE();
+    CONTINUE();
+}
+
+uint32_t meow_stencil_LEAVE(Slot* registers) noexcept {
+    (void)registers;
+    LEAVE();
+}
+}
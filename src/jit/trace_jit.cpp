@@ -0,0 +1,843 @@
+#include "jit/trace_jit.h"
+#include "core/objects/function.h"
+#include "core/superinstructions.h"
+#include "core/value.h"
+#include "jit/x64_assembler.h"
+#include "runtime/bytecode.h"
+#include "runtime/chunk.h"
+
+namespace meow::jit {
+using namespace meow::core;
+using namespace meow::runtime;
+
+#if MEOW_JIT_X64
+namespace {
+constexpr size_t MAX_TRACE_LENGTH = 512;       // Lệnh trong một vòng được ghi
+constexpr uint8_t MAX_RECORD_ATTEMPTS = 3;     // Ghi hỏng quá số lần này thì bỏ hẳn vòng lặp
+constexpr uint64_t REVIEW_ENTRIES = 64;        // Cứ ngần ấy lần vào trace thì xem trace có đáng giữ không
+constexpr uint64_t MIN_ITERATIONS_PER_ENTRY = 4;
+constexpr uint32_t NONE = static_cast<uint32_t>(-1);
+
+enum class Kind : uint8_t { INT, FLOAT, OTHER };
+enum class Compare : uint8_t { EQ, NEQ, LT, LE, NOT_LT, NOT_LE };
+
+enum class Ir : uint8_t {
+    CONST,      ///< INT: `constant.bits` is the int64; FLOAT: the double's bits; OTHER: the boxed Value
+    LOAD,       ///< Value of VM register `reg` at entry, type-checked once; a PHI if the loop also writes it
+    ADD,        ///< a + b
+    GUARD,      ///< Side exit at `pc` unless (compare a b) == expect
+    GUARD_FOR,  ///< Side exit at `pc` unless the int FOR_LOOP with i = a, limit = b, step = c goes on == expect
+};
+
+struct IrInst {
+    Ir op;
+    Kind kind;  ///< Of the result, or of the operands for guards
+    Compare compare = Compare::EQ;
+    bool expect = false;
+    uint16_t reg = 0;
+    uint32_t a = NONE, b = NONE, c = NONE;
+    ValueBits constant{};
+    uint32_t pc = 0;
+    uint32_t snapshot = NONE;
+    bool phi = false;     ///< LOAD carried around the loop
+    uint32_t tail = NONE; ///< PHI: value the register holds at the end of an iteration
+    bool hoisted = false; ///< Loop-invariant, runs once before the loop
+};
+
+/// @brief VM registers a side exit writes back, with the IR value each holds at that guard
+using Snapshot = std::vector<std::pair<uint16_t, uint32_t>>;
+
+/// @brief A recorded iteration in SSA form
+struct TraceIr {
+    std::vector<IrInst> insts;
+    std::vector<Snapshot> snapshots;
+    std::vector<std::pair<uint16_t, uint32_t>> tail_stores;  ///< Registers written but not carried, still live at the header
+};
+
+template <typename T>
+bool compare(Compare kind, T lhs, T rhs) noexcept {
+    switch (kind) {
+        case Compare::EQ:
+            return lhs == rhs;
+        case Compare::NEQ:
+            return !(lhs == rhs);
+        case Compare::LT:
+            return lhs < rhs;
+        case Compare::LE:
+            return lhs <= rhs;
+        case Compare::NOT_LT:
+            return !(lhs < rhs);
+        case Compare::NOT_LE:
+            return !(lhs <= rhs);
+    }
+    return false;
+}
+
+// Cùng công thức với op_for_loop
+bool for_loop_continues(int64_t i, int64_t limit, int64_t step) noexcept {
+    if (step > 0 ? i > limit : i < limit) return false;
+    uint64_t remaining = step > 0 ? static_cast<uint64_t>(limit) - static_cast<uint64_t>(i) : static_cast<uint64_t>(i) - static_cast<uint64_t>(limit);
+    uint64_t stride = step > 0 ? static_cast<uint64_t>(step) : uint64_t{0} - static_cast<uint64_t>(step);
+    return remaining >= stride;
+}
+
+int64_t wrap_int(int64_t value) noexcept {
+    return static_cast<int64_t>(static_cast<uint64_t>(value) << 16) >> 16;
+}
+
+/**
+ * @brief Runs one iteration of the loop on a copy of the frame's registers and emits the IR of the path it
+ * takes at the same time: the copy decides branches and types, the IR records what to check and compute
+ */
+class Recorder {
+public:
+    Recorder(const ValueLayout& layout, proto_t proto, uint32_t header, const Value* registers)
+        : layout_(layout),
+          chunk_(proto->get_chunk()),
+          code_(chunk_.get_code()),
+          size_(chunk_.get_code_size()),
+          num_registers_(proto->get_num_registers()),
+          header_(header) {
+        values_.reserve(num_registers_);
+        for (size_t r = 0; r < num_registers_; ++r) values_.push_back(bits_of(registers[r]));
+        current_.assign(num_registers_, NONE);
+        loaded_.assign(num_registers_, NONE);
+        written_.assign(num_registers_, false);
+    }
+
+    bool record(TraceIr& out) {
+        uint32_t pc = header_;
+        for (size_t steps = 0; steps < MAX_TRACE_LENGTH && pc < size_; ++steps) {
+            uint32_t next = 0;
+            if (!step(pc, next)) return false;
+            if (next == header_) return close(out);
+            // Nhảy ngược tới chỗ khác: vòng lặp bên trong, chỉ trace vòng trong cùng
+            if (next < pc) return false;
+            pc = next;
+        }
+        return false;
+    }
+
+private:
+    const ValueLayout& layout_;
+    const Chunk& chunk_;
+    const uint8_t* code_;
+    size_t size_;
+    size_t num_registers_;
+    uint32_t header_;
+
+    std::vector<ValueBits> values_;   ///< Concrete registers of the recorded iteration
+    std::vector<uint32_t> current_;   ///< IR value each register holds, NONE until read or written
+    std::vector<uint32_t> loaded_;    ///< LOAD of the register, if it was read before being written
+    std::vector<bool> written_;
+    std::vector<uint16_t> write_order_;
+    TraceIr ir_;
+    std::vector<uint32_t> guards_;    ///< Emitted so far, for guard elimination
+
+    uint16_t operand(uint32_t pc, size_t i) const noexcept {
+        return decode_instruction(code_, pc).operand(i);
+    }
+
+    Kind kind_of(ValueBits value) const noexcept {
+        if (value.index == layout_.int_index) return Kind::INT;
+        if (value.index == layout_.float_index) return Kind::FLOAT;
+        return Kind::OTHER;
+    }
+    static int64_t int_of(ValueBits value) noexcept {
+        return static_cast<int64_t>(value.bits << 16) >> 16;
+    }
+    static double float_of(ValueBits value) noexcept {
+        return std::bit_cast<double>(value.bits);
+    }
+    ValueBits box_int(int64_t value) const noexcept {
+        return {(static_cast<uint64_t>(value) & PAYLOAD_MASK) | layout_.int_tag, layout_.int_index};
+    }
+    ValueBits box_float(double value) const noexcept {
+        return {value != value ? layout_.nan_bits : std::bit_cast<uint64_t>(value), layout_.float_index};
+    }
+
+    uint32_t push(IrInst inst) {
+        ir_.insts.push_back(inst);
+        return static_cast<uint32_t>(ir_.insts.size() - 1);
+    }
+    const IrInst& at(uint32_t v) const noexcept {
+        return ir_.insts[v];
+    }
+
+    uint32_t constant(ValueBits value) {
+        IrInst inst{Ir::CONST, kind_of(value)};
+        inst.constant = value;
+        if (inst.kind == Kind::INT) inst.constant.bits = static_cast<uint64_t>(int_of(value));
+        return push(inst);
+    }
+
+    /// @brief IR value of register `reg`, loading it on first use. NONE if it holds something the trace cannot carry
+    uint32_t read(uint16_t reg) {
+        if (reg >= num_registers_) return NONE;
+        if (current_[reg] != NONE) return current_[reg];
+        Kind kind = kind_of(values_[reg]);
+        if (kind == Kind::OTHER) return NONE;
+        IrInst inst{Ir::LOAD, kind};
+        inst.reg = reg;
+        loaded_[reg] = current_[reg] = push(inst);
+        return current_[reg];
+    }
+
+    void write(uint16_t reg, uint32_t value, ValueBits concrete) {
+        values_[reg] = concrete;
+        current_[reg] = value;
+        if (!written_[reg]) {
+            written_[reg] = true;
+            write_order_.push_back(reg);
+        }
+    }
+
+    uint32_t snapshot() {
+        Snapshot snap;
+        for (uint16_t reg : write_order_) snap.push_back({reg, current_[reg]});
+        ir_.snapshots.push_back(std::move(snap));
+        return static_cast<uint32_t>(ir_.snapshots.size() - 1);
+    }
+
+    // Gấp hằng số hai vế, và bỏ guard trùng với một guard đã qua trong cùng vòng
+    void guard(Ir op, Kind kind, Compare cmp, uint32_t a, uint32_t b, uint32_t c, bool expect, uint32_t pc) {
+        if (op == Ir::GUARD && at(a).op == Ir::CONST && at(b).op == Ir::CONST) return;
+        for (uint32_t g : guards_) {
+            const IrInst& seen = at(g);
+            if (seen.op == op && seen.kind == kind && seen.compare == cmp && seen.a == a && seen.b == b && seen.c == c && seen.expect == expect) return;
+        }
+        IrInst inst{op, kind};
+        inst.compare = cmp;
+        inst.a = a;
+        inst.b = b;
+        inst.c = c;
+        inst.expect = expect;
+        inst.pc = pc;
+        inst.snapshot = snapshot();
+        guards_.push_back(push(inst));
+    }
+
+    uint32_t add(Kind kind, uint32_t a, uint32_t b, ValueBits result) {
+        if (at(a).op == Ir::CONST && at(b).op == Ir::CONST) return constant(result);
+        IrInst inst{Ir::ADD, kind};
+        inst.a = a;
+        inst.b = b;
+        return push(inst);
+    }
+
+    /// @brief Jump target of the instruction at `pc`
+    bool target(uint32_t pc, uint32_t& next) const noexcept {
+        uint32_t offset = decode_instruction(code_, pc).address();
+        if (offset > size_) return false;
+        next = offset;
+        return true;
+    }
+
+    bool step(uint32_t pc, uint32_t& next) {
+        Instruction instruction;
+        if (!decode_instruction(code_, size_, pc, instruction)) return false;
+        OpCode op = superinstruction_head(instruction.op());
+        next = pc + instruction.size;
+
+        switch (op) {
+            case OpCode::LOAD_NULL:
+            case OpCode::LOAD_TRUE:
+            case OpCode::LOAD_FALSE:
+            case OpCode::LOAD_INT:
+            case OpCode::LOAD_SMALLINT:
+            case OpCode::LOAD_FLOAT:
+            case OpCode::LOAD_CONST: {
+                uint16_t dst = operand(pc, 0);
+                std::optional<ValueBits> value = loaded_value(chunk_, pc);
+                if (dst >= num_registers_ || !value) return false;
+                write(dst, constant(*value), *value);
+                return true;
+            }
+            case OpCode::MOVE: {
+                uint16_t dst = operand(pc, 0), src = operand(pc, 1);
+                uint32_t value = read(src);
+                // Giá trị không phải số chỉ đi được qua trace dưới dạng hằng số đã biết
+                if (value == NONE || dst >= num_registers_) return false;
+                write(dst, value, values_[src]);
+                return true;
+            }
+            case OpCode::ADD: {
+                uint16_t dst = operand(pc, 0), lhs = operand(pc, 1), rhs = operand(pc, 2);
+                uint32_t a = read(lhs), b = read(rhs);
+                if (a == NONE || b == NONE || dst >= num_registers_) return false;
+                Kind kind = kind_of(values_[lhs]);
+                if (kind == Kind::OTHER || kind_of(values_[rhs]) != kind) return false;
+                ValueBits result = kind == Kind::INT ? box_int(wrap_int(int_of(values_[lhs]) + int_of(values_[rhs])))
+                                                     : box_float(float_of(values_[lhs]) + float_of(values_[rhs]));
+                write(dst, add(kind, a, b, result), result);
+                return true;
+            }
+            case OpCode::JUMP:
+                return target(pc, next);
+            case OpCode::JUMP_IF_FALSE:
+            case OpCode::JUMP_IF_TRUE: {
+                uint16_t reg = operand(pc, 0);
+                uint32_t to = 0;
+                if (reg >= num_registers_ || !target(pc, to)) return false;
+                ValueBits value = values_[reg];
+                bool truthy;
+                if (kind_of(value) == Kind::INT) {
+                    uint32_t v = read(reg);
+                    if (v == NONE) return false;
+                    truthy = int_of(value) != 0;
+                    guard(Ir::GUARD, Kind::INT, Compare::NEQ, v, constant(box_int(0)), NONE, truthy, pc);
+                } else if (current_[reg] != NONE && at(current_[reg]).op == Ir::CONST && (value.index == layout_.false_.index || value.index == layout_.null.index)) {
+                    // Bool/null chỉ có thể là hằng số do chính vòng lặp nạp: điều kiện đã biết, không cần guard
+                    truthy = value.index == layout_.false_.index && (value.bits & 1) != 0;
+                } else {
+                    return false;
+                }
+                if (truthy == (op == OpCode::JUMP_IF_TRUE)) next = to;
+                return true;
+            }
+            case OpCode::JUMP_IF_EQ:
+            case OpCode::JUMP_IF_NEQ:
+            case OpCode::JUMP_IF_LT:
+            case OpCode::JUMP_IF_LE:
+            case OpCode::JUMP_IF_NOT_LT:
+            case OpCode::JUMP_IF_NOT_LE: {
+                uint16_t lhs = operand(pc, 0), rhs = operand(pc, 1);
+                uint32_t to = 0;
+                uint32_t a = read(lhs), b = read(rhs);
+                if (a == NONE || b == NONE || !target(pc, to)) return false;
+                Kind kind = kind_of(values_[lhs]);
+                if (kind == Kind::OTHER || kind_of(values_[rhs]) != kind) return false;
+                Compare cmp = static_cast<Compare>(static_cast<uint8_t>(op) - static_cast<uint8_t>(OpCode::JUMP_IF_EQ));
+                bool taken = kind == Kind::INT ? compare(cmp, int_of(values_[lhs]), int_of(values_[rhs])) : compare(cmp, float_of(values_[lhs]), float_of(values_[rhs]));
+                guard(Ir::GUARD, kind, cmp, a, b, NONE, taken, pc);
+                if (taken) next = to;
+                return true;
+            }
+            case OpCode::FOR_LOOP: {
+                uint16_t base = operand(pc, 0);
+                uint32_t body = 0;
+                if (base + 4u > num_registers_ || !target(pc, body)) return false;
+                uint32_t i = read(base), limit = read(base + 1), step = read(base + 2);
+                if (i == NONE || limit == NONE || step == NONE) return false;
+                if (kind_of(values_[base]) != Kind::INT || kind_of(values_[base + 1]) != Kind::INT || kind_of(values_[base + 2]) != Kind::INT) return false;
+                int64_t iv = int_of(values_[base]), sv = int_of(values_[base + 2]);
+                bool goes_on = for_loop_continues(iv, int_of(values_[base + 1]), sv);
+                guard(Ir::GUARD_FOR, Kind::INT, Compare::EQ, i, limit, step, goes_on, pc);
+                if (!goes_on) return true;
+                ValueBits result = box_int(wrap_int(iv + sv));
+                uint32_t value = add(Kind::INT, i, step, result);
+                write(base, value, result);
+                write(base + 3, value, result);
+                next = body;
+                return true;
+            }
+            default:
+                // Gọi hàm, đối tượng, toán tử chung...: để lại cho tầng baseline
+                return false;
+        }
+    }
+
+    // Khép vòng: thanh ghi vừa đọc trước vừa ghi thành PHI, thanh ghi chỉ ghi mà còn sống ở đầu vòng thì lưu ở cuối vòng
+    bool close(TraceIr& out) {
+        const RegisterLiveness& liveness = chunk_.get_liveness();
+        const uint64_t* live = liveness.empty() ? nullptr : liveness.at(header_);
+        for (uint16_t reg : write_order_) {
+            uint32_t value = current_[reg];
+            if (loaded_[reg] != NONE) {
+                IrInst& phi = ir_.insts[loaded_[reg]];
+                if (at(value).kind != phi.kind) return false;
+                phi.phi = true;
+                phi.tail = value;
+            } else if (live == nullptr || liveness.is_live(live, reg)) {
+                ir_.tail_stores.push_back({reg, value});
+            }
+        }
+        // Ở vòng thứ hai trở đi, thanh ghi PHI chưa ghi lại trong vòng vẫn chỉ nằm trong thanh ghi máy
+        for (Snapshot& snap : ir_.snapshots) {
+            for (uint16_t reg : write_order_) {
+                if (loaded_[reg] == NONE) continue;
+                bool present = std::any_of(snap.begin(), snap.end(), [reg](const auto& entry) { return entry.first == reg; });
+                if (!present) snap.push_back({reg, loaded_[reg]});
+            }
+        }
+        out = std::move(ir_);
+        return true;
+    }
+};
+
+// Lệnh có toán hạng đều bất biến trong vòng (hằng, LOAD không phải PHI, lệnh đã kéo ra) thì chạy một lần trước vòng
+void hoist_invariants(TraceIr& ir) {
+    std::vector<bool> invariant(ir.insts.size(), false);
+    auto is_invariant = [&](uint32_t v) { return v == NONE || invariant[v]; };
+    for (size_t v = 0; v < ir.insts.size(); ++v) {
+        IrInst& inst = ir.insts[v];
+        switch (inst.op) {
+            case Ir::CONST:
+                invariant[v] = true;
+                break;
+            case Ir::LOAD:
+                invariant[v] = !inst.phi;
+                break;
+            default:
+                inst.hoisted = is_invariant(inst.a) && is_invariant(inst.b) && is_invariant(inst.c);
+                invariant[v] = inst.hoisted;
+                break;
+        }
+    }
+}
+
+constexpr std::array<Reg, 12> INT_POOL{Reg::RBX, Reg::RBP, Reg::RSI, Reg::RDX, Reg::R8, Reg::R9, Reg::R10, Reg::R11, Reg::R12, Reg::R13, Reg::R14, Reg::R15};
+constexpr std::array<Reg, 6> CALLEE_SAVED{Reg::RBX, Reg::RBP, Reg::R12, Reg::R13, Reg::R14, Reg::R15};
+constexpr size_t XMM_FIRST = 2;  // xmm0, xmm1 làm scratch
+constexpr size_t XMM_COUNT = 14;
+
+/// @brief Trace IR to x86-64. `rdi` holds R0 of the frame, rax/rcx/xmm0/xmm1 are scratch
+class TraceCompiler {
+public:
+    TraceCompiler(const ValueLayout& layout, const TraceIr& ir, uint32_t header, uint64_t* iterations) noexcept
+        : layout_(layout), ir_(ir), header_(header), iterations_(iterations) {
+    }
+
+    bool compile(std::vector<uint8_t>& out) {
+        order();
+        if (!allocate()) return false;
+
+        Label loop = a_.new_label();
+        entry_exit_ = a_.new_label();
+        for (Reg reg : CALLEE_SAVED) a_.push(reg);
+        for (uint32_t v : preheader_) emit(v);
+        a_.bind(loop);
+        for (uint32_t v : body_) emit(v);
+        emit_tail();
+        a_.jmp(loop);
+
+        a_.bind(entry_exit_);
+        leave(header_);
+        for (const auto& [label, v] : exits_) {
+            a_.bind(label);
+            const IrInst& guard = ir_.insts[v];
+            for (const auto& [reg, value] : ir_.snapshots[guard.snapshot]) store(reg, value);
+            leave(guard.pc);
+        }
+        return a_.finish(out);
+    }
+
+private:
+    const ValueLayout& layout_;
+    const TraceIr& ir_;
+    uint32_t header_;
+    uint64_t* iterations_;
+
+    X64Assembler a_;
+    std::vector<uint32_t> preheader_;  ///< LOADs and hoisted instructions, run once
+    std::vector<uint32_t> body_;       ///< The loop
+    std::vector<int8_t> home_;         ///< Machine register of each value (index into its pool), -1 if none
+    Label entry_exit_{};
+    std::vector<std::pair<Label, uint32_t>> exits_;
+
+    static Mem bits(uint16_t reg) noexcept {
+        return {Reg::RDI, static_cast<int32_t>(reg) * VALUE_SIZE};
+    }
+    static Mem index(uint16_t reg) noexcept {
+        return {Reg::RDI, static_cast<int32_t>(reg) * VALUE_SIZE + INDEX_OFFSET};
+    }
+    const IrInst& inst(uint32_t v) const noexcept {
+        return ir_.insts[v];
+    }
+    Reg gpr(uint32_t v) const noexcept {
+        return INT_POOL[static_cast<size_t>(home_[v])];
+    }
+    Xmm xmm(uint32_t v) const noexcept {
+        return static_cast<Xmm>(XMM_FIRST + static_cast<size_t>(home_[v]));
+    }
+
+    void order() {
+        for (uint32_t v = 0; v < ir_.insts.size(); ++v) {
+            const IrInst& i = inst(v);
+            if (i.op == Ir::CONST) continue;
+            if (i.op == Ir::LOAD || i.hoisted) preheader_.push_back(v);
+            else body_.push_back(v);
+        }
+    }
+
+    // Linear scan: khoảng sống tính theo vị trí trong preheader + thân vòng; giá trị sống qua cạnh quay lại kéo dài tới cuối vòng
+    bool allocate() {
+        size_t count = ir_.insts.size();
+        std::vector<size_t> position(count, 0);
+        std::vector<size_t> start(count, 0), end(count, 0);
+        std::vector<bool> used(count, false);
+        size_t loop_start = preheader_.size();
+        size_t loop_end = preheader_.size() + body_.size();
+        for (size_t p = 0; p < preheader_.size(); ++p) position[preheader_[p]] = p;
+        for (size_t p = 0; p < body_.size(); ++p) position[body_[p]] = loop_start + p;
+
+        auto use = [&](uint32_t v, size_t at) {
+            if (v == NONE || inst(v).op == Ir::CONST) return;
+            used[v] = true;
+            // Định nghĩa trước vòng mà dùng trong vòng: phải sống qua mọi vòng lặp
+            size_t last = position[v] < loop_start && at >= loop_start ? loop_end : at;
+            end[v] = std::max(end[v], last);
+        };
+        for (uint32_t v = 0; v < count; ++v) start[v] = end[v] = position[v];
+        for (uint32_t v = 0; v < count; ++v) {
+            const IrInst& i = inst(v);
+            if (i.op == Ir::CONST) continue;
+            use(i.a, position[v]);
+            use(i.b, position[v]);
+            use(i.c, position[v]);
+            if (i.snapshot != NONE && !i.hoisted) {
+                for (const auto& entry : ir_.snapshots[i.snapshot]) use(entry.second, position[v]);
+            }
+            if (i.phi) {
+                used[v] = true;
+                end[v] = loop_end;
+                use(i.tail, loop_end);
+            }
+        }
+        for (const auto& entry : ir_.tail_stores) use(entry.second, loop_end);
+
+        std::vector<uint32_t> values;
+        for (uint32_t v = 0; v < count; ++v) {
+            Ir op = inst(v).op;
+            if (used[v] && (op == Ir::LOAD || op == Ir::ADD)) values.push_back(v);
+        }
+        std::sort(values.begin(), values.end(), [&](uint32_t x, uint32_t y) { return start[x] < start[y]; });
+
+        home_.assign(count, -1);
+        std::array<uint32_t, INT_POOL.size()> int_owner;
+        std::array<uint32_t, XMM_COUNT> xmm_owner;
+        int_owner.fill(NONE);
+        xmm_owner.fill(NONE);
+        auto take = [&](auto& owners, uint32_t v) {
+            for (size_t r = 0; r < owners.size(); ++r) {
+                if (owners[r] == NONE || end[owners[r]] < start[v]) {
+                    owners[r] = v;
+                    home_[v] = static_cast<int8_t>(r);
+                    return true;
+                }
+            }
+            return false;
+        };
+        for (uint32_t v : values) {
+            if (!(inst(v).kind == Kind::FLOAT ? take(xmm_owner, v) : take(int_owner, v))) return false;
+        }
+        return true;
+    }
+
+    void leave(uint32_t pc) {
+        for (auto it = CALLEE_SAVED.rbegin(); it != CALLEE_SAVED.rend(); ++it) a_.pop(*it);
+        a_.mov(Reg::RAX, uint64_t{pc});
+        a_.ret();
+    }
+
+    Label exit_for(uint32_t v) {
+        if (inst(v).hoisted) return entry_exit_;
+        Label label = a_.new_label();
+        exits_.push_back({label, v});
+        return label;
+    }
+
+    void int_into(Reg dst, uint32_t v) {
+        if (inst(v).op == Ir::CONST) a_.mov(dst, inst(v).constant.bits);
+        else a_.mov(dst, gpr(v));
+    }
+    void float_into(Xmm dst, uint32_t v) {
+        if (inst(v).op == Ir::CONST) {
+            a_.mov(Reg::RAX, inst(v).constant.bits);
+            a_.movq(dst, Reg::RAX);
+        } else {
+            a_.movsd(dst, xmm(v));
+        }
+    }
+
+    /// @brief Boxes IR value `v` into VM register `reg` like the interpreter would. Clobbers rax, rcx
+    void store(uint16_t reg, uint32_t v) {
+        const IrInst& value = inst(v);
+        if (value.op == Ir::CONST) {
+            ValueBits boxed = value.constant;
+            if (value.kind == Kind::INT) boxed = {(value.constant.bits & PAYLOAD_MASK) | layout_.int_tag, layout_.int_index};
+            if (value.kind == Kind::FLOAT && std::isnan(std::bit_cast<double>(boxed.bits))) boxed.bits = layout_.nan_bits;
+            if (value.kind == Kind::FLOAT) boxed.index = layout_.float_index;
+            a_.mov(Reg::RAX, boxed.bits);
+            a_.mov(bits(reg), Reg::RAX);
+            a_.mov8(index(reg), boxed.index);
+            return;
+        }
+        if (value.kind == Kind::INT) {
+            a_.mov(Reg::RAX, gpr(v));
+            a_.shl(Reg::RAX, 16);
+            a_.shr(Reg::RAX, 16);
+            a_.mov(Reg::RCX, layout_.int_tag);
+            a_.or_(Reg::RAX, Reg::RCX);
+            a_.mov(bits(reg), Reg::RAX);
+            a_.mov8(index(reg), layout_.int_index);
+            return;
+        }
+        Label done = a_.new_label();
+        a_.movq(Reg::RAX, xmm(v));
+        a_.ucomisd(xmm(v), xmm(v));
+        a_.j(Cond::NP, done);
+        a_.mov(Reg::RAX, layout_.nan_bits);
+        a_.bind(done);
+        a_.mov(bits(reg), Reg::RAX);
+        a_.mov8(index(reg), layout_.float_index);
+    }
+
+    void emit(uint32_t v) {
+        const IrInst& i = inst(v);
+        switch (i.op) {
+            case Ir::LOAD:
+                a_.cmp8(index(i.reg), i.kind == Kind::INT ? layout_.int_index : layout_.float_index);
+                a_.j(Cond::NE, entry_exit_);
+                if (home_[v] < 0) return;
+                if (i.kind == Kind::INT) {
+                    a_.mov(gpr(v), bits(i.reg));
+                    a_.shl(gpr(v), 16);
+                    a_.sar(gpr(v), 16);
+                } else {
+                    a_.movsd(xmm(v), bits(i.reg));
+                }
+                return;
+            case Ir::ADD:
+                if (home_[v] < 0) return;
+                if (i.kind == Kind::INT) {
+                    int_into(Reg::RAX, i.a);
+                    int_into(Reg::RCX, i.b);
+                    a_.add(Reg::RAX, Reg::RCX);
+                    // Số nguyên của Value chỉ có 48 bit
+                    a_.shl(Reg::RAX, 16);
+                    a_.sar(Reg::RAX, 16);
+                    a_.mov(gpr(v), Reg::RAX);
+                } else {
+                    float_into(Xmm::XMM0, i.a);
+                    float_into(Xmm::XMM1, i.b);
+                    a_.addsd(Xmm::XMM0, Xmm::XMM1);
+                    a_.movsd(xmm(v), Xmm::XMM0);
+                }
+                return;
+            case Ir::GUARD:
+                emit_guard(v);
+                return;
+            case Ir::GUARD_FOR:
+                emit_guard_for(v);
+                return;
+            case Ir::CONST:
+                return;
+        }
+    }
+
+    void emit_guard(uint32_t v) {
+        const IrInst& i = inst(v);
+        Label exit = exit_for(v);
+        bool negated = i.compare == Compare::NEQ || i.compare == Compare::NOT_LT || i.compare == Compare::NOT_LE;
+        // Guard qua khi kết quả của dạng không phủ định bằng `holds`
+        bool holds = i.expect != negated;
+        if (i.kind == Kind::INT) {
+            int_into(Reg::RAX, i.a);
+            int_into(Reg::RCX, i.b);
+            a_.cmp(Reg::RAX, Reg::RCX);
+            Cond cond = (i.compare == Compare::EQ || i.compare == Compare::NEQ) ? Cond::E : (i.compare == Compare::LT || i.compare == Compare::NOT_LT) ? Cond::L : Cond::LE;
+            a_.j(holds ? invert(cond) : cond, exit);
+            return;
+        }
+        float_into(Xmm::XMM0, i.a);
+        float_into(Xmm::XMM1, i.b);
+        if (i.compare == Compare::EQ || i.compare == Compare::NEQ) {
+            // Bằng nhau khi ZF = 1 và không có NaN (PF = 0)
+            a_.ucomisd(Xmm::XMM0, Xmm::XMM1);
+            if (holds) {
+                a_.j(Cond::P, exit);
+                a_.j(Cond::NE, exit);
+            } else {
+                Label pass = a_.new_label();
+                a_.j(Cond::P, pass);
+                a_.j(Cond::E, exit);
+                a_.bind(pass);
+            }
+            return;
+        }
+        // lhs < rhs <=> rhs "above" lhs; NaN bật CF nên so sánh nào cũng sai
+        a_.ucomisd(Xmm::XMM1, Xmm::XMM0);
+        Cond cond = (i.compare == Compare::LT || i.compare == Compare::NOT_LT) ? Cond::A : Cond::AE;
+        a_.j(holds ? invert(cond) : cond, exit);
+    }
+
+    void emit_guard_for(uint32_t v) {
+        const IrInst& i = inst(v);
+        Label exit = exit_for(v);
+        Label compare = a_.new_label();
+        // Chỉ số đã vượt giới hạn thì vòng lặp dừng, không cần so khoảng còn lại
+        Label ended = i.expect ? exit : a_.new_label();
+        const IrInst& step = inst(i.c);
+        // Khoảng còn lại ở rax, độ dài bước ở rcx, cả hai unsigned như op_for_loop
+        auto positive = [&] {
+            int_into(Reg::RAX, i.b);
+            int_into(Reg::RCX, i.a);
+            a_.cmp(Reg::RCX, Reg::RAX);
+            a_.j(Cond::G, ended);
+            a_.sub(Reg::RAX, Reg::RCX);
+            int_into(Reg::RCX, i.c);
+        };
+        auto negative = [&] {
+            int_into(Reg::RAX, i.a);
+            int_into(Reg::RCX, i.b);
+            a_.cmp(Reg::RAX, Reg::RCX);
+            a_.j(Cond::L, ended);
+            a_.sub(Reg::RAX, Reg::RCX);
+            int_into(Reg::RCX, i.c);
+            a_.neg(Reg::RCX);
+        };
+        if (step.op == Ir::CONST) {
+            if (static_cast<int64_t>(step.constant.bits) > 0) positive();
+            else negative();
+        } else {
+            Label down = a_.new_label();
+            int_into(Reg::RCX, i.c);
+            a_.test(Reg::RCX, Reg::RCX);
+            a_.j(Cond::LE, down);
+            positive();
+            a_.jmp(compare);
+            a_.bind(down);
+            negative();
+        }
+        a_.bind(compare);
+        a_.cmp(Reg::RAX, Reg::RCX);
+        a_.j(i.expect ? Cond::B : Cond::AE, exit);
+        if (!i.expect) a_.bind(ended);
+    }
+
+    // Cuối vòng: đếm vòng, lưu thanh ghi tạm còn sống, rồi chuyển giá trị mới vào thanh ghi máy của các PHI
+    void emit_tail() {
+        a_.mov(Reg::RAX, reinterpret_cast<uint64_t>(iterations_));
+        a_.inc(Mem{Reg::RAX, 0});
+        for (const auto& [reg, value] : ir_.tail_stores) store(reg, value);
+
+        std::vector<std::pair<int8_t, uint32_t>> int_moves, xmm_moves;
+        std::vector<std::pair<uint32_t, uint32_t>> constants;
+        for (uint32_t v = 0; v < ir_.insts.size(); ++v) {
+            const IrInst& i = inst(v);
+            if (!i.phi || i.tail == v) continue;
+            if (inst(i.tail).op == Ir::CONST) {
+                constants.push_back({v, i.tail});
+            } else if (home_[i.tail] != home_[v]) {
+                (i.kind == Kind::FLOAT ? xmm_moves : int_moves).push_back({home_[v], i.tail});
+            }
+        }
+        parallel_move(int_moves, false);
+        parallel_move(xmm_moves, true);
+        for (const auto& [phi, value] : constants) {
+            if (inst(phi).kind == Kind::FLOAT) float_into(xmm(phi), value);
+            else int_into(gpr(phi), value);
+        }
+    }
+
+    /// @brief Moves (destination home, source value) at once; a cycle is broken through the scratch register
+    void parallel_move(std::vector<std::pair<int8_t, uint32_t>> moves, bool floats) {
+        constexpr int8_t SCRATCH = -1;
+        std::vector<std::pair<int8_t, int8_t>> pending;
+        for (const auto& [dst, src] : moves) pending.push_back({dst, home_[src]});
+        auto move = [&](int8_t dst, int8_t src) {
+            if (floats) {
+                Xmm to = static_cast<Xmm>(XMM_FIRST + static_cast<size_t>(dst));
+                a_.movsd(to, src == SCRATCH ? Xmm::XMM0 : static_cast<Xmm>(XMM_FIRST + static_cast<size_t>(src)));
+            } else if (dst == SCRATCH) {
+                a_.mov(Reg::RAX, INT_POOL[static_cast<size_t>(src)]);
+            } else {
+                a_.mov(INT_POOL[static_cast<size_t>(dst)], src == SCRATCH ? Reg::RAX : INT_POOL[static_cast<size_t>(src)]);
+            }
+        };
+        while (!pending.empty()) {
+            auto ready = std::find_if(pending.begin(), pending.end(), [&](const auto& m) {
+                return std::none_of(pending.begin(), pending.end(), [&](const auto& other) { return other.second == m.first; });
+            });
+            if (ready != pending.end()) {
+                move(ready->first, ready->second);
+                pending.erase(ready);
+                continue;
+            }
+            // Chỉ còn chu trình: cất một đích vào scratch để giải phóng nó
+            int8_t saved = pending.front().first;
+            if (floats) a_.movsd(Xmm::XMM0, static_cast<Xmm>(XMM_FIRST + static_cast<size_t>(saved)));
+            else move(SCRATCH, saved);
+            for (auto& m : pending) {
+                if (m.second == saved) m.second = SCRATCH;
+            }
+        }
+    }
+};
+}  // namespace
+#endif
+
+std::unique_ptr<TraceJit> TraceJit::create(const JitOptions& options) {
+#if MEOW_JIT_X64
+    if (!options.enabled || !options.tracing) return nullptr;
+    std::optional<ValueLayout> layout = probe_layout();
+    if (!layout) return nullptr;
+    return std::make_unique<TraceJit>(options, *layout);
+#else
+    (void)options;
+    return nullptr;
+#endif
+}
+
+LoopTraces& TraceJit::loops_of(proto_t proto) {
+    if (LoopTraces* loops = proto->get_loop_traces()) return *loops;
+    size_t size = proto->get_chunk().get_code_size();
+    auto loops = std::make_unique<LoopTraces>();
+    loops->hotness.assign(size, 0);
+    loops->attempts.assign(size, 0);
+    loops->has_trace.assign(size, 0);
+    loops->traces.resize(size);
+    proto->set_loop_traces(loops.get());
+    loops_.push_back(std::move(loops));
+    return *loops_.back();
+}
+
+const uint8_t* TraceJit::loop_flags(proto_t proto) {
+    return loops_of(proto).has_trace.data();
+}
+
+uint32_t TraceJit::run_loop(proto_t proto, uint32_t header, Value* registers) {
+#if MEOW_JIT_X64
+    LoopTraces& loops = loops_of(proto);
+    if (header >= loops.hotness.size()) return header;
+
+    if (Trace* trace = loops.traces[header].get()) {
+        uint32_t resume = trace->enter(registers);
+        // Gần đây trace thoát gần như ngay mỗi lần vào (một guard giờ luôn sai) thì không đáng giữ: trả vòng lặp cho tầng baseline
+        if (trace->get_entries() % REVIEW_ENTRIES == 0 && trace->take_recent_iterations() < REVIEW_ENTRIES * MIN_ITERATIONS_PER_ENTRY) {
+            loops.traces[header].reset();
+            loops.has_trace[header] = 0;
+            loops.hotness[header] = BLACKLISTED;
+        }
+        return resume;
+    }
+
+    uint16_t& hotness = loops.hotness[header];
+    if (hotness == BLACKLISTED || ++hotness < options_.trace_threshold) return header;
+    hotness = 0;
+
+    TraceIr ir;
+    std::vector<uint8_t> code;
+    auto trace = std::make_unique<Trace>(header);
+    bool ok = Recorder(layout_, proto, header, registers).record(ir);
+    if (ok) {
+        hoist_invariants(ir);
+        ok = TraceCompiler(layout_, ir, header, &trace->iterations()).compile(code);
+    }
+    std::optional<CodeMemory> memory = ok ? CodeMemory::map(code) : std::nullopt;
+    if (!memory) {
+        if (++loops.attempts[header] >= MAX_RECORD_ATTEMPTS) hotness = BLACKLISTED;
+        return header;
+    }
+    trace->attach(std::move(*memory));
+    loops.traces[header] = std::move(trace);
+    loops.has_trace[header] = 1;
+    return loops.traces[header]->enter(registers);
+#else
+    (void)proto;
+    (void)registers;
+    return header;
+#endif
+}
+}  // namespace meow::jit
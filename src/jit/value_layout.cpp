@@ -0,0 +1,83 @@
+#include "jit/value_layout.h"
+#include "core/superinstructions.h"
+#include "core/value.h"
+#include "runtime/bytecode.h"
+#include "runtime/chunk.h"
+
+#include <cstring>
+
+namespace meow::jit {
+using namespace meow::core;
+using namespace meow::runtime;
+
+ValueBits bits_of(const Value& value) noexcept {
+    ValueBits out{};
+#if MEOW_CAN_USE_NAN_BOXING
+    static_assert(sizeof(Value) == VALUE_SIZE, "the JIT addresses registers as 16-byte NaN-boxed values");
+    const auto* raw = static_cast<const uint8_t*>(static_cast<const void*>(&value));
+    std::memcpy(&out.bits, raw, sizeof(out.bits));
+    out.index = raw[INDEX_OFFSET];
+#else
+    (void)value;
+#endif
+    return out;
+}
+
+std::optional<ValueBits> loaded_value(const Chunk& chunk, size_t pc) noexcept {
+    Instruction instruction = decode_instruction(chunk.get_code(), pc);
+    OpCode op = superinstruction_head(instruction.op());
+    Value value;
+    switch (op) {
+        case OpCode::LOAD_TRUE:
+            value = Value(true);
+            break;
+        case OpCode::LOAD_FALSE:
+            value = Value(false);
+            break;
+        case OpCode::LOAD_INT:
+            value = Value(std::bit_cast<int_t>(instruction.imm64()));
+            break;
+        case OpCode::LOAD_SMALLINT:
+            value = Value(int_t{static_cast<int16_t>(instruction.operand(1))});
+            break;
+        case OpCode::LOAD_FLOAT:
+            value = Value(std::bit_cast<float_t>(instruction.imm64()));
+            break;
+        case OpCode::LOAD_CONST: {
+            // Hằng số sống cùng proto nên bits của nó (kể cả con trỏ object) nhúng thẳng vào code được
+            uint16_t index = instruction.operand(1);
+            if (index >= chunk.get_pool_size()) return std::nullopt;
+            value = chunk.get_constant(index);
+            break;
+        }
+        default:
+            break;
+    }
+    return bits_of(value);
+}
+
+// Đo encoding thật thay vì tin vào giả định, lệch ở đâu thì không bật JIT
+std::optional<ValueLayout> probe_layout() noexcept {
+#if MEOW_CAN_USE_NAN_BOXING
+    ValueBits zero = bits_of(Value(int_t{0}));
+    ValueBits one = bits_of(Value(int_t{1}));
+    ValueBits minus = bits_of(Value(int_t{-1}));
+    ValueBits yes = bits_of(Value(true));
+    ValueBits no = bits_of(Value(false));
+    ValueBits real = bits_of(Value(float_t{1.5}));
+    ValueBits nan = bits_of(Value(std::numeric_limits<float_t>::quiet_NaN()));
+    ValueBits null = bits_of(Value());
+
+    bool ok = (zero.bits & PAYLOAD_MASK) == 0 && one.bits == zero.bits + 1 && minus.bits == (zero.bits | PAYLOAD_MASK) && one.index == zero.index &&
+              minus.index == zero.index && yes.bits == (no.bits | 1) && (no.bits & 1) == 0 && yes.index == no.index &&
+              real.bits == std::bit_cast<uint64_t>(float_t{1.5}) && nan.index == real.index;
+    std::array<uint8_t, 4> indices{null.index, no.index, zero.index, real.index};
+    std::sort(indices.begin(), indices.end());
+    ok = ok && std::adjacent_find(indices.begin(), indices.end()) == indices.end();
+    if (!ok) return std::nullopt;
+    return ValueLayout{null, no, zero.index, real.index, zero.bits, nan.bits};
+#else
+    return std::nullopt;
+#endif
+}
+}  // namespace meow::jit
@@ -0,0 +1,289 @@
+#include "jit/x64_assembler.h"
+
+namespace meow::jit {
+namespace {
+constexpr uint8_t code_of(Reg reg) noexcept {
+    return static_cast<uint8_t>(reg);
+}
+constexpr uint8_t code_of(Xmm reg) noexcept {
+    return static_cast<uint8_t>(reg);
+}
+}  // namespace
+
+Label X64Assembler::new_label() {
+    labels_.push_back(UNBOUND);
+    return Label{static_cast<uint32_t>(labels_.size() - 1)};
+}
+
+void X64Assembler::bind(Label label) {
+    labels_[label.id] = static_cast<uint32_t>(code_.size());
+}
+
+void X64Assembler::emit8(uint8_t byte) {
+    code_.push_back(byte);
+}
+
+void X64Assembler::emit32(uint32_t value) {
+    for (int i = 0; i < 4; ++i) emit8(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+void X64Assembler::emit64(uint64_t value) {
+    for (int i = 0; i < 8; ++i) emit8(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+// REX chỉ cần khi có W, register mở rộng r8-r15, hoặc khi thanh ghi 8 bit là spl/bpl/sil/dil
+void X64Assembler::rex(bool w, uint8_t reg, uint8_t base, bool force) {
+    uint8_t prefix = static_cast<uint8_t>(0x40 | (w ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((base & 8) ? 1 : 0));
+    if (prefix != 0x40 || force) emit8(prefix);
+}
+
+// Luôn dùng disp32 cho đơn giản; rsp/r12 làm base cần thêm byte SIB
+void X64Assembler::modrm_mem(uint8_t reg, Mem mem) {
+    uint8_t base = code_of(mem.base);
+    emit8(static_cast<uint8_t>(0x80 | ((reg & 7) << 3) | (base & 7)));
+    if ((base & 7) == 4) emit8(0x24);
+    emit32(static_cast<uint32_t>(mem.disp));
+}
+
+void X64Assembler::modrm_reg(uint8_t reg, uint8_t rm) {
+    emit8(static_cast<uint8_t>(0xC0 | ((reg & 7) << 3) | (rm & 7)));
+}
+
+void X64Assembler::mov(Reg dst, Reg src) {
+    alu(0x89, dst, src);
+}
+
+void X64Assembler::mov(Reg dst, Mem src) {
+    rex(true, code_of(dst), code_of(src.base));
+    emit8(0x8B);
+    modrm_mem(code_of(dst), src);
+}
+
+void X64Assembler::mov(Mem dst, Reg src) {
+    rex(true, code_of(src), code_of(dst.base));
+    emit8(0x89);
+    modrm_mem(code_of(src), dst);
+}
+
+void X64Assembler::mov(Reg dst, uint64_t imm) {
+    uint8_t r = code_of(dst);
+    // mov r32, imm32 tự xoá 32 bit cao, ngắn hơn movabs
+    bool fits32 = imm <= std::numeric_limits<uint32_t>::max();
+    rex(!fits32, 0, r);
+    emit8(static_cast<uint8_t>(0xB8 + (r & 7)));
+    if (fits32) emit32(static_cast<uint32_t>(imm));
+    else emit64(imm);
+}
+
+void X64Assembler::mov8(Mem dst, uint8_t imm) {
+    rex(false, 0, code_of(dst.base));
+    emit8(0xC6);
+    modrm_mem(0, dst);
+    emit8(imm);
+}
+
+void X64Assembler::cmp8(Mem lhs, uint8_t imm) {
+    rex(false, 0, code_of(lhs.base));
+    emit8(0x80);
+    modrm_mem(7, lhs);
+    emit8(imm);
+}
+
+void X64Assembler::test8(Mem lhs, uint8_t imm) {
+    rex(false, 0, code_of(lhs.base));
+    emit8(0xF6);
+    modrm_mem(0, lhs);
+    emit8(imm);
+}
+
+// Dạng `op r/m64, r64`: dst nằm ở trường r/m, src ở trường reg
+void X64Assembler::alu(uint8_t opcode, Reg dst, Reg src) {
+    rex(true, code_of(src), code_of(dst));
+    emit8(opcode);
+    modrm_reg(code_of(src), code_of(dst));
+}
+
+void X64Assembler::add(Reg dst, Reg src) {
+    alu(0x01, dst, src);
+}
+void X64Assembler::sub(Reg dst, Reg src) {
+    alu(0x29, dst, src);
+}
+void X64Assembler::and_(Reg dst, Reg src) {
+    alu(0x21, dst, src);
+}
+void X64Assembler::or_(Reg dst, Reg src) {
+    alu(0x09, dst, src);
+}
+void X64Assembler::xor_(Reg dst, Reg src) {
+    alu(0x31, dst, src);
+}
+void X64Assembler::cmp(Reg lhs, Reg rhs) {
+    alu(0x39, lhs, rhs);
+}
+void X64Assembler::test(Reg lhs, Reg rhs) {
+    alu(0x85, lhs, rhs);
+}
+
+void X64Assembler::imul(Reg dst, Reg src) {
+    rex(true, code_of(dst), code_of(src));
+    emit8(0x0F);
+    emit8(0xAF);
+    modrm_reg(code_of(dst), code_of(src));
+}
+
+void X64Assembler::neg(Reg reg) {
+    rex(true, 0, code_of(reg));
+    emit8(0xF7);
+    modrm_reg(3, code_of(reg));
+}
+
+void X64Assembler::shift(uint8_t ext, Reg reg, uint8_t count) {
+    rex(true, 0, code_of(reg));
+    emit8(0xC1);
+    modrm_reg(ext, code_of(reg));
+    emit8(count);
+}
+
+void X64Assembler::shl(Reg reg, uint8_t count) {
+    shift(4, reg, count);
+}
+void X64Assembler::shr(Reg reg, uint8_t count) {
+    shift(5, reg, count);
+}
+void X64Assembler::sar(Reg reg, uint8_t count) {
+    shift(7, reg, count);
+}
+
+void X64Assembler::add_rsp(int8_t imm) {
+    rex(true, 0, code_of(Reg::RSP));
+    emit8(0x83);
+    modrm_reg(0, code_of(Reg::RSP));
+    emit8(static_cast<uint8_t>(imm));
+}
+
+void X64Assembler::inc(Mem dst) {
+    rex(true, 0, code_of(dst.base));
+    emit8(0xFF);
+    modrm_mem(0, dst);
+}
+
+void X64Assembler::push(Reg reg) {
+    rex(false, 0, code_of(reg));
+    emit8(static_cast<uint8_t>(0x50 + (code_of(reg) & 7)));
+}
+
+void X64Assembler::pop(Reg reg) {
+    rex(false, 0, code_of(reg));
+    emit8(static_cast<uint8_t>(0x58 + (code_of(reg) & 7)));
+}
+
+void X64Assembler::set(Cond cond, Reg dst) {
+    uint8_t r = code_of(dst);
+    rex(false, 0, r, r >= 4);
+    emit8(0x0F);
+    emit8(static_cast<uint8_t>(0x90 + static_cast<uint8_t>(cond)));
+    modrm_reg(0, r);
+    // movzx r32, r8
+    rex(false, r, r, r >= 4);
+    emit8(0x0F);
+    emit8(0xB6);
+    modrm_reg(r, r);
+}
+
+// Prefix bắt buộc (F2/66) phải đứng trước REX
+void X64Assembler::sse(uint8_t prefix, uint8_t opcode, uint8_t reg, Mem mem) {
+    emit8(prefix);
+    rex(false, reg, code_of(mem.base));
+    emit8(0x0F);
+    emit8(opcode);
+    modrm_mem(reg, mem);
+}
+
+void X64Assembler::sse(uint8_t prefix, uint8_t opcode, uint8_t reg, uint8_t rm) {
+    emit8(prefix);
+    rex(false, reg, rm);
+    emit8(0x0F);
+    emit8(opcode);
+    modrm_reg(reg, rm);
+}
+
+void X64Assembler::movsd(Xmm dst, Mem src) {
+    sse(0xF2, 0x10, code_of(dst), src);
+}
+void X64Assembler::movsd(Xmm dst, Xmm src) {
+    sse(0xF2, 0x10, code_of(dst), code_of(src));
+}
+void X64Assembler::addsd(Xmm dst, Xmm src) {
+    sse(0xF2, 0x58, code_of(dst), code_of(src));
+}
+void X64Assembler::addsd(Xmm dst, Mem src) {
+    sse(0xF2, 0x58, code_of(dst), src);
+}
+void X64Assembler::subsd(Xmm dst, Mem src) {
+    sse(0xF2, 0x5C, code_of(dst), src);
+}
+void X64Assembler::mulsd(Xmm dst, Mem src) {
+    sse(0xF2, 0x59, code_of(dst), src);
+}
+void X64Assembler::divsd(Xmm dst, Mem src) {
+    sse(0xF2, 0x5E, code_of(dst), src);
+}
+
+void X64Assembler::ucomisd(Xmm lhs, Xmm rhs) {
+    sse(0x66, 0x2E, code_of(lhs), code_of(rhs));
+}
+
+void X64Assembler::movq(Reg dst, Xmm src) {
+    emit8(0x66);
+    rex(true, code_of(src), code_of(dst));
+    emit8(0x0F);
+    emit8(0x7E);
+    modrm_reg(code_of(src), code_of(dst));
+}
+
+void X64Assembler::movq(Xmm dst, Reg src) {
+    emit8(0x66);
+    rex(true, code_of(dst), code_of(src));
+    emit8(0x0F);
+    emit8(0x6E);
+    modrm_reg(code_of(dst), code_of(src));
+}
+
+void X64Assembler::rel32(Label target) {
+    fixups_.push_back({code_.size(), target.id});
+    emit32(0);
+}
+
+void X64Assembler::jmp(Label target) {
+    emit8(0xE9);
+    rel32(target);
+}
+
+void X64Assembler::j(Cond cond, Label target) {
+    emit8(0x0F);
+    emit8(static_cast<uint8_t>(0x80 + static_cast<uint8_t>(cond)));
+    rel32(target);
+}
+
+void X64Assembler::call(Reg target) {
+    rex(false, 0, code_of(target));
+    emit8(0xFF);
+    modrm_reg(2, code_of(target));
+}
+
+void X64Assembler::ret() {
+    emit8(0xC3);
+}
+
+bool X64Assembler::finish(std::vector<uint8_t>& out) {
+    for (const Fixup& fixup : fixups_) {
+        uint32_t target = labels_[fixup.label];
+        if (target == UNBOUND) return false;
+        uint32_t rel = target - static_cast<uint32_t>(fixup.at + 4);
+        for (int i = 0; i < 4; ++i) code_[fixup.at + i] = static_cast<uint8_t>(rel >> (8 * i));
+    }
+    out = std::move(code_);
+    return true;
+}
+}  // namespace meow::jit
@@ -7,14 +7,14 @@ namespace meow::memory {
 
 MarkSweepGC::~MarkSweepGC() noexcept {
     std::cout << "[destroy] Đang xử lí các object khi hủy GC" << std::endl;
-    for (auto const& [obj, data] : metadata_) {
-        delete obj;
+    for (const meow::core::MeowObject* object : objects_) {
+        meow::core::MeowObject::destroy(object);
     }
 }
 
 void MarkSweepGC::register_object(const meow::core::MeowObject* object) {
     std::cout << "[register] Đang đăng kí object: " << object << std::endl;
-    metadata_.emplace(object, GCMetadata{});
+    objects_.push_back(object);
 }
 
 size_t MarkSweepGC::collect() noexcept {
@@ -23,20 +23,18 @@ size_t MarkSweepGC::collect() noexcept {
     context_->trace(*this);
     builtins_->trace(*this);
 
-    for (auto it = metadata_.begin(); it != metadata_.end();) {
-        const meow::core::MeowObject* object = it->first;
-        GCMetadata& data = it->second;
-
-        if (data.is_marked_) {
-            data.is_marked_ = false;
-            ++it;
+    size_t live = 0;
+    for (const meow::core::MeowObject* object : objects_) {
+        if (object->is_marked()) {
+            object->clear_marked();
+            objects_[live++] = object;
         } else {
-            delete object;
-            it = metadata_.erase(it);
+            meow::core::MeowObject::destroy(object);
         }
     }
+    objects_.resize(live);
 
-    return metadata_.size();
+    return objects_.size();
 }
 
 void MarkSweepGC::visit_value(meow::core::param_t value) noexcept {
@@ -49,9 +47,8 @@ void MarkSweepGC::visit_object(const meow::core::MeowObject* object) noexcept {
 
 void MarkSweepGC::mark(const meow::core::MeowObject* object) {
     if (object == nullptr) return;
-    auto it = metadata_.find(object);
-    if (it == metadata_.end() || it->second.is_marked_) return;
-    it->second.is_marked_ = true;
+    if (object->is_marked()) return;
+    object->set_marked();
     object->trace(*this);
 }
 
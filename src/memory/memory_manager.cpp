@@ -23,25 +23,57 @@ MemoryManager::~MemoryManager() noexcept = default;
 // }
 
 string_t MemoryManager::new_string(std::string_view str_view) noexcept {
-    auto it = string_pool_.find(str_view);
+    utils::string::PrehashedString str{str_view, utils::string::hash_string(str_view)};
+    auto it = string_pool_.find(str);
     if (it != string_pool_.end()) {
         return it->second;
     }
-    
-    std::string s(str_view);
-    string_t new_obj = new_object<objects::ObjString>(s);
-    string_pool_.emplace(std::move(s), new_obj);
-    return new_obj;
+    return intern_new_string(str);
 }
 
 string_t MemoryManager::new_string(const char* chars, size_t length) noexcept {
-    return new_string(std::string(chars, length));
+    return new_string(std::string_view(chars, length));
+}
+
+string_t MemoryManager::new_string(const utils::string::PrehashedString& str) noexcept {
+    auto it = string_pool_.find(str);
+    if (it != string_pool_.end()) {
+        return it->second;
+    }
+    // Hash sai mà vẫn thêm vào thì string bị intern hai lần, nên chỉ kiểm tra khi thật sự tạo string mới.
+    // Đây là lần hash duy nhất: header của string và key của pool đều dùng lại hash đã kiểm tra
+    if (utils::string::hash_string(str.text) != str.hash) return nullptr;
+    return intern_new_string(str);
+}
+
+string_t MemoryManager::intern_new_string(const utils::string::PrehashedString& str) noexcept {
+    string_t new_obj = new_object<objects::ObjString>(std::string(str.text), str.hash);
+    string_pool_.emplace(utils::string::HashedString{std::string(str.text), str.hash}, new_obj);
+    return new_obj;
+}
+
+std::vector<string_t> MemoryManager::intern_strings(std::span<const utils::string::PrehashedString> strings) noexcept {
+    string_pool_.reserve(string_pool_.size() + strings.size());
+    std::vector<string_t> interned;
+    interned.reserve(strings.size());
+    for (const utils::string::PrehashedString& str : strings) {
+        interned.push_back(new_string(str));
+    }
+    return interned;
 }
 
 array_t MemoryManager::new_array(const std::vector<Value>& elements) noexcept {
     return new_object<objects::ObjArray>(elements);
 }
 
+array_t MemoryManager::new_array(std::vector<core::int_t>&& elements) noexcept {
+    return new_object<objects::ObjArray>(std::move(elements));
+}
+
+array_t MemoryManager::new_array(std::vector<core::float_t>&& elements) noexcept {
+    return new_object<objects::ObjArray>(std::move(elements));
+}
+
 hash_table_t MemoryManager::new_hash(const std::unordered_map<string_t, Value>& fields) noexcept {
     return new_object<objects::ObjHashTable>(fields);
 }
@@ -0,0 +1,251 @@
+#include "module/aot_compiler.h"
+
+#include "core/objects/function.h"
+#include "core/objects/string.h"
+#include "core/superinstructions.h"
+#include "core/value.h"
+#include "jit/baseline_jit.h"
+#include "module/aot_module.h"
+#include "runtime/bytecode.h"
+#include "runtime/chunk.h"
+
+namespace meow::module {
+
+using namespace meow::core;
+using namespace meow::runtime;
+
+namespace {
+/// @brief One proto's bytecode to a C++ function `proto_<index>`, with a label per instruction
+class ProtoWriter {
+public:
+    ProtoWriter(proto_t proto, size_t index, std::string& out) noexcept
+        : proto_(proto),
+          chunk_(proto->get_chunk()),
+          code_(chunk_.get_code()),
+          size_(chunk_.get_code_size()),
+          num_registers_(proto->get_num_registers()),
+          index_(index),
+          out_(out) {
+    }
+
+    void write() {
+        std::vector<size_t> offsets;
+        bool decoded = decode_instructions(code_, size_, offsets) && size_ < jit::PENDING_ERROR;
+        if (decoded) {
+            starts_.assign(size_, 0);
+            for (size_t offset : offsets) starts_[offset] = 1;
+        }
+
+        line("// " + proto_name());
+        line("uint32_t proto_" + std::to_string(index_) + "(Value* r, uint32_t pc, void* context, CompiledCode::callout_t callout) {");
+        if (!decoded) {
+            // Không giải mã được thì để interpreter tự báo lỗi
+            line("    (void)r;\n    (void)context;\n    (void)callout;\n    return pc;\n}\n");
+            return;
+        }
+        line("    switch (pc) {");
+        for (size_t offset : offsets) line("        case " + std::to_string(offset) + ": goto L" + std::to_string(offset) + ";");
+        line("        default: return pc;");
+        line("    }");
+        for (size_t offset : offsets) {
+            line("L" + std::to_string(offset) + ":");
+            emit(static_cast<uint32_t>(offset));
+        }
+        // Chạy quá lệnh cuối: interpreter tự return ngầm định
+        line("    (void)context;\n    (void)callout;\n    return " + std::to_string(size_) + ";");
+        line("}\n");
+    }
+
+private:
+    proto_t proto_;
+    const Chunk& chunk_;
+    const uint8_t* code_;
+    size_t size_;
+    size_t num_registers_;
+    size_t index_;
+    std::string& out_;
+    std::vector<uint8_t> starts_;  ///< Non-zero at the offset of each instruction
+
+    std::string proto_name() const {
+        std::string name = proto_->get_name() ? proto_->get_name()->c_str() : "<anonymous>";
+        // Tên nằm trong comment `//`: xuống dòng hay `\` cuối dòng sẽ kéo dòng kế tiếp vào comment
+        std::replace_if(name.begin(), name.end(), [](char c) { return c == '\n' || c == '\r' || c == '\\'; }, ' ');
+        return name;
+    }
+    void line(const std::string& text) {
+        out_ += text;
+        out_ += '\n';
+    }
+    uint16_t operand(uint32_t pc, size_t i) const noexcept {
+        return decode_instruction(code_, pc).operand(i);
+    }
+    /// @brief Jump target of the instruction at `pc`, as a byte offset
+    uint32_t address(uint32_t pc) const noexcept {
+        return decode_instruction(code_, pc).address();
+    }
+    bool fits(uint32_t first, uint32_t count) const noexcept {
+        return first + count <= num_registers_;
+    }
+    bool target(uint32_t offset) const noexcept {
+        return offset == size_ || (offset < starts_.size() && starts_[offset] != 0);
+    }
+    static std::string reg(uint16_t index) {
+        return "r[" + std::to_string(index) + "]";
+    }
+    void leave(uint32_t pc) {
+        line("    return " + std::to_string(pc) + ";");
+    }
+    // Nhảy tới hết chunk cũng là trả về interpreter
+    std::string go(uint32_t offset) const {
+        return offset == size_ ? "return " + std::to_string(size_) + ";" : "goto L" + std::to_string(offset) + ";";
+    }
+
+    /// @brief C++ expression of the Value a LOAD_* stores, empty if only known at run time (object constants)
+    std::string loaded(uint32_t pc, OpCode op) const {
+        Value value;
+        switch (op) {
+            case OpCode::LOAD_NULL:
+                return "Value()";
+            case OpCode::LOAD_TRUE:
+                return "Value(true)";
+            case OpCode::LOAD_FALSE:
+                return "Value(false)";
+            case OpCode::LOAD_INT:
+            case OpCode::LOAD_FLOAT: {
+                uint64_t imm = decode_instruction(code_, pc).imm64();
+                return op == OpCode::LOAD_INT ? int_literal(std::bit_cast<int_t>(imm)) : float_literal(imm);
+            }
+            case OpCode::LOAD_SMALLINT:
+                return int_literal(static_cast<int16_t>(operand(pc, 1)));
+            case OpCode::LOAD_CONST: {
+                uint16_t index = operand(pc, 1);
+                if (index >= chunk_.get_pool_size()) return {};
+                value = chunk_.get_constant(index);
+                if (value.is_null()) return "Value()";
+                if (value.is_bool()) return value.as_bool() ? "Value(true)" : "Value(false)";
+                if (value.is_int()) return int_literal(value.as_int());
+                if (value.is_float()) return float_literal(std::bit_cast<uint64_t>(value.as_float()));
+                return {};
+            }
+            default:
+                return {};
+        }
+    }
+    static std::string int_literal(int64_t value) {
+        return "Value(static_cast<int_t>(" + std::to_string(static_cast<uint64_t>(value)) + "ull))";
+    }
+    static std::string float_literal(uint64_t bits) {
+        return "Value(std::bit_cast<float_t>(uint64_t{" + std::to_string(bits) + "ull}))";
+    }
+
+    void emit(uint32_t pc) {
+        OpCode op = superinstruction_head(decode_instruction(code_, pc).op());
+        if (jit::is_callout_opcode(op)) {
+            // Handler có thể cấp phát và làm register file dời chỗ: lấy lại R0 sau mỗi callout
+            line("    r = callout(context, " + std::to_string(pc) + ");");
+            line("    if (r == nullptr) return " + std::to_string(pc) + "u | meow::jit::PENDING_ERROR;");
+            return;
+        }
+        switch (op) {
+            case OpCode::LOAD_NULL:
+            case OpCode::LOAD_TRUE:
+            case OpCode::LOAD_FALSE:
+            case OpCode::LOAD_INT:
+            case OpCode::LOAD_SMALLINT:
+            case OpCode::LOAD_FLOAT:
+            case OpCode::LOAD_CONST: {
+                std::string value = loaded(pc, op);
+                if (value.empty() || !fits(operand(pc, 0), 1)) return leave(pc);
+                line("    " + reg(operand(pc, 0)) + " = " + value + ";");
+                return;
+            }
+            case OpCode::MOVE:
+                if (!fits(operand(pc, 0), 1) || !fits(operand(pc, 1), 1)) return leave(pc);
+                line("    " + reg(operand(pc, 0)) + " = " + reg(operand(pc, 1)) + ";");
+                return;
+            case OpCode::ADD:
+                if (!fits(operand(pc, 0), 1) || !fits(operand(pc, 1), 1) || !fits(operand(pc, 2), 1)) return leave(pc);
+                line("    if (!aot::add(" + reg(operand(pc, 0)) + ", " + reg(operand(pc, 1)) + ", " + reg(operand(pc, 2)) + ")) return " + std::to_string(pc) + ";");
+                return;
+            case OpCode::JUMP:
+                if (!target(address(pc))) return leave(pc);
+                line("    " + go(address(pc)));
+                return;
+            case OpCode::JUMP_IF_FALSE:
+            case OpCode::JUMP_IF_TRUE: {
+                if (!fits(operand(pc, 0), 1) || !target(address(pc))) return leave(pc);
+                std::string taken = op == OpCode::JUMP_IF_TRUE ? "1" : "0";
+                line("    switch (aot::truthy(" + reg(operand(pc, 0)) + ")) {");
+                line("        case -1: return " + std::to_string(pc) + ";");
+                line("        case " + taken + ": " + go(address(pc)));
+                line("        default: break;");
+                line("    }");
+                return;
+            }
+            case OpCode::JUMP_IF_EQ:
+            case OpCode::JUMP_IF_NEQ:
+            case OpCode::JUMP_IF_LT:
+            case OpCode::JUMP_IF_LE:
+            case OpCode::JUMP_IF_NOT_LT:
+            case OpCode::JUMP_IF_NOT_LE: {
+                if (!fits(operand(pc, 0), 1) || !fits(operand(pc, 1), 1) || !target(address(pc))) return leave(pc);
+                // NEQ/NOT_LT/NOT_LE nhảy khi phép so sánh gốc sai, như COMPARE_JUMP_HANDLER
+                const char* compare = (op == OpCode::JUMP_IF_EQ || op == OpCode::JUMP_IF_NEQ) ? "equal" : (op == OpCode::JUMP_IF_LT || op == OpCode::JUMP_IF_NOT_LT) ? "less" : "less_equal";
+                bool when = op == OpCode::JUMP_IF_EQ || op == OpCode::JUMP_IF_LT || op == OpCode::JUMP_IF_LE;
+                line("    switch (aot::" + std::string(compare) + "(" + reg(operand(pc, 0)) + ", " + reg(operand(pc, 1)) + ")) {");
+                line("        case -1: return " + std::to_string(pc) + ";");
+                line(std::string("        case ") + (when ? "1" : "0") + ": " + go(address(pc)));
+                line("        default: break;");
+                line("    }");
+                return;
+            }
+            case OpCode::FOR_LOOP:
+                if (!fits(operand(pc, 0), 4) || !target(address(pc))) return leave(pc);
+                line("    switch (aot::for_loop(&" + reg(operand(pc, 0)) + ")) {");
+                line("        case -1: return " + std::to_string(pc) + ";");
+                line("        case 1: " + go(address(pc)));
+                line("        default: break;");
+                line("    }");
+                return;
+            default:
+                return leave(pc);
+        }
+    }
+};
+}  // namespace
+
+std::string generate_aot_source(proto_t main, const std::vector<uint8_t>& bytecode, const std::string& name) {
+    std::vector<proto_t> protos = objects::collect_protos(main);
+    std::string out;
+    out += "// Generated by meow-aotc from " + name + ". Do not edit.\n";
+    out += "#include \"jit/baseline_jit.h\"\n#include \"module/aot_module.h\"\n\n";
+    out += "#if defined(_WIN32)\n#define MEOW_AOT_EXPORT __declspec(dllexport)\n#else\n#define MEOW_AOT_EXPORT __attribute__((visibility(\"default\")))\n#endif\n\n";
+    out += "namespace {\nusing namespace meow::core;\nusing meow::jit::CompiledCode;\nnamespace aot = meow::module::aot;\n\n";
+
+    out += "const uint8_t BYTECODE[] = {";
+    for (size_t i = 0; i < bytecode.size(); ++i) {
+        if (i % 24 == 0) out += "\n   ";
+        out += " " + std::to_string(bytecode[i]) + ",";
+    }
+    out += "\n};\n\n";
+
+    for (size_t i = 0; i < protos.size(); ++i) ProtoWriter(protos[i], i, out).write();
+
+    out += "const meow::module::AotProto PROTOS[] = {\n";
+    for (size_t i = 0; i < protos.size(); ++i) {
+        out += "    {" + std::to_string(hash_proto(protos[i])) + "ull, &proto_" + std::to_string(i) + "},\n";
+    }
+    out += "};\n}  // namespace\n\n";
+
+    std::string quoted;
+    for (char c : name) {
+        if (c == '\\' || c == '"') quoted += '\\';
+        quoted += c;
+    }
+    out += "extern \"C\" MEOW_AOT_EXPORT meow::core::module_t CreateMeowModule(meow::vm::MeowEngine* engine, meow::memory::MemoryManager* heap) {\n";
+    out += "    static const meow::module::AotModule module{meow::module::AOT_ABI_VERSION, \"" + quoted + "\", BYTECODE, sizeof(BYTECODE), PROTOS, " +
+           std::to_string(protos.size()) + "};\n";
+    out += "    return meow::module::load_aot_module(engine, heap, module);\n}\n";
+    return out;
+}
+}  // namespace meow::module
@@ -0,0 +1,79 @@
+#include "module/aot_module.h"
+
+#include "core/objects/function.h"
+#include "core/objects/module.h"
+#include "memory/memory_manager.h"
+#include "module/loader/binary_loader.h"
+
+namespace meow::module {
+
+using namespace meow::core;
+using namespace meow::loader;
+using namespace meow::memory;
+
+runtime::OptimizerOptions aot_optimizer_options() noexcept {
+    // Không đọc biến môi trường: MEOW_NO_OPTIMIZE lúc chạy không được làm lệch bytecode so với lúc biên dịch
+    return runtime::OptimizerOptions{};
+}
+
+uint64_t hash_proto(proto_t proto) noexcept {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&hash](uint8_t byte) {
+        hash ^= byte;
+        hash *= 0x100000001b3ull;
+    };
+    auto mix64 = [&mix](uint64_t word) {
+        for (int i = 0; i < 8; ++i) mix(static_cast<uint8_t>(word >> (8 * i)));
+    };
+    const auto& chunk = proto->get_chunk();
+    const uint8_t* code = chunk.get_code();
+    for (size_t i = 0; i < chunk.get_code_size(); ++i) mix(code[i]);
+    mix64(proto->get_num_registers());
+
+    // Mã native nhúng thẳng hằng số của LOAD_CONST: cùng bytecode nhưng khác pool thì không được dùng lại
+    mix64(chunk.get_pool_size());
+    for (size_t i = 0; i < chunk.get_pool_size(); ++i) {
+        Value constant = chunk.get_constant(i);
+        mix(static_cast<uint8_t>(constant.index()));
+        if (constant.is_bool()) {
+            mix(constant.as_bool() ? 1 : 0);
+        } else if (constant.is_int()) {
+            mix64(static_cast<uint64_t>(constant.as_int()));
+        } else if (constant.is_float()) {
+            mix64(std::bit_cast<uint64_t>(constant.as_float()));
+        } else if (constant.is_string()) {
+            string_t str = constant.as_string();
+            mix64(str->size());
+            for (size_t k = 0; k < str->size(); ++k) mix(static_cast<uint8_t>(str->c_str()[k]));
+        }
+        // Proto lồng nhau có hash riêng, các object khác chỉ tính theo kiểu
+    }
+    return hash;
+}
+
+module_t load_aot_module(vm::MeowEngine* engine, MemoryManager* heap, const AotModule& module) {
+    if (module.abi_version != AOT_ABI_VERSION) {
+        throw std::runtime_error("Module native '" + std::string(module.name) + "' được meow-aotc dịch cho ABI " + std::to_string(module.abi_version) +
+                                 ", VM này dùng ABI " + std::to_string(AOT_ABI_VERSION) + ": hãy dịch lại");
+    }
+
+    proto_t main_proto = nullptr;
+    try {
+        BinaryLoader loader(heap, std::span<const uint8_t>(module.bytecode, module.bytecode_size), aot_optimizer_options());
+        main_proto = loader.load_module();
+    } catch (const BinaryLoaderError& e) {
+        throw std::runtime_error("Bytecode nhúng trong module native '" + std::string(module.name) + "' không hợp lệ: " + e.what());
+    }
+
+    // Proto nào không còn khớp (VM đổi optimizer/loader từ lúc dịch) thì vẫn chạy bằng interpreter
+    std::vector<proto_t> protos = objects::collect_protos(main_proto);
+    if (engine) {
+        for (size_t i = 0; i < protos.size() && i < module.proto_count; ++i) {
+            if (module.protos[i].entry && module.protos[i].code_hash == hash_proto(protos[i])) engine->attach_native_code(protos[i], module.protos[i].entry);
+        }
+    }
+
+    string_t name = heap->new_string(module.name);
+    return heap->new_module(name, name, main_proto);
+}
+}  // namespace meow::module
@@ -1,9 +1,12 @@
 #include "module/loader/binary_loader.h"
+#include "module/loader/binary_format.h"
 #include "memory/memory_manager.h"
 #include "core/objects/string.h"
 #include "core/objects/function.h"
 #include "core/value.h"
+#include "runtime/bytecode.h"
 #include "runtime/chunk.h"
+#include "runtime/optimizer.h"
 
 namespace meow::loader {
 
@@ -12,19 +15,116 @@ using namespace meow::runtime;
 using namespace meow::memory;
 using namespace meow::core::objects;
 
-constexpr uint32_t MAGIC_NUMBER = 0x4D454F57; // "MEOW"
-constexpr uint32_t FORMAT_VERSION = 1;
+BinaryLoader::BinaryLoader(MemoryManager* heap, std::span<const uint8_t> data, const OptimizerOptions& options)
+    : heap_(heap), data_(data), cursor_(0), options_(options) {}
 
-enum class ConstantTag : uint8_t {
-    NULL_T,
-    INT_T,
-    FLOAT_T,
-    STRING_T,
-    PROTO_REF_T
+BinaryLoader::BinaryLoader(MemoryManager* heap, std::shared_ptr<const MappedFile> file, const OptimizerOptions& options, bool lazy)
+    : heap_(heap), data_(file->bytes()), file_(std::move(file)), cursor_(0), options_(options), lazy_(lazy) {}
+
+bool BinaryLoader::lazy_from_environment() noexcept {
+    const char* eager = std::getenv("MEOW_EAGER_LOAD");
+    return eager == nullptr || *eager == '\0' || std::string_view(eager) == "0";
+}
+
+namespace {
+// Chuỗi và proto mới tạo chỉ nằm trong vector cục bộ cho tới khi gắn vào proto, nên không được để GC chạy giữa chừng
+class GCPause {
+public:
+    explicit GCPause(MemoryManager* heap) noexcept : heap_(heap), was_enabled_(heap->is_gc_enabled()) {
+        heap_->disable_gc();
+    }
+    GCPause(const GCPause&) = delete;
+    GCPause& operator=(const GCPause&) = delete;
+    ~GCPause() noexcept {
+        if (was_enabled_) heap_->enable_gc();
+    }
+private:
+    MemoryManager* heap_;
+    bool was_enabled_;
 };
 
-BinaryLoader::BinaryLoader(MemoryManager* heap, const std::vector<uint8_t>& data)
-    : heap_(heap), data_(data), cursor_(0) {}
+// Tệp đã tối ưu sẵn (meow-aotc --emit-meowb) không qua optimizer nữa: code giữ nguyên nên vẫn chạy thẳng trên page của tệp
+void prepare_proto(proto_t proto, bool optimized, const OptimizerOptions& options, const InlineCandidates& globals) {
+    if (!optimized) {
+        optimize_proto(proto, options, globals);
+        return;
+    }
+    if (auto error = adopt_optimized_proto(proto)) {
+        throw BinaryLoaderError("Pre-optimized prototype is invalid: " + *error);
+    }
+}
+}  // namespace
+
+/// @brief Stub table of a lazily loaded module. Every proto loaded from it holds it, it only holds the file
+class LazyBodies final : public ProtoBodySource, public std::enable_shared_from_this<LazyBodies> {
+public:
+    LazyBodies(MemoryManager* heap, std::shared_ptr<const MappedFile> file, const OptimizerOptions& options, bool optimized, std::vector<uint32_t>&& offsets,
+               std::shared_ptr<const std::vector<utils::string::PrehashedString>> strings)
+        : heap_(heap), file_(std::move(file)), options_(options), optimized_(optimized), offsets_(std::move(offsets)), strings_(std::move(strings)), protos_(offsets_.size(), nullptr) {}
+
+    [[nodiscard]] size_t size() const noexcept {
+        return offsets_.size();
+    }
+
+    /// @brief The live proto with index `index`, or a new stub if it was never made or has been collected
+    proto_t proto_at(uint32_t index) {
+        if (protos_[index] != nullptr) return protos_[index];
+        BinaryLoader loader(heap_, file_, options_, true);
+        loader.bodies_ = shared_from_this();
+        loader.strings_ = strings_;
+        loader.optimized_ = optimized_;
+        loader.cursor_ = offsets_[index];
+        proto_t stub = loader.read_stub();
+        adopt(stub, index, true);
+        return stub;
+    }
+    void adopt(proto_t proto, uint32_t index, bool pending) {
+        proto->set_body_source(shared_from_this(), index, pending);
+        protos_[index] = proto;
+    }
+
+    void remember_inline_candidates(const InlineCandidates& candidates) {
+        for (const auto& [name, proto] : candidates) {
+            if (proto->get_body_index() < protos_.size() && protos_[proto->get_body_index()] == proto) inline_candidates_[name] = proto->get_body_index();
+        }
+    }
+    /// @brief Candidates whose proto is still alive and already has its body, the inliner cannot copy a stub
+    InlineCandidates inline_candidates() const {
+        InlineCandidates candidates;
+        for (const auto& [name, index] : inline_candidates_) {
+            if (protos_[index] != nullptr && !protos_[index]->is_body_pending()) candidates[name] = protos_[index];
+        }
+        return candidates;
+    }
+
+    void load_body(ObjFunctionProto* proto, uint32_t index) override {
+        GCPause pause(heap_);
+        BinaryLoader loader(heap_, file_, options_, true);
+        loader.bodies_ = shared_from_this();
+        loader.strings_ = strings_;
+        loader.optimized_ = optimized_;
+        loader.cursor_ = offsets_[index];
+        BinaryLoader::PrototypeRecord record = loader.read_record();
+        proto->set_body(loader.make_chunk(record));
+        proto->set_exception_table(std::move(record.exception_table));
+        loader.add_relocations(proto, record);
+        loader.link_prototypes();
+        prepare_proto(proto, optimized_, options_, optimized_ ? InlineCandidates{} : inline_candidates());
+    }
+    void forget(const ObjFunctionProto* proto, uint32_t index) noexcept override {
+        if (index < protos_.size() && protos_[index] == proto) protos_[index] = nullptr;
+    }
+
+private:
+    MemoryManager* heap_;
+    std::shared_ptr<const MappedFile> file_;
+    OptimizerOptions options_;
+    bool optimized_;  ///< The file was written by write_optimized_module()
+    std::vector<uint32_t> offsets_;
+    std::shared_ptr<const std::vector<utils::string::PrehashedString>> strings_;  ///< Interned on demand by each body
+    std::vector<proto_t> protos_;  ///< Weak: a proto clears its entry when it is freed
+    std::unordered_map<std::string, uint32_t> inline_candidates_;
+};
 
 
 void BinaryLoader::check_can_read(size_t bytes) {
@@ -78,39 +178,172 @@ string_t BinaryLoader::read_string() {
     return heap_->new_string(str);
 }
 
-Value BinaryLoader::read_constant() {
+void BinaryLoader::read_string_table() {
+    uint32_t count = read_u32();
+    auto strings = std::make_shared<std::vector<utils::string::PrehashedString>>();
+    strings->reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        uint64_t hash = read_u64();
+        uint32_t length = read_u32();
+        check_can_read(length);
+        strings->push_back({std::string_view(reinterpret_cast<const char*>(data_.data() + cursor_), length), hash});
+        cursor_ += length;
+    }
+    strings_ = std::move(strings);
+}
+
+string_t BinaryLoader::string_at(uint32_t index) {
+    if (!strings_ || index >= strings_->size()) {
+        throw BinaryLoaderError("String table index is out of bounds.");
+    }
+    string_t str = index < interned_.size() ? interned_[index] : heap_->new_string((*strings_)[index]);
+    if (str == nullptr) {
+        throw BinaryLoaderError("String table hash mismatch.");
+    }
+    return str;
+}
+
+Value BinaryLoader::read_constant(uint32_t slot, std::vector<ProtoRelocation>& relocations) {
     ConstantTag tag = static_cast<ConstantTag>(read_u8());
     switch (tag) {
         case ConstantTag::NULL_T:   return Value(null_t{});
         case ConstantTag::INT_T:    return Value(static_cast<int64_t>(read_u64()));
         case ConstantTag::FLOAT_T:  return Value(read_f64());
         case ConstantTag::STRING_T: return Value(read_string());
+        case ConstantTag::STRING_REF_T: return Value(string_at(read_u32()));
         case ConstantTag::PROTO_REF_T: {
-            uint32_t proto_index = read_u32();
-            std::string ref_str = "::proto_ref_idx::" + std::to_string(proto_index);
-            return Value(heap_->new_string(ref_str)); 
+            // Proto đích có thể chưa được đọc: để null, link_prototypes vá lại theo relocation
+            relocations.push_back(ProtoRelocation{slot, read_u32()});
+            return Value(null_t{});
+        }
+        default:
+            throw BinaryLoaderError("Unknown constant tag in binary file.");
+    }
+}
+
+// Bỏ qua một hằng số mà không cấp phát gì, để dựng stub
+void BinaryLoader::skip_constant() {
+    ConstantTag tag = static_cast<ConstantTag>(read_u8());
+    switch (tag) {
+        case ConstantTag::NULL_T:
+            return;
+        case ConstantTag::INT_T:
+        case ConstantTag::FLOAT_T:
+            check_can_read(8);
+            cursor_ += 8;
+            return;
+        case ConstantTag::STRING_T: {
+            uint32_t length = read_u32();
+            check_can_read(length);
+            cursor_ += length;
+            return;
         }
+        case ConstantTag::PROTO_REF_T:
+        case ConstantTag::STRING_REF_T:
+            (void)read_u32();
+            return;
         default:
             throw BinaryLoaderError("Unknown constant tag in binary file.");
     }
 }
 
+BinaryLoader::PrototypeRecord BinaryLoader::read_record() {
+    PrototypeRecord record;
+    record.num_registers = read_u32();
+    record.num_upvalues = read_u32();
+    uint32_t name_idx_in_pool = read_u32();
+
+    uint32_t constant_pool_size = read_u32();
+    record.constants.reserve(constant_pool_size);
+    for (uint32_t i = 0; i < constant_pool_size; ++i) {
+        record.constants.push_back(read_constant(i, record.relocations));
+    }
+    
+    if (name_idx_in_pool >= record.constants.size() || !record.constants[name_idx_in_pool].is_string()) {
+        throw BinaryLoaderError("Invalid function prototype name index.");
+    }
+    record.name = record.constants[name_idx_in_pool].as_string();
+
+    uint32_t upvalue_desc_count = read_u32();
+    if (upvalue_desc_count != record.num_upvalues) {
+         throw BinaryLoaderError("Upvalue count mismatch.");
+    }
+    record.upvalue_descs.reserve(upvalue_desc_count);
+    for (uint32_t i = 0; i < upvalue_desc_count; ++i) {
+        bool is_local = (read_u8() == 1);
+        uint32_t index = read_u32();
+        record.upvalue_descs.emplace_back(is_local, index);
+    }
+
+    uint32_t bytecode_size = read_u32();
+    check_can_read(bytecode_size);
+    record.bytecode = data_.subspan(cursor_, bytecode_size);
+    cursor_ += bytecode_size;
+
+    if (optimized_) {
+        uint32_t region_count = read_u32();
+        check_can_read(static_cast<size_t>(region_count) * 12);
+        record.exception_table.reserve(region_count);
+        for (uint32_t i = 0; i < region_count; ++i) {
+            uint32_t start = read_u32();
+            uint32_t end = read_u32();
+            uint32_t handler = read_u32();
+            record.exception_table.push_back(ExceptionRegion{start, end, handler});
+        }
+    }
+    return record;
+}
+
+Chunk BinaryLoader::make_chunk(PrototypeRecord& record) {
+    // Tệp v1: toán hạng cố định 16-bit, nhảy tuyệt đối, phải mã hoá lại sang dạng gọn (nên không chạy thẳng trên tệp được)
+    if (fixed_width_code_) {
+        std::vector<Instruction> instructions;
+        std::vector<uint8_t> code;
+        if (!decode_fixed_width_code(record.bytecode.data(), record.bytecode.size(), instructions) || !encode_code(instructions, code)) {
+            throw BinaryLoaderError(std::format("Invalid bytecode in prototype '{}'.", record.name->c_str()));
+        }
+        return Chunk(std::move(code), std::move(record.constants));
+    }
+    // Nạp từ tệp được map thì chunk chạy thẳng trên các byte của tệp, chỉ chép khi optimizer sửa code
+    if (file_) return Chunk(record.bytecode, file_, std::move(record.constants));
+    return Chunk(std::vector<uint8_t>(record.bytecode.begin(), record.bytecode.end()), std::move(record.constants));
+}
+
+void BinaryLoader::add_relocations(proto_t proto, const PrototypeRecord& record) {
+    for (const ProtoRelocation& relocation : record.relocations) relocations_.emplace_back(proto, relocation);
+}
+
 proto_t BinaryLoader::read_prototype() {
+    PrototypeRecord record = read_record();
+    proto_t proto = heap_->new_proto(record.num_registers, record.num_upvalues, record.name, make_chunk(record), std::move(record.upvalue_descs));
+    proto->set_exception_table(std::move(record.exception_table));
+    add_relocations(proto, record);
+    return proto;
+}
+
+// Stub chỉ có những gì CLOSURE và lời gọi cần trước khi đọc thân: kích thước frame, upvalue và tên
+proto_t BinaryLoader::read_stub() {
     uint32_t num_registers = read_u32();
     uint32_t num_upvalues = read_u32();
     uint32_t name_idx_in_pool = read_u32();
 
     uint32_t constant_pool_size = read_u32();
-    std::vector<Value> constants;
-    constants.reserve(constant_pool_size);
+    string_t name = nullptr;
     for (uint32_t i = 0; i < constant_pool_size; ++i) {
-        constants.push_back(read_constant());
+        ConstantTag tag = cursor_ < data_.size() ? static_cast<ConstantTag>(data_[cursor_]) : ConstantTag::NULL_T;
+        if (i == name_idx_in_pool && tag == ConstantTag::STRING_T) {
+            ++cursor_;
+            name = read_string();
+        } else if (i == name_idx_in_pool && tag == ConstantTag::STRING_REF_T) {
+            ++cursor_;
+            name = string_at(read_u32());
+        } else {
+            skip_constant();
+        }
     }
-    
-    if (name_idx_in_pool >= constants.size() || !constants[name_idx_in_pool].is_string()) {
+    if (name == nullptr) {
         throw BinaryLoaderError("Invalid function prototype name index.");
     }
-    string_t name = constants[name_idx_in_pool].as_string();
 
     uint32_t upvalue_desc_count = read_u32();
     if (upvalue_desc_count != num_upvalues) {
@@ -123,70 +356,119 @@ proto_t BinaryLoader::read_prototype() {
         uint32_t index = read_u32();
         upvalue_descs.emplace_back(is_local, index);
     }
-
-    uint32_t bytecode_size = read_u32();
-    check_can_read(bytecode_size);
-    std::vector<uint8_t> bytecode(data_.data() + cursor_, data_.data() + cursor_ + bytecode_size);
-    cursor_ += bytecode_size;
-    
-    Chunk chunk(std::move(bytecode), std::move(constants));
-    return heap_->new_proto(num_registers, num_upvalues, name, std::move(chunk), std::move(upvalue_descs));
+    return heap_->new_proto(num_registers, num_upvalues, name, Chunk{}, std::move(upvalue_descs));
 }
 
-void BinaryLoader::check_magic() {
+uint32_t BinaryLoader::check_magic() {
     if (read_u32() != MAGIC_NUMBER) {
         throw BinaryLoaderError("Not a valid Meow bytecode file (magic number mismatch).");
     }
     uint32_t version = read_u32();
-    if (version != FORMAT_VERSION) {
+    if (version < MIN_FORMAT_VERSION || version > FORMAT_VERSION) {
         throw BinaryLoaderError(
-            std::format("Bytecode version mismatch. File is v{}, VM supports v{}. Please recompile.", 
-                        version, FORMAT_VERSION)
+            std::format("Bytecode version mismatch. File is v{}, VM supports v{} to v{}. Please recompile.", 
+                        version, MIN_FORMAT_VERSION, FORMAT_VERSION)
         );
     }
+    return version;
 }
 
-void BinaryLoader::link_prototypes() {    
-    const std::string ref_prefix = "::proto_ref_idx::";
-    for (proto_t proto : loaded_protos_) {
-        Chunk& chunk = const_cast<Chunk&>(proto->get_chunk()); 
-        for (size_t i = 0; i < chunk.get_pool_size(); ++i) {
-            Value& constant_ref = chunk.get_constant_ref(i); 
-            
-            if (constant_ref.is_string()) {
-                std::string_view s = constant_ref.as_string()->c_str();
-                if (s.rfind(ref_prefix, 0) == 0) {
-                    uint32_t proto_index = std::stoul(std::string(s.substr(ref_prefix.size())));
-                    if (proto_index >= loaded_protos_.size()) {
-                        throw BinaryLoaderError("Invalid prototype reference in constant pool.");
-                    }
-                    constant_ref = Value(loaded_protos_[proto_index]);
-                }
-            }
+void BinaryLoader::read_flags() {
+    uint32_t flags = read_u32();
+    if ((flags & ~FLAG_OPTIMIZED) != 0) {
+        throw BinaryLoaderError(std::format("Unknown bytecode file flags 0x{:x}. Please recompile.", flags));
+    }
+    optimized_ = (flags & FLAG_OPTIMIZED) != 0;
+    if (optimized_ && read_u32() != OPTIMIZED_CODE_VERSION) {
+        throw BinaryLoaderError("Pre-optimized bytecode was written for another VM version. Please recompile.");
+    }
+}
+
+std::vector<uint32_t> BinaryLoader::read_offsets(uint32_t prototype_count) {
+    check_can_read(static_cast<size_t>(prototype_count) * 4);
+    std::vector<uint32_t> offsets(prototype_count);
+    for (uint32_t& offset : offsets) {
+        offset = read_u32();
+        if (offset >= data_.size()) {
+            throw BinaryLoaderError("Prototype offset is out of bounds.");
         }
     }
+    return offsets;
+}
+
+proto_t BinaryLoader::resolve_proto(uint32_t index) {
+    if (bodies_) {
+        if (index >= bodies_->size()) {
+            throw BinaryLoaderError("Invalid prototype reference in constant pool.");
+        }
+        return bodies_->proto_at(index);
+    }
+    if (index >= loaded_protos_.size()) {
+        throw BinaryLoaderError("Invalid prototype reference in constant pool.");
+    }
+    return loaded_protos_[index];
+}
+
+void BinaryLoader::link_prototypes() {
+    for (const auto& [proto, relocation] : relocations_) {
+        proto->get_chunk().get_constant_ref(relocation.constant) = Value(resolve_proto(relocation.proto));
+    }
+    relocations_.clear();
 }
 
 proto_t BinaryLoader::load_module() {
-    check_magic();
-    
+    GCPause pause(heap_);
+    uint32_t version = check_magic();
+    fixed_width_code_ = version < COMPACT_CODE_VERSION;
+    if (version >= FLAGS_VERSION) read_flags();
+
     uint32_t main_proto_index = read_u32();
     uint32_t prototype_count = read_u32();
     
     if (prototype_count == 0) {
         throw BinaryLoaderError("No prototypes found in bytecode file.");
     }
+    if (main_proto_index >= prototype_count) {
+        throw BinaryLoaderError("Main prototype index is out of bounds.");
+    }
+    std::vector<uint32_t> offsets;
+    if (version >= OFFSET_TABLE_VERSION) offsets = read_offsets(prototype_count);
+    if (version >= STRING_TABLE_VERSION) read_string_table();
+
+    // Nạp lười: chỉ đọc main, các proto khác là stub đến lần gọi đầu tiên; string được intern khi proto cần tới
+    if (lazy_ && file_ && !offsets.empty()) {
+        cursor_ = offsets[main_proto_index];
+        bodies_ = std::make_shared<LazyBodies>(heap_, file_, options_, optimized_, std::move(offsets), strings_);
+        proto_t main_proto = read_prototype();
+        bodies_->adopt(main_proto, main_proto_index, false);
+        loaded_protos_.push_back(main_proto);
+        link_prototypes();
+
+        InlineCandidates globals;
+        if (!optimized_) {
+            globals = find_inline_candidates(loaded_protos_);
+            bodies_->remember_inline_candidates(globals);
+        }
+        prepare_proto(main_proto, optimized_, options_, globals);
+        return main_proto;
+    }
     
+    // Nạp hết: intern cả bảng string một lượt, mỗi string một lần dù bao nhiêu proto dùng nó
+    if (strings_) interned_ = heap_->intern_strings(*strings_);
+
     loaded_protos_.reserve(prototype_count);
     for (uint32_t i = 0; i < prototype_count; ++i) {
+        if (!offsets.empty()) cursor_ = offsets[i];
         loaded_protos_.push_back(read_prototype());
     }
     
-    if (main_proto_index >= loaded_protos_.size()) {
-        throw BinaryLoaderError("Main prototype index is out of bounds.");
-    }
-    
     link_prototypes();
+
+    // Chỉ tối ưu sau khi link, lúc đó CLOSURE mới trỏ tới proto thật để biết register nào bị bắt giữ
+    InlineCandidates globals = optimized_ ? InlineCandidates{} : find_inline_candidates(loaded_protos_);
+    for (proto_t proto : loaded_protos_) {
+        prepare_proto(proto, optimized_, options_, globals);
+    }
     
     return loaded_protos_[main_proto_index];
 }
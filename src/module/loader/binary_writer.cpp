@@ -0,0 +1,161 @@
+#include "module/loader/binary_writer.h"
+
+#include "core/objects/function.h"
+#include "core/objects/string.h"
+#include "core/value.h"
+#include "module/loader/binary_format.h"
+#include "module/loader/binary_loader.h"
+#include "utils/string/string_hash.h"
+
+namespace meow::loader {
+
+using namespace meow::core;
+using namespace meow::core::objects;
+
+namespace {
+class Output {
+public:
+    void u8(uint8_t value) {
+        bytes_.push_back(value);
+    }
+    void u32(uint32_t value) {
+        for (int i = 0; i < 4; ++i) bytes_.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+    void u64(uint64_t value) {
+        for (int i = 0; i < 8; ++i) bytes_.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+    void raw(const uint8_t* data, size_t size) {
+        bytes_.insert(bytes_.end(), data, data + size);
+    }
+    void text(std::string_view text) {
+        raw(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    }
+    /// @brief Overwrites a u32 written earlier at `offset`
+    void patch_u32(size_t offset, uint32_t value) {
+        for (int i = 0; i < 4; ++i) bytes_[offset + i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+    [[nodiscard]] size_t size() const noexcept {
+        return bytes_.size();
+    }
+    [[nodiscard]] std::vector<uint8_t> take() noexcept {
+        return std::move(bytes_);
+    }
+private:
+    std::vector<uint8_t> bytes_;
+};
+
+uint32_t checked_u32(size_t value, const char* what) {
+    if (value > std::numeric_limits<uint32_t>::max()) throw BinaryLoaderError(std::string(what) + " does not fit in a .meowb file.");
+    return static_cast<uint32_t>(value);
+}
+}  // namespace
+
+std::vector<uint8_t> write_optimized_module(proto_t main_proto) {
+    std::vector<proto_t> protos = collect_protos(main_proto);
+    std::unordered_map<proto_t, uint32_t> proto_index;
+    for (size_t i = 0; i < protos.size(); ++i) proto_index.emplace(protos[i], static_cast<uint32_t>(i));
+
+    // Bảng string chung của module, mỗi string một lần, theo thứ tự gặp lần đầu
+    std::vector<std::string_view> strings;
+    std::unordered_map<std::string_view, uint32_t> string_index;
+    auto intern = [&](string_t str) {
+        std::string_view text(str->c_str(), str->size());
+        auto [it, added] = string_index.try_emplace(text, static_cast<uint32_t>(strings.size()));
+        if (added) strings.push_back(text);
+        return it->second;
+    };
+    for (proto_t proto : protos) {
+        const auto& chunk = proto->get_chunk();
+        for (size_t i = 0; i < chunk.get_pool_size(); ++i) {
+            if (chunk.get_constant(i).is_string()) (void)intern(chunk.get_constant(i).as_string());
+        }
+        if (proto->get_name()) (void)intern(proto->get_name());
+    }
+
+    Output out;
+    out.u32(MAGIC_NUMBER);
+    out.u32(FORMAT_VERSION);
+    out.u32(FLAG_OPTIMIZED);
+    out.u32(OPTIMIZED_CODE_VERSION);
+    out.u32(0);  // Main proto: collect_protos() đặt nó đầu tiên
+    out.u32(checked_u32(protos.size(), "Prototype count"));
+    size_t offsets_at = out.size();
+    for (size_t i = 0; i < protos.size(); ++i) out.u32(0);
+
+    out.u32(checked_u32(strings.size(), "String table"));
+    for (std::string_view text : strings) {
+        out.u64(utils::string::hash_string(text));
+        out.u32(checked_u32(text.size(), "String"));
+        out.text(text);
+    }
+
+    for (size_t index = 0; index < protos.size(); ++index) {
+        proto_t proto = protos[index];
+        const auto& chunk = proto->get_chunk();
+        out.patch_u32(offsets_at + 4 * index, checked_u32(out.size(), "Module"));
+
+        // Tên phải là một hằng số của pool; proto không có sẵn thì thêm vào cuối, code không bao giờ đọc tới
+        size_t pool_size = chunk.get_pool_size();
+        size_t name_slot = pool_size;
+        string_t name = proto->get_name();
+        for (size_t i = 0; i < pool_size && name != nullptr; ++i) {
+            if (chunk.get_constant(i).is_string() && chunk.get_constant(i).as_string() == name) {
+                name_slot = i;
+                break;
+            }
+        }
+        out.u32(checked_u32(proto->get_num_registers(), "Frame size"));
+        out.u32(checked_u32(proto->get_num_upvalues(), "Upvalue count"));
+        out.u32(checked_u32(name_slot, "Constant pool"));
+        out.u32(checked_u32(pool_size + (name_slot == pool_size), "Constant pool"));
+        for (size_t i = 0; i < pool_size; ++i) {
+            Value constant = chunk.get_constant(i);
+            if (constant.is_null()) {
+                out.u8(static_cast<uint8_t>(ConstantTag::NULL_T));
+            } else if (constant.is_int()) {
+                out.u8(static_cast<uint8_t>(ConstantTag::INT_T));
+                out.u64(static_cast<uint64_t>(constant.as_int()));
+            } else if (constant.is_float()) {
+                out.u8(static_cast<uint8_t>(ConstantTag::FLOAT_T));
+                out.u64(std::bit_cast<uint64_t>(constant.as_float()));
+            } else if (constant.is_string()) {
+                out.u8(static_cast<uint8_t>(ConstantTag::STRING_REF_T));
+                out.u32(intern(constant.as_string()));
+            } else if (constant.is_proto() && proto_index.contains(constant.as_proto())) {
+                out.u8(static_cast<uint8_t>(ConstantTag::PROTO_REF_T));
+                out.u32(proto_index.at(constant.as_proto()));
+            } else {
+                throw BinaryLoaderError(std::format("Constant {} of a prototype cannot be written to a .meowb file.", i));
+            }
+        }
+        if (name_slot == pool_size && name != nullptr) {
+            out.u8(static_cast<uint8_t>(ConstantTag::STRING_REF_T));
+            out.u32(intern(name));
+        } else if (name_slot == pool_size) {
+            // Proto vô danh vẫn cần một string làm tên
+            constexpr std::string_view anonymous = "<anonymous>";
+            out.u8(static_cast<uint8_t>(ConstantTag::STRING_T));
+            out.u32(static_cast<uint32_t>(anonymous.size()));
+            out.text(anonymous);
+        }
+
+        out.u32(checked_u32(proto->get_num_upvalues(), "Upvalue count"));
+        for (size_t i = 0; i < proto->get_num_upvalues(); ++i) {
+            const UpvalueDesc& desc = proto->get_desc(i);
+            out.u8(desc.is_local_ ? 1 : 0);
+            out.u32(checked_u32(desc.index_, "Upvalue index"));
+        }
+
+        out.u32(checked_u32(chunk.get_code_size(), "Bytecode"));
+        out.raw(chunk.get_code(), chunk.get_code_size());
+
+        out.u32(checked_u32(proto->get_exception_table().size(), "Exception table"));
+        for (const ExceptionRegion& region : proto->get_exception_table()) {
+            out.u32(region.start_);
+            out.u32(region.end_);
+            out.u32(region.handler_);
+        }
+    }
+    return out.take();
+}
+}  // namespace meow::loader
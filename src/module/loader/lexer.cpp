@@ -20,6 +20,9 @@ static const std::array<std::string_view, static_cast<size_t>(meow::core::OpCode
         "GET_INDEX",  "SET_INDEX",     "GET_KEYS",      "GET_VALUES", "NEW_CLASS",  "NEW_INSTANCE", "GET_PROP",    "SET_PROP",  "SET_METHOD",
         "INHERIT",    "GET_SUPER",     "BIT_AND",       "BIT_OR",     "BIT_XOR",    "BIT_NOT",      "LSHIFT",      "RSHIFT",    "THROW",
         "SETUP_TRY",  "POP_TRY",       "IMPORT_MODULE", "EXPORT",     "GET_EXPORT", "IMPORT_ALL",
+        "JUMP_IF_EQ", "JUMP_IF_NEQ",   "JUMP_IF_LT",    "JUMP_IF_LE", "JUMP_IF_NOT_LT", "JUMP_IF_NOT_LE",
+        "FOR_PREP",   "FOR_LOOP",      "FOR_IN",        "ITER_NEW",   "ITER_NEXT",
+        "TAIL_CALL",  "LOAD_SMALLINT",
     };
     std::sort(array.begin(), array.end());
     return array;
@@ -0,0 +1,49 @@
+#include "module/loader/mapped_file.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MEOW_HAS_MMAP 1
+#else
+#define MEOW_HAS_MMAP 0
+#endif
+
+namespace meow::loader {
+
+MappedFile::~MappedFile() noexcept {
+#if MEOW_HAS_MMAP
+    if (mapped_) munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+}
+
+std::shared_ptr<const MappedFile> MappedFile::open(const std::filesystem::path& path) {
+    std::shared_ptr<MappedFile> file(new MappedFile());
+#if MEOW_HAS_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+    struct stat info {};
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        // MAP_PRIVATE + PROT_READ: các process chạy cùng tệp dùng chung page cache, không ai ghi được vào
+        void* memory = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (memory != MAP_FAILED) {
+            ::close(fd);
+            file->data_ = static_cast<const uint8_t*>(memory);
+            file->size_ = static_cast<size_t>(info.st_size);
+            file->mapped_ = true;
+            return file;
+        }
+    }
+    ::close(fd);
+#endif
+    // Không map được (tệp rỗng, pipe, nền tảng không có mmap): đọc cả tệp vào buffer như trước
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream.is_open()) return nullptr;
+    file->buffer_.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    if (stream.bad()) return nullptr;
+    file->data_ = file->buffer_.data();
+    file->size_ = file->buffer_.size();
+    return file;
+}
+}  // namespace meow::loader
@@ -70,7 +70,20 @@ static const std::unordered_map<std::string_view, OpCode> OP_MAP = {{"LOAD_CONST
                                                                     {"IMPORT_MODULE", OpCode::IMPORT_MODULE},
                                                                     {"EXPORT", OpCode::EXPORT},
                                                                     {"GET_EXPORT", OpCode::GET_EXPORT},
-                                                                    {"IMPORT_ALL", OpCode::IMPORT_ALL}};
+                                                                    {"IMPORT_ALL", OpCode::IMPORT_ALL},
+                                                                    {"JUMP_IF_EQ", OpCode::JUMP_IF_EQ},
+                                                                    {"JUMP_IF_NEQ", OpCode::JUMP_IF_NEQ},
+                                                                    {"JUMP_IF_LT", OpCode::JUMP_IF_LT},
+                                                                    {"JUMP_IF_LE", OpCode::JUMP_IF_LE},
+                                                                    {"JUMP_IF_NOT_LT", OpCode::JUMP_IF_NOT_LT},
+                                                                    {"JUMP_IF_NOT_LE", OpCode::JUMP_IF_NOT_LE},
+                                                                    {"FOR_PREP", OpCode::FOR_PREP},
+                                                                    {"FOR_LOOP", OpCode::FOR_LOOP},
+                                                                    {"FOR_IN", OpCode::FOR_IN},
+                                                                    {"ITER_NEW", OpCode::ITER_NEW},
+                                                                    {"ITER_NEXT", OpCode::ITER_NEXT},
+                                                                    {"TAIL_CALL", OpCode::TAIL_CALL},
+                                                                    {"LOAD_SMALLINT", OpCode::LOAD_SMALLINT}};
 
 TextParser::TextParser(meow::memory::MemoryManager* h, const std::vector<Token>& t, std::string_view s) noexcept : heap_(h), src_name_(s), toks_(t), ti_(0) {
 }
@@ -383,7 +396,6 @@ Result<void> TextParser::instr() {
     if (it == OP_MAP.end()) return Result<void>::Err(mkdiag(ErrCode::INVALID_IDENT, "Opcode không hợp lệ.", &opT));
     OpCode op = it->second;
     PData& d = *cur_;
-    size_t pos = d.code.size();
     d.wb(static_cast<uint8_t>(op));
 
     auto rd_u16 = [&](const Token*& outTk) -> Result<uint16_t> {
@@ -431,17 +443,19 @@ Result<void> TextParser::instr() {
     };
     auto rd_addr_or_lbl = [&]() -> Result<void> {
         const Token& tk = cur_tok();
+        // Địa chỉ dạng số là chỉ số lệnh trong hàm (không phải offset byte), giống nhãn
         if (tk.type == TokenType::NUMBER_INT) {
-            const Token* tmp = nullptr;
-            auto r = rd_u16(tmp);
-            if (!r.ok) return Result<void>::Err(r.diag);
-            d.wu16(r.val);
+            adv();
+            uint32_t v;
+            auto r = std::from_chars(tk.lexeme.data(), tk.lexeme.data() + tk.lexeme.size(), v);
+            if (r.ec != std::errc() || r.ptr != tk.lexeme.data() + tk.lexeme.size())
+                return Result<void>::Err(mkdiag(ErrCode::OUT_OF_RANGE, "Địa chỉ nhảy phải là chỉ số lệnh 32-bit không dấu hợp lệ.", &tk));
+            d.waddr(v);
             return Result<void>::Ok();
         } else if (tk.type == TokenType::IDENTIFIER) {
             adv();
-            size_t patch_at = d.code.size();
-            d.wu16(0xDEAD);
-            d.pending.emplace_back(pos, patch_at, tk.lexeme);
+            d.waddr(0);
+            d.pending.emplace_back(d.code.size() - 1, tk.lexeme);
             return Result<void>::Ok();
         } else
             return Result<void>::Err(mkdiag(ErrCode::INVALID_NUMBER, "Mong đợi nhãn hoặc địa chỉ cho lệnh nhảy.", &tk));
@@ -514,7 +528,8 @@ Result<void> TextParser::instr() {
         case OpCode::GET_UPVALUE:
         case OpCode::NEW_INSTANCE:
         case OpCode::GET_KEYS:
-        case OpCode::GET_VALUES: {
+        case OpCode::GET_VALUES:
+        case OpCode::ITER_NEW: {
             const Token* t = nullptr;
             auto a = rd_u16(t);
             if (!a.ok) return Result<void>::Err(a.diag);
@@ -553,6 +568,19 @@ Result<void> TextParser::instr() {
             d.wu64(std::bit_cast<uint64_t>(vi.val));
             return Result<void>::Ok();
         }
+        case OpCode::LOAD_SMALLINT: {
+            const Token* t = nullptr;
+            auto dst = rd_u16(t);
+            if (!dst.ok) return Result<void>::Err(dst.diag);
+            const Token& vt = cur_tok();
+            auto vi = rd_i64();
+            if (!vi.ok) return Result<void>::Err(vi.diag);
+            if (vi.val < std::numeric_limits<int16_t>::min() || vi.val > std::numeric_limits<int16_t>::max())
+                return Result<void>::Err(mkdiag(ErrCode::OUT_OF_RANGE, "LOAD_SMALLINT chỉ nhận số nguyên 16-bit có dấu, dùng LOAD_INT cho giá trị lớn hơn.", &vt));
+            d.wu16(dst.val);
+            d.wu16(static_cast<uint16_t>(static_cast<int16_t>(vi.val)));
+            return Result<void>::Ok();
+        }
         case OpCode::LOAD_FLOAT: {
             const Token* t = nullptr;
             auto dst = rd_u16(t);
@@ -668,7 +696,10 @@ Result<void> TextParser::instr() {
             return Result<void>::Ok();
         }
         case OpCode::JUMP_IF_FALSE:
-        case OpCode::JUMP_IF_TRUE: {
+        case OpCode::JUMP_IF_TRUE:
+        case OpCode::FOR_PREP:
+        case OpCode::FOR_LOOP:
+        case OpCode::FOR_IN: {
             const Token* tmp = nullptr;
             auto a = rd_u16(tmp);
             if (!a.ok) return Result<void>::Err(a.diag);
@@ -677,6 +708,41 @@ Result<void> TextParser::instr() {
             if (!rr.ok) return rr;
             return Result<void>::Ok();
         }
+        case OpCode::JUMP_IF_EQ:
+        case OpCode::JUMP_IF_NEQ:
+        case OpCode::JUMP_IF_LT:
+        case OpCode::JUMP_IF_LE:
+        case OpCode::JUMP_IF_NOT_LT:
+        case OpCode::JUMP_IF_NOT_LE: {
+            const Token* ta = nullptr;
+            auto a = rd_u16(ta);
+            if (!a.ok) return Result<void>::Err(a.diag);
+            d.wu16(a.val);
+            const Token* tb = nullptr;
+            auto b = rd_u16(tb);
+            if (!b.ok) return Result<void>::Err(b.diag);
+            d.wu16(b.val);
+            auto rr = rd_addr_or_lbl();
+            if (!rr.ok) return rr;
+            return Result<void>::Ok();
+        }
+        case OpCode::ITER_NEXT: {
+            const Token* ta = nullptr;
+            auto a = rd_u16(ta);
+            if (!a.ok) return Result<void>::Err(a.diag);
+            d.wu16(a.val);
+            const Token* tb = nullptr;
+            auto b = rd_u16(tb);
+            if (!b.ok) return Result<void>::Err(b.diag);
+            d.wu16(b.val);
+            const Token* tc = nullptr;
+            auto c = rd_u16(tc);
+            if (!c.ok) return Result<void>::Err(c.diag);
+            d.wu16(c.val);
+            auto rr = rd_addr_or_lbl();
+            if (!rr.ok) return rr;
+            return Result<void>::Ok();
+        }
         case OpCode::CALL: {
             const Token* ta = nullptr;
             auto a = rd_u16(ta);
@@ -696,7 +762,8 @@ Result<void> TextParser::instr() {
             d.wu16(dpar.val);
             return Result<void>::Ok();
         }
-        case OpCode::CALL_VOID: {
+        case OpCode::CALL_VOID:
+        case OpCode::TAIL_CALL: {
             const Token* ta = nullptr;
             auto a = rd_u16(ta);
             if (!a.ok) return Result<void>::Err(a.diag);
@@ -790,14 +857,10 @@ Result<meow::core::value_t> TextParser::parse_const_val() {
 }
 
 Result<void> TextParser::resolve_labels(PData& d) {
-    for (const auto& pj : d.pending) {
-        size_t patch = std::get<1>(pj);
-        std::string_view lbl = std::get<2>(pj);
+    for (const auto& [index, lbl] : d.pending) {
         auto it = d.labels.find(lbl);
         if (it == d.labels.end()) return Result<void>::Err(mkdiag(ErrCode::LABEL_NOT_FOUND, "Không tìm thấy nhãn '" + std::string(lbl) + "' trong hàm '" + d.name + "'.", nullptr));
-        size_t addr = it->second;
-        if (addr > UINT16_MAX) return Result<void>::Err(mkdiag(ErrCode::OUT_OF_RANGE, "Địa chỉ nhãn vượt quá giới hạn 16-bit.", nullptr));
-        if (!d.patch_u16(patch, static_cast<uint16_t>(addr))) return Result<void>::Err(mkdiag(ErrCode::INTERNAL_ERROR, "Không thể patch địa chỉ nhảy.", nullptr));
+        d.code[index].set_address(static_cast<uint32_t>(it->second));
     }
     d.pending.clear();
     return Result<void>::Ok();
@@ -825,7 +888,10 @@ std::vector<meow::core::value_t> TextParser::build_final_const_pool(PData& d) {
 meow::core::proto_t TextParser::build_proto(const std::string& name, PData& d) {
     string_t nm = heap_->new_string(name);
     auto final_consts = build_final_const_pool(d);
-    Chunk ck(std::move(d.code), std::move(final_consts));
+    // Khoảng cách nhảy chỉ biết sau khi đủ cả hàm: encode_code chọn dạng hẹp/WIDE cho từng lệnh
+    std::vector<uint8_t> code;
+    if (!meow::runtime::encode_code(d.code, code)) throw std::runtime_error("Địa chỉ nhảy nằm ngoài hàm hoặc hàm quá lớn: " + name);
+    Chunk ck(std::move(code), std::move(final_consts));
     auto udesc = std::move(d.updesc);
     if (udesc.size() != d.nup) throw std::runtime_error("Lỗi nội bộ: upvalue desc mismatch for " + name);
     proto_t p = heap_->new_proto(d.nreg, d.nup, nm, std::move(ck), std::move(udesc));
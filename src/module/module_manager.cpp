@@ -74,7 +74,12 @@ module_t ModuleManager::load_module(string_t module_path_obj, string_t importer_
                 throw std::runtime_error("Hàm factory của module native '" + resolved_native_path +
                                          "' trả về null.");
             }
-            native_module->set_executed();
+            // Module do meow-aotc dịch có main proto: để IMPORT_MODULE chạy nó như module bytecode
+            if (native_module->is_has_main()) {
+                native_module->set_file_path(resolved_native_path_obj);
+            } else {
+                native_module->set_executed();
+            }
         } catch (const std::exception& e) {
             close_native_library(handle);
             throw std::runtime_error(
@@ -113,25 +118,16 @@ module_t ModuleManager::load_module(string_t module_path_obj, string_t importer_
         return it->second;
     }
 
-    std::ifstream file(binary_file_path, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
+    // Map tệp chỉ đọc: code của proto chạy thẳng trên page của tệp, tệp được giữ đến khi proto cuối cùng bị thu hồi
+    std::shared_ptr<const MappedFile> file = MappedFile::open(binary_file_path_fs);
+    if (!file) {
         throw std::runtime_error("Không thể mở tệp module (đã thử native và bytecode '" + 
                                  binary_file_path + "')");
     }
-    
-    std::streamsize size = file.tellg();
-    file.seekg(0, std::ios::beg);
-    
-    std::vector<uint8_t> buffer(static_cast<size_t>(size));
-    if (!file.read(reinterpret_cast<char*>(buffer.data()), size)) {
-         throw std::runtime_error("Không thể đọc tệp bytecode: " + binary_file_path);
-    }
-    
-    file.close();
 
     proto_t main_proto = nullptr;
     try {
-        BinaryLoader loader(heap_, buffer);
+        BinaryLoader loader(heap_, std::move(file), meow::runtime::OptimizerOptions::from_environment(), BinaryLoader::lazy_from_environment());
         main_proto = loader.load_module();
     } catch (const BinaryLoaderError& e) {
         throw std::runtime_error("Tệp bytecode bị hỏng hoặc không hợp lệ: " + 
@@ -0,0 +1,505 @@
+#include "runtime/array_kernels.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MEOW_ARRAY_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace meow::runtime;
+
+namespace meow::runtime::scalar_kernels {
+// Cộng/nhân int dùng unsigned để tràn số wrap giống phép toán của VM, không phải UB
+[[nodiscard]] inline int64_t wrap_add(int64_t a, int64_t b) noexcept {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+}
+[[nodiscard]] inline int64_t wrap_mul(int64_t a, int64_t b) noexcept {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+}
+
+int64_t sum_i64(const int64_t* data, size_t n) noexcept {
+    int64_t sum = 0;
+    for (size_t i = 0; i < n; ++i) sum = wrap_add(sum, data[i]);
+    return sum;
+}
+double sum_f64(const double* data, size_t n) noexcept {
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) sum += data[i];
+    return sum;
+}
+int64_t min_i64(const int64_t* data, size_t n) noexcept {
+    int64_t result = data[0];
+    for (size_t i = 1; i < n; ++i) result = data[i] < result ? data[i] : result;
+    return result;
+}
+double min_f64(const double* data, size_t n) noexcept {
+    double result = data[0];
+    for (size_t i = 1; i < n; ++i) result = data[i] < result ? data[i] : result;
+    return result;
+}
+int64_t max_i64(const int64_t* data, size_t n) noexcept {
+    int64_t result = data[0];
+    for (size_t i = 1; i < n; ++i) result = data[i] > result ? data[i] : result;
+    return result;
+}
+double max_f64(const double* data, size_t n) noexcept {
+    double result = data[0];
+    for (size_t i = 1; i < n; ++i) result = data[i] > result ? data[i] : result;
+    return result;
+}
+int64_t dot_i64(const int64_t* a, const int64_t* b, size_t n) noexcept {
+    int64_t sum = 0;
+    for (size_t i = 0; i < n; ++i) sum = wrap_add(sum, wrap_mul(a[i], b[i]));
+    return sum;
+}
+double dot_f64(const double* a, const double* b, size_t n) noexcept {
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+void fill_i64(int64_t* data, size_t n, int64_t value) noexcept {
+    for (size_t i = 0; i < n; ++i) data[i] = value;
+}
+void fill_f64(double* data, size_t n, double value) noexcept {
+    for (size_t i = 0; i < n; ++i) data[i] = value;
+}
+size_t index_of_i64(const int64_t* data, size_t n, int64_t value) noexcept {
+    for (size_t i = 0; i < n; ++i) {
+        if (data[i] == value) return i;
+    }
+    return ArrayKernels::npos;
+}
+size_t index_of_f64(const double* data, size_t n, double value) noexcept {
+    for (size_t i = 0; i < n; ++i) {
+        if (data[i] == value) return i;
+    }
+    return ArrayKernels::npos;
+}
+size_t mismatch_i64(const int64_t* a, const int64_t* b, size_t n) noexcept {
+    for (size_t i = 0; i < n; ++i) {
+        if (a[i] != b[i]) return i;
+    }
+    return ArrayKernels::npos;
+}
+size_t mismatch_f64(const double* a, const double* b, size_t n) noexcept {
+    for (size_t i = 0; i < n; ++i) {
+        if (a[i] != b[i]) return i;
+    }
+    return ArrayKernels::npos;
+}
+void add_i64(int64_t* out, const int64_t* in, size_t n, int64_t scalar) noexcept {
+    for (size_t i = 0; i < n; ++i) out[i] = wrap_add(in[i], scalar);
+}
+void add_f64(double* out, const double* in, size_t n, double scalar) noexcept {
+    for (size_t i = 0; i < n; ++i) out[i] = in[i] + scalar;
+}
+void mul_i64(int64_t* out, const int64_t* in, size_t n, int64_t scalar) noexcept {
+    for (size_t i = 0; i < n; ++i) out[i] = wrap_mul(in[i], scalar);
+}
+void mul_f64(double* out, const double* in, size_t n, double scalar) noexcept {
+    for (size_t i = 0; i < n; ++i) out[i] = in[i] * scalar;
+}
+}  // namespace meow::runtime::scalar_kernels
+
+#if MEOW_ARRAY_KERNELS_X86
+// SSE2 là baseline của x86-64 nên không cần target attribute.
+// SSE2 không có so sánh/nhân int64, các kernel đó dùng lại bản scalar
+namespace meow::runtime::sse2_kernels {
+int64_t sum_i64(const int64_t* data, size_t n) noexcept {
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        acc = _mm_add_epi64(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+    }
+    alignas(16) int64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    int64_t sum = scalar_kernels::wrap_add(lanes[0], lanes[1]);
+    for (; i < n; ++i) sum = scalar_kernels::wrap_add(sum, data[i]);
+    return sum;
+}
+double sum_f64(const double* data, size_t n) noexcept {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_loadu_pd(data + i));
+        acc1 = _mm_add_pd(acc1, _mm_loadu_pd(data + i + 2));
+    }
+    __m128d acc = _mm_add_pd(acc0, acc1);
+    double sum = _mm_cvtsd_f64(_mm_add_sd(acc, _mm_unpackhi_pd(acc, acc)));
+    for (; i < n; ++i) sum += data[i];
+    return sum;
+}
+double min_f64(const double* data, size_t n) noexcept {
+    // Như bản scalar: NaN ở data[0] là kết quả, NaN ở chỗ khác bị bỏ qua. minpd/maxpd trả toán hạng thứ hai khi có NaN,
+    // nên accumulator khởi tạo từ data[0] (không phải NaN) sẽ không bao giờ thành NaN và không nuốt các phần tử sau
+    if (n < 2 || std::isnan(data[0])) return data[0];
+    __m128d acc = _mm_set1_pd(data[0]);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) acc = _mm_min_pd(_mm_loadu_pd(data + i), acc);
+    double result = _mm_cvtsd_f64(_mm_min_sd(_mm_unpackhi_pd(acc, acc), acc));
+    for (; i < n; ++i) result = data[i] < result ? data[i] : result;
+    return result;
+}
+double max_f64(const double* data, size_t n) noexcept {
+    if (n < 2 || std::isnan(data[0])) return data[0];
+    __m128d acc = _mm_set1_pd(data[0]);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) acc = _mm_max_pd(_mm_loadu_pd(data + i), acc);
+    double result = _mm_cvtsd_f64(_mm_max_sd(_mm_unpackhi_pd(acc, acc), acc));
+    for (; i < n; ++i) result = data[i] > result ? data[i] : result;
+    return result;
+}
+double dot_f64(const double* a, const double* b, size_t n) noexcept {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    __m128d acc = _mm_add_pd(acc0, acc1);
+    double sum = _mm_cvtsd_f64(_mm_add_sd(acc, _mm_unpackhi_pd(acc, acc)));
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+void fill_i64(int64_t* data, size_t n, int64_t value) noexcept {
+    __m128i v = _mm_set1_epi64x(value);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), v);
+    for (; i < n; ++i) data[i] = value;
+}
+void fill_f64(double* data, size_t n, double value) noexcept {
+    __m128d v = _mm_set1_pd(value);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) _mm_storeu_pd(data + i, v);
+    for (; i < n; ++i) data[i] = value;
+}
+size_t index_of_f64(const double* data, size_t n, double value) noexcept {
+    __m128d v = _mm_set1_pd(value);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        int mask = _mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(data + i), v));
+        if (mask) return i + static_cast<size_t>(std::countr_zero(static_cast<unsigned>(mask)));
+    }
+    for (; i < n; ++i) {
+        if (data[i] == value) return i;
+    }
+    return ArrayKernels::npos;
+}
+// Không có cmpeq_epi64 (SSE4.1): hai int64 bằng nhau khi cả hai nửa 32 bit bằng nhau, tức đủ 8 bit mask của lane
+size_t mismatch_i64(const int64_t* a, const int64_t* b, size_t n) noexcept {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi32(x, y));
+        if (mask != 0xFFFF) return i + ((mask & 0xFF) == 0xFF ? 1 : 0);
+    }
+    for (; i < n; ++i) {
+        if (a[i] != b[i]) return i;
+    }
+    return ArrayKernels::npos;
+}
+size_t mismatch_f64(const double* a, const double* b, size_t n) noexcept {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        int mask = _mm_movemask_pd(_mm_cmpneq_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        if (mask) return i + static_cast<size_t>(std::countr_zero(static_cast<unsigned>(mask)));
+    }
+    for (; i < n; ++i) {
+        if (a[i] != b[i]) return i;
+    }
+    return ArrayKernels::npos;
+}
+void add_i64(int64_t* out, const int64_t* in, size_t n, int64_t scalar) noexcept {
+    __m128i v = _mm_set1_epi64x(scalar);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi64(x, v));
+    }
+    for (; i < n; ++i) out[i] = scalar_kernels::wrap_add(in[i], scalar);
+}
+void add_f64(double* out, const double* in, size_t n, double scalar) noexcept {
+    __m128d v = _mm_set1_pd(scalar);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(in + i), v));
+    for (; i < n; ++i) out[i] = in[i] + scalar;
+}
+void mul_f64(double* out, const double* in, size_t n, double scalar) noexcept {
+    __m128d v = _mm_set1_pd(scalar);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(in + i), v));
+    for (; i < n; ++i) out[i] = in[i] * scalar;
+}
+}  // namespace meow::runtime::sse2_kernels
+
+// AVX2 chỉ được gọi sau khi CPUID xác nhận, nên mỗi hàm tự bật target riêng
+#define MEOW_AVX2 __attribute__((target("avx2")))
+namespace meow::runtime::avx2_kernels {
+MEOW_AVX2 int64_t sum_i64(const int64_t* data, size_t n) noexcept {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm256_add_epi64(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+    }
+    alignas(32) int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    int64_t sum = 0;
+    for (int64_t lane : lanes) sum = scalar_kernels::wrap_add(sum, lane);
+    for (; i < n; ++i) sum = scalar_kernels::wrap_add(sum, data[i]);
+    return sum;
+}
+MEOW_AVX2 double sum_f64(const double* data, size_t n) noexcept {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(data + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(data + i + 4));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < n; ++i) sum += data[i];
+    return sum;
+}
+MEOW_AVX2 int64_t min_i64(const int64_t* data, size_t n) noexcept {
+    if (n < 4) return scalar_kernels::min_i64(data, n);
+    __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        acc = _mm256_blendv_epi8(acc, x, _mm256_cmpgt_epi64(acc, x));
+    }
+    alignas(32) int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    int64_t result = scalar_kernels::min_i64(lanes, 4);
+    for (; i < n; ++i) result = data[i] < result ? data[i] : result;
+    return result;
+}
+MEOW_AVX2 int64_t max_i64(const int64_t* data, size_t n) noexcept {
+    if (n < 4) return scalar_kernels::max_i64(data, n);
+    __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        acc = _mm256_blendv_epi8(acc, x, _mm256_cmpgt_epi64(x, acc));
+    }
+    alignas(32) int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    int64_t result = scalar_kernels::max_i64(lanes, 4);
+    for (; i < n; ++i) result = data[i] > result ? data[i] : result;
+    return result;
+}
+MEOW_AVX2 double min_f64(const double* data, size_t n) noexcept {
+    if (n < 4) return scalar_kernels::min_f64(data, n);
+    // Accumulator không bao giờ là NaN, xem min_f64 của SSE2
+    if (std::isnan(data[0])) return data[0];
+    __m256d acc = _mm256_set1_pd(data[0]);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) acc = _mm256_min_pd(_mm256_loadu_pd(data + i), acc);
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, acc);
+    double result = scalar_kernels::min_f64(lanes, 4);
+    for (; i < n; ++i) result = data[i] < result ? data[i] : result;
+    return result;
+}
+MEOW_AVX2 double max_f64(const double* data, size_t n) noexcept {
+    if (n < 4) return scalar_kernels::max_f64(data, n);
+    if (std::isnan(data[0])) return data[0];
+    __m256d acc = _mm256_set1_pd(data[0]);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) acc = _mm256_max_pd(_mm256_loadu_pd(data + i), acc);
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, acc);
+    double result = scalar_kernels::max_f64(lanes, 4);
+    for (; i < n; ++i) result = data[i] > result ? data[i] : result;
+    return result;
+}
+MEOW_AVX2 double dot_f64(const double* a, const double* b, size_t n) noexcept {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+MEOW_AVX2 void fill_i64(int64_t* data, size_t n, int64_t value) noexcept {
+    __m256i v = _mm256_set1_epi64x(value);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), v);
+    for (; i < n; ++i) data[i] = value;
+}
+MEOW_AVX2 void fill_f64(double* data, size_t n, double value) noexcept {
+    __m256d v = _mm256_set1_pd(value);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm256_storeu_pd(data + i, v);
+    for (; i < n; ++i) data[i] = value;
+}
+MEOW_AVX2 size_t index_of_i64(const int64_t* data, size_t n, int64_t value) noexcept {
+    __m256i v = _mm256_set1_epi64x(value);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(x, v)));
+        if (mask) return i + static_cast<size_t>(std::countr_zero(static_cast<unsigned>(mask)));
+    }
+    for (; i < n; ++i) {
+        if (data[i] == value) return i;
+    }
+    return ArrayKernels::npos;
+}
+MEOW_AVX2 size_t index_of_f64(const double* data, size_t n, double value) noexcept {
+    __m256d v = _mm256_set1_pd(value);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(data + i), v, _CMP_EQ_OQ));
+        if (mask) return i + static_cast<size_t>(std::countr_zero(static_cast<unsigned>(mask)));
+    }
+    for (; i < n; ++i) {
+        if (data[i] == value) return i;
+    }
+    return ArrayKernels::npos;
+}
+MEOW_AVX2 size_t mismatch_i64(const int64_t* a, const int64_t* b, size_t n) noexcept {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(x, y))) ^ 0xF;
+        if (mask) return i + static_cast<size_t>(std::countr_zero(static_cast<unsigned>(mask)));
+    }
+    for (; i < n; ++i) {
+        if (a[i] != b[i]) return i;
+    }
+    return ArrayKernels::npos;
+}
+MEOW_AVX2 size_t mismatch_f64(const double* a, const double* b, size_t n) noexcept {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), _CMP_NEQ_UQ));
+        if (mask) return i + static_cast<size_t>(std::countr_zero(static_cast<unsigned>(mask)));
+    }
+    for (; i < n; ++i) {
+        if (a[i] != b[i]) return i;
+    }
+    return ArrayKernels::npos;
+}
+MEOW_AVX2 void add_i64(int64_t* out, const int64_t* in, size_t n, int64_t scalar) noexcept {
+    __m256i v = _mm256_set1_epi64x(scalar);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi64(x, v));
+    }
+    for (; i < n; ++i) out[i] = scalar_kernels::wrap_add(in[i], scalar);
+}
+MEOW_AVX2 void add_f64(double* out, const double* in, size_t n, double scalar) noexcept {
+    __m256d v = _mm256_set1_pd(scalar);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(in + i), v));
+    for (; i < n; ++i) out[i] = in[i] + scalar;
+}
+MEOW_AVX2 void mul_f64(double* out, const double* in, size_t n, double scalar) noexcept {
+    __m256d v = _mm256_set1_pd(scalar);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(in + i), v));
+    for (; i < n; ++i) out[i] = in[i] * scalar;
+}
+}  // namespace meow::runtime::avx2_kernels
+#undef MEOW_AVX2
+#endif
+
+namespace meow::runtime {
+const ArrayKernels& get_scalar_array_kernels() noexcept {
+    using namespace scalar_kernels;
+    static const ArrayKernels table{
+        "scalar", sum_i64, sum_f64, min_i64, min_f64, max_i64, max_f64, dot_i64, dot_f64,
+        fill_i64, fill_f64, index_of_i64, index_of_f64, mismatch_i64, mismatch_f64, add_i64, add_f64, mul_i64, mul_f64,
+    };
+    return table;
+}
+
+#if MEOW_ARRAY_KERNELS_X86
+namespace {
+const ArrayKernels& sse2_table() noexcept {
+    static const ArrayKernels table{
+        "sse2",
+        sse2_kernels::sum_i64,
+        sse2_kernels::sum_f64,
+        scalar_kernels::min_i64,
+        sse2_kernels::min_f64,
+        scalar_kernels::max_i64,
+        sse2_kernels::max_f64,
+        scalar_kernels::dot_i64,
+        sse2_kernels::dot_f64,
+        sse2_kernels::fill_i64,
+        sse2_kernels::fill_f64,
+        scalar_kernels::index_of_i64,
+        sse2_kernels::index_of_f64,
+        sse2_kernels::mismatch_i64,
+        sse2_kernels::mismatch_f64,
+        sse2_kernels::add_i64,
+        sse2_kernels::add_f64,
+        scalar_kernels::mul_i64,
+        sse2_kernels::mul_f64,
+    };
+    return table;
+}
+
+// AVX2 không có nhân int64 (cần AVX-512), nên dot/mul int dùng lại bản scalar
+const ArrayKernels& avx2_table() noexcept {
+    static const ArrayKernels table{
+        "avx2",
+        avx2_kernels::sum_i64,
+        avx2_kernels::sum_f64,
+        avx2_kernels::min_i64,
+        avx2_kernels::min_f64,
+        avx2_kernels::max_i64,
+        avx2_kernels::max_f64,
+        scalar_kernels::dot_i64,
+        avx2_kernels::dot_f64,
+        avx2_kernels::fill_i64,
+        avx2_kernels::fill_f64,
+        avx2_kernels::index_of_i64,
+        avx2_kernels::index_of_f64,
+        avx2_kernels::mismatch_i64,
+        avx2_kernels::mismatch_f64,
+        avx2_kernels::add_i64,
+        avx2_kernels::add_f64,
+        scalar_kernels::mul_i64,
+        avx2_kernels::mul_f64,
+    };
+    return table;
+}
+
+bool cpu_has_avx2() noexcept {
+    static const bool has_avx2 = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return has_avx2;
+}
+}  // namespace
+#endif
+
+const ArrayKernels& get_array_kernels() noexcept {
+#if MEOW_ARRAY_KERNELS_X86
+    return cpu_has_avx2() ? avx2_table() : sse2_table();
+#else
+    return get_scalar_array_kernels();
+#endif
+}
+
+std::vector<const ArrayKernels*> get_supported_array_kernels() {
+    std::vector<const ArrayKernels*> tables{&get_scalar_array_kernels()};
+#if MEOW_ARRAY_KERNELS_X86
+    tables.push_back(&sse2_table());
+    if (cpu_has_avx2()) tables.push_back(&avx2_table());
+#endif
+    return tables;
+}
+}  // namespace meow::runtime
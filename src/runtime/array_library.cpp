@@ -0,0 +1,260 @@
+#include "core/objects/array.h"
+#include "core/objects/native.h"
+#include "memory/memory_manager.h"
+#include "runtime/array_kernels.h"
+#include "runtime/builtin_registry.h"
+#include "vm/meow_vm.h"
+
+using namespace meow::core;
+using namespace meow::core::objects;
+using namespace meow::memory;
+
+namespace meow::runtime {
+namespace {
+[[noreturn]] void throw_array_error(std::string_view fn, std::string_view message) {
+    throw meow::vm::VMError(std::format("array.{}: {}", fn, message));
+}
+
+array_t expect_array(arguments_t args, size_t index, std::string_view fn) {
+    if (args.size() <= index || !args[index].is_array()) {
+        throw_array_error(fn, std::format("argument {} must be an array.", index + 1));
+    }
+    return args[index].as_array();
+}
+
+param_t expect_arg(arguments_t args, size_t index, std::string_view fn) {
+    if (args.size() <= index) throw_array_error(fn, std::format("missing argument {}.", index + 1));
+    return args[index];
+}
+
+double expect_number(param_t value, std::string_view fn) {
+    if (value.is_int()) return static_cast<double>(value.as_int());
+    if (value.is_float()) return value.as_float();
+    throw_array_error(fn, "element is not a number.");
+}
+
+// So sánh chặt: cùng kiểu và cùng giá trị, object so sánh theo con trỏ (string đã được intern)
+bool strict_equals(param_t lhs, param_t rhs) noexcept {
+    if (lhs.index() != rhs.index()) return false;
+    if (lhs.is_null()) return true;
+    if (lhs.is_bool()) return lhs.as_bool() == rhs.as_bool();
+    if (lhs.is_int()) return lhs.as_int() == rhs.as_int();
+    if (lhs.is_float()) return lhs.as_float() == rhs.as_float();
+    return lhs.as_object() == rhs.as_object();
+}
+
+Value array_sum(arguments_t args) {
+    array_t arr = expect_array(args, 0, "sum");
+    const ArrayKernels& kernels = get_array_kernels();
+    switch (arr->kind()) {
+        case ElementKind::INT:
+            return Value(kernels.sum_i64(arr->int_data(), arr->size()));
+        case ElementKind::FLOAT:
+            return Value(kernels.sum_f64(arr->float_data(), arr->size()));
+        default:
+            break;
+    }
+    int64_t int_sum = 0;
+    double float_sum = 0.0;
+    bool is_float = false;
+    for (size_t i = 0; i < arr->size(); ++i) {
+        Value element = arr->get(i);
+        if (element.is_int() && !is_float) {
+            int_sum = static_cast<int64_t>(static_cast<uint64_t>(int_sum) + static_cast<uint64_t>(element.as_int()));
+        } else {
+            if (!is_float) float_sum = static_cast<double>(int_sum);
+            is_float = true;
+            float_sum += expect_number(element, "sum");
+        }
+    }
+    return is_float ? Value(float_sum) : Value(int_sum);
+}
+
+template <bool IsMin>
+Value array_extremum(arguments_t args) {
+    constexpr std::string_view fn = IsMin ? "min" : "max";
+    array_t arr = expect_array(args, 0, fn);
+    if (arr->empty()) return Value(null_t{});
+    const ArrayKernels& kernels = get_array_kernels();
+    switch (arr->kind()) {
+        case ElementKind::INT:
+            return Value(IsMin ? kernels.min_i64(arr->int_data(), arr->size()) : kernels.max_i64(arr->int_data(), arr->size()));
+        case ElementKind::FLOAT:
+            return Value(IsMin ? kernels.min_f64(arr->float_data(), arr->size()) : kernels.max_f64(arr->float_data(), arr->size()));
+        default:
+            break;
+    }
+    Value best = arr->get(0);
+    double best_number = expect_number(best, fn);
+    for (size_t i = 1; i < arr->size(); ++i) {
+        Value element = arr->get(i);
+        double number = expect_number(element, fn);
+        if (IsMin ? number < best_number : number > best_number) {
+            best = element;
+            best_number = number;
+        }
+    }
+    return best;
+}
+
+Value array_dot(arguments_t args) {
+    array_t lhs = expect_array(args, 0, "dot");
+    array_t rhs = expect_array(args, 1, "dot");
+    if (lhs->size() != rhs->size()) throw_array_error("dot", "arrays must have the same length.");
+    const ArrayKernels& kernels = get_array_kernels();
+    if (lhs->kind() == ElementKind::INT && rhs->kind() == ElementKind::INT) {
+        return Value(kernels.dot_i64(lhs->int_data(), rhs->int_data(), lhs->size()));
+    }
+    if (lhs->kind() == ElementKind::FLOAT && rhs->kind() == ElementKind::FLOAT) {
+        return Value(kernels.dot_f64(lhs->float_data(), rhs->float_data(), lhs->size()));
+    }
+    double sum = 0.0;
+    for (size_t i = 0; i < lhs->size(); ++i) {
+        sum += expect_number(lhs->get(i), "dot") * expect_number(rhs->get(i), "dot");
+    }
+    return Value(sum);
+}
+
+Value array_fill(arguments_t args) {
+    array_t arr = expect_array(args, 0, "fill");
+    param_t value = expect_arg(args, 1, "fill");
+    if (arr->empty()) return Value(arr);
+    const ArrayKernels& kernels = get_array_kernels();
+    if (arr->kind() == ElementKind::INT && value.is_int()) {
+        kernels.fill_i64(arr->int_data(), arr->size(), value.as_int());
+    } else if (arr->kind() == ElementKind::FLOAT && value.is_float()) {
+        kernels.fill_f64(arr->float_data(), arr->size(), value.as_float());
+    } else {
+        for (size_t i = 0; i < arr->size(); ++i) arr->set(i, value);
+    }
+    return Value(arr);
+}
+
+Value array_index_of(arguments_t args) {
+    array_t arr = expect_array(args, 0, "index_of");
+    param_t value = expect_arg(args, 1, "index_of");
+    const ArrayKernels& kernels = get_array_kernels();
+    size_t index = ArrayKernels::npos;
+    if (arr->kind() == ElementKind::INT) {
+        if (value.is_int()) index = kernels.index_of_i64(arr->int_data(), arr->size(), value.as_int());
+    } else if (arr->kind() == ElementKind::FLOAT) {
+        if (value.is_float()) index = kernels.index_of_f64(arr->float_data(), arr->size(), value.as_float());
+    } else {
+        for (size_t i = 0; i < arr->size(); ++i) {
+            if (strict_equals(arr->get(i), value)) {
+                index = i;
+                break;
+            }
+        }
+    }
+    return Value(index == ArrayKernels::npos ? int64_t{-1} : static_cast<int64_t>(index));
+}
+
+// Chỉ số đầu tiên hai mảng khác nhau (so sánh như EQ của VM: int/float cùng kiểu theo giá trị, NaN khác mọi thứ),
+// độ dài mảng ngắn hơn nếu một mảng là phần đầu của mảng kia, npos nếu bằng nhau
+size_t find_mismatch(array_t lhs, array_t rhs) {
+    size_t size = std::min(lhs->size(), rhs->size());
+    const ArrayKernels& kernels = get_array_kernels();
+    size_t index = ArrayKernels::npos;
+    if (lhs->kind() == ElementKind::INT && rhs->kind() == ElementKind::INT) {
+        index = kernels.mismatch_i64(lhs->int_data(), rhs->int_data(), size);
+    } else if (lhs->kind() == ElementKind::FLOAT && rhs->kind() == ElementKind::FLOAT) {
+        index = kernels.mismatch_f64(lhs->float_data(), rhs->float_data(), size);
+    } else {
+        for (size_t i = 0; i < size; ++i) {
+            if (!strict_equals(lhs->get(i), rhs->get(i))) {
+                index = i;
+                break;
+            }
+        }
+    }
+    if (index == ArrayKernels::npos && lhs->size() != rhs->size()) index = size;
+    return index;
+}
+
+Value array_equals(arguments_t args) {
+    array_t lhs = expect_array(args, 0, "equals");
+    array_t rhs = expect_array(args, 1, "equals");
+    return Value(lhs->size() == rhs->size() && find_mismatch(lhs, rhs) == ArrayKernels::npos);
+}
+
+Value array_mismatch(arguments_t args) {
+    size_t index = find_mismatch(expect_array(args, 0, "mismatch"), expect_array(args, 1, "mismatch"));
+    return Value(index == ArrayKernels::npos ? int64_t{-1} : static_cast<int64_t>(index));
+}
+
+template <bool IsAdd>
+Value array_map(MemoryManager* heap, arguments_t args) {
+    constexpr std::string_view fn = IsAdd ? "map_add" : "map_mul";
+    array_t arr = expect_array(args, 0, fn);
+    param_t scalar = expect_arg(args, 1, fn);
+    if (!scalar.is_int() && !scalar.is_float()) throw_array_error(fn, "scalar must be a number.");
+    const ArrayKernels& kernels = get_array_kernels();
+    size_t size = arr->size();
+
+    if (arr->kind() == ElementKind::INT && scalar.is_int()) {
+        std::vector<core::int_t> out(size);
+        (IsAdd ? kernels.add_i64 : kernels.mul_i64)(out.data(), arr->int_data(), size, scalar.as_int());
+        return Value(heap->new_array(std::move(out)));
+    }
+    if (arr->kind() != ElementKind::VALUE) {
+        // int array với scalar float: đổi sang double rồi chạy kernel tại chỗ
+        std::vector<core::float_t> out(size);
+        const core::float_t* in = arr->float_data();
+        if (arr->kind() == ElementKind::INT) {
+            for (size_t i = 0; i < size; ++i) out[i] = static_cast<core::float_t>(arr->int_data()[i]);
+            in = out.data();
+        }
+        (IsAdd ? kernels.add_f64 : kernels.mul_f64)(out.data(), in, size, expect_number(scalar, fn));
+        return Value(heap->new_array(std::move(out)));
+    }
+
+    std::vector<Value> out;
+    out.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        Value element = arr->get(i);
+        if (element.is_int() && scalar.is_int()) {
+            uint64_t lhs = static_cast<uint64_t>(element.as_int()), rhs = static_cast<uint64_t>(scalar.as_int());
+            out.emplace_back(static_cast<int64_t>(IsAdd ? lhs + rhs : lhs * rhs));
+        } else {
+            double lhs = expect_number(element, fn), rhs = expect_number(scalar, fn);
+            out.emplace_back(IsAdd ? lhs + rhs : lhs * rhs);
+        }
+    }
+    return Value(heap->new_array(out));
+}
+
+Value array_copy(MemoryManager* heap, arguments_t args) {
+    array_t arr = expect_array(args, 0, "copy");
+    switch (arr->kind()) {
+        case ElementKind::INT:
+            return Value(heap->new_array(std::vector<core::int_t>(arr->int_data(), arr->int_data() + arr->size())));
+        case ElementKind::FLOAT:
+            return Value(heap->new_array(std::vector<core::float_t>(arr->float_data(), arr->float_data() + arr->size())));
+        default:
+            return Value(heap->new_array(std::vector<Value>(arr->value_data(), arr->value_data() + arr->size())));
+    }
+}
+}  // namespace
+
+void register_array_natives(BuiltinRegistry& registry, MemoryManager* heap) {
+    auto& methods = registry.methods_[heap->new_string("array")];
+    auto define = [&](std::string_view name, ObjNativeFunction::native_fn_simple fn) {
+        // Key phải nằm trong registry (đã được trace) trước khi cấp phát native, vì new_native có thể kích hoạt GC
+        Value& slot = methods[heap->new_string(name)];
+        slot = Value(heap->new_native(std::move(fn)));
+    };
+
+    define("sum", array_sum);
+    define("min", array_extremum<true>);
+    define("max", array_extremum<false>);
+    define("dot", array_dot);
+    define("fill", array_fill);
+    define("index_of", array_index_of);
+    define("equals", array_equals);
+    define("mismatch", array_mismatch);
+    define("copy", [heap](arguments_t args) { return array_copy(heap, args); });
+    define("map_add", [heap](arguments_t args) { return array_map<true>(heap, args); });
+    define("map_mul", [heap](arguments_t args) { return array_map<false>(heap, args); });
+}
+}  // namespace meow::runtime
@@ -0,0 +1,452 @@
+#include "runtime/bytecode.h"
+#include "core/superinstructions.h"
+
+using namespace meow::core;
+
+namespace meow::runtime {
+namespace {
+// Độ rộng của toán hạng trong Instruction::bytes
+constexpr size_t operand_size(OperandKind kind) noexcept {
+    switch (kind) {
+        case OperandKind::ADDR:
+            return 4;
+        case OperandKind::IMM64:
+            return 8;
+        default:
+            return 2;
+    }
+}
+
+// Độ rộng khi mã hoá: dạng hẹp, hoặc dạng đứng sau tiền tố WIDE
+constexpr size_t encoded_operand_size(OperandKind kind, bool wide) noexcept {
+    switch (kind) {
+        case OperandKind::IMM16:
+            return 2;
+        case OperandKind::IMM64:
+            return 8;
+        case OperandKind::ADDR:
+            return wide ? 4 : 2;
+        default:
+            return wide ? 2 : 1;
+    }
+}
+
+constexpr OpcodeLayout make_layout(std::initializer_list<OperandKind> operands) noexcept {
+    OpcodeLayout layout{0, {}};
+    for (OperandKind kind : operands) layout.operands[layout.operand_count++] = kind;
+    return layout;
+}
+
+constexpr size_t NUM_LAYOUTS = static_cast<size_t>(OpCode::TOTAL_OPCODES);
+
+constexpr std::array<OpcodeLayout, NUM_LAYOUTS> LAYOUTS = [] {
+    using enum OpCode;
+    using enum OperandKind;
+    std::array<OpcodeLayout, NUM_LAYOUTS> t{};
+    auto set = [&](OpCode op, std::initializer_list<OperandKind> operands) { t[static_cast<size_t>(op)] = make_layout(operands); };
+
+    set(LOAD_CONST, {DST, CONST});
+    set(LOAD_NULL, {DST});
+    set(LOAD_TRUE, {DST});
+    set(LOAD_FALSE, {DST});
+    set(LOAD_INT, {DST, IMM64});
+    set(LOAD_FLOAT, {DST, IMM64});
+    set(MOVE, {DST, REG});
+    for (OpCode op : {ADD, SUB, MUL, DIV, MOD, POW, EQ, NEQ, GT, GE, LT, LE, BIT_AND, BIT_OR, BIT_XOR, LSHIFT, RSHIFT}) {
+        set(op, {DST, REG, REG});
+    }
+    set(NEG, {DST, REG});
+    set(NOT, {DST, REG});
+    set(BIT_NOT, {DST, REG});
+    set(GET_GLOBAL, {DST, CONST});
+    set(SET_GLOBAL, {CONST, REG});
+    set(GET_UPVALUE, {DST, COUNT});
+    set(SET_UPVALUE, {COUNT, REG});
+    set(CLOSURE, {DST, CONST});
+    set(CLOSE_UPVALUES, {COUNT});
+    set(JUMP, {ADDR});
+    set(JUMP_IF_FALSE, {REG, ADDR});
+    set(JUMP_IF_TRUE, {REG, ADDR});
+    set(CALL, {DST, REG, RANGE, COUNT});
+    set(CALL_VOID, {REG, RANGE, COUNT});
+    set(RETURN, {REG});
+    set(HALT, {});
+    set(NEW_ARRAY, {DST, RANGE, COUNT});
+    set(NEW_HASH, {DST, RANGE, COUNT});
+    set(GET_INDEX, {DST, REG, REG});
+    set(SET_INDEX, {REG, REG, REG});
+    set(GET_KEYS, {DST, REG});
+    set(GET_VALUES, {DST, REG});
+    set(NEW_CLASS, {DST, CONST});
+    set(NEW_INSTANCE, {DST, REG});
+    set(GET_PROP, {DST, REG, CONST});
+    set(SET_PROP, {REG, CONST, REG});
+    set(SET_METHOD, {REG, CONST, REG});
+    set(INHERIT, {REG, REG});
+    set(GET_SUPER, {DST, CONST});
+    set(THROW, {REG});
+    set(SETUP_TRY, {ADDR});
+    set(POP_TRY, {});
+    set(IMPORT_MODULE, {DST, CONST});
+    set(EXPORT, {CONST, REG});
+    set(GET_EXPORT, {DST, REG, CONST});
+    set(IMPORT_ALL, {REG});
+    for (OpCode op : {JUMP_IF_EQ, JUMP_IF_NEQ, JUMP_IF_LT, JUMP_IF_LE, JUMP_IF_NOT_LT, JUMP_IF_NOT_LE}) {
+        set(op, {REG, REG, ADDR});
+    }
+    // Thanh ghi đầu của khối điều khiển vòng lặp, xem reads_register
+    set(FOR_PREP, {REG, ADDR});
+    set(FOR_LOOP, {REG, ADDR});
+    set(FOR_IN, {REG, ADDR});
+    set(ITER_NEW, {DST, REG});
+    set(ITER_NEXT, {REG, DST, DST, ADDR});
+    set(TAIL_CALL, {REG, RANGE, COUNT});
+    set(LOAD_SMALLINT, {DST, IMM16});
+    set(GUARD_CALLEE, {REG, CONST, ADDR});
+    // Superinstruction chỉ thay byte opcode đầu, phần còn lại giữ nguyên nên layout là của lệnh đầu
+    for (const Superinstruction& si : SUPERINSTRUCTIONS) {
+        t[static_cast<size_t>(si.op)] = t[static_cast<size_t>(si.parts[0])];
+    }
+    return t;
+}();
+
+// WIDE không tự đứng một mình: có thì chỉ ở trước một lệnh có toán hạng giãn được
+bool has_wide_form(const OpcodeLayout& layout) noexcept {
+    for (size_t i = 0; i < layout.operand_count; ++i) {
+        if (layout.operands[i] != OperandKind::IMM16 && layout.operands[i] != OperandKind::IMM64) return true;
+    }
+    return false;
+}
+
+// Mọi toán hạng (trừ ADDR, phụ thuộc vào khoảng cách nhảy) vừa 1 byte. 0xFF của REG/DST dành cho "không có"
+bool fits_narrow(const Instruction& ins, const OpcodeLayout& layout) noexcept {
+    for (size_t i = 0; i < layout.operand_count; ++i) {
+        OperandKind kind = layout.operands[i];
+        if (kind == OperandKind::ADDR || kind == OperandKind::IMM16 || kind == OperandKind::IMM64) continue;
+        uint16_t value = ins.operand(i);
+        bool optional = kind == OperandKind::REG || kind == OperandKind::DST;
+        if (optional ? value >= 0xFF && value != 0xFFFF : value > 0xFF) return false;
+    }
+    return true;
+}
+
+uint32_t read_u32(const uint8_t* at) noexcept {
+    return static_cast<uint32_t>(at[0]) | (static_cast<uint32_t>(at[1]) << 8) | (static_cast<uint32_t>(at[2]) << 16) | (static_cast<uint32_t>(at[3]) << 24);
+}
+
+void write_u32(uint8_t* at, uint32_t value) noexcept {
+    for (size_t i = 0; i < 4; ++i) at[i] = static_cast<uint8_t>((value >> (i * 8)) & 0xFF);
+}
+
+size_t addr_operand(const OpcodeLayout& layout) noexcept {
+    for (size_t i = 0; i < layout.operand_count; ++i) {
+        if (layout.operands[i] == OperandKind::ADDR) return i;
+    }
+    return layout.operand_count;
+}
+
+// Đổi ADDR từ offset byte sang chỉ số lệnh; đích phải là đầu một lệnh hoặc cuối chunk
+bool index_targets(std::vector<Instruction>& instructions, const std::vector<size_t>& offsets, size_t size) {
+    std::vector<uint32_t> index_of(size + 1, NO_OFFSET);
+    for (size_t i = 0; i < offsets.size(); ++i) index_of[offsets[i]] = static_cast<uint32_t>(i);
+    index_of[size] = static_cast<uint32_t>(offsets.size());
+    for (Instruction& ins : instructions) {
+        auto target = get_jump_target(ins);
+        if (!target) continue;
+        if (*target > size || index_of[*target] == NO_OFFSET) return false;
+        ins.set_address(index_of[*target]);
+    }
+    return true;
+}
+}  // namespace
+
+uint64_t Instruction::imm64() const noexcept {
+    const uint8_t* at = bytes.data() + get_operand_offset(layout(), layout().operand_count - 1);
+    uint64_t bits = 0;
+    for (size_t i = 0; i < 8; ++i) bits |= static_cast<uint64_t>(at[i]) << (i * 8);
+    return bits;
+}
+
+void Instruction::set_imm64(uint64_t bits) noexcept {
+    uint8_t* at = bytes.data() + get_operand_offset(layout(), layout().operand_count - 1);
+    for (size_t i = 0; i < 8; ++i) at[i] = static_cast<uint8_t>((bits >> (i * 8)) & 0xFF);
+}
+
+uint32_t Instruction::address() const noexcept {
+    return read_u32(bytes.data() + get_operand_offset(layout(), addr_operand(layout())));
+}
+
+void Instruction::set_address(uint32_t address) noexcept {
+    write_u32(bytes.data() + get_operand_offset(layout(), addr_operand(layout())), address);
+}
+
+const OpcodeLayout* get_opcode_layout(uint8_t opcode) noexcept {
+    if (opcode >= NUM_LAYOUTS || opcode == static_cast<uint8_t>(OpCode::WIDE)) return nullptr;
+    return &LAYOUTS[opcode];
+}
+
+size_t get_operand_offset(const OpcodeLayout& layout, size_t index) noexcept {
+    size_t offset = 1;
+    for (size_t i = 0; i < index; ++i) offset += operand_size(layout.operands[i]);
+    return offset;
+}
+
+size_t get_encoded_size(const OpcodeLayout& layout, bool wide) noexcept {
+    size_t size = wide ? 2 : 1;
+    for (size_t i = 0; i < layout.operand_count; ++i) size += encoded_operand_size(layout.operands[i], wide);
+    return size;
+}
+
+bool decode_instruction(const uint8_t* code, size_t size, size_t offset, Instruction& out) noexcept {
+    if (offset >= size) return false;
+    bool wide = code[offset] == static_cast<uint8_t>(OpCode::WIDE);
+    const uint8_t* at = code + offset + (wide ? 1 : 0);
+    if (wide && offset + 1 >= size) return false;
+    const OpcodeLayout* layout = get_opcode_layout(at[0]);
+    if (layout == nullptr) return false;
+    // Superinstruction chỉ gộp các lệnh dạng hẹp, xem encode_code
+    if (wide && (is_superinstruction(static_cast<OpCode>(at[0])) || !has_wide_form(*layout))) return false;
+    size_t length = get_encoded_size(*layout, wide);
+    if (length > size - offset) return false;
+
+    out = Instruction(static_cast<OpCode>(at[0]));
+    out.size = static_cast<uint8_t>(length);
+    out.wide = wide;
+    ++at;
+    for (size_t i = 0; i < layout->operand_count; ++i) {
+        OperandKind kind = layout->operands[i];
+        uint8_t* field = out.bytes.data() + get_operand_offset(*layout, i);
+        switch (kind) {
+            case OperandKind::IMM16:
+            case OperandKind::IMM64:
+                std::copy_n(at, operand_size(kind), field);
+                break;
+            case OperandKind::ADDR: {
+                int64_t displacement = wide ? static_cast<int32_t>(read_u32(at)) : static_cast<int16_t>(read_operand_u16(at));
+                int64_t target = static_cast<int64_t>(offset) + displacement;
+                if (target < 0 || target > static_cast<int64_t>(UINT32_MAX)) return false;
+                write_u32(field, static_cast<uint32_t>(target));
+                break;
+            }
+            default: {
+                uint16_t value = wide ? read_operand_u16(at) : at[0];
+                if (!wide && value == 0xFF && (kind == OperandKind::REG || kind == OperandKind::DST)) value = 0xFFFF;
+                write_operand_u16(field, value);
+                break;
+            }
+        }
+        at += encoded_operand_size(kind, wide);
+    }
+    return true;
+}
+
+Instruction decode_instruction(const uint8_t* code, size_t offset) noexcept {
+    Instruction out;
+    (void)decode_instruction(code, std::numeric_limits<size_t>::max(), offset, out);
+    return out;
+}
+
+bool decode_instructions(const uint8_t* code, size_t size, std::vector<size_t>& offsets) {
+    offsets.clear();
+    Instruction ins;
+    for (size_t offset = 0; offset < size; offset += ins.size) {
+        if (!decode_instruction(code, size, offset, ins)) return false;
+        offsets.push_back(offset);
+    }
+    return true;
+}
+
+bool decode_code(const uint8_t* code, size_t size, std::vector<Instruction>& out) {
+    out.clear();
+    std::vector<size_t> offsets;
+    Instruction ins;
+    for (size_t offset = 0; offset < size; offset += ins.size) {
+        if (!decode_instruction(code, size, offset, ins)) return false;
+        offsets.push_back(offset);
+        out.push_back(ins);
+    }
+    return index_targets(out, offsets, size);
+}
+
+bool decode_fixed_width_code(const uint8_t* code, size_t size, std::vector<Instruction>& out) {
+    out.clear();
+    std::vector<size_t> offsets;
+    for (size_t offset = 0; offset < size;) {
+        const OpcodeLayout* layout = get_opcode_layout(code[offset]);
+        // Superinstruction chỉ có trong code đã tối ưu, mà code tối ưu của định dạng cũ thì không được nạp
+        if (layout == nullptr || is_superinstruction(static_cast<OpCode>(code[offset]))) return false;
+        Instruction ins(static_cast<OpCode>(code[offset]));
+        size_t at = offset + 1;
+        for (size_t i = 0; i < layout->operand_count; ++i) {
+            OperandKind kind = layout->operands[i];
+            size_t width = kind == OperandKind::IMM64 ? 8 : 2;
+            if (width > size - at) return false;
+            uint8_t* field = ins.bytes.data() + get_operand_offset(*layout, i);
+            if (kind == OperandKind::ADDR) {
+                write_u32(field, read_operand_u16(code + at));
+            } else {
+                std::copy_n(code + at, width, field);
+            }
+            at += width;
+        }
+        ins.size = static_cast<uint8_t>(at - offset);
+        offsets.push_back(offset);
+        out.push_back(ins);
+        offset = at;
+    }
+    return index_targets(out, offsets, size);
+}
+
+bool encode_code(const std::vector<Instruction>& instructions, std::vector<uint8_t>& out, std::vector<uint32_t>* offsets) {
+    size_t n = instructions.size();
+    std::vector<bool> wide(n, false);
+    for (size_t i = 0; i < n; ++i) {
+        const OpcodeLayout* layout = get_opcode_layout(instructions[i].bytes[0]);
+        if (layout == nullptr) return false;
+        auto target = get_jump_target(instructions[i]);
+        if (target && *target > n) return false;
+        wide[i] = !fits_narrow(instructions[i], *layout);
+    }
+
+    // Bắt đầu với mọi lệnh nhảy ở dạng hẹp, giãn dần cho tới khi mọi khoảng cách đều vừa. Chỉ giãn ra chứ không thu lại nên luôn dừng
+    std::vector<int64_t> at(n + 1, 0);
+    for (bool changed = true; changed;) {
+        changed = false;
+        int64_t offset = 0;
+        for (size_t i = 0; i < n; ++i) {
+            at[i] = offset;
+            offset += static_cast<int64_t>(get_encoded_size(instructions[i].layout(), wide[i]));
+        }
+        at[n] = offset;
+        if (offset > std::numeric_limits<int32_t>::max()) return false;
+        for (size_t i = 0; i < n; ++i) {
+            auto target = get_jump_target(instructions[i]);
+            if (!target || wide[i]) continue;
+            int64_t displacement = at[*target] - at[i];
+            if (displacement < std::numeric_limits<int16_t>::min() || displacement > std::numeric_limits<int16_t>::max()) {
+                wide[i] = true;
+                changed = true;
+            }
+        }
+    }
+
+    out.clear();
+    out.reserve(static_cast<size_t>(at[n]));
+    auto push = [&](uint64_t value, size_t width) {
+        for (size_t k = 0; k < width; ++k) out.push_back(static_cast<uint8_t>((value >> (k * 8)) & 0xFF));
+    };
+    for (size_t i = 0; i < n; ++i) {
+        const Instruction& ins = instructions[i];
+        const OpcodeLayout& layout = ins.layout();
+        OpCode op = ins.op();
+        // Handler gộp đọc toán hạng dạng hẹp của từng thành phần, nên lệnh nào trong chuỗi bị giãn thì bỏ gộp
+        if (is_superinstruction(op)) {
+            const Superinstruction& si = SUPERINSTRUCTIONS[static_cast<size_t>(op) - FIRST_SUPERINSTRUCTION];
+            bool narrow = i + si.length <= n;
+            for (size_t k = 0; k < si.length && narrow; ++k) narrow = !wide[i + k];
+            if (!narrow) op = si.parts[0];
+        }
+        if (wide[i]) out.push_back(static_cast<uint8_t>(OpCode::WIDE));
+        out.push_back(static_cast<uint8_t>(op));
+        for (size_t k = 0; k < layout.operand_count; ++k) {
+            OperandKind kind = layout.operands[k];
+            const uint8_t* field = ins.bytes.data() + get_operand_offset(layout, k);
+            switch (kind) {
+                case OperandKind::IMM16:
+                case OperandKind::IMM64:
+                    out.insert(out.end(), field, field + operand_size(kind));
+                    break;
+                case OperandKind::ADDR:
+                    push(static_cast<uint64_t>(at[ins.address()] - at[i]), wide[i] ? 4 : 2);
+                    break;
+                default: {
+                    uint16_t value = read_operand_u16(field);
+                    push(wide[i] ? value : value & 0xFF, wide[i] ? 2 : 1);
+                    break;
+                }
+            }
+        }
+    }
+    if (offsets != nullptr) offsets->assign(at.begin(), at.end());
+    return true;
+}
+
+size_t get_read_ranges(const Instruction& instruction, std::array<RegisterRange, 4>& out) noexcept {
+    OpCode op = superinstruction_head(instruction.op());
+    size_t count = 0;
+    // Đọc ngầm R0: GET_SUPER lấy receiver, HALT in giá trị cuối
+    if (op == OpCode::GET_SUPER || op == OpCode::HALT) out[count++] = {0, 1};
+    // Vòng for số đọc [base, base + 3), FOR_IN và ITER_NEXT đọc collection và con trỏ
+    if (op == OpCode::FOR_PREP || op == OpCode::FOR_LOOP || op == OpCode::FOR_IN || op == OpCode::ITER_NEXT) {
+        out[count++] = {instruction.operand(0), op == OpCode::FOR_PREP || op == OpCode::FOR_LOOP ? 3u : 2u};
+        return count;
+    }
+
+    const OpcodeLayout& layout = instruction.layout();
+    for (size_t i = 0; i < layout.operand_count; ++i) {
+        OperandKind kind = layout.operands[i];
+        if (kind == OperandKind::REG && instruction.operand(i) != 0xFFFF) out[count++] = {instruction.operand(i), 1};
+        if (kind == OperandKind::RANGE) {
+            uint32_t size = instruction.operand(i + 1);
+            if (op == OpCode::NEW_HASH) size *= 2;
+            if (size != 0) out[count++] = {instruction.operand(i), size};
+        }
+    }
+    return count;
+}
+
+size_t get_write_ranges(const Instruction& instruction, std::array<RegisterRange, 4>& out) noexcept {
+    OpCode op = superinstruction_head(instruction.op());
+    switch (op) {
+        case OpCode::FOR_PREP:
+        case OpCode::FOR_LOOP:
+            out[0] = {instruction.operand(0), 4};
+            return 1;
+        case OpCode::FOR_IN:
+            out[0] = {static_cast<uint16_t>(instruction.operand(0) + 1), 3};
+            return 1;
+        case OpCode::ITER_NEW:
+            out[0] = {instruction.operand(0), 2};
+            return 1;
+        default:
+            break;
+    }
+
+    const OpcodeLayout& layout = instruction.layout();
+    size_t count = 0;
+    for (size_t i = 0; i < layout.operand_count; ++i) {
+        if (layout.operands[i] == OperandKind::DST && instruction.operand(i) != 0xFFFF) out[count++] = {instruction.operand(i), 1};
+    }
+    // ITER_NEXT còn ghi con trỏ ở [iter + 1]
+    if (op == OpCode::ITER_NEXT) out[count++] = {static_cast<uint16_t>(instruction.operand(0) + 1), 1};
+    return count;
+}
+
+bool reads_register(const Instruction& instruction, uint16_t reg) noexcept {
+    std::array<RegisterRange, 4> ranges;
+    size_t count = get_read_ranges(instruction, ranges);
+    for (size_t i = 0; i < count; ++i) {
+        if (reg >= ranges[i].first && reg < ranges[i].first + ranges[i].count) return true;
+    }
+    return false;
+}
+
+// Vòng lặp và ITER_NEXT chỉ ghi khi không thoát, nên không được tính là ghi chắc chắn
+bool writes_register(const Instruction& instruction, uint16_t reg) noexcept {
+    if (superinstruction_head(instruction.op()) == OpCode::ITER_NEXT) return false;
+    const OpcodeLayout& layout = instruction.layout();
+    for (size_t i = 0; i < layout.operand_count; ++i) {
+        if (layout.operands[i] == OperandKind::DST && instruction.operand(i) == reg) return true;
+    }
+    return false;
+}
+
+std::optional<uint32_t> get_jump_target(const Instruction& instruction) noexcept {
+    if (addr_operand(instruction.layout()) == instruction.layout().operand_count) return std::nullopt;
+    return instruction.address();
+}
+
+bool is_block_terminator(OpCode op) noexcept {
+    return op == OpCode::JUMP || op == OpCode::RETURN || op == OpCode::TAIL_CALL || op == OpCode::HALT || op == OpCode::THROW;
+}
+}  // namespace meow::runtime
@@ -0,0 +1,144 @@
+#include "runtime/feedback.h"
+
+#include "core/objects.h"
+#include "core/superinstructions.h"
+#include "debug/disassemble.h"
+#include "memory/gc_visitor.h"
+#include "runtime/bytecode.h"
+
+namespace meow::runtime {
+
+using namespace meow::core;
+
+namespace {
+std::optional<SiteKind> site_kind(OpCode op) noexcept {
+    switch (op) {
+        case OpCode::ADD:
+        case OpCode::SUB:
+        case OpCode::MUL:
+        case OpCode::DIV:
+        case OpCode::MOD:
+        case OpCode::POW:
+        case OpCode::BIT_AND:
+        case OpCode::BIT_OR:
+        case OpCode::BIT_XOR:
+        case OpCode::LSHIFT:
+        case OpCode::RSHIFT:
+        case OpCode::NEG:
+        case OpCode::NOT:
+        case OpCode::BIT_NOT:
+            return SiteKind::ARITHMETIC;
+        case OpCode::EQ:
+        case OpCode::NEQ:
+        case OpCode::GT:
+        case OpCode::GE:
+        case OpCode::LT:
+        case OpCode::LE:
+        case OpCode::JUMP_IF_EQ:
+        case OpCode::JUMP_IF_NEQ:
+        case OpCode::JUMP_IF_LT:
+        case OpCode::JUMP_IF_LE:
+        case OpCode::JUMP_IF_NOT_LT:
+        case OpCode::JUMP_IF_NOT_LE:
+            return SiteKind::COMPARE;
+        case OpCode::GET_PROP:
+        case OpCode::SET_PROP:
+            return SiteKind::PROPERTY;
+        case OpCode::GET_INDEX:
+        case OpCode::SET_INDEX:
+            return SiteKind::INDEX;
+        case OpCode::CALL:
+        case OpCode::CALL_VOID:
+        case OpCode::TAIL_CALL:
+            return SiteKind::CALL;
+        default:
+            return std::nullopt;
+    }
+}
+
+constexpr std::array<std::string_view, NUM_VALUE_TYPES> TYPE_NAMES = {
+    "null", "bool", "int", "float", "object", "array", "string", "hash", "instance", "class", "bound_method", "upvalue", "proto", "function", "native", "module",
+};
+
+std::string type_set_name(type_set_t types) {
+    if (types == 0) return "-";
+    std::string name;
+    for (size_t i = 0; i < NUM_VALUE_TYPES; ++i) {
+        if ((types & (1u << i)) == 0) continue;
+        if (!name.empty()) name += ',';
+        name += TYPE_NAMES[i];
+    }
+    return name;
+}
+
+std::string target_name(const MeowObject* target) {
+    switch (target->get_type()) {
+        case ObjectType::CLASS: {
+            string_t name = static_cast<const objects::ObjClass*>(target)->get_name();
+            return name ? name->c_str() : "<class>";
+        }
+        case ObjectType::PROTO: {
+            string_t name = static_cast<const objects::ObjFunctionProto*>(target)->get_name();
+            return name ? name->c_str() : "<fn>";
+        }
+        case ObjectType::MODULE: {
+            string_t name = static_cast<const objects::ObjModule*>(target)->get_file_name();
+            return name ? name->c_str() : "<module>";
+        }
+        case ObjectType::NATIVE_FN:
+            return "<native>";
+        default:
+            return "<object>";
+    }
+}
+}  // namespace
+
+FeedbackOptions FeedbackOptions::from_environment() noexcept {
+    FeedbackOptions options;
+    const char* threshold = std::getenv("MEOW_FEEDBACK_THRESHOLD");
+    if (threshold != nullptr && *threshold != '\0') {
+        unsigned long value = std::strtoul(threshold, nullptr, 10);
+        if (value <= std::numeric_limits<uint32_t>::max()) options.threshold = static_cast<uint32_t>(value);
+    }
+    return options;
+}
+
+FeedbackVector::FeedbackVector(const Chunk& chunk) : code_(chunk.get_code()) {
+    std::vector<size_t> offsets;
+    if (!decode_instructions(chunk.get_code(), chunk.get_code_size(), offsets)) return;
+    slot_of_.assign(chunk.get_code_size(), NO_SLOT);
+    for (size_t offset : offsets) {
+        // Thành phần của superinstruction vẫn giữ byte opcode riêng, handler của nó ghi vào slot của chính nó.
+        // Lệnh WIDE được đánh khoá theo byte tiền tố, là chỗ handler tính op_start
+        OpCode op = superinstruction_head(decode_instruction(chunk.get_code(), offset).op());
+        std::optional<SiteKind> kind = site_kind(op);
+        if (!kind || slots_.size() >= NO_SLOT) continue;
+        slot_of_[offset] = static_cast<uint16_t>(slots_.size());
+        slots_.emplace_back(static_cast<uint32_t>(offset), op, *kind);
+    }
+}
+
+void FeedbackVector::dump(std::ostream& os, std::string_view name) const {
+    os << "proto " << name << ": invocations " << invocations_ << ", backedges " << backedges_ << '\n';
+    for (const FeedbackSlot& slot : slots_) {
+        if (slot.count_ == 0) continue;
+        os << "  @" << slot.pc_ << ' ' << debug::opcode_to_string(slot.op_) << " x" << slot.count_ << ' ' << type_set_name(slot.types_[0]);
+        if (slot.kind_ != SiteKind::PROPERTY && slot.kind_ != SiteKind::CALL) os << " | " << type_set_name(slot.types_[1]);
+        size_t targets = slot.target_count();
+        if (targets != 0) {
+            os << " ->";
+            for (size_t i = 0; i < targets; ++i) os << ' ' << target_name(slot.targets_[i]);
+            os << (slot.megamorphic_ ? " (megamorphic)" : targets == 1 ? " (monomorphic)" : " (polymorphic)");
+        }
+        os << '\n';
+    }
+}
+
+void FeedbackVector::trace(meow::memory::GCVisitor& visitor) const noexcept {
+    for (const FeedbackSlot& slot : slots_) {
+        for (const MeowObject* target : slot.targets_) {
+            if (target != nullptr) visitor.visit_object(target);
+        }
+    }
+}
+}  // namespace meow::runtime
@@ -28,6 +28,24 @@ OperatorDispatcher::OperatorDispatcher(meow::memory::MemoryManager* heap) noexce
         return Value(lhs.as_float() + rhs.as_float());
     };
 
+    // So sánh số cùng kiểu. Các lệnh nhảy gộp (JUMP_IF_*) so sánh inline đúng như các kernel này và đi qua đây với
+    // mọi cặp kiểu khác, nên hai cách chạy luôn cho cùng kết quả. Phải giữ: NEQ là phủ định của EQ, GT/GE là LT/LE
+    // với toán hạng đảo, vì peephole gộp EQ + JUMP_IF_FALSE thành JUMP_IF_NEQ và GT thành LT đảo toán hạng
+#define COMPARE(opcode, cmp)                                                                          \
+    BINARY(opcode, Int, Int) {                                                                        \
+        return Value(lhs.as_int() cmp rhs.as_int());                                                  \
+    };                                                                                                \
+    BINARY(opcode, Float, Float) {                                                                    \
+        return Value(lhs.as_float() cmp rhs.as_float());                                              \
+    }
+    COMPARE(EQ, ==);
+    COMPARE(NEQ, !=);
+    COMPARE(LT, <);
+    COMPARE(LE, <=);
+    COMPARE(GT, >);
+    COMPARE(GE, >=);
+#undef COMPARE
+
     // too lazy to implement ~300 lambdas like old vm
     BINARY(ADD, String, String) {
         // the enclosing-function 'this' cannot be referenced in a lambda body unless it is in the capture list
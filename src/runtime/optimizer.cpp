@@ -0,0 +1,961 @@
+#include "runtime/optimizer.h"
+#include "core/objects/function.h"
+#include "core/objects/string.h"
+#include "core/superinstructions.h"
+#include "runtime/bytecode.h"
+#include "runtime/chunk.h"
+#include "runtime/peephole.h"
+
+using namespace meow::core;
+using meow::core::objects::ExceptionRegion;
+
+namespace meow::runtime {
+namespace {
+constexpr uint32_t NO_TARGET = static_cast<uint32_t>(-1);
+constexpr size_t MAX_ROUNDS = 4;
+constexpr size_t MAX_THREAD_HOPS = 8;
+// Giới hạn bộ nhớ cho bảng liveness (số lệnh x số word của bitset)
+constexpr size_t MAX_LIVENESS_WORDS = size_t{1} << 22;
+// Đồ thị xung đột là ma trận bit num_registers x num_registers
+constexpr size_t MAX_COMPACT_REGISTERS = 4096;
+// Callee lớn hơn thì chi phí CALL không còn đáng kể so với phần thân
+constexpr size_t MAX_INLINE_INSTRUCTIONS = 16;
+// Tổng số lệnh được chép vào một proto
+constexpr size_t MAX_INLINE_GROWTH = 256;
+
+// Một lệnh trong IR: lệnh đã giải mã ở dạng đủ rộng, riêng đích nhảy lưu theo chỉ số lệnh để các pass xoá/thay lệnh thoải mái
+struct Instr : Instruction {
+    uint32_t target = NO_TARGET;
+    bool removed = false;
+};
+
+using Code = std::vector<Instr>;
+
+Instr make_load(OpCode op, uint16_t dst, uint64_t bits) noexcept {
+    Instr ins;
+    ins.bytes[0] = static_cast<uint8_t>(op);
+    ins.set_operand(0, dst);
+    ins.set_imm64(bits);
+    return ins;
+}
+
+bool lift(const uint8_t* code, size_t size, Code& out) {
+    std::vector<Instruction> decoded;
+    if (!decode_code(code, size, decoded)) return false;
+    out.clear();
+    out.reserve(decoded.size());
+    for (const Instruction& ins : decoded) {
+        Instr lifted;
+        static_cast<Instruction&>(lifted) = ins;
+        if (auto target = get_jump_target(ins)) lifted.target = *target;
+        out.push_back(lifted);
+    }
+    return true;
+}
+
+bool lower(const Code& code, std::vector<uint8_t>& out) {
+    // Lệnh đã xoá nhận chỉ số của lệnh còn lại kế tiếp
+    std::vector<uint32_t> new_index(code.size() + 1);
+    uint32_t kept = 0;
+    for (size_t i = 0; i < code.size(); ++i) {
+        new_index[i] = kept;
+        if (!code[i].removed) ++kept;
+    }
+    new_index[code.size()] = kept;
+
+    std::vector<Instruction> instructions;
+    instructions.reserve(kept);
+    for (const Instr& ins : code) {
+        if (ins.removed) continue;
+        instructions.push_back(ins);
+        if (ins.target != NO_TARGET) instructions.back().set_address(new_index[ins.target]);
+    }
+    return encode_code(instructions, out);
+}
+
+void compact(Code& code) {
+    std::vector<uint32_t> new_index(code.size() + 1);
+    uint32_t kept = 0;
+    for (size_t i = 0; i < code.size(); ++i) {
+        new_index[i] = kept;
+        if (!code[i].removed) ++kept;
+    }
+    new_index[code.size()] = kept;
+
+    Code out;
+    out.reserve(kept);
+    for (Instr& ins : code) {
+        if (ins.removed) continue;
+        if (ins.target != NO_TARGET) ins.target = new_index[ins.target];
+        out.push_back(ins);
+    }
+    code = std::move(out);
+}
+
+// Đầu basic block: lệnh đầu, đích nhảy (kể cả catch) và lệnh ngay sau một lệnh nhảy hay kết thúc
+std::vector<bool> find_leaders(const Code& code) {
+    std::vector<bool> leader(code.size() + 1, false);
+    leader[0] = true;
+    for (size_t i = 0; i < code.size(); ++i) {
+        if (code[i].target == NO_TARGET && !is_block_terminator(code[i].op())) continue;
+        if (code[i].target != NO_TARGET) leader[code[i].target] = true;
+        leader[i + 1] = true;
+    }
+    return leader;
+}
+
+bool is_captured(const std::vector<bool>& captured, uint16_t reg) noexcept {
+    return reg < captured.size() && captured[reg];
+}
+
+// Gọi `fn(reg)` cho mọi register mà lệnh có thể ghi
+template <typename Fn>
+void for_each_clobbered(const Instr& ins, Fn&& fn) {
+    std::array<RegisterRange, 4> ranges;
+    size_t count = get_write_ranges(ins, ranges);
+    for (size_t i = 0; i < count; ++i) {
+        for (uint32_t k = 0; k < ranges[i].count; ++k) fn(static_cast<uint16_t>(ranges[i].first + k));
+    }
+}
+
+struct Constant {
+    bool is_float;
+    uint64_t bits;
+};
+
+// Chỉ gấp những gì OperatorDispatcher định nghĩa sẵn cho số: ADD int/int (tràn thì quay vòng) và ADD float/float.
+// Các tổ hợp khác ném lỗi lúc chạy nên phải giữ nguyên
+size_t fold_constants(Code& code, const std::vector<bool>& captured) {
+    std::vector<bool> leader = find_leaders(code);
+    std::unordered_map<uint16_t, Constant> known;
+    size_t folded = 0;
+
+    for (size_t i = 0; i < code.size(); ++i) {
+        if (leader[i]) known.clear();
+        Instr& ins = code[i];
+
+        if (ins.op() == OpCode::ADD) {
+            auto left = known.find(ins.operand(1));
+            auto right = known.find(ins.operand(2));
+            if (left != known.end() && right != known.end() && left->second.is_float == right->second.is_float) {
+                uint16_t dst = ins.operand(0);
+                if (left->second.is_float) {
+                    double sum = std::bit_cast<double>(left->second.bits) + std::bit_cast<double>(right->second.bits);
+                    ins = make_load(OpCode::LOAD_FLOAT, dst, std::bit_cast<uint64_t>(sum));
+                } else {
+                    ins = make_load(OpCode::LOAD_INT, dst, left->second.bits + right->second.bits);
+                }
+                ++folded;
+            }
+        }
+
+        for_each_clobbered(ins, [&](uint16_t reg) { known.erase(reg); });
+        if ((ins.op() == OpCode::LOAD_INT || ins.op() == OpCode::LOAD_FLOAT) && !is_captured(captured, ins.operand(0))) {
+            known[ins.operand(0)] = Constant{ins.op() == OpCode::LOAD_FLOAT, ins.imm64()};
+        } else if (ins.op() == OpCode::LOAD_SMALLINT && !is_captured(captured, ins.operand(0))) {
+            known[ins.operand(0)] = Constant{false, static_cast<uint64_t>(static_cast<int64_t>(static_cast<int16_t>(ins.operand(1))))};
+        }
+    }
+    return folded;
+}
+
+// Toán hạng REG của các lệnh này là đầu một khối register, không đổi tên riêng lẻ được
+bool has_block_operand(OpCode op) noexcept {
+    return op == OpCode::FOR_PREP || op == OpCode::FOR_LOOP || op == OpCode::FOR_IN || op == OpCode::ITER_NEXT;
+}
+
+// Sau `MOVE b, a`, các lần đọc b trong cùng basic block được đọc thẳng từ a cho tới khi a hoặc b bị ghi.
+// MOVE thành thừa sẽ được dead store elimination xoá
+size_t propagate_copies(Code& code, const std::vector<bool>& captured) {
+    std::vector<bool> leader = find_leaders(code);
+    std::unordered_map<uint16_t, uint16_t> copy_of;
+    size_t propagated = 0;
+
+    for (size_t i = 0; i < code.size(); ++i) {
+        if (leader[i]) copy_of.clear();
+        Instr& ins = code[i];
+        OpCode op = ins.op();
+
+        if (!copy_of.empty() && !has_block_operand(op)) {
+            const OpcodeLayout& layout = ins.layout();
+            for (size_t k = 0; k < layout.operand_count; ++k) {
+                if (layout.operands[k] != OperandKind::REG) continue;
+                auto it = copy_of.find(ins.operand(k));
+                if (it == copy_of.end()) continue;
+                ins.set_operand(k, it->second);
+                ++propagated;
+            }
+        }
+        if (op == OpCode::MOVE && ins.operand(0) == ins.operand(1)) {
+            ins.removed = true;
+            ++propagated;
+            continue;
+        }
+
+        for_each_clobbered(ins, [&](uint16_t reg) {
+            copy_of.erase(reg);
+            std::erase_if(copy_of, [reg](const auto& entry) { return entry.second == reg; });
+        });
+        if (op == OpCode::MOVE && !is_captured(captured, ins.operand(0)) && !is_captured(captured, ins.operand(1))) {
+            copy_of[ins.operand(0)] = ins.operand(1);
+        }
+    }
+    return propagated;
+}
+
+bool is_pure_store(OpCode op) noexcept {
+    using enum OpCode;
+    return op == LOAD_CONST || op == LOAD_NULL || op == LOAD_TRUE || op == LOAD_FALSE || op == LOAD_INT || op == LOAD_SMALLINT || op == LOAD_FLOAT ||
+           op == MOVE;
+}
+
+// LOAD_INT vừa 16 bit có dấu thành LOAD_SMALLINT: 4 byte thay vì 10 ở dạng hẹp
+size_t shrink_immediates(Code& code) {
+    size_t shrunk = 0;
+    for (Instr& ins : code) {
+        if (ins.op() != OpCode::LOAD_INT) continue;
+        int64_t value = std::bit_cast<int64_t>(ins.imm64());
+        if (value < std::numeric_limits<int16_t>::min() || value > std::numeric_limits<int16_t>::max()) continue;
+        Instr small;
+        small.bytes[0] = static_cast<uint8_t>(OpCode::LOAD_SMALLINT);
+        small.set_operand(0, ins.operand(0));
+        small.set_operand(1, static_cast<uint16_t>(static_cast<int16_t>(value)));
+        ins = small;
+        ++shrunk;
+    }
+    return shrunk;
+}
+
+// Liveness ngược trên toàn hàm. Lệnh nào cũng có thể ném lỗi nên mọi catch target đều là successor của mọi lệnh.
+// Register bị closure bắt giữ luôn được coi là sống
+class Liveness {
+public:
+    // `handlers` là catch target của bảng exception tĩnh (chỉ số lệnh), thêm vào các SETUP_TRY còn trong code
+    Liveness(const Code& code, const std::vector<bool>& captured, size_t num_registers, std::vector<uint32_t> handlers = {})
+        : code_(code), num_registers_(num_registers), words_((num_registers + 63) / 64), catch_targets_(std::move(handlers)) {
+        size_t n = code.size();
+        if (n == 0 || words_ == 0 || n * words_ > MAX_LIVENESS_WORDS) return;
+        for (const Instr& ins : code) {
+            if (ins.op() == OpCode::SETUP_TRY && ins.target < n) catch_targets_.push_back(ins.target);
+        }
+
+        std::vector<uint64_t> use(n * words_, 0), def(n * words_, 0);
+        for (size_t i = 0; i < n; ++i) {
+            std::array<RegisterRange, 4> ranges;
+            size_t count = get_read_ranges(code[i], ranges);
+            for (size_t r = 0; r < count; ++r) {
+                for (uint32_t k = 0; k < ranges[r].count; ++k) set(&use[i * words_], ranges[r].first + k);
+            }
+            for (size_t reg = 0; reg < std::min(num_registers, captured.size()); ++reg) {
+                if (captured[reg]) set(&use[i * words_], reg);
+            }
+            // Chỉ DST là ghi chắc chắn, xem writes_register
+            if (code[i].op() == OpCode::ITER_NEXT) continue;
+            const OpcodeLayout& layout = code[i].layout();
+            for (size_t k = 0; k < layout.operand_count; ++k) {
+                if (layout.operands[k] == OperandKind::DST && code[i].operand(k) != 0xFFFF) set(&def[i * words_], code[i].operand(k));
+            }
+        }
+
+        live_in_.assign(n * words_, 0);
+        std::vector<uint64_t> out(words_);
+        for (bool changed = true; changed;) {
+            changed = false;
+            for (size_t i = n; i-- > 0;) {
+                live_out(i, out);
+                for (size_t w = 0; w < words_; ++w) {
+                    uint64_t in = use[i * words_ + w] | (out[w] & ~def[i * words_ + w]);
+                    if (in != live_in_[i * words_ + w]) {
+                        live_in_[i * words_ + w] = in;
+                        changed = true;
+                    }
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] bool valid() const noexcept { return !live_in_.empty(); }
+    [[nodiscard]] size_t words() const noexcept { return words_; }
+    [[nodiscard]] const uint64_t* live_in(size_t i) const noexcept { return live_in_.data() + i * words_; }
+
+    void live_out(size_t i, std::vector<uint64_t>& out) const {
+        std::fill(out.begin(), out.end(), 0);
+        auto merge = [&](size_t succ) {
+            if (succ >= code_.size()) return;
+            for (size_t w = 0; w < words_; ++w) out[w] |= live_in_[succ * words_ + w];
+        };
+        if (!is_block_terminator(code_[i].op())) merge(i + 1);
+        if (code_[i].target != NO_TARGET) merge(code_[i].target);
+        for (uint32_t target : catch_targets_) merge(target);
+    }
+
+    static bool test(const uint64_t* bits, size_t reg) noexcept { return (bits[reg / 64] >> (reg % 64)) & 1; }
+
+private:
+    void set(uint64_t* bits, size_t reg) const noexcept {
+        if (reg < num_registers_) bits[reg / 64] |= uint64_t{1} << (reg % 64);
+    }
+
+    const Code& code_;
+    size_t num_registers_;
+    size_t words_;
+    std::vector<uint32_t> catch_targets_;
+    std::vector<uint64_t> live_in_;
+};
+
+size_t eliminate_dead_stores(Code& code, const std::vector<bool>& captured, size_t num_registers) {
+    Liveness liveness(code, captured, num_registers);
+    if (!liveness.valid()) return 0;
+
+    size_t removed = 0;
+    std::vector<uint64_t> live_out(liveness.words());
+    for (size_t i = 0; i < code.size(); ++i) {
+        if (!is_pure_store(code[i].op())) continue;
+        uint16_t dst = code[i].operand(0);
+        if (dst >= num_registers || is_captured(captured, dst)) continue;
+        liveness.live_out(i, live_out);
+        if (Liveness::test(live_out.data(), dst)) continue;
+        code[i].removed = true;
+        ++removed;
+    }
+    return removed;
+}
+
+// Đánh số lại register để frame nhỏ nhất có thể (tô màu đồ thị xung đột).
+// Register cố định, giữ nguyên chỉ số: R0 (self, receiver, catch ghi lỗi vào), register bị bắt giữ,
+// register sống ở đầu hàm (tham số) và mọi register thuộc một khối liên tiếp (đối số CALL, NEW_ARRAY, vòng lặp...)
+size_t compact_registers(Code& code, const std::vector<bool>& captured, size_t num_registers) {
+    if (num_registers <= 1 || num_registers > MAX_COMPACT_REGISTERS) return num_registers;
+    Liveness liveness(code, captured, num_registers);
+    if (!liveness.valid()) return num_registers;
+
+    size_t words = liveness.words();
+    std::vector<bool> used(num_registers, false), fixed(num_registers, false);
+    fixed[0] = true;
+    for (size_t reg = 0; reg < num_registers; ++reg) {
+        if (Liveness::test(liveness.live_in(0), reg)) fixed[reg] = true;
+        // Upvalue mở trỏ thẳng vào slot của frame: frame phải đủ chỗ cho nó và không register nào khác được tô lên nó,
+        // kể cả khi hàm cha không tự đọc/ghi register đó
+        if (is_captured(captured, static_cast<uint16_t>(reg))) used[reg] = fixed[reg] = true;
+    }
+    for (const Instr& ins : code) {
+        std::array<RegisterRange, 4> ranges;
+        bool block = has_block_operand(ins.op()) || ins.op() == OpCode::ITER_NEW;
+        for (auto get : {&get_read_ranges, &get_write_ranges}) {
+            size_t count = get(ins, ranges);
+            for (size_t r = 0; r < count; ++r) {
+                for (uint32_t k = 0; k < ranges[r].count; ++k) {
+                    size_t reg = ranges[r].first + k;
+                    if (reg >= num_registers) return num_registers;
+                    used[reg] = true;
+                    if (block || ranges[r].count > 1) fixed[reg] = true;
+                }
+            }
+        }
+        // Khối đối số chỉ có một register vẫn là toán hạng RANGE, không đổi tên được
+        const OpcodeLayout& layout = ins.layout();
+        for (size_t k = 0; k < layout.operand_count; ++k) {
+            if (layout.operands[k] == OperandKind::RANGE && ins.operand(k + 1) != 0) fixed[ins.operand(k)] = true;
+        }
+    }
+
+    // Xung đột: register có thể bị ghi ở một lệnh với mọi register sống sau lệnh đó, và các register cùng bị ghi với nhau
+    std::vector<uint64_t> conflicts(num_registers * words, 0);
+    auto add_conflict = [&](size_t a, size_t b) {
+        if (a == b) return;
+        conflicts[a * words + b / 64] |= uint64_t{1} << (b % 64);
+        conflicts[b * words + a / 64] |= uint64_t{1} << (a % 64);
+    };
+    std::vector<uint64_t> live_out(words);
+    for (size_t i = 0; i < code.size(); ++i) {
+        std::vector<uint16_t> written;
+        for_each_clobbered(code[i], [&](uint16_t reg) { written.push_back(reg); });
+        if (written.empty()) continue;
+        liveness.live_out(i, live_out);
+        for (uint16_t w : written) {
+            for (size_t reg = 0; reg < num_registers; ++reg) {
+                if (Liveness::test(live_out.data(), reg)) add_conflict(w, reg);
+            }
+            for (uint16_t other : written) add_conflict(w, other);
+        }
+    }
+
+    std::vector<uint16_t> color(num_registers, 0);
+    size_t new_count = 0;
+    for (size_t reg = 0; reg < num_registers; ++reg) {
+        if (!used[reg]) continue;
+        if (fixed[reg]) {
+            color[reg] = static_cast<uint16_t>(reg);
+            new_count = std::max(new_count, reg + 1);
+        }
+    }
+    for (size_t reg = 0; reg < num_registers; ++reg) {
+        if (!used[reg] || fixed[reg]) continue;
+        std::vector<bool> taken(num_registers, false);
+        taken[0] = true;
+        for (size_t other = 0; other < num_registers; ++other) {
+            // Slot bị bắt giữ thuộc về upvalue suốt đời frame, dù đồ thị xung đột không thấy nó sống
+            if (is_captured(captured, static_cast<uint16_t>(other))) taken[other] = true;
+            if (!used[other] || !Liveness::test(&conflicts[reg * words], other)) continue;
+            // Register chưa tô (không cố định, chỉ số lớn hơn) chưa có màu
+            if (fixed[other] || other < reg) taken[color[other]] = true;
+        }
+        size_t c = 1;
+        while (taken[c]) ++c;
+        color[reg] = static_cast<uint16_t>(c);
+        new_count = std::max(new_count, c + 1);
+    }
+    if (new_count >= num_registers) return num_registers;
+
+    for (Instr& ins : code) {
+        const OpcodeLayout& layout = ins.layout();
+        for (size_t k = 0; k < layout.operand_count; ++k) {
+            if (layout.operands[k] != OperandKind::REG && layout.operands[k] != OperandKind::DST) continue;
+            uint16_t reg = ins.operand(k);
+            if (reg < num_registers && !fixed[reg]) ins.set_operand(k, color[reg]);
+        }
+    }
+    return new_count;
+}
+
+// Thân callee có thể chép vào caller: không upvalue, không try, không phụ thuộc R0 ngầm hay module hiện tại,
+// mọi đường đi đều kết thúc bằng RETURN/THROW. Superinstruction (nếu callee đã được tối ưu trước) trả về lệnh đầu
+bool lift_inline_body(proto_t callee, Code& body) {
+    if (callee->get_num_upvalues() != 0 || !callee->get_exception_table().empty()) return false;
+    const Chunk& chunk = callee->get_chunk();
+    if (!lift(chunk.get_code(), chunk.get_code_size(), body) || body.empty() || body.size() > MAX_INLINE_INSTRUCTIONS) return false;
+    for (Instr& ins : body) {
+        ins.bytes[0] = static_cast<uint8_t>(superinstruction_head(ins.op()));
+        switch (ins.op()) {
+            case OpCode::SETUP_TRY:
+            case OpCode::POP_TRY:
+            case OpCode::GET_SUPER:
+            case OpCode::HALT:
+            case OpCode::CLOSURE:
+            case OpCode::CLOSE_UPVALUES:
+            case OpCode::GET_UPVALUE:
+            case OpCode::SET_UPVALUE:
+            case OpCode::IMPORT_MODULE:
+            case OpCode::EXPORT:
+            case OpCode::GET_EXPORT:
+            case OpCode::IMPORT_ALL:
+            case OpCode::GUARD_CALLEE:
+            case OpCode::TAIL_CALL:
+                return false;
+            default:
+                break;
+        }
+        if (ins.target == body.size()) return false;
+    }
+    OpCode last = body.back().op();
+    return last == OpCode::RETURN || last == OpCode::THROW || last == OpCode::JUMP;
+}
+
+uint16_t proto_constant(Chunk& chunk, proto_t proto) {
+    for (size_t i = 0; i < chunk.get_pool_size(); ++i) {
+        if (chunk.get_constant(i).is_proto() && chunk.get_constant(i).as_proto() == proto) return static_cast<uint16_t>(i);
+    }
+    return static_cast<uint16_t>(chunk.add_constant(Value(proto)));
+}
+
+// Chép callee nhỏ vào chỗ gọi khi đoán được callee (CLOSURE trong cùng block, hoặc global chỉ gán một lần):
+//   GUARD_CALLEE fn, proto, @call
+//   MOVE/LOAD_NULL cho register sống ở đầu callee
+//   <thân callee, register dời lên `base`, RETURN thành MOVE dst + JUMP @end>
+//   @call: CALL ... (giữ nguyên, chạy khi guard sai)
+//   @end:
+// Mọi chỗ gọi dùng chung vùng register [base, base + số register của callee)
+size_t inline_calls(Code& code, proto_t caller, const InlineCandidates& globals, size_t& num_registers) {
+    Chunk& chunk = caller->get_chunk();
+    std::vector<bool> leader = find_leaders(code);
+    std::unordered_map<uint16_t, proto_t> known;
+    size_t base = num_registers;
+    size_t grown = 0;
+    size_t inlined = 0;
+
+    Code out;
+    std::vector<uint32_t> new_index(code.size() + 1);
+    std::vector<bool> copied;  // Lệnh chép vào đã có đích nhảy theo chỉ số mới
+    for (size_t i = 0; i < code.size(); ++i) {
+        if (leader[i]) known.clear();
+        new_index[i] = static_cast<uint32_t>(out.size());
+        const Instr& ins = code[i];
+
+        if (ins.op() == OpCode::CALL || ins.op() == OpCode::CALL_VOID) {
+            bool has_dst = ins.op() == OpCode::CALL;
+            uint16_t dst = has_dst ? ins.operand(0) : 0xFFFF;
+            uint16_t fn = ins.operand(has_dst ? 1 : 0);
+            uint16_t arg_start = ins.operand(has_dst ? 2 : 1);
+            uint16_t argc = ins.operand(has_dst ? 3 : 2);
+            auto it = known.find(fn);
+            Code body;
+            if (it != known.end() && it->second != caller && lift_inline_body(it->second, body) && grown + body.size() <= MAX_INLINE_GROWTH &&
+                base + it->second->get_num_registers() < 0xFFFF && chunk.get_pool_size() + it->second->get_chunk().get_pool_size() < 0xFFFF) {
+                proto_t callee = it->second;
+                size_t callee_registers = callee->get_num_registers();
+                const Chunk& callee_chunk = callee->get_chunk();
+
+                Instr guard;
+                guard.bytes[0] = static_cast<uint8_t>(OpCode::GUARD_CALLEE);
+                guard.set_operand(0, fn);
+                guard.set_operand(1, proto_constant(chunk, callee));
+                size_t guard_at = out.size();
+                out.push_back(guard);
+                copied.push_back(true);
+
+                // Frame mới toàn null, nên register nào được đọc trước khi ghi phải được khởi tạo lại ở mỗi lần vào
+                Liveness entry(body, {}, callee_registers);
+                for (size_t reg = 0; reg < callee_registers; ++reg) {
+                    if (entry.valid() && !Liveness::test(entry.live_in(0), reg)) continue;
+                    Instr init;
+                    if (reg < argc) {
+                        init.bytes[0] = static_cast<uint8_t>(OpCode::MOVE);
+                        init.set_operand(1, static_cast<uint16_t>(arg_start + reg));
+                    } else {
+                        init.bytes[0] = static_cast<uint8_t>(OpCode::LOAD_NULL);
+                    }
+                    init.set_operand(0, static_cast<uint16_t>(base + reg));
+                    out.push_back(init);
+                    copied.push_back(true);
+                }
+
+                std::unordered_map<uint16_t, uint16_t> constants;
+                std::vector<uint32_t> body_index(body.size() + 1);
+                std::vector<size_t> exits;
+                for (size_t k = 0; k < body.size(); ++k) {
+                    Instr copy = body[k];
+                    body_index[k] = static_cast<uint32_t>(out.size());
+                    if (copy.op() == OpCode::RETURN) {
+                        uint16_t value = copy.operand(0);
+                        if (has_dst && dst != 0xFFFF) {
+                            Instr result;
+                            result.bytes[0] = static_cast<uint8_t>(value == 0xFFFF ? OpCode::LOAD_NULL : OpCode::MOVE);
+                            result.set_operand(0, dst);
+                            if (value != 0xFFFF) result.set_operand(1, static_cast<uint16_t>(base + value));
+                            out.push_back(result);
+                            copied.push_back(true);
+                        }
+                        Instr exit;
+                        exit.bytes[0] = static_cast<uint8_t>(OpCode::JUMP);
+                        exits.push_back(out.size());
+                        out.push_back(exit);
+                        copied.push_back(true);
+                        continue;
+                    }
+                    const OpcodeLayout& layout = copy.layout();
+                    for (size_t op = 0; op < layout.operand_count; ++op) {
+                        uint16_t value = copy.operand(op);
+                        switch (layout.operands[op]) {
+                            case OperandKind::REG:
+                            case OperandKind::DST:
+                            case OperandKind::RANGE:
+                                if (value != 0xFFFF) copy.set_operand(op, static_cast<uint16_t>(base + value));
+                                break;
+                            case OperandKind::CONST: {
+                                auto [slot, added] = constants.try_emplace(value, 0);
+                                if (added) slot->second = static_cast<uint16_t>(chunk.add_constant(callee_chunk.get_constant(value)));
+                                copy.set_operand(op, slot->second);
+                                break;
+                            }
+                            default:
+                                break;
+                        }
+                    }
+                    out.push_back(copy);
+                    copied.push_back(true);
+                }
+                // Đích nhảy trong thân trỏ theo chỉ số lệnh của callee
+                for (size_t k = 0; k < body.size(); ++k) {
+                    if (body[k].target != NO_TARGET) out[body_index[k]].target = body_index[body[k].target];
+                }
+                out[guard_at].target = static_cast<uint32_t>(out.size());
+                for (size_t exit : exits) out[exit].target = static_cast<uint32_t>(out.size() + 1);
+
+                num_registers = std::max(num_registers, base + callee_registers);
+                grown += body.size();
+                ++inlined;
+            }
+        }
+
+        out.push_back(ins);
+        copied.push_back(false);
+
+        for_each_clobbered(ins, [&](uint16_t reg) { known.erase(reg); });
+        if (ins.op() == OpCode::CLOSURE || ins.op() == OpCode::GET_GLOBAL) {
+            Value constant = chunk.get_constant(ins.operand(1));
+            if (ins.op() == OpCode::CLOSURE && constant.is_proto()) {
+                known[ins.operand(0)] = constant.as_proto();
+            } else if (ins.op() == OpCode::GET_GLOBAL && constant.is_string()) {
+                auto it = globals.find(constant.as_string()->c_str());
+                if (it != globals.end()) known[ins.operand(0)] = it->second;
+            }
+        }
+    }
+    if (inlined == 0) return 0;
+
+    new_index[code.size()] = static_cast<uint32_t>(out.size());
+    for (size_t k = 0; k < out.size(); ++k) {
+        if (!copied[k] && out[k].target != NO_TARGET) out[k].target = new_index[out[k].target];
+    }
+    code = std::move(out);
+    return inlined;
+}
+
+// CALL dst, ... ngay trước RETURN dst thành TAIL_CALL. RETURN giữ nguyên phòng khi là đích nhảy, nếu không remove_unreachable sẽ xoá.
+// Bỏ qua cả proto nếu có try: handler của frame bị thay sẽ nhảy nhầm vào chunk của callee
+size_t form_tail_calls(Code& code) {
+    for (const Instr& ins : code) {
+        if (ins.op() == OpCode::SETUP_TRY) return 0;
+    }
+    size_t formed = 0;
+    for (size_t i = 0; i + 1 < code.size(); ++i) {
+        if (code[i].op() != OpCode::CALL || code[i + 1].op() != OpCode::RETURN) continue;
+        uint16_t dst = code[i].operand(0);
+        if (dst == 0xFFFF || code[i + 1].operand(0) != dst) continue;
+
+        Instr tail;
+        tail.bytes[0] = static_cast<uint8_t>(OpCode::TAIL_CALL);
+        for (size_t k = 0; k < 3; ++k) tail.set_operand(k, code[i].operand(k + 1));
+        code[i] = tail;
+        ++formed;
+    }
+    return formed;
+}
+
+// SETUP_TRY/POP_TRY lồng nhau đúng cấu trúc thành bảng exception tĩnh trong proto, rồi xoá khỏi code để vào/ra khối try không tốn gì.
+// Duyệt CFG với chồng handler đang mở tại mỗi lệnh; chỉ làm khi mọi đường tới một lệnh cho cùng một chồng.
+// Catch target nhận chồng trước SETUP_TRY vì handler đã bị lấy ra khi lỗi được bắt
+size_t build_exception_table(proto_t proto) {
+    Chunk& chunk = proto->get_chunk();
+    std::vector<Instruction> code;
+    if (!decode_code(chunk.get_code(), chunk.get_code_size(), code)) return 0;
+    size_t n = code.size();
+
+    auto head = [&](size_t i) { return superinstruction_head(code[i].op()); };
+    size_t markers = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (head(i) == OpCode::SETUP_TRY || head(i) == OpCode::POP_TRY) ++markers;
+    }
+    if (markers == 0) return 0;
+
+    using Stack = std::vector<uint32_t>;
+    std::vector<std::optional<Stack>> state(n);
+    std::vector<uint32_t> work;
+    bool consistent = true;
+    auto flow = [&](uint32_t to, const Stack& stack) {
+        if (to >= n) return;  // Chạy hết chunk là return ngầm
+        if (!state[to]) {
+            state[to] = stack;
+            work.push_back(to);
+        } else if (*state[to] != stack) {
+            consistent = false;
+        }
+    };
+    flow(0, {});
+    while (!work.empty() && consistent) {
+        uint32_t i = work.back();
+        work.pop_back();
+        Stack stack = *state[i];
+        std::optional<uint32_t> target = get_jump_target(code[i]);
+        uint32_t target_index = target ? *target : NO_TARGET;
+        switch (head(i)) {
+            case OpCode::SETUP_TRY:
+                flow(target_index, stack);
+                stack.push_back(target_index);
+                flow(i + 1, stack);
+                continue;
+            case OpCode::POP_TRY:
+                if (stack.empty()) return 0;
+                stack.pop_back();
+                flow(i + 1, stack);
+                continue;
+            case OpCode::TAIL_CALL:
+                // Frame bị thay thì bảng tĩnh của proto cũ không còn áp dụng được
+                if (!stack.empty()) return 0;
+                break;
+            default:
+                break;
+        }
+        if (!is_block_terminator(head(i))) flow(i + 1, stack);
+        if (target_index != NO_TARGET) flow(target_index, stack);
+    }
+    if (!consistent) return 0;
+
+    // Bỏ marker; lệnh bị bỏ nhận chỉ số của lệnh kế tiếp. Mã hoá lại vì đích nhảy là tương đối
+    std::vector<uint32_t> new_index(n + 1);
+    std::vector<Instruction> kept;
+    kept.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        new_index[i] = static_cast<uint32_t>(kept.size());
+        if (head(i) != OpCode::SETUP_TRY && head(i) != OpCode::POP_TRY) kept.push_back(code[i]);
+    }
+    new_index[n] = static_cast<uint32_t>(kept.size());
+    for (Instruction& ins : kept) {
+        if (auto target = get_jump_target(ins)) ins.set_address(new_index[*target]);
+    }
+    std::vector<uint8_t> stripped;
+    std::vector<uint32_t> offset_of;
+    if (!encode_code(kept, stripped, &offset_of)) return 0;
+
+    std::vector<ExceptionRegion> table;
+    for (size_t i = 0; i < n; ++i) {
+        if (head(i) == OpCode::SETUP_TRY || head(i) == OpCode::POP_TRY || !state[i] || state[i]->empty()) continue;
+        uint32_t start = offset_of[new_index[i]];
+        uint32_t end = offset_of[new_index[i] + 1];
+        uint32_t handler = offset_of[new_index[state[i]->back()]];
+        if (!table.empty() && table.back().end_ == start && table.back().handler_ == handler) {
+            table.back().end_ = end;
+        } else {
+            table.push_back(ExceptionRegion{start, end, handler});
+        }
+    }
+
+    chunk.set_code(std::move(stripped));
+    proto->set_exception_table(std::move(table));
+    return markers;
+}
+
+RegisterLiveness build_liveness_table(const Chunk& chunk, const std::vector<bool>& captured, size_t num_registers, const std::vector<ExceptionRegion>& table) {
+    Code code;
+    std::vector<size_t> offsets;
+    if (!lift(chunk.get_code(), chunk.get_code_size(), code) || !decode_instructions(chunk.get_code(), chunk.get_code_size(), offsets)) return {};
+    std::vector<uint32_t> handlers;
+    for (const ExceptionRegion& region : table) {
+        auto it = std::lower_bound(offsets.begin(), offsets.end(), region.handler_);
+        if (it != offsets.end() && *it == region.handler_) handlers.push_back(static_cast<uint32_t>(it - offsets.begin()));
+    }
+    Liveness liveness(code, captured, num_registers, std::move(handlers));
+    if (!liveness.valid()) return {};
+
+    size_t words = liveness.words();
+    std::vector<uint64_t> bits(code.size() * words);
+    std::vector<uint64_t> live_out(words);
+    for (size_t i = 0; i < code.size(); ++i) {
+        liveness.live_out(i, live_out);
+        for (size_t w = 0; w < words; ++w) bits[i * words + w] = liveness.live_in(i)[w] | live_out[w];
+    }
+    return RegisterLiveness(std::vector<uint32_t>(offsets.begin(), offsets.end()), std::move(bits), num_registers);
+}
+
+size_t thread_jumps(Code& code) {
+    size_t threaded = 0;
+    for (Instr& ins : code) {
+        if (ins.target == NO_TARGET) continue;
+        uint32_t target = ins.target;
+        for (size_t hops = 0; target < code.size() && code[target].op() == OpCode::JUMP && hops < MAX_THREAD_HOPS; ++hops) {
+            target = code[target].target;
+        }
+        if (target != ins.target) {
+            ins.target = target;
+            ++threaded;
+        }
+    }
+    // JUMP tới ngay lệnh kế tiếp là thừa
+    for (size_t i = 0; i < code.size(); ++i) {
+        if (code[i].op() == OpCode::JUMP && code[i].target == i + 1) {
+            code[i].removed = true;
+            ++threaded;
+        }
+    }
+    return threaded;
+}
+
+size_t remove_unreachable(Code& code) {
+    std::vector<bool> reached(code.size(), false);
+    std::vector<uint32_t> work{0};
+    while (!work.empty()) {
+        uint32_t i = work.back();
+        work.pop_back();
+        if (i >= code.size() || reached[i]) continue;
+        reached[i] = true;
+        if (code[i].target != NO_TARGET) work.push_back(code[i].target);
+        if (!is_block_terminator(code[i].op())) work.push_back(i + 1);
+    }
+
+    size_t removed = 0;
+    for (size_t i = 0; i < code.size(); ++i) {
+        if (reached[i]) continue;
+        code[i].removed = true;
+        ++removed;
+    }
+    return removed;
+}
+
+std::string describe(size_t offset, std::string_view problem) {
+    return std::format("offset {}: {}", offset, problem);
+}
+}  // namespace
+
+InlineCandidates find_inline_candidates(const std::vector<proto_t>& protos) {
+    InlineCandidates candidates;
+    std::unordered_map<std::string, size_t> assignments;
+    for (proto_t proto : protos) {
+        const Chunk& chunk = proto->get_chunk();
+        std::vector<size_t> offsets;
+        if (!decode_instructions(chunk.get_code(), chunk.get_code_size(), offsets)) continue;
+        for (size_t i = 0; i < offsets.size(); ++i) {
+            Instruction ins = decode_instruction(chunk.get_code(), offsets[i]);
+            if (superinstruction_head(ins.op()) != OpCode::SET_GLOBAL) continue;
+            uint16_t name_idx = ins.operand(0);
+            if (name_idx >= chunk.get_pool_size() || !chunk.get_constant(name_idx).is_string()) continue;
+            std::string name = chunk.get_constant(name_idx).as_string()->c_str();
+            ++assignments[name];
+
+            // Chỉ nhận mẫu CLOSURE r, proto ngay trước SET_GLOBAL name, r
+            if (i == 0) continue;
+            Instruction prev = decode_instruction(chunk.get_code(), offsets[i - 1]);
+            if (superinstruction_head(prev.op()) != OpCode::CLOSURE || prev.operand(0) != ins.operand(1)) continue;
+            uint16_t proto_idx = prev.operand(1);
+            if (proto_idx < chunk.get_pool_size() && chunk.get_constant(proto_idx).is_proto()) candidates[name] = chunk.get_constant(proto_idx).as_proto();
+        }
+    }
+    // Global gán nhiều lần thì không đoán được, GUARD_CALLEE vẫn đúng nhưng sẽ trượt liên tục
+    std::erase_if(candidates, [&](const auto& entry) { return assignments[entry.first] != 1; });
+    return candidates;
+}
+
+OptimizerOptions OptimizerOptions::from_environment() noexcept {
+    OptimizerOptions options;
+    const char* disable = std::getenv("MEOW_NO_OPTIMIZE");
+    if (disable != nullptr && *disable != '\0' && std::string_view(disable) != "0") options.enabled = false;
+    return options;
+}
+
+std::optional<std::string> verify_chunk(const Chunk& chunk, size_t num_registers, size_t num_upvalues) {
+    const uint8_t* code = chunk.get_code();
+    size_t size = chunk.get_code_size();
+    std::vector<size_t> offsets;
+    if (!decode_instructions(code, size, offsets)) return "unknown opcode or truncated instruction";
+
+    std::vector<bool> boundary(size + 1, false);
+    for (size_t offset : offsets) boundary[offset] = true;
+    boundary[size] = true;
+
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        size_t offset = offsets[i];
+        Instruction instruction = decode_instruction(code, offset);
+        OpCode op = instruction.op();
+        const OpcodeLayout& layout = instruction.layout();
+
+        std::array<RegisterRange, 4> ranges;
+        size_t count = get_read_ranges(instruction, ranges);
+        for (size_t r = 0; r < count; ++r) {
+            // HALT đọc R0 chỉ khi có register, xem op_HALT
+            if (op == OpCode::HALT) break;
+            if (ranges[r].first + ranges[r].count > num_registers) return describe(offset, "register read out of frame");
+        }
+        count = get_write_ranges(instruction, ranges);
+        for (size_t r = 0; r < count; ++r) {
+            if (ranges[r].first + ranges[r].count > num_registers) return describe(offset, "register write out of frame");
+        }
+
+        for (size_t k = 0; k < layout.operand_count; ++k) {
+            switch (layout.operands[k]) {
+                case OperandKind::CONST:
+                    if (instruction.operand(k) >= chunk.get_pool_size()) return describe(offset, "constant index out of range");
+                    break;
+                case OperandKind::ADDR:
+                    if (instruction.address() > size || !boundary[instruction.address()]) return describe(offset, "jump target is not an instruction boundary");
+                    break;
+                case OperandKind::COUNT: {
+                    OpCode head = superinstruction_head(op);
+                    if ((head == OpCode::GET_UPVALUE || head == OpCode::SET_UPVALUE) && instruction.operand(k) >= num_upvalues) {
+                        return describe(offset, "upvalue index out of range");
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        if (is_superinstruction(op)) {
+            const Superinstruction& si = SUPERINSTRUCTIONS[static_cast<size_t>(op) - FIRST_SUPERINSTRUCTION];
+            for (size_t k = 1; k < si.length; ++k) {
+                if (i + k >= offsets.size() || superinstruction_head(static_cast<OpCode>(code[offsets[i + k]])) != si.parts[k]) {
+                    return describe(offset, "superinstruction does not match the following instructions");
+                }
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+OptimizerStats optimize_proto(proto_t proto, const OptimizerOptions& options, const InlineCandidates& globals) {
+    OptimizerStats stats;
+    if (!options.enabled) return stats;
+
+    Chunk& chunk = proto->get_chunk();
+    size_t num_registers = proto->get_num_registers();
+    size_t num_upvalues = proto->get_num_upvalues();
+    if (options.verify && verify_chunk(chunk, num_registers, num_upvalues)) return stats;
+
+    std::vector<uint8_t> original(chunk.get_code(), chunk.get_code() + chunk.get_code_size());
+    std::vector<bool> captured = captured_registers(chunk);
+
+    Code code;
+    if (lift(chunk.get_code(), chunk.get_code_size(), code) && !code.empty()) {
+        if (options.inline_calls) stats.inlined = inline_calls(code, proto, globals, num_registers);
+        stats.tail_calls = form_tail_calls(code);
+        for (size_t round = 0; round < MAX_ROUNDS; ++round) {
+            size_t changes = 0;
+            auto run = [&](size_t& counter, size_t found) {
+                counter += found;
+                changes += found;
+                compact(code);
+            };
+            run(stats.unreachable, remove_unreachable(code));
+            run(stats.threaded, thread_jumps(code));
+            run(stats.folded, fold_constants(code, captured));
+            run(stats.propagated, propagate_copies(code, captured));
+            run(stats.dead_stores, eliminate_dead_stores(code, captured, num_registers));
+            if (changes == 0 || code.empty()) break;
+        }
+        stats.shrunk = shrink_immediates(code);
+        size_t compacted = compact_registers(code, captured, num_registers);
+        std::vector<uint8_t> out;
+        if (lower(code, out)) {
+            // Không đổi gì thì giữ nguyên code, để chunk nạp từ tệp được map không phải chép
+            if (!std::equal(out.begin(), out.end(), chunk.get_code(), chunk.get_code() + chunk.get_code_size())) chunk.set_code(std::move(out));
+            stats.registers_saved = num_registers - compacted;
+            num_registers = compacted;
+        } else {
+            stats = OptimizerStats{};
+            num_registers = proto->get_num_registers();
+        }
+    }
+
+    stats.fused_branches = fuse_compare_branches(chunk);
+    // Phải chạy cuối cùng: superinstruction không chịu được việc đổi opcode của các lệnh phía sau
+    if (options.superinstructions) stats.superinstructions = form_superinstructions(chunk);
+
+    if (options.verify && verify_chunk(chunk, num_registers, num_upvalues)) {
+        chunk.set_code(std::move(original));
+        chunk.set_liveness(build_liveness_table(chunk, captured, proto->get_num_registers(), proto->get_exception_table()));
+        return OptimizerStats{.reverted = true};
+    }
+    proto->set_num_registers(num_registers);
+
+    std::vector<uint8_t> with_markers(chunk.get_code(), chunk.get_code() + chunk.get_code_size());
+    stats.try_markers = build_exception_table(proto);
+    if (stats.try_markers != 0 && options.verify && verify_chunk(chunk, num_registers, num_upvalues)) {
+        chunk.set_code(std::move(with_markers));
+        proto->set_exception_table({});
+        stats.try_markers = 0;
+    }
+    chunk.set_liveness(build_liveness_table(chunk, captured, num_registers, proto->get_exception_table()));
+    return stats;
+}
+
+std::optional<std::string> adopt_optimized_proto(proto_t proto) {
+    Chunk& chunk = proto->get_chunk();
+    if (auto error = verify_chunk(chunk, proto->get_num_registers(), proto->get_num_upvalues())) return error;
+    for (const ExceptionRegion& region : proto->get_exception_table()) {
+        if (region.start_ >= region.end_ || region.end_ > chunk.get_code_size() || region.handler_ >= chunk.get_code_size()) {
+            return std::format("exception region [{}, {}) -> {} is out of bounds", region.start_, region.end_, region.handler_);
+        }
+    }
+    chunk.set_liveness(build_liveness_table(chunk, captured_registers(chunk), proto->get_num_registers(), proto->get_exception_table()));
+    return std::nullopt;
+}
+}  // namespace meow::runtime
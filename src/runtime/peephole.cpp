@@ -0,0 +1,177 @@
+#include "runtime/peephole.h"
+#include "core/objects/function.h"
+#include "core/superinstructions.h"
+#include "runtime/bytecode.h"
+#include "runtime/chunk.h"
+
+using namespace meow::core;
+
+namespace meow::runtime {
+namespace {
+struct FusedBranch {
+    OpCode op;
+    bool swap;
+};
+
+// Opcode gộp cho (so sánh, nhảy khi true?). GT/GE được đổi thành LT/LE với toán hạng đảo
+std::optional<FusedBranch> fused_branch_for(OpCode compare, bool jump_if_true) noexcept {
+    using enum OpCode;
+    switch (compare) {
+        case EQ:  return FusedBranch{jump_if_true ? JUMP_IF_EQ : JUMP_IF_NEQ, false};
+        case NEQ: return FusedBranch{jump_if_true ? JUMP_IF_NEQ : JUMP_IF_EQ, false};
+        case LT:  return FusedBranch{jump_if_true ? JUMP_IF_LT : JUMP_IF_NOT_LT, false};
+        case LE:  return FusedBranch{jump_if_true ? JUMP_IF_LE : JUMP_IF_NOT_LE, false};
+        case GT:  return FusedBranch{jump_if_true ? JUMP_IF_LT : JUMP_IF_NOT_LT, true};
+        case GE:  return FusedBranch{jump_if_true ? JUMP_IF_LE : JUMP_IF_NOT_LE, true};
+        default:  return std::nullopt;
+    }
+}
+
+// Duyệt mọi đường đi từ `starts` (chỉ số lệnh): register chết nếu bị ghi đè (hoặc hàm kết thúc) trước khi được đọc
+bool is_dead_from(const std::vector<Instruction>& code, std::vector<size_t> work, uint16_t reg) {
+    std::vector<bool> seen(code.size(), false);
+    while (!work.empty()) {
+        size_t index = work.back();
+        work.pop_back();
+        if (index >= code.size() || seen[index]) continue;
+        seen[index] = true;
+
+        const Instruction& instruction = code[index];
+        if (reads_register(instruction, reg)) return false;
+        if (writes_register(instruction, reg)) continue;
+
+        if (auto target = get_jump_target(instruction)) work.push_back(*target);
+        if (!is_block_terminator(instruction.op())) work.push_back(index + 1);
+    }
+    return true;
+}
+}  // namespace
+
+// Register bị closure bắt giữ có thể được đọc qua upvalue ở bất cứ đâu
+std::vector<bool> captured_registers(const Chunk& chunk) {
+    std::vector<bool> captured;
+    const uint8_t* code = chunk.get_code();
+    std::vector<size_t> offsets;
+    if (!decode_instructions(code, chunk.get_code_size(), offsets)) {
+        captured.assign(UINT16_MAX + 1, true);
+        return captured;
+    }
+    for (size_t offset : offsets) {
+        Instruction closure = decode_instruction(code, offset);
+        if (closure.op() != OpCode::CLOSURE) continue;
+        uint16_t proto_idx = closure.operand(1);
+        if (proto_idx >= chunk.get_pool_size() || !chunk.get_constant(proto_idx).is_proto()) {
+            // Không biết closure bắt register nào: coi như tất cả
+            captured.assign(UINT16_MAX + 1, true);
+            return captured;
+        }
+        proto_t proto = chunk.get_constant(proto_idx).as_proto();
+        for (size_t i = 0; i < proto->desc_size(); ++i) {
+            const auto& desc = proto->get_desc(i);
+            if (!desc.is_local_) continue;
+            if (desc.index_ >= captured.size()) captured.resize(desc.index_ + 1, false);
+            captured[desc.index_] = true;
+        }
+    }
+    return captured;
+}
+
+size_t fuse_compare_branches(Chunk& chunk) {
+    std::vector<Instruction> code;
+    if (!decode_code(chunk.get_code(), chunk.get_code_size(), code)) return 0;
+    size_t n = code.size();
+
+    std::vector<bool> is_target(n + 1, false);
+    std::vector<size_t> catch_targets;
+    for (const Instruction& instruction : code) {
+        auto target = get_jump_target(instruction);
+        if (!target) continue;
+        is_target[*target] = true;
+        if (instruction.op() == OpCode::SETUP_TRY) catch_targets.push_back(*target);
+    }
+    std::vector<bool> captured = captured_registers(chunk);
+
+    // Lệnh bị gộp trỏ về lệnh gộp ngay trước nó; không lệnh nào nhảy vào đó nên chỉ để đánh số lại
+    std::vector<Instruction> out;
+    out.reserve(n);
+    std::vector<uint32_t> new_index(n + 1, NO_OFFSET);
+    size_t fused = 0;
+
+    for (size_t i = 0; i < n; ++i) {
+        const Instruction& instruction = code[i];
+        new_index[i] = static_cast<uint32_t>(out.size());
+
+        if (i + 1 < n) {
+            const Instruction& next = code[i + 1];
+            OpCode next_op = next.op();
+            auto branch = fused_branch_for(instruction.op(), next_op == OpCode::JUMP_IF_TRUE);
+            // Chỉ lệnh so sánh mới có toán hạng đích để đọc
+            uint16_t dst = branch ? instruction.operand(0) : 0;
+
+            if (branch && (next_op == OpCode::JUMP_IF_FALSE || next_op == OpCode::JUMP_IF_TRUE) && next.operand(0) == dst && !is_target[i + 1] &&
+                (dst >= captured.size() || !captured[dst])) {
+                uint32_t target = next.address();
+                std::vector<size_t> successors = catch_targets;
+                successors.push_back(i + 2);
+                successors.push_back(target);
+
+                if (is_dead_from(code, std::move(successors), dst)) {
+                    uint16_t r1 = instruction.operand(1);
+                    uint16_t r2 = instruction.operand(2);
+                    if (branch->swap) std::swap(r1, r2);
+
+                    Instruction jump(branch->op);
+                    jump.set_operand(0, r1);
+                    jump.set_operand(1, r2);
+                    jump.set_address(target);
+                    out.push_back(jump);
+                    new_index[i + 1] = new_index[i];
+                    ++fused;
+                    ++i;
+                    continue;
+                }
+            }
+        }
+        out.push_back(instruction);
+    }
+    if (fused == 0) return 0;
+
+    new_index[n] = static_cast<uint32_t>(out.size());
+    for (Instruction& instruction : out) {
+        if (get_jump_target(instruction)) instruction.set_address(new_index[instruction.address()]);
+    }
+    std::vector<uint8_t> bytes;
+    if (!encode_code(out, bytes)) return 0;
+    chunk.set_code(std::move(bytes));
+    return fused;
+}
+
+size_t form_superinstructions(Chunk& chunk) {
+    const uint8_t* code = chunk.get_code();
+    size_t size = chunk.get_code_size();
+
+    std::vector<size_t> offsets;
+    if (!decode_instructions(code, size, offsets)) return 0;
+
+    // So khớp trên mã gốc: lệnh thứ hai của một superinstruction vẫn có thể là đầu của superinstruction khác,
+    // vì handler gộp nhảy thẳng vào label của lệnh thường chứ không đọc lại byte opcode đó
+    std::vector<uint8_t> out(code, code + size);
+    size_t formed = 0;
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        for (const Superinstruction& si : SUPERINSTRUCTIONS) {
+            if (i + si.length > offsets.size()) continue;
+            bool match = true;
+            // Lệnh WIDE có byte đầu là tiền tố nên không bao giờ khớp: handler gộp chỉ đọc toán hạng dạng hẹp
+            for (size_t k = 0; k < si.length && match; ++k) {
+                match = static_cast<OpCode>(code[offsets[i + k]]) == si.parts[k];
+            }
+            if (!match) continue;
+            out[offsets[i]] = static_cast<uint8_t>(si.op);
+            ++formed;
+            break;
+        }
+    }
+    if (formed != 0) chunk.set_code(std::move(out));
+    return formed;
+}
+}  // namespace meow::runtime
@@ -1,10 +1,11 @@
 #pragma once
 // Chứa các handler cho Array, Hash, Index
 
+template <bool Wide>
 inline void MeowVM::op_new_array(const uint8_t*& ip) {
-    uint16_t dst = READ_U16();
-    uint16_t start_idx = READ_U16();
-    uint16_t count = READ_U16();
+    uint16_t dst = READ_ARG();
+    uint16_t start_idx = READ_ARG();
+    uint16_t count = READ_ARG();
     auto array = heap_->new_array();
     array->reserve(count);
     for (size_t i = 0; i < count; ++i) {
@@ -15,10 +16,11 @@ inline void MeowVM::op_new_array(const uint8_t*& ip) {
     printl("is_array(): {}", REGISTER(dst).is_array());
 }
 
+template <bool Wide>
 inline void MeowVM::op_new_hash(const uint8_t*& ip) {
-    uint16_t dst = READ_U16();
-    uint16_t start_idx = READ_U16();
-    uint16_t count = READ_U16();
+    uint16_t dst = READ_ARG();
+    uint16_t start_idx = READ_ARG();
+    uint16_t count = READ_ARG();
     auto hash_table = heap_->new_hash();
     for (size_t i = 0; i < count; ++i) {
         Value& key = REGISTER(start_idx + i * 2);
@@ -31,12 +33,15 @@ inline void MeowVM::op_new_hash(const uint8_t*& ip) {
     REGISTER(dst) = Value(hash_table);
 }
 
+template <bool Wide>
 inline void MeowVM::op_get_index(const uint8_t*& ip) {
-    uint16_t dst = READ_U16();
-    uint16_t src_reg = READ_U16();
-    uint16_t key_reg = READ_U16();
+    const uint8_t* op_start = ip - 1 - Wide;
+    uint16_t dst = READ_ARG();
+    uint16_t src_reg = READ_ARG();
+    uint16_t key_reg = READ_ARG();
     Value& src = REGISTER(src_reg);
     Value& key = REGISTER(key_reg);
+    if (auto* slot = FEEDBACK_SLOT(op_start)) slot->record(src, key);
     if (src.is_array()) {
         if (!key.is_int()) throw_vm_error("Array index must be an integer.");
         int64_t idx = key.as_int();
@@ -44,7 +49,18 @@ inline void MeowVM::op_get_index(const uint8_t*& ip) {
         if (idx < 0 || (uint64_t)idx >= arr->size()) {
             throw_vm_error("Array index out of bounds.");
         }
-        REGISTER(dst) = arr->get(idx);
+        // Packed arrays: đọc thẳng số, không cần kiểm tra tag
+        switch (arr->kind()) {
+            case objects::ElementKind::INT:
+                REGISTER(dst) = arr->int_data()[idx];
+                break;
+            case objects::ElementKind::FLOAT:
+                REGISTER(dst) = arr->float_data()[idx];
+                break;
+            default:
+                REGISTER(dst) = arr->get(idx);
+                break;
+        }
     } else if (src.is_hash_table()) {
         if (!key.is_string()) throw_vm_error("Hash table key must be a string.");
         hash_table_t hash = src.as_hash_table();
@@ -66,22 +82,37 @@ inline void MeowVM::op_get_index(const uint8_t*& ip) {
     }
 }
 
+template <bool Wide>
 inline void MeowVM::op_set_index(const uint8_t*& ip) {
-    uint16_t src_reg = READ_U16();
-    uint16_t key_reg = READ_U16();
-    uint16_t val_reg = READ_U16();
+    const uint8_t* op_start = ip - 1 - Wide;
+    uint16_t src_reg = READ_ARG();
+    uint16_t key_reg = READ_ARG();
+    uint16_t val_reg = READ_ARG();
     Value& src = REGISTER(src_reg);
     Value& key = REGISTER(key_reg);
+    if (auto* slot = FEEDBACK_SLOT(op_start)) slot->record(src, key);
     Value& val = REGISTER(val_reg);
     if (src.is_array()) {
         if (!key.is_int()) throw_vm_error("Array index must be an integer.");
         int64_t idx = key.as_int();
         array_t arr = src.as_array();
         if (idx < 0) throw_vm_error("Array index cannot be negative.");
-        if ((uint64_t)idx >= arr->size()) {
+        uint64_t size = arr->size();
+        if ((uint64_t)idx < size) {
+            // Packed arrays: ghi thẳng nếu giá trị cùng kiểu, ngược lại set() sẽ chuyển sang VALUE
+            if (arr->kind() == objects::ElementKind::INT && val.is_int()) {
+                arr->int_data()[idx] = val.as_int();
+            } else if (arr->kind() == objects::ElementKind::FLOAT && val.is_float()) {
+                arr->float_data()[idx] = val.as_float();
+            } else {
+                arr->set(idx, val);
+            }
+        } else if ((uint64_t)idx == size) {
+            arr->push(val);
+        } else {
             arr->resize(idx + 1);
+            arr->set(idx, val);
         }
-        arr->set(idx, val);
     } else if (src.is_hash_table()) {
         if (!key.is_string()) throw_vm_error("Hash table key must be a string.");
         hash_table_t hash = src.as_hash_table();
@@ -91,9 +122,10 @@ inline void MeowVM::op_set_index(const uint8_t*& ip) {
     }
 }
 
+template <bool Wide>
 inline void MeowVM::op_get_keys(const uint8_t*& ip) {
-    uint16_t dst = READ_U16();
-    uint16_t src_reg = READ_U16();
+    uint16_t dst = READ_ARG();
+    uint16_t src_reg = READ_ARG();
     Value& src = REGISTER(src_reg);
     auto keys_array = heap_->new_array();
     if (src.is_hash_table()) {
@@ -119,9 +151,10 @@ inline void MeowVM::op_get_keys(const uint8_t*& ip) {
     REGISTER(dst) = Value(keys_array);
 }
 
+template <bool Wide>
 inline void MeowVM::op_get_values(const uint8_t*& ip) {
-    uint16_t dst = READ_U16();
-    uint16_t src_reg = READ_U16();
+    uint16_t dst = READ_ARG();
+    uint16_t src_reg = READ_ARG();
     Value& src = REGISTER(src_reg);
     auto vals_array = heap_->new_array();
     if (src.is_hash_table()) {
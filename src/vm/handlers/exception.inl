@@ -1,6 +1,63 @@
 #pragma once
 // Chứa các handler cho Exception (Try/Catch/Throw)
 
+inline bool MeowVM::handle_error(const std::string& message, const uint8_t*& ip) {
+    printl("An execption was threw: {}", message);
+#ifdef MEOW_PROFILE_OPCODES
+    opcode_profile_.break_sequence();
+#endif
+    auto& frames = context_->call_stack_;
+    auto& handlers = context_->exception_handlers_;
+
+    // Tìm trước rồi mới gỡ frame, để lỗi không ai bắt vẫn giữ nguyên stack
+    size_t kept_handlers = handlers.size();
+    size_t depth = frames.size();
+    size_t catch_ip = 0;
+    size_t stack_depth = 0;
+    bool found = false;
+    while (!found && depth > 0) {
+        --depth;
+        // Bản ghi của frame sâu hơn (hoặc của frame đã return mà không POP_TRY) không còn hiệu lực
+        while (kept_handlers > 0 && handlers[kept_handlers - 1].frame_depth_ > depth) --kept_handlers;
+        if (kept_handlers > 0 && handlers[kept_handlers - 1].frame_depth_ == depth) {
+            --kept_handlers;
+            catch_ip = handlers[kept_handlers].catch_ip_;
+            stack_depth = handlers[kept_handlers].stack_depth_;
+            found = true;
+        } else {
+            // Frame đang chạy dừng ở đầu lệnh lỗi, frame gọi thì đã lưu ip ngay sau lệnh CALL
+            const CallFrame& frame = frames[depth];
+            proto_t proto = frame.function_->get_proto();
+            size_t pc = static_cast<size_t>(frame.ip_ - proto->get_chunk().get_code());
+            if (depth + 1 != frames.size() && pc > 0) --pc;
+            if (const objects::ExceptionRegion* region = proto->find_exception_region(pc)) {
+                catch_ip = region->handler_;
+                stack_depth = frame.start_reg_ + proto->get_num_registers();
+                found = true;
+            }
+        }
+    }
+    if (!found) {
+        printl("No exception handler. Halting.");
+        uncaught_error_ = message;
+        return false;
+    }
+
+    while (frames.size() - 1 > depth) {
+        close_upvalues(context_.get(), frames.back().start_reg_);
+        frames.pop_back();
+    }
+    handlers.resize(kept_handlers);
+    context_->registers_.resize(stack_depth);
+    context_->current_frame_ = &frames.back();
+    context_->current_base_ = context_->current_frame_->start_reg_;
+    ip = CURRENT_CHUNK().get_code() + catch_ip;
+    if (context_->current_base_ < context_->registers_.size()) {
+        REGISTER(0) = Value(heap_->new_string(message));
+    }
+    return true;
+}
+
 inline void MeowVM::op_pop_try() {
     if (!context_->exception_handlers_.empty()) {
         context_->exception_handlers_.pop_back();
@@ -1,44 +1,59 @@
 #pragma once
 
+template <bool Wide>
 inline void MeowVM::op_load_const(const uint8_t*& ip) {
-    uint16_t dst = READ_U16();
+    uint16_t dst = READ_ARG();
     Value value = READ_CONSTANT();
     REGISTER(dst) = value;
 }
 
+template <bool Wide>
 inline void MeowVM::op_load_null(const uint8_t*& ip) {
-    uint16_t dst = READ_U16();
+    uint16_t dst = READ_ARG();
     REGISTER(dst) = Value(null_t{});
     printl("load_null r{}", dst);
 }
 
+template <bool Wide>
 inline void MeowVM::op_load_true(const uint8_t*& ip) {
-    uint16_t dst = READ_U16();
+    uint16_t dst = READ_ARG();
     REGISTER(dst) = Value(true);
     printl("load_true r{}", dst);
 }
 
+template <bool Wide>
 inline void MeowVM::op_load_false(const uint8_t*& ip) {
-    uint16_t dst = READ_U16();
+    uint16_t dst = READ_ARG();
     REGISTER(dst) = Value(false);
     printl("load_false r{}", dst);
 }
 
+template <bool Wide>
 inline void MeowVM::op_move(const uint8_t*& ip) {
-    uint16_t dst = READ_U16();
-    uint16_t src = READ_U16();
+    uint16_t dst = READ_ARG();
+    uint16_t src = READ_ARG();
     REGISTER(dst) = REGISTER(src);
 }
 
+template <bool Wide>
 inline void MeowVM::op_load_int(const uint8_t*& ip) {
-    uint16_t dst = READ_U16();
+    uint16_t dst = READ_ARG();
     int64_t value = READ_I64();
     REGISTER(dst) = Value(value);
     printl("load_int r{}, {}", dst, value);
 }
 
+template <bool Wide>
+inline void MeowVM::op_load_smallint(const uint8_t*& ip) {
+    uint16_t dst = READ_ARG();
+    int64_t value = static_cast<int16_t>(READ_U16());
+    REGISTER(dst) = Value(value);
+    printl("load_smallint r{}, {}", dst, value);
+}
+
+template <bool Wide>
 inline void MeowVM::op_load_float(const uint8_t*& ip) {
-    uint16_t dst = READ_U16();
+    uint16_t dst = READ_ARG();
     double value = READ_F64();
     REGISTER(dst) = Value(value);
     printl("load_float r{}, {}", dst, value);
@@ -0,0 +1,197 @@
+#pragma once
+// Chứa các handler cho vòng lặp số (FOR_PREP/FOR_LOOP) và duyệt collection (FOR_IN, ITER_NEW/ITER_NEXT)
+
+// Khối register của vòng for số: [base] = chỉ số, [base+1] = giới hạn, [base+2] = bước nhảy, [base+3] = biến lặp
+
+template <bool Wide>
+inline void MeowVM::op_for_prep(const uint8_t*& ip) {
+    const uint8_t* op_start = ip - 1 - Wide;
+    uint16_t base = READ_ARG();
+    int32_t exit = READ_JUMP();
+    Value& index = REGISTER(base);
+    Value& limit = REGISTER(base + 1);
+    Value& step = REGISTER(base + 2);
+
+    // Bản int: cả ba đều là int thì FOR_LOOP sẽ chạy nhánh int
+    if (index.is_int() && limit.is_int() && step.is_int()) {
+        int64_t i = index.as_int(), l = limit.as_int(), s = step.as_int();
+        if (s == 0) throw_vm_error("FOR_PREP: Bước nhảy của vòng lặp phải khác 0.");
+        if (s > 0 ? i > l : i < l) {
+            ip = op_start + exit;
+            return;
+        }
+        REGISTER(base + 3) = Value(i);
+        return;
+    }
+
+    // Bản float: chuẩn hoá cả ba về float để FOR_LOOP không phải kiểm tra lại kiểu
+    auto to_float = [](param_t value, double& out) noexcept {
+        if (value.is_int()) out = static_cast<double>(value.as_int());
+        else if (value.is_float()) out = value.as_float();
+        else return false;
+        return true;
+    };
+    double i, l, s;
+    if (!to_float(index, i) || !to_float(limit, l) || !to_float(step, s)) {
+        throw_vm_error("FOR_PREP: Chỉ số, giới hạn và bước nhảy phải là số.");
+    }
+    if (s == 0.0 || std::isnan(s)) throw_vm_error("FOR_PREP: Bước nhảy của vòng lặp phải khác 0.");
+    index = Value(i);
+    limit = Value(l);
+    step = Value(s);
+    if (s > 0 ? !(i <= l) : !(i >= l)) {
+        ip = op_start + exit;
+        return;
+    }
+    REGISTER(base + 3) = Value(i);
+}
+
+template <bool Wide>
+inline void MeowVM::op_for_loop(const uint8_t*& ip) {
+    const uint8_t* op_start = ip - 1 - Wide;
+    uint16_t base = READ_ARG();
+    int32_t body = READ_JUMP();
+    Value& index = REGISTER(base);
+    Value& limit = REGISTER(base + 1);
+    Value& step = REGISTER(base + 2);
+
+    // FOR_PREP để cả ba cùng int hoặc cùng float; thân vòng lặp vẫn có thể ghi đè giới hạn hoặc bước nhảy
+    if (index.is_int() && limit.is_int() && step.is_int()) {
+        int64_t i = index.as_int(), l = limit.as_int(), s = step.as_int();
+        // Thân vòng lặp có thể kéo giới hạn về sau chỉ số; khi đó khoảng còn lại dưới đây sẽ quay vòng thành số rất lớn
+        if (s > 0 ? i > l : i < l) return;
+        // Tính khoảng còn lại bằng unsigned để i + s không bao giờ tràn
+        uint64_t remaining = s > 0 ? static_cast<uint64_t>(l) - static_cast<uint64_t>(i) : static_cast<uint64_t>(i) - static_cast<uint64_t>(l);
+        uint64_t stride = s > 0 ? static_cast<uint64_t>(s) : uint64_t{0} - static_cast<uint64_t>(s);
+        if (remaining < stride) return;
+        i += s;
+        index = Value(i);
+        REGISTER(base + 3) = Value(i);
+        ip = op_start + body;
+        return;
+    }
+
+    if (!index.is_float() || !limit.is_float() || !step.is_float()) {
+        throw_vm_error("FOR_LOOP: Chỉ số, giới hạn và bước nhảy phải cùng là int hoặc cùng là float.");
+    }
+    double s = step.as_float();
+    double l = limit.as_float();
+    double i = index.as_float() + s;
+    if (s > 0 ? !(i <= l) : !(i >= l)) return;
+    index = Value(i);
+    REGISTER(base + 3) = Value(i);
+    ip = op_start + body;
+}
+
+// Một bước duyệt: có phần tử, hết phần tử, hoặc hash table đã bị rehash nên con trỏ không còn dùng được
+enum class IterStep : uint8_t { ENTRY, DONE, REHASHED };
+
+// Con trỏ duyệt theo bucket (int 47 bit, 0 = chưa bắt đầu): 12 bit thấp là vị trí trong bucket, 29 bit kế là chỉ số
+// bucket, 6 bit cao là bit_width(bucket_count) lúc đọc phần tử trước. Bảng chỉ tự rehash khi lớn lên và mỗi lần ít
+// nhất gấp đôi số bucket nên 6 bit này luôn đổi: vị trí cũ trỏ sai bucket, phải báo lỗi thay vì bỏ sót hay lặp lại.
+// Bucket của unordered_map (key là con trỏ chuỗi) chỉ có vài phần tử nên mỗi bước là O(1) trung bình, còn xa mới chạm
+// giới hạn 4095 phần tử mỗi bucket và 2^29 bucket
+constexpr int CURSOR_LOCAL_BITS = 12;
+constexpr int CURSOR_BUCKET_BITS = 29;
+
+template <typename Buckets>
+inline IterStep next_bucket_entry(const Buckets& table, int64_t& cursor, Value& key, Value& value) {
+    const uint64_t tag = static_cast<uint64_t>(std::bit_width(table.bucket_count()));
+    const uint64_t raw = static_cast<uint64_t>(cursor);
+    if (raw != 0 && raw >> (CURSOR_LOCAL_BITS + CURSOR_BUCKET_BITS) != tag) return IterStep::REHASHED;
+    size_t bucket = (raw >> CURSOR_LOCAL_BITS) & ((uint64_t{1} << CURSOR_BUCKET_BITS) - 1);
+    size_t local = raw & ((uint64_t{1} << CURSOR_LOCAL_BITS) - 1);
+    for (; bucket < table.bucket_count(); ++bucket, local = 0) {
+        if (local < table.bucket_size(bucket)) {
+            auto it = std::next(table.begin(bucket), static_cast<std::ptrdiff_t>(local));
+            key = Value(it->first);
+            value = it->second;
+            cursor = static_cast<int64_t>((tag << (CURSOR_LOCAL_BITS + CURSOR_BUCKET_BITS)) | (bucket << CURSOR_LOCAL_BITS) | (local + 1));
+            return IterStep::ENTRY;
+        }
+    }
+    return IterStep::DONE;
+}
+
+inline bool is_iterable(param_t value) noexcept {
+    return value.is_array() || value.is_hash_table() || value.is_string() || value.is_instance();
+}
+
+// Một bước duyệt chung cho FOR_IN và ITER_NEXT, không cấp phát gì ngoài chuỗi 1 ký tự (đã intern) khi duyệt string.
+// `collection` phải thoả is_iterable
+inline IterStep next_entry(MemoryManager* heap, param_t collection, int64_t& cursor, Value& key, Value& value, bool want_value) {
+    if (collection.is_hash_table()) return next_bucket_entry(*collection.as_hash_table(), cursor, key, value);
+    if (collection.is_instance()) return next_bucket_entry(collection.as_instance()->get_fields(), cursor, key, value);
+
+    if (cursor < 0) return IterStep::DONE;
+    size_t index = static_cast<size_t>(cursor);
+    if (collection.is_array()) {
+        array_t arr = collection.as_array();
+        if (index >= arr->size()) return IterStep::DONE;
+        if (want_value) value = arr->get(index);
+    } else {
+        string_t str = collection.as_string();
+        if (index >= str->size()) return IterStep::DONE;
+        if (want_value) value = Value(heap->new_string(std::string_view(str->c_str() + index, 1)));
+    }
+    key = Value(cursor);
+    cursor += 1;
+    return IterStep::ENTRY;
+}
+
+// Khối register của FOR_IN: [base] = collection, [base+1] = con trỏ (int, khởi tạo 0), [base+2] = key, [base+3] = value
+template <bool Wide>
+inline void MeowVM::op_for_in(const uint8_t*& ip) {
+    const uint8_t* op_start = ip - 1 - Wide;
+    uint16_t base = READ_ARG();
+    int32_t exit = READ_JUMP();
+    Value collection = REGISTER(base);
+    if (!is_iterable(collection)) throw_vm_error("FOR_IN: Giá trị không duyệt được.");
+    if (!REGISTER(base + 1).is_int()) throw_vm_error("FOR_IN: Thanh ghi con trỏ phải là int.");
+    int64_t cursor = REGISTER(base + 1).as_int();
+
+    Value key, value;
+    IterStep step = next_entry(heap_.get(), collection, cursor, key, value, true);
+    if (step == IterStep::REHASHED) throw_vm_error("FOR_IN: Collection bị thêm phần tử (rehash) trong lúc duyệt.");
+    if (step == IterStep::DONE) {
+        ip = op_start + exit;
+        return;
+    }
+    REGISTER(base + 1) = Value(cursor);
+    REGISTER(base + 2) = key;
+    REGISTER(base + 3) = value;
+}
+
+// Iterator là cặp register: [iter] = collection, [iter+1] = con trỏ. Không cần object iterator riêng
+template <bool Wide>
+inline void MeowVM::op_iter_new(const uint8_t*& ip) {
+    uint16_t iter = READ_ARG();
+    uint16_t src = READ_ARG();
+    Value collection = REGISTER(src);
+    if (!is_iterable(collection)) throw_vm_error("ITER_NEW: Giá trị không duyệt được.");
+    REGISTER(iter) = collection;
+    REGISTER(iter + 1) = Value(int64_t{0});
+}
+
+template <bool Wide>
+inline void MeowVM::op_iter_next(const uint8_t*& ip) {
+    const uint8_t* op_start = ip - 1 - Wide;
+    uint16_t iter = READ_ARG();
+    uint16_t key_reg = READ_OPT_REG();
+    uint16_t value_reg = READ_OPT_REG();
+    int32_t exit = READ_JUMP();
+    Value collection = REGISTER(iter);
+    if (!is_iterable(collection) || !REGISTER(iter + 1).is_int()) throw_vm_error("ITER_NEXT: Register không phải là iterator.");
+    int64_t cursor = REGISTER(iter + 1).as_int();
+
+    Value key, value;
+    IterStep step = next_entry(heap_.get(), collection, cursor, key, value, value_reg != 0xFFFF);
+    if (step == IterStep::REHASHED) throw_vm_error("ITER_NEXT: Collection bị thêm phần tử (rehash) trong lúc duyệt.");
+    if (step == IterStep::DONE) {
+        ip = op_start + exit;
+        return;
+    }
+    REGISTER(iter + 1) = Value(cursor);
+    if (key_reg != 0xFFFF) REGISTER(key_reg) = key;
+    if (value_reg != 0xFFFF) REGISTER(value_reg) = value;
+}
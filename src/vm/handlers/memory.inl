@@ -1,9 +1,10 @@
 #pragma once
 // Chứa các handler cho Global, Upvalue, Closure
 
+template <bool Wide>
 inline void MeowVM::op_get_global(const uint8_t*& ip) {
-    uint16_t dst = READ_U16();
-    uint16_t name_idx = READ_U16();
+    uint16_t dst = READ_ARG();
+    uint16_t name_idx = READ_ARG();
     string_t name = CONSTANT(name_idx).as_string();
     module_t module = context_->current_frame_->module_;
     if (module->has_global(name)) {
@@ -13,17 +14,19 @@ inline void MeowVM::op_get_global(const uint8_t*& ip) {
     }
 }
 
+template <bool Wide>
 inline void MeowVM::op_set_global(const uint8_t*& ip) {
-    uint16_t name_idx = READ_U16();
-    uint16_t src = READ_U16();
+    uint16_t name_idx = READ_ARG();
+    uint16_t src = READ_ARG();
     string_t name = CONSTANT(name_idx).as_string();
     module_t module = context_->current_frame_->module_;
     module->set_global(name, REGISTER(src));
 }
 
+template <bool Wide>
 inline void MeowVM::op_get_upvalue(const uint8_t*& ip) {
-    uint16_t dst = READ_U16();
-    uint16_t uv_idx = READ_U16();
+    uint16_t dst = READ_ARG();
+    uint16_t uv_idx = READ_ARG();
     upvalue_t uv = context_->current_frame_->function_->get_upvalue(uv_idx);
     if (uv->is_closed()) {
         REGISTER(dst) = uv->get_value();
@@ -32,9 +35,10 @@ inline void MeowVM::op_get_upvalue(const uint8_t*& ip) {
     }
 }
 
+template <bool Wide>
 inline void MeowVM::op_set_upvalue(const uint8_t*& ip) {
-    uint16_t uv_idx = READ_U16();
-    uint16_t src = READ_U16();
+    uint16_t uv_idx = READ_ARG();
+    uint16_t src = READ_ARG();
     upvalue_t uv = context_->current_frame_->function_->get_upvalue(uv_idx);
     if (uv->is_closed()) {
         uv->close(REGISTER(src));
@@ -43,9 +47,10 @@ inline void MeowVM::op_set_upvalue(const uint8_t*& ip) {
     }
 }
 
+template <bool Wide>
 inline void MeowVM::op_closure(const uint8_t*& ip) {
-    uint16_t dst = READ_U16();
-    uint16_t proto_idx = READ_U16();
+    uint16_t dst = READ_ARG();
+    uint16_t proto_idx = READ_ARG();
     proto_t proto = CONSTANT(proto_idx).as_proto();
     function_t closure = heap_->new_function(proto);
     for (size_t i = 0; i < proto->get_num_upvalues(); ++i) {
@@ -59,7 +64,8 @@ inline void MeowVM::op_closure(const uint8_t*& ip) {
     REGISTER(dst) = Value(closure);
 }
 
+template <bool Wide>
 inline void MeowVM::op_close_upvalues(const uint8_t*& ip) {
-    uint16_t last_reg = READ_U16();
+    uint16_t last_reg = READ_ARG();
     close_upvalues(context_.get(), context_->current_base_ + last_reg);
 }
\ No newline at end of file
@@ -1,27 +1,41 @@
 #pragma once
 // Chứa các handler cho Module, Import, Export
 
+template <bool Wide>
 inline void MeowVM::op_export(const uint8_t*& ip) {
-    uint16_t name_idx = READ_U16();
-    uint16_t src_reg = READ_U16();
+    uint16_t name_idx = READ_ARG();
+    uint16_t src_reg = READ_ARG();
     string_t name = CONSTANT(name_idx).as_string();
     context_->current_frame_->module_->set_export(name, REGISTER(src_reg));
 }
 
+template <bool Wide>
 inline void MeowVM::op_get_export(const uint8_t*& ip) {
-    uint16_t dst = READ_U16();
-    uint16_t mod_reg = READ_U16();
-    uint16_t name_idx = READ_U16();
+    uint16_t dst = READ_ARG();
+    uint16_t mod_reg = READ_ARG();
+    uint16_t name_idx = READ_ARG();
     Value& mod_val = REGISTER(mod_reg);
     string_t name = CONSTANT(name_idx).as_string();
     if (!mod_val.is_module()) throw_vm_error("GET_EXPORT: operand is not a module.");
     module_t mod = mod_val.as_module();
-    if (!mod->has_export(name)) throw_vm_error("Module does not export name.");
-    REGISTER(dst) = mod->get_export(name);
+
+    // Fast path: slot cached by a previous execution of this site
+    uint32_t& cached_slot = CURRENT_CHUNK().get_slot_cache(name_idx);
+    if (mod->is_export_slot(cached_slot, name)) {
+        REGISTER(dst) = mod->get_export_slot(cached_slot);
+        return;
+    }
+
+    // Tên lấy qua IMPORT_ALL cũng có slot riêng trong `mod` (liên kết tới module gốc), nên luôn cache được
+    size_t slot = mod->resolve_export(name);
+    if (slot == objects::ObjModule::npos) throw_vm_error("Module does not export name.");
+    cached_slot = static_cast<uint32_t>(slot);
+    REGISTER(dst) = mod->get_export_slot(slot);
 }
 
+template <bool Wide>
 inline void MeowVM::op_import_all(const uint8_t*& ip) {
-    uint16_t src_idx = READ_U16();
+    uint16_t src_idx = READ_ARG();
     const Value& mod_val = REGISTER(src_idx);
     if (auto src_mod = mod_val.as_if_module()) {
         module_t curr_mod = context_->current_frame_->module_;
@@ -1,26 +1,42 @@
 #pragma once
 // Chứa các handler cho Class, Instance, Prop, Method, Inherit, Super
 
+template <bool Wide>
 inline void MeowVM::op_new_class(const uint8_t*& ip) {
-    uint16_t dst = READ_U16();
-    uint16_t name_idx = READ_U16();
+    uint16_t dst = READ_ARG();
+    uint16_t name_idx = READ_ARG();
     string_t name = CONSTANT(name_idx).as_string();
     REGISTER(dst) = Value(heap_->new_class(name));
 }
 
+template <bool Wide>
 inline void MeowVM::op_new_instance(const uint8_t*& ip) {
-    uint16_t dst = READ_U16();
-    uint16_t class_reg = READ_U16();
+    uint16_t dst = READ_ARG();
+    uint16_t class_reg = READ_ARG();
     Value& class_val = REGISTER(class_reg);
     if (!class_val.is_class()) throw_vm_error("NEW_INSTANCE: operand is not a class.");
     REGISTER(dst) = Value(heap_->new_instance(class_val.as_class()));
 }
 
+// Slot PROPERTY ghi kiểu của receiver và class của nó (module thì ghi chính module)
+static inline void record_property_feedback(FeedbackSlot* slot, const Value& receiver) noexcept {
+    if (slot == nullptr) return;
+    slot->record(receiver);
+    if (receiver.is_instance()) {
+        slot->record_target(receiver.as_instance()->get_class());
+    } else if (receiver.is_module()) {
+        slot->record_target(receiver.as_module());
+    }
+}
+
+template <bool Wide>
 inline void MeowVM::op_get_prop(const uint8_t*& ip) {
-    uint16_t dst = READ_U16();
-    uint16_t obj_reg = READ_U16();
-    uint16_t name_idx = READ_U16();
+    const uint8_t* op_start = ip - 1 - Wide;
+    uint16_t dst = READ_ARG();
+    uint16_t obj_reg = READ_ARG();
+    uint16_t name_idx = READ_ARG();
     Value& obj = REGISTER(obj_reg);
+    record_property_feedback(FEEDBACK_SLOT(op_start), obj);
     string_t name = CONSTANT(name_idx).as_string();
     if (obj.is_instance()) {
         instance_t inst = obj.as_instance();
@@ -39,19 +55,22 @@ inline void MeowVM::op_get_prop(const uint8_t*& ip) {
     }
     if (obj.is_module()) {
         module_t mod = obj.as_module();
-        if (mod->has_export(name)) {
-            REGISTER(dst) = mod->get_export(name);
+        if (size_t slot = mod->resolve_export(name); slot != objects::ObjModule::npos) {
+            REGISTER(dst) = mod->get_export_slot(slot);
             return;
         }
     }
     REGISTER(dst) = Value(null_t{});
 }
 
+template <bool Wide>
 inline void MeowVM::op_set_prop(const uint8_t*& ip) {
-    uint16_t obj_reg = READ_U16();
-    uint16_t name_idx = READ_U16();
-    uint16_t val_reg = READ_U16();
+    const uint8_t* op_start = ip - 1 - Wide;
+    uint16_t obj_reg = READ_ARG();
+    uint16_t name_idx = READ_ARG();
+    uint16_t val_reg = READ_ARG();
     Value& obj = REGISTER(obj_reg);
+    record_property_feedback(FEEDBACK_SLOT(op_start), obj);
     string_t name = CONSTANT(name_idx).as_string();
     Value& val = REGISTER(val_reg);
     if (obj.is_instance()) {
@@ -61,10 +80,11 @@ inline void MeowVM::op_set_prop(const uint8_t*& ip) {
     }
 }
 
+template <bool Wide>
 inline void MeowVM::op_set_method(const uint8_t*& ip) {
-    uint16_t call_reg = READ_U16();
-    uint16_t name_idx = READ_U16();
-    uint16_t method_reg = READ_U16();
+    uint16_t call_reg = READ_ARG();
+    uint16_t name_idx = READ_ARG();
+    uint16_t method_reg = READ_ARG();
     Value& class_val = REGISTER(call_reg);
     string_t name = CONSTANT(name_idx).as_string();
     Value& methodVal = REGISTER(method_reg);
@@ -73,9 +93,10 @@ inline void MeowVM::op_set_method(const uint8_t*& ip) {
     class_val.as_class()->set_method(name, methodVal);
 }
 
+template <bool Wide>
 inline void MeowVM::op_inherit(const uint8_t*& ip) {
-    uint16_t sub_reg = READ_U16();
-    uint16_t super_reg = READ_U16();
+    uint16_t sub_reg = READ_ARG();
+    uint16_t super_reg = READ_ARG();
     Value& sub_val = REGISTER(sub_reg);
     Value& super_val = REGISTER(super_reg);
     if (!sub_val.is_class() || !super_val.is_class()) {
@@ -86,8 +107,9 @@ inline void MeowVM::op_inherit(const uint8_t*& ip) {
     sub->set_super(super);
 }
 
+template <bool Wide>
 inline void MeowVM::op_get_super(const uint8_t*& ip) {
-    uint16_t dst = READ_U16(), name_idx = READ_U16();
+    uint16_t dst = READ_ARG(), name_idx = READ_ARG();
     string_t name = CONSTANT(name_idx).as_string();
     Value& receiver_val = REGISTER(0);
     if (!receiver_val.is_instance()) {
@@ -1,6 +1,10 @@
 #include "vm/meow_vm.h"
 #include "common/pch.h"
 #include "core/op_codes.h"
+#include "core/superinstructions.h"
+#include "jit/baseline_jit.h"
+#include "jit/trace_jit.h"
+#include "memory/gc_disable_guard.h"
 #include "memory/mark_sweep_gc.h"
 #include "memory/memory_manager.h"
 #include "module/module_manager.h"
@@ -29,25 +33,59 @@ using namespace meow::common;
 // --- Macro đọc bytecode ---
 #define READ_BYTE() (*ip++)
 #define READ_U16() (ip += 2, (uint16_t)((ip[-2] | (ip[-1] << 8))))
+#define READ_U32() (ip += 4, (uint32_t)(ip[-4]) | ((uint32_t)(ip[-3]) << 8) | ((uint32_t)(ip[-2]) << 16) | ((uint32_t)(ip[-1]) << 24))
 #define READ_U64()                                                                                                                                                                 \
     (ip += 8, (uint64_t)(ip[-8]) | ((uint64_t)(ip[-7]) << 8) | ((uint64_t)(ip[-6]) << 16) | ((uint64_t)(ip[-5]) << 24) | ((uint64_t)(ip[-4]) << 32) | ((uint64_t)(ip[-3]) << 40) | \
                   ((uint64_t)(ip[-2]) << 48) | ((uint64_t)(ip[-1]) << 56))
 
 #define READ_I64() (std::bit_cast<int64_t>(READ_U64()))
 #define READ_F64() (std::bit_cast<double>(READ_U64()))
-#define READ_ADDRESS() READ_U16()
+
+// Toán hạng register/hằng số/đếm: 1 byte ở dạng hẹp, 2 byte sau tiền tố WIDE. `Wide` là tham số template của handler,
+// hoặc constexpr của label trong run()
+#define READ_ARG() (Wide ? READ_U16() : static_cast<uint16_t>(READ_BYTE()))
+// Register có thể vắng mặt (0xFFFF): dạng hẹp ghi là 0xFF
+#define READ_OPT_REG() (Wide ? READ_U16() : widen_optional_reg(READ_BYTE()))
+// Khoảng nhảy tính từ byte đầu của lệnh, kể cả tiền tố: i16 ở dạng hẹp, i32 sau WIDE
+#define READ_JUMP() (Wide ? static_cast<int32_t>(READ_U32()) : static_cast<int32_t>(static_cast<int16_t>(READ_U16())))
 
 #define CURRENT_CHUNK() (context_->current_frame_->function_->get_proto()->get_chunk())
-#define READ_CONSTANT() (CURRENT_CHUNK().get_constant(READ_U16()))
+#define READ_CONSTANT() (CURRENT_CHUNK().get_constant(READ_ARG()))
 
 #define REGISTER(idx) (context_->registers_[context_->current_base_ + (idx)])
 #define CONSTANT(idx) (CURRENT_CHUNK().get_constant(idx))
 
-#define UNARY_OP_HANDLER(OPCODE, OPNAME) \
+// Slot phản hồi kiểu của lệnh bắt đầu ở `op_start` (tiền tố WIDE nếu có) trong proto đang chạy, nullptr nếu lệnh không có slot
+#define FEEDBACK_SLOT(op_start) (context_->current_frame_->feedback_ ? context_->current_frame_->feedback_->slot_at(op_start) : nullptr)
+// Frame mới của `proto` lấy sẵn feedback vector; proto còn nguội (chưa đủ ngưỡng) thì frame không ghi gì
+#define ENTER_FEEDBACK(proto)                                                                  \
+    do {                                                                                       \
+        context_->current_frame_->feedback_ = (proto)->profile(feedback_threshold_);           \
+        if (context_->current_frame_->feedback_) context_->current_frame_->feedback_->count_invocation(); \
+    } while (0)
+
+// Handler viết liền trong run() có hai bản: op_X cho dạng hẹp và wide_X cho lệnh đứng sau tiền tố WIDE
+#define BOTH_WIDTHS(BODY, OPCODE, ...) BODY(op_##OPCODE, false, OPCODE __VA_OPT__(,) __VA_ARGS__) BODY(wide_##OPCODE, true, OPCODE __VA_OPT__(,) __VA_ARGS__)
+
+// Handler nằm trong handlers/*.inl
+#define HELPER_HANDLER(OPCODE, FN) \
     op_##OPCODE: { \
-        uint16_t dst = READ_U16(); \
-        uint16_t src = READ_U16(); \
+        FN<false>(ip); \
+        DISPATCH(); \
+    } \
+    wide_##OPCODE: { \
+        FN<true>(ip); \
+        DISPATCH(); \
+    }
+
+#define UNARY_OP_BODY(LABEL, WIDE, OPCODE, OPNAME) \
+    LABEL: { \
+        constexpr bool Wide = WIDE; \
+        const uint8_t* op_start = ip - 1 - Wide; \
+        uint16_t dst = READ_ARG(); \
+        uint16_t src = READ_ARG(); \
         auto& val = REGISTER(src); \
+        if (auto* slot = FEEDBACK_SLOT(op_start)) slot->record(val); \
         if (auto func = op_dispatcher_->find(OpCode::OPCODE, val)) { \
             REGISTER(dst) = func(val); \
         } else { \
@@ -55,29 +93,278 @@ using namespace meow::common;
         } \
         DISPATCH(); \
     }
-
-#define BINARY_OP_HANDLER(OPCODE, OPNAME) \
-    op_##OPCODE: { \
-        uint16_t dst = READ_U16(); \
-        uint16_t r1 = READ_U16(); \
-        uint16_t r2 = READ_U16(); \
+#define UNARY_OP_HANDLER(OPCODE, OPNAME) BOTH_WIDTHS(UNARY_OP_BODY, OPCODE, OPNAME)
+
+#define BINARY_OP_BODY(LABEL, WIDE, OPCODE, MESSAGE) \
+    LABEL: { \
+        constexpr bool Wide = WIDE; \
+        const uint8_t* op_start = ip - 1 - Wide; \
+        uint16_t dst = READ_ARG(); \
+        uint16_t r1 = READ_ARG(); \
+        uint16_t r2 = READ_ARG(); \
         auto& left = REGISTER(r1); \
         auto& right = REGISTER(r2); \
+        if (auto* slot = FEEDBACK_SLOT(op_start)) slot->record(left, right); \
         if (auto func = op_dispatcher_->find(OpCode::OPCODE, left, right)) { \
             REGISTER(dst) = func(left, right); \
         } else { \
-            throw_vm_error("Unsupported binary operator " OPNAME); \
+            throw_vm_error(MESSAGE); \
         } \
         DISPATCH(); \
     }
+#define BINARY_OP_HANDLER(OPCODE, OPNAME) BOTH_WIDTHS(BINARY_OP_BODY, OPCODE, "Unsupported binary operator " OPNAME)
+
+// Peephole có thể gộp GT thành JUMP_IF_LT đảo toán hạng, NEQ thành JUMP_IF_EQ... nên lệnh gộp không biết toán tử
+// đã viết: mọi phép so sánh, gộp hay không, báo chung một lỗi
+#define COMPARE_ERROR "Unsupported comparison operands"
+#define COMPARE_OP_HANDLER(OPCODE) BOTH_WIDTHS(BINARY_OP_BODY, OPCODE, COMPARE_ERROR)
+
+// So sánh rồi nhảy: số cùng kiểu so sánh trực tiếp, còn lại đi qua dispatcher như opcode so sánh thường
+#define COMPARE_JUMP_BODY(LABEL, WIDE, OPCODE, BASE_OPCODE, CMP, JUMP_WHEN) \
+    LABEL: { \
+        constexpr bool Wide = WIDE; \
+        const uint8_t* op_start = ip - 1 - Wide; \
+        uint16_t r1 = READ_ARG(); \
+        uint16_t r2 = READ_ARG(); \
+        int32_t offset = READ_JUMP(); \
+        auto& left = REGISTER(r1); \
+        auto& right = REGISTER(r2); \
+        if (auto* slot = FEEDBACK_SLOT(op_start)) slot->record(left, right); \
+        bool result; \
+        if (left.is_int() && right.is_int()) { \
+            result = left.as_int() CMP right.as_int(); \
+        } else if (left.is_float() && right.is_float()) { \
+            result = left.as_float() CMP right.as_float(); \
+        } else if (auto func = op_dispatcher_->find(OpCode::BASE_OPCODE, left, right)) { \
+            result = is_truthy(func(left, right)); \
+        } else { \
+            throw_vm_error(COMPARE_ERROR); \
+        } \
+        if (result == JUMP_WHEN) { \
+            const uint8_t* from = ip; \
+            ip = op_start + offset; \
+            if (ip < from) LOOP_BACK_EDGE(); \
+        } \
+        DISPATCH(); \
+    }
+#define COMPARE_JUMP_HANDLER(OPCODE, BASE_OPCODE, CMP, JUMP_WHEN) BOTH_WIDTHS(COMPARE_JUMP_BODY, OPCODE, BASE_OPCODE, CMP, JUMP_WHEN)
+
+#define JUMP_BODY(LABEL, WIDE, OPCODE) \
+    LABEL: { \
+        constexpr bool Wide = WIDE; \
+        const uint8_t* op_start = ip - 1 - Wide; \
+        int32_t offset = READ_JUMP(); \
+        const uint8_t* from = ip; \
+        ip = op_start + offset; \
+        if (ip < from) LOOP_BACK_EDGE(); \
+        DISPATCH(); \
+    }
+
+#define CONDITIONAL_JUMP_BODY(LABEL, WIDE, OPCODE, JUMP_WHEN) \
+    LABEL: { \
+        constexpr bool Wide = WIDE; \
+        const uint8_t* op_start = ip - 1 - Wide; \
+        uint16_t reg = READ_ARG(); \
+        int32_t offset = READ_JUMP(); \
+        if (is_truthy(REGISTER(reg)) == JUMP_WHEN) { \
+            const uint8_t* from = ip; \
+            ip = op_start + offset; \
+            if (ip < from) LOOP_BACK_EDGE(); \
+        } \
+        DISPATCH(); \
+    }
+
+#define FOR_LOOP_BODY(LABEL, WIDE, OPCODE) \
+    LABEL: { \
+        const uint8_t* from = ip; \
+        op_for_loop<WIDE>(ip); \
+        if (ip < from) LOOP_BACK_EDGE(); \
+        DISPATCH(); \
+    }
+
+// Bản inline của callee chỉ đúng khi register vẫn giữ closure của đúng proto đó, ngược lại quay về CALL thường
+#define GUARD_CALLEE_BODY(LABEL, WIDE, OPCODE) \
+    LABEL: { \
+        constexpr bool Wide = WIDE; \
+        const uint8_t* op_start = ip - 1 - Wide; \
+        uint16_t fn_reg = READ_ARG(); \
+        uint16_t proto_idx = READ_ARG(); \
+        int32_t fallback = READ_JUMP(); \
+        const Value& callee = REGISTER(fn_reg); \
+        auto expected = CONSTANT(proto_idx); \
+        if (!callee.is_function() || !expected.is_proto() || callee.as_function()->get_proto() != expected.as_proto()) { \
+            ip = op_start + fallback; \
+        } \
+        DISPATCH(); \
+    }
+
+// CALL, CALL_VOID và TAIL_CALL chỉ giải mã toán hạng vào `call` rồi vào thân chung, để thân dài không bị nhân đôi
+#define CALL_BODY(LABEL, WIDE, OPCODE, HAS_DST, TARGET) \
+    LABEL: { \
+        constexpr bool Wide = WIDE; \
+        call.op_start = ip - 1 - Wide; \
+        call.dst = HAS_DST ? READ_OPT_REG() : uint16_t{0xFFFF}; \
+        call.fn_reg = READ_ARG(); \
+        call.arg_start = READ_ARG(); \
+        call.argc = READ_ARG(); \
+        goto TARGET; \
+    }
+
+#define RETURN_BODY(LABEL, WIDE, OPCODE) \
+    LABEL: { \
+        constexpr bool Wide = WIDE; \
+        uint16_t ret_reg_idx = READ_OPT_REG(); \
+        frame_result = (ret_reg_idx == 0xFFFF) ? Value(null_t{}) : REGISTER(ret_reg_idx); \
+        goto do_return; \
+    }
+
+#define THROW_BODY(LABEL, WIDE, OPCODE) \
+    LABEL: { \
+        constexpr bool Wide = WIDE; \
+        uint16_t reg = READ_ARG(); \
+        /* Tự gỡ frame theo bảng handler, không đi qua C++ exception */ \
+        if (!handle_error("Explicit throw: " + to_string(REGISTER(reg)), ip)) { \
+            return; \
+        } \
+        goto dispatch_start; \
+    }
+
+// Bản ghi handler giữ offset tuyệt đối của khối catch trong chunk
+#define SETUP_TRY_BODY(LABEL, WIDE, OPCODE) \
+    LABEL: { \
+        constexpr bool Wide = WIDE; \
+        const uint8_t* op_start = ip - 1 - Wide; \
+        int32_t offset = READ_JUMP(); \
+        size_t catch_ip = static_cast<size_t>(op_start + offset - CURRENT_CHUNK().get_code()); \
+        size_t frame_depth = context_->call_stack_.size() - 1; \
+        size_t stack_depth = context_->registers_.size(); \
+        context_->exception_handlers_.emplace_back(catch_ip, frame_depth, stack_depth); \
+        DISPATCH(); \
+    }
+
+#define IMPORT_MODULE_BODY(LABEL, WIDE, OPCODE) \
+    LABEL: { \
+        constexpr bool Wide = WIDE; \
+        import_dst = READ_ARG(); \
+        import_path = READ_ARG(); \
+        goto do_import; \
+    }
+
+#ifdef MEOW_PROFILE_OPCODES
+#define PROFILE_OPCODE(instruction) opcode_profile_.record(instruction)
+#else
+#define PROFILE_OPCODE(instruction) ((void)0)
+#endif
 
 #define DISPATCH()                                           \
     do {                                                          \
         context_->current_frame_->ip_ = ip;                       \
         uint8_t instruction = READ_BYTE();                        \
+        PROFILE_OPCODE(instruction);                              \
         goto *dispatch_table[instruction];                         \
     } while (0)
 
+// --- Tier-up ---
+// Proto đã được dịch thì chạy mã máy từ ip, đến lệnh mà nó trả lại cho interpreter.
+// Lỗi của một callout được ném lại ở đúng lệnh đó để catch bên dưới gỡ frame như bình thường
+#define ENTER_JIT()                                                                                                                     \
+    do {                                                                                                                                \
+        if (const jit::CompiledCode* jit_code = context_->current_frame_->function_->get_proto()->get_jit_code()) {                     \
+            const uint8_t* jit_base = CURRENT_CHUNK().get_code();                                                                      \
+            uint32_t resume = jit_code->enter(context_->registers_.data() + context_->current_base_, static_cast<size_t>(ip - jit_base)); \
+            ip = jit_base + (resume & ~jit::PENDING_ERROR);                                                                            \
+            if (resume & jit::PENDING_ERROR) {                                                                                         \
+                context_->current_frame_->ip_ = ip;                                                                                    \
+                std::rethrow_exception(std::exchange(jit_error_, nullptr));                                                            \
+            }                                                                                                                          \
+        }                                                                                                                               \
+    } while (0)
+
+// Lượt gọi và lần nhảy ngược của vòng lặp làm proto nóng thêm, mỗi loại một bộ đếm; đủ ngưỡng thì dịch rồi vào mã máy
+#define TIER_UP_WITH(TICK, THRESHOLD)                                                              \
+    do {                                                                                           \
+        proto_t hot_proto = context_->current_frame_->function_->get_proto();                      \
+        if (jit_ && hot_proto->TICK(jit_->THRESHOLD()))                                            \
+            (void)jit_->compile(hot_proto, tracer_ ? tracer_->loop_flags(hot_proto) : nullptr);    \
+        ENTER_JIT();                                                                               \
+    } while (0)
+#define TIER_UP() TIER_UP_WITH(tick_hotness, get_threshold)
+
+// Nhảy ngược về đầu vòng lặp: vòng lặp có trace thì chạy trace, interpreter (hoặc mã baseline) tiếp tục từ lệnh
+// mà trace thoát ra. Đây cũng là điểm OSR: proto được dịch giữa chừng thì vào mã máy ngay tại đầu vòng lặp, trên
+// đúng cửa sổ register của frame đang chạy
+#define LOOP_BACK_EDGE()                                                                                        \
+    do {                                                                                                        \
+        CallFrame* loop_frame = context_->current_frame_;                                                       \
+        if (!loop_frame->feedback_) loop_frame->feedback_ = loop_frame->function_->get_proto()->profile(feedback_threshold_); \
+        if (loop_frame->feedback_) loop_frame->feedback_->count_backedge();                                     \
+        if (tracer_) {                                                                                          \
+            const uint8_t* loop_base = CURRENT_CHUNK().get_code();                                              \
+            ip = loop_base + tracer_->run_loop(context_->current_frame_->function_->get_proto(),                 \
+                                               static_cast<uint32_t>(ip - loop_base),                           \
+                                               context_->registers_.data() + context_->current_base_);         \
+        }                                                                                                       \
+        TIER_UP_WITH(tick_loop_hotness, get_osr_threshold);                                                     \
+    } while (0)
+
+// --- Superinstruction ---
+// Mỗi lệnh được phép đứng trước trong một superinstruction cần một SUPER_STEP: chạy lệnh dạng hẹp, không dispatch.
+// scripts/gen_superinstructions.py đọc danh sách này để biết lệnh nào gộp được
+#define SUPER_STEP_LOAD_CONST op_load_const<false>(ip)
+#define SUPER_STEP_LOAD_NULL op_load_null<false>(ip)
+#define SUPER_STEP_LOAD_TRUE op_load_true<false>(ip)
+#define SUPER_STEP_LOAD_FALSE op_load_false<false>(ip)
+#define SUPER_STEP_LOAD_INT op_load_int<false>(ip)
+#define SUPER_STEP_LOAD_SMALLINT op_load_smallint<false>(ip)
+#define SUPER_STEP_LOAD_FLOAT op_load_float<false>(ip)
+#define SUPER_STEP_MOVE op_move<false>(ip)
+#define SUPER_STEP_GET_GLOBAL op_get_global<false>(ip)
+#define SUPER_STEP_SET_GLOBAL op_set_global<false>(ip)
+#define SUPER_STEP_GET_UPVALUE op_get_upvalue<false>(ip)
+#define SUPER_STEP_SET_UPVALUE op_set_upvalue<false>(ip)
+#define SUPER_STEP_CLOSURE op_closure<false>(ip)
+#define SUPER_STEP_CLOSE_UPVALUES op_close_upvalues<false>(ip)
+#define SUPER_STEP_NEW_ARRAY op_new_array<false>(ip)
+#define SUPER_STEP_NEW_HASH op_new_hash<false>(ip)
+#define SUPER_STEP_GET_INDEX op_get_index<false>(ip)
+#define SUPER_STEP_SET_INDEX op_set_index<false>(ip)
+#define SUPER_STEP_GET_KEYS op_get_keys<false>(ip)
+#define SUPER_STEP_GET_VALUES op_get_values<false>(ip)
+#define SUPER_STEP_NEW_CLASS op_new_class<false>(ip)
+#define SUPER_STEP_NEW_INSTANCE op_new_instance<false>(ip)
+#define SUPER_STEP_GET_PROP op_get_prop<false>(ip)
+#define SUPER_STEP_SET_PROP op_set_prop<false>(ip)
+#define SUPER_STEP_SET_METHOD op_set_method<false>(ip)
+#define SUPER_STEP_INHERIT op_inherit<false>(ip)
+#define SUPER_STEP_GET_SUPER op_get_super<false>(ip)
+#define SUPER_STEP_EXPORT op_export<false>(ip)
+#define SUPER_STEP_GET_EXPORT op_get_export<false>(ip)
+#define SUPER_STEP_IMPORT_ALL op_import_all<false>(ip)
+#define SUPER_STEP_ITER_NEW op_iter_new<false>(ip)
+
+// Bỏ qua byte opcode của lệnh kế tiếp (vẫn nằm nguyên trong bytecode) như DISPATCH nhưng không nhảy gián tiếp
+#define SUPER_NEXT()                            \
+    do {                                        \
+        context_->current_frame_->ip_ = ip;     \
+        ++ip;                                   \
+    } while (0)
+
+#define SUPERINSTRUCTION_HANDLER(NAME, A, B) \
+    op_SI_##NAME: { \
+        SUPER_STEP_##A; \
+        SUPER_NEXT(); \
+        goto op_##B; \
+    }
+
+#define SUPERINSTRUCTION3_HANDLER(NAME, A, B, C) \
+    op_SI_##NAME: { \
+        SUPER_STEP_##A; \
+        SUPER_NEXT(); \
+        SUPER_STEP_##B; \
+        SUPER_NEXT(); \
+        goto op_##C; \
+    }
+
 
 // === SỬA LỖI: Di chuyển các hàm helper lên trên ===
 
@@ -95,6 +382,10 @@ inline bool is_truthy(param_t value) noexcept {
     return true;
 }
 
+inline uint16_t widen_optional_reg(uint8_t reg) noexcept {
+    return reg == 0xFF ? uint16_t{0xFFFF} : uint16_t{reg};
+}
+
 inline upvalue_t capture_upvalue(ExecutionContext* context, MemoryManager* heap, size_t register_index) {
     // Tìm kiếm các upvalue đã mở từ trên xuống dưới (chỉ số stack cao -> thấp)
     for (auto it = context->open_upvalues_.rbegin(); it != context->open_upvalues_.rend(); ++it) {
@@ -128,9 +419,72 @@ inline void close_upvalues(ExecutionContext* context, size_t last_index) noexcep
 #include "handlers/data.inl"
 #include "handlers/oop.inl"
 #include "handlers/module.inl"
+#include "handlers/loop.inl"
 #include "handlers/exception.inl"
 
 
+// === Callout của JIT ===
+
+meow::core::Value* MeowVM::jit_callout(void* vm, uint32_t pc) noexcept {
+    return static_cast<MeowVM*>(vm)->jit_step(pc);
+}
+
+// Chạy một lệnh thẳng (không đổi luồng) bằng đúng handler của interpreter, xem jit::is_callout_opcode.
+// Không để exception nào đi xuyên qua mã máy: lưu lại, mã máy trả về, run() ném lại
+meow::core::Value* MeowVM::jit_step(uint32_t pc) noexcept {
+    const uint8_t* ip = CURRENT_CHUNK().get_code() + pc;
+    // GC có thể chạy trong handler và đọc ip của frame để biết register nào còn sống
+    context_->current_frame_->ip_ = ip;
+    try {
+        bool wide = *ip == static_cast<uint8_t>(OpCode::WIDE);
+        if (wide) ++ip;
+        switch (superinstruction_head(static_cast<OpCode>(READ_BYTE()))) {
+#define JIT_CALLOUT(OP, FN)                  \
+    case OpCode::OP:                         \
+        wide ? FN<true>(ip) : FN<false>(ip); \
+        break;
+            JIT_CALLOUT(GET_GLOBAL, op_get_global)
+            JIT_CALLOUT(SET_GLOBAL, op_set_global)
+            JIT_CALLOUT(GET_UPVALUE, op_get_upvalue)
+            JIT_CALLOUT(SET_UPVALUE, op_set_upvalue)
+            JIT_CALLOUT(CLOSURE, op_closure)
+            JIT_CALLOUT(CLOSE_UPVALUES, op_close_upvalues)
+            JIT_CALLOUT(NEW_ARRAY, op_new_array)
+            JIT_CALLOUT(NEW_HASH, op_new_hash)
+            JIT_CALLOUT(GET_INDEX, op_get_index)
+            JIT_CALLOUT(SET_INDEX, op_set_index)
+            JIT_CALLOUT(GET_KEYS, op_get_keys)
+            JIT_CALLOUT(GET_VALUES, op_get_values)
+            JIT_CALLOUT(NEW_CLASS, op_new_class)
+            JIT_CALLOUT(NEW_INSTANCE, op_new_instance)
+            JIT_CALLOUT(GET_PROP, op_get_prop)
+            JIT_CALLOUT(SET_PROP, op_set_prop)
+            JIT_CALLOUT(SET_METHOD, op_set_method)
+            JIT_CALLOUT(INHERIT, op_inherit)
+            JIT_CALLOUT(GET_SUPER, op_get_super)
+            JIT_CALLOUT(EXPORT, op_export)
+            JIT_CALLOUT(GET_EXPORT, op_get_export)
+            JIT_CALLOUT(IMPORT_ALL, op_import_all)
+            JIT_CALLOUT(ITER_NEW, op_iter_new)
+#undef JIT_CALLOUT
+            default:
+                throw_vm_error("JIT: Lệnh không chạy được qua callout.");
+        }
+    } catch (...) {
+        jit_error_ = std::current_exception();
+        return nullptr;
+    }
+    return context_->registers_.data() + context_->current_base_;
+}
+
+void MeowVM::attach_native_code(proto_t proto, NativeEntry entry) {
+    // MEOW_NO_JIT tắt cả mã máy dịch sẵn: module vẫn chạy được bằng bytecode nhúng kèm
+    static const bool enabled = jit::JitOptions::from_environment().enabled;
+    if (!enabled || proto->get_jit_code() != nullptr) return;
+    aot_code_.push_back(std::make_unique<jit::CompiledCode>(entry, this, &MeowVM::jit_callout));
+    proto->set_jit_code(aot_code_.back().get());
+}
+
 // === Bắt đầu phần code logic của meow_vm.cpp ===
 
 MeowVM::MeowVM(const std::string& entry_point_directory, const std::string& entry_path, int argc, char* argv[]) {
@@ -149,26 +503,66 @@ MeowVM::MeowVM(const std::string& entry_point_directory, const std::string& entr
 
     mod_manager_ = std::make_unique<meow::module::ModuleManager>(heap_.get(), this);
     op_dispatcher_ = std::make_unique<OperatorDispatcher>(heap_.get());
+    jit::JitOptions jit_options = jit::JitOptions::from_environment();
+    jit_ = jit::BaselineJit::create(jit_options, this, &MeowVM::jit_callout);
+    tracer_ = jit::TraceJit::create(jit_options);
+    feedback_threshold_ = FeedbackOptions::from_environment().threshold;
+
+    // Mỗi thư viện native trong builtins được expose thành một module, import bằng tên
+    register_array_natives(*builtins_, heap_.get());
+    for (const auto& [name, methods] : builtins_->methods_) {
+        module_t mod = heap_->new_module(name, name);
+        builtins_->modules_[name] = mod;
+        for (const auto& [method_name, method] : methods) {
+            mod->set_export(method_name, method);
+        }
+        mod->set_executed();
+        mod_manager_->add_cache(name, mod);
+    }
 
     printl("MeowVM initialized successfully!");
 }
 
 MeowVM::~MeowVM() noexcept {
+#ifdef MEOW_PROFILE_OPCODES
+    opcode_profile_.flush();
+#endif
+    dump_feedback();
     printl("MeowVM shutting down.");
 }
 
+void MeowVM::dump_feedback() const {
+    const char* path = std::getenv("MEOW_FEEDBACK_DUMP");
+    if (path == nullptr || *path == '\0') return;
+    std::ofstream file(path, std::ios::app);
+    if (!file) return;
+
+    // Proto chỉ sinh ra từ bảng hằng số của module, nên duyệt từ main proto của từng module là đủ
+    std::vector<module_t> modules = mod_manager_->get_modules();
+    if (entry_module_) modules.insert(modules.begin(), entry_module_);
+    std::unordered_map<proto_t, bool> dumped;
+    file << "# meow type feedback v1\n";
+    for (module_t mod : modules) {
+        for (proto_t proto : objects::collect_protos(mod->get_main_proto())) {
+            const FeedbackVector* feedback = proto->get_feedback();
+            if (feedback == nullptr || !dumped.try_emplace(proto, true).second) continue;
+            feedback->dump(file, proto->get_name() ? proto->get_name()->c_str() : "<anonymous>");
+        }
+    }
+}
+
 [[nodiscard]] inline uint8_t to_byte(OpCode op_code) noexcept {
     return static_cast<uint8_t>(op_code);
 }
 
-using raw_value_t = meow::variant<OpCode, uint64_t, double, int64_t, uint16_t>;
-[[nodiscard]] inline constexpr Chunk make_chunk(const std::vector<raw_value_t>& code) {
+using raw_value_t = meow::variant<OpCode, uint64_t, double, int64_t, uint16_t, uint8_t>;
+[[nodiscard]] inline Chunk make_chunk(const std::vector<raw_value_t>& code) {
     Chunk chunk;
 
     for (size_t i = 0; i < code.size(); ++i) {
         code[i].visit([&chunk](OpCode value) { chunk.write_byte(static_cast<uint8_t>(value)); }, [&chunk](uint64_t value) { chunk.write_u64(value); },
                       [&chunk](double value) { chunk.write_f64(value); }, [&chunk](int64_t value) { chunk.write_u64(std::bit_cast<uint64_t>(value)); },
-                      [&chunk](uint16_t value) { chunk.write_u16(value); });
+                      [&chunk](uint16_t value) { chunk.write_u16(value); }, [&chunk](uint8_t value) { chunk.write_byte(value); });
     }
 
     return chunk;
@@ -183,18 +577,49 @@ void MeowVM::interpret() noexcept {
     }
 }
 
+Value MeowVM::run_module(const std::string& path) {
+    context_->reset();
+    uncaught_error_.reset();
+    proto_t main_proto = nullptr;
+    {
+        // Cache module không được GC trace: module chỉ an toàn khi frame của nó đã nằm trên call stack
+        meow::memory::GCDisableGuard guard(heap_.get());
+        string_t entry_path = heap_->new_string(args_.entry_path_);
+        mod_manager_->set_entry_path(entry_path);
+        module_t mod = mod_manager_->load_module(heap_->new_string(path), entry_path);
+        if (!mod->is_has_main()) throw_vm_error("Module '" + path + "' không có main proto.");
+        main_proto = mod->get_main_proto();
+        if (main_proto->is_body_pending()) load_proto_body(main_proto);
+        function_t main_func = heap_->new_function(main_proto);
+        entry_module_ = mod;
+        mod->set_execution();
+
+        context_->registers_.resize(main_proto->get_num_registers());
+        context_->call_stack_.emplace_back(main_func, mod, 0, static_cast<size_t>(-1), main_proto->get_chunk().get_code());
+        context_->current_frame_ = &context_->call_stack_.back();
+        context_->current_base_ = 0;
+    }
+    ENTER_FEEDBACK(main_proto);
+
+    run();
+    if (uncaught_error_) throw VMError(*std::exchange(uncaught_error_, std::nullopt));
+    entry_module_->set_executed();
+    return context_->registers_.empty() ? Value(null_t{}) : context_->registers_[0];
+}
+
 void MeowVM::prepare() noexcept {
     printl("Preparing for execution...");
 
-    using u16 = uint16_t;
+    // Toán hạng dạng hẹp, xem runtime/bytecode.h
+    using u8 = uint8_t;
     using u64 = uint64_t;
 
     using enum OpCode;
 
     Chunk test_chunk = make_chunk({
-        LOAD_INT, u16(0), u64(1802),
-        LOAD_TRUE, u16(1),
-        NEW_ARRAY, u16(2), u16(0), u16(2), 
+        LOAD_INT, u8(0), u64(1802),
+        LOAD_TRUE, u8(1),
+        NEW_ARRAY, u8(2), u8(0), u8(2), 
         HALT
     });
     size_t num_register = 3;
@@ -203,6 +628,7 @@ void MeowVM::prepare() noexcept {
     auto main_func = heap_->new_function(main_proto);
 
     auto main_module = heap_->new_module(heap_->new_string("main"), heap_->new_string(args_.entry_path_), main_proto);
+    entry_module_ = main_module;
 
     context_->registers_.resize(num_register);
 
@@ -215,6 +641,29 @@ void MeowVM::prepare() noexcept {
 
     context_->current_frame_ = &context_->call_stack_.back();
     context_->current_base_ = context_->current_frame_->start_reg_;
+    ENTER_FEEDBACK(main_proto);
+}
+
+// Proto của module nạp lười chỉ là stub đến lần gọi đầu tiên; tệp hỏng thì báo như lỗi của lệnh gọi
+void MeowVM::load_proto_body(proto_t proto) {
+    try {
+        proto->ensure_body();
+    } catch (const std::exception& e) {
+        throw_vm_error(std::string("Không thể nạp thân hàm: ") + e.what());
+    }
+}
+
+// Slot CALL ghi kiểu của callee và đích thật sự được gọi: proto của closure/bound method, class của lời gọi constructor, hoặc native
+static inline void record_call_feedback(FeedbackSlot* slot, const Value& callee) noexcept {
+    if (slot == nullptr) return;
+    slot->record(callee);
+    if (callee.is_function()) {
+        slot->record_target(callee.as_function()->get_proto());
+    } else if (callee.is_bound_method()) {
+        slot->record_target(callee.as_bound_method()->get_function()->get_proto());
+    } else if (callee.is_class() || callee.is_native_fn()) {
+        slot->record_target(callee.as_object());
+    }
 }
 
 // --- HÀM RUN() CHÍNH (ĐÃ TÁI CẤU TRÚC) ---
@@ -227,6 +676,14 @@ void MeowVM::run() {
 #endif
 
     const uint8_t* ip = context_->current_frame_->ip_;
+    // Giá trị trả về của frame đang kết thúc, dùng chung giữa RETURN và TAIL_CALL
+    Value frame_result;
+    // Toán hạng đã giải mã của lệnh gọi/import, để bản hẹp và bản WIDE dùng chung một thân handler
+    struct {
+        const uint8_t* op_start;
+        uint16_t dst, fn_reg, arg_start, argc;
+    } call{};
+    uint16_t import_dst = 0, import_path = 0;
 
     // --- Bảng nhảy (Dispatch Table) ---
     static const void* dispatch_table[static_cast<size_t>(OpCode::TOTAL_OPCODES)] = {
@@ -290,6 +747,103 @@ void MeowVM::run() {
         [+OpCode::EXPORT]         = &&op_EXPORT,
         [+OpCode::GET_EXPORT]     = &&op_GET_EXPORT,
         [+OpCode::IMPORT_ALL]     = &&op_IMPORT_ALL,
+        [+OpCode::JUMP_IF_EQ]     = &&op_JUMP_IF_EQ,
+        [+OpCode::JUMP_IF_NEQ]    = &&op_JUMP_IF_NEQ,
+        [+OpCode::JUMP_IF_LT]     = &&op_JUMP_IF_LT,
+        [+OpCode::JUMP_IF_LE]     = &&op_JUMP_IF_LE,
+        [+OpCode::JUMP_IF_NOT_LT] = &&op_JUMP_IF_NOT_LT,
+        [+OpCode::JUMP_IF_NOT_LE] = &&op_JUMP_IF_NOT_LE,
+        [+OpCode::FOR_PREP]       = &&op_FOR_PREP,
+        [+OpCode::FOR_LOOP]       = &&op_FOR_LOOP,
+        [+OpCode::FOR_IN]         = &&op_FOR_IN,
+        [+OpCode::ITER_NEW]       = &&op_ITER_NEW,
+        [+OpCode::ITER_NEXT]      = &&op_ITER_NEXT,
+        [+OpCode::TAIL_CALL]      = &&op_TAIL_CALL,
+        [+OpCode::LOAD_SMALLINT]  = &&op_LOAD_SMALLINT,
+        [+OpCode::GUARD_CALLEE]   = &&op_GUARD_CALLEE,
+        [+OpCode::WIDE]           = &&op_WIDE,
+#define MEOW_SUPERINSTRUCTION(NAME, A, B) [+OpCode::SI_##NAME] = &&op_SI_##NAME,
+#define MEOW_SUPERINSTRUCTION3(NAME, A, B, C) [+OpCode::SI_##NAME] = &&op_SI_##NAME,
+#include "core/superinstructions.def"
+#undef MEOW_SUPERINSTRUCTION
+#undef MEOW_SUPERINSTRUCTION3
+    };
+    // Lệnh sau tiền tố WIDE. Ô nullptr là lệnh không có dạng rộng (không toán hạng, superinstruction)
+    static const void* wide_dispatch_table[static_cast<size_t>(OpCode::TOTAL_OPCODES)] = {
+        [+OpCode::LOAD_CONST]     = &&wide_LOAD_CONST,
+        [+OpCode::LOAD_NULL]      = &&wide_LOAD_NULL,
+        [+OpCode::LOAD_TRUE]      = &&wide_LOAD_TRUE,
+        [+OpCode::LOAD_FALSE]     = &&wide_LOAD_FALSE,
+        [+OpCode::LOAD_INT]       = &&wide_LOAD_INT,
+        [+OpCode::LOAD_FLOAT]     = &&wide_LOAD_FLOAT,
+        [+OpCode::MOVE]           = &&wide_MOVE,
+        [+OpCode::ADD]            = &&wide_ADD,
+        [+OpCode::SUB]            = &&wide_SUB,
+        [+OpCode::MUL]            = &&wide_MUL,
+        [+OpCode::DIV]            = &&wide_DIV,
+        [+OpCode::MOD]            = &&wide_MOD,
+        [+OpCode::POW]            = &&wide_POW,
+        [+OpCode::EQ]             = &&wide_EQ,
+        [+OpCode::NEQ]            = &&wide_NEQ,
+        [+OpCode::GT]             = &&wide_GT,
+        [+OpCode::GE]             = &&wide_GE,
+        [+OpCode::LT]             = &&wide_LT,
+        [+OpCode::LE]             = &&wide_LE,
+        [+OpCode::NEG]            = &&wide_NEG,
+        [+OpCode::NOT]            = &&wide_NOT,
+        [+OpCode::GET_GLOBAL]     = &&wide_GET_GLOBAL,
+        [+OpCode::SET_GLOBAL]     = &&wide_SET_GLOBAL,
+        [+OpCode::GET_UPVALUE]    = &&wide_GET_UPVALUE,
+        [+OpCode::SET_UPVALUE]    = &&wide_SET_UPVALUE,
+        [+OpCode::CLOSURE]        = &&wide_CLOSURE,
+        [+OpCode::CLOSE_UPVALUES] = &&wide_CLOSE_UPVALUES,
+        [+OpCode::JUMP]           = &&wide_JUMP,
+        [+OpCode::JUMP_IF_FALSE]  = &&wide_JUMP_IF_FALSE,
+        [+OpCode::JUMP_IF_TRUE]   = &&wide_JUMP_IF_TRUE,
+        [+OpCode::CALL]           = &&wide_CALL,
+        [+OpCode::CALL_VOID]      = &&wide_CALL_VOID,
+        [+OpCode::RETURN]         = &&wide_RETURN,
+        [+OpCode::HALT]           = nullptr,
+        [+OpCode::NEW_ARRAY]      = &&wide_NEW_ARRAY,
+        [+OpCode::NEW_HASH]       = &&wide_NEW_HASH,
+        [+OpCode::GET_INDEX]      = &&wide_GET_INDEX,
+        [+OpCode::SET_INDEX]      = &&wide_SET_INDEX,
+        [+OpCode::GET_KEYS]       = &&wide_GET_KEYS,
+        [+OpCode::GET_VALUES]     = &&wide_GET_VALUES,
+        [+OpCode::NEW_CLASS]      = &&wide_NEW_CLASS,
+        [+OpCode::NEW_INSTANCE]   = &&wide_NEW_INSTANCE,
+        [+OpCode::GET_PROP]       = &&wide_GET_PROP,
+        [+OpCode::SET_PROP]       = &&wide_SET_PROP,
+        [+OpCode::SET_METHOD]     = &&wide_SET_METHOD,
+        [+OpCode::INHERIT]        = &&wide_INHERIT,
+        [+OpCode::GET_SUPER]      = &&wide_GET_SUPER,
+        [+OpCode::BIT_AND]        = &&wide_BIT_AND,
+        [+OpCode::BIT_OR]         = &&wide_BIT_OR,
+        [+OpCode::BIT_XOR]        = &&wide_BIT_XOR,
+        [+OpCode::BIT_NOT]        = &&wide_BIT_NOT,
+        [+OpCode::LSHIFT]         = &&wide_LSHIFT,
+        [+OpCode::RSHIFT]         = &&wide_RSHIFT,
+        [+OpCode::THROW]          = &&wide_THROW,
+        [+OpCode::SETUP_TRY]      = &&wide_SETUP_TRY,
+        [+OpCode::POP_TRY]        = nullptr,
+        [+OpCode::IMPORT_MODULE]  = &&wide_IMPORT_MODULE,
+        [+OpCode::EXPORT]         = &&wide_EXPORT,
+        [+OpCode::GET_EXPORT]     = &&wide_GET_EXPORT,
+        [+OpCode::IMPORT_ALL]     = &&wide_IMPORT_ALL,
+        [+OpCode::JUMP_IF_EQ]     = &&wide_JUMP_IF_EQ,
+        [+OpCode::JUMP_IF_NEQ]    = &&wide_JUMP_IF_NEQ,
+        [+OpCode::JUMP_IF_LT]     = &&wide_JUMP_IF_LT,
+        [+OpCode::JUMP_IF_LE]     = &&wide_JUMP_IF_LE,
+        [+OpCode::JUMP_IF_NOT_LT] = &&wide_JUMP_IF_NOT_LT,
+        [+OpCode::JUMP_IF_NOT_LE] = &&wide_JUMP_IF_NOT_LE,
+        [+OpCode::FOR_PREP]       = &&wide_FOR_PREP,
+        [+OpCode::FOR_LOOP]       = &&wide_FOR_LOOP,
+        [+OpCode::FOR_IN]         = &&wide_FOR_IN,
+        [+OpCode::ITER_NEW]       = &&wide_ITER_NEW,
+        [+OpCode::ITER_NEXT]      = &&wide_ITER_NEXT,
+        [+OpCode::TAIL_CALL]      = &&wide_TAIL_CALL,
+        [+OpCode::LOAD_SMALLINT]  = &&wide_LOAD_SMALLINT,
+        [+OpCode::GUARD_CALLEE]   = &&wide_GUARD_CALLEE,
     };
 
 dispatch_start:
@@ -330,34 +884,14 @@ dispatch_start:
 
         // --- Các Label thực thi Opcode (chuyển đổi từ 'case') ---
 
-        op_LOAD_CONST: {
-            op_load_const(ip);
-            DISPATCH();
-        }
-        op_LOAD_NULL: {
-            op_load_null(ip);
-            DISPATCH();
-        }
-        op_LOAD_TRUE: {
-            op_load_true(ip);
-            DISPATCH();
-        }
-        op_LOAD_FALSE: {
-            op_load_false(ip);
-            DISPATCH();
-        }
-        op_MOVE: {
-            op_move(ip);
-            DISPATCH();
-        }
-        op_LOAD_INT: {
-            op_load_int(ip);
-            DISPATCH();
-        }
-        op_LOAD_FLOAT: {
-            op_load_float(ip);
-            DISPATCH();
-        }
+        HELPER_HANDLER(LOAD_CONST, op_load_const)
+        HELPER_HANDLER(LOAD_NULL, op_load_null)
+        HELPER_HANDLER(LOAD_TRUE, op_load_true)
+        HELPER_HANDLER(LOAD_FALSE, op_load_false)
+        HELPER_HANDLER(MOVE, op_move)
+        HELPER_HANDLER(LOAD_INT, op_load_int)
+        HELPER_HANDLER(LOAD_SMALLINT, op_load_smallint)
+        HELPER_HANDLER(LOAD_FLOAT, op_load_float)
 
         // --- Các Op Handler dùng Macro (Giữ nguyên) ---
         BINARY_OP_HANDLER(ADD,     "ADD")
@@ -366,12 +900,12 @@ dispatch_start:
         BINARY_OP_HANDLER(DIV,     "DIV")
         BINARY_OP_HANDLER(MOD,     "MOD")
         BINARY_OP_HANDLER(POW,     "POW")
-        BINARY_OP_HANDLER(EQ,      "EQ")
-        BINARY_OP_HANDLER(NEQ,     "NEQ")
-        BINARY_OP_HANDLER(GT,      "GT")
-        BINARY_OP_HANDLER(GE,      "GE")
-        BINARY_OP_HANDLER(LT,      "LT")
-        BINARY_OP_HANDLER(LE,      "LE")
+        COMPARE_OP_HANDLER(EQ)
+        COMPARE_OP_HANDLER(NEQ)
+        COMPARE_OP_HANDLER(GT)
+        COMPARE_OP_HANDLER(GE)
+        COMPARE_OP_HANDLER(LT)
+        COMPARE_OP_HANDLER(LE)
         BINARY_OP_HANDLER(BIT_AND, "BIT_AND")
         BINARY_OP_HANDLER(BIT_OR,  "BIT_OR")
         BINARY_OP_HANDLER(BIT_XOR, "BIT_XOR")
@@ -383,74 +917,38 @@ dispatch_start:
         UNARY_OP_HANDLER(BIT_NOT, "BIT_NOT")
         
         // --- Các Op Handler đã refactor ---
-        op_GET_GLOBAL: {
-            op_get_global(ip);
-            DISPATCH();
-        }
-        op_SET_GLOBAL: {
-            op_set_global(ip);
-            DISPATCH();
-        }
-        op_GET_UPVALUE: {
-            op_get_upvalue(ip);
-            DISPATCH();
-        }
-        op_SET_UPVALUE: {
-            op_set_upvalue(ip);
-            DISPATCH();
-        }
-        op_CLOSURE: {
-            op_closure(ip);
-            DISPATCH();
-        }
-        op_CLOSE_UPVALUES: {
-            op_close_upvalues(ip);
-            DISPATCH();
-        }
+        HELPER_HANDLER(GET_GLOBAL, op_get_global)
+        HELPER_HANDLER(SET_GLOBAL, op_set_global)
+        HELPER_HANDLER(GET_UPVALUE, op_get_upvalue)
+        HELPER_HANDLER(SET_UPVALUE, op_set_upvalue)
+        HELPER_HANDLER(CLOSURE, op_closure)
+        HELPER_HANDLER(CLOSE_UPVALUES, op_close_upvalues)
 
         // --- Các Op control flow (Giữ nguyên) ---
-        op_JUMP: {
-            uint16_t target = READ_ADDRESS();
-            ip = CURRENT_CHUNK().get_code() + target;
-            DISPATCH();
-        }
-        op_JUMP_IF_FALSE: {
-            uint16_t reg = READ_U16();
-            uint16_t target = READ_ADDRESS();
-            bool is_truthy_val = is_truthy(REGISTER(reg));
-            if (!is_truthy_val) {
-                ip = CURRENT_CHUNK().get_code() + target;
-            }
-            DISPATCH();
-        }
-        op_JUMP_IF_TRUE: {
-            uint16_t reg = READ_U16();
-            uint16_t target = READ_ADDRESS();
-            bool is_truthy_val = is_truthy(REGISTER(reg));
-            if (is_truthy_val) {
-                ip = CURRENT_CHUNK().get_code() + target;
-            }
-            DISPATCH();
-        }
-        op_CALL:
-        op_CALL_VOID: {
-            uint16_t dst, fn_reg, arg_start, argc;
-            size_t ret_reg;
-            OpCode instruction = (ip[-1] == static_cast<uint8_t>(OpCode::CALL)) ? OpCode::CALL : OpCode::CALL_VOID;
-
-            if (instruction == OpCode::CALL) {
-                dst = READ_U16();
-                fn_reg = READ_U16();
-                arg_start = READ_U16();
-                argc = READ_U16();
-                ret_reg = (dst == 0xFFFF) ? static_cast<size_t>(-1) : static_cast<size_t>(dst);
-            } else {
-                fn_reg = READ_U16();
-                arg_start = READ_U16();
-                argc = READ_U16();
-                ret_reg = static_cast<size_t>(-1);
-            }
+        BOTH_WIDTHS(JUMP_BODY, JUMP)
+        BOTH_WIDTHS(CONDITIONAL_JUMP_BODY, JUMP_IF_FALSE, false)
+        BOTH_WIDTHS(CONDITIONAL_JUMP_BODY, JUMP_IF_TRUE, true)
+        // NEQ được hiểu là !(a == b), GT/GE đã được đảo toán hạng thành LT/LE
+        COMPARE_JUMP_HANDLER(JUMP_IF_EQ,     EQ,  ==, true)
+        COMPARE_JUMP_HANDLER(JUMP_IF_NEQ,    NEQ, !=, true)
+        COMPARE_JUMP_HANDLER(JUMP_IF_LT,     LT,  <,  true)
+        COMPARE_JUMP_HANDLER(JUMP_IF_LE,     LE,  <=, true)
+        COMPARE_JUMP_HANDLER(JUMP_IF_NOT_LT, LT,  <,  false)
+        COMPARE_JUMP_HANDLER(JUMP_IF_NOT_LE, LE,  <=, false)
+        HELPER_HANDLER(FOR_PREP, op_for_prep)
+        BOTH_WIDTHS(FOR_LOOP_BODY, FOR_LOOP)
+        HELPER_HANDLER(FOR_IN, op_for_in)
+        HELPER_HANDLER(ITER_NEW, op_iter_new)
+        HELPER_HANDLER(ITER_NEXT, op_iter_next)
+        BOTH_WIDTHS(GUARD_CALLEE_BODY, GUARD_CALLEE)
+        BOTH_WIDTHS(CALL_BODY, CALL, true, do_call)
+        BOTH_WIDTHS(CALL_BODY, CALL_VOID, false, do_call)
+        do_call: {
+            const uint8_t* op_start = call.op_start;
+            uint16_t dst = call.dst, fn_reg = call.fn_reg, arg_start = call.arg_start, argc = call.argc;
+            size_t ret_reg = (dst == 0xFFFF) ? static_cast<size_t>(-1) : static_cast<size_t>(dst);
             Value& callee = REGISTER(fn_reg);
+            record_call_feedback(FEEDBACK_SLOT(op_start), callee);
 
             if (callee.is_native_fn()) {
                 {
@@ -499,6 +997,7 @@ dispatch_start:
             }
 
             proto_t proto = closure_to_call->get_proto();
+            if (proto->is_body_pending()) load_proto_body(proto);
             size_t new_base = context_->registers_.size();
             context_->registers_.resize(new_base + proto->get_num_registers());
             size_t arg_offset = 0;
@@ -520,12 +1019,89 @@ dispatch_start:
             context_->current_frame_ = &context_->call_stack_.back();
             ip = context_->current_frame_->ip_;
             context_->current_base_ = context_->current_frame_->start_reg_;
-            
+            ENTER_FEEDBACK(proto);
+            TIER_UP();
+            DISPATCH();
+        }
+        // Gọi đuôi: callee thay chỗ frame hiện tại và dùng lại cửa sổ register, nên đệ quy đuôi không làm stack lớn lên
+        BOTH_WIDTHS(CALL_BODY, TAIL_CALL, false, do_tail_call)
+        do_tail_call: {
+            const uint8_t* op_start = call.op_start;
+            uint16_t fn_reg = call.fn_reg, arg_start = call.arg_start, argc = call.argc;
+            Value callee = REGISTER(fn_reg);
+            record_call_feedback(FEEDBACK_SLOT(op_start), callee);
+
+            // Handler của try trong frame này sẽ nhảy vào chunk của callee, nên không cho phép
+            if (!context_->exception_handlers_.empty() && context_->exception_handlers_.back().frame_depth_ == context_->call_stack_.size() - 1) {
+                throw_vm_error("TAIL_CALL: Không thể gọi đuôi bên trong khối try.");
+            }
+
+            if (callee.is_native_fn()) {
+                std::vector<Value> args(argc);
+                for (size_t i = 0; i < argc; ++i) {
+                    args[i] = REGISTER(arg_start + i);
+                }
+                frame_result = callee.as_native_fn()->call(this, args);
+                goto do_return;
+            }
+
+            instance_t self = nullptr;
+            function_t closure_to_call = nullptr;
+            if (callee.is_function()) {
+                closure_to_call = callee.as_function();
+            } else if (callee.is_bound_method()) {
+                bound_method_t bound = callee.as_bound_method();
+                self = bound->get_instance();
+                closure_to_call = bound->get_function();
+            } else if (callee.is_class()) {
+                class_t k = callee.as_class();
+                self = heap_->new_instance(k);
+                Value init_val = k->get_method(heap_->new_string("init"));
+                if (!init_val.is_function()) {
+                    frame_result = Value(self);
+                    goto do_return;
+                }
+                closure_to_call = init_val.as_function();
+                // Như CALL constructor: frame gọi nhận instance ngay, init chạy với ret_reg = -1
+                size_t depth = context_->call_stack_.size();
+                if (depth > 1 && context_->current_frame_->ret_reg_ != static_cast<size_t>(-1)) {
+                    context_->registers_[context_->call_stack_[depth - 2].start_reg_ + context_->current_frame_->ret_reg_] = Value(self);
+                }
+                context_->current_frame_->ret_reg_ = static_cast<size_t>(-1);
+            } else {
+                throw_vm_error("TAIL_CALL: Giá trị không thể gọi được.");
+            }
+
+            proto_t proto = closure_to_call->get_proto();
+            if (proto->is_body_pending()) load_proto_body(proto);
+            size_t base = context_->current_base_;
+            size_t num_registers = proto->get_num_registers();
+            size_t arg_offset = (self != nullptr && num_registers > 0) ? 1 : 0;
+            size_t count = std::min<size_t>(argc, num_registers - arg_offset);
+            close_upvalues(context_.get(), base);
+
+            // Dời đối số về đầu cửa sổ (có thể chồng lên nhau), rồi xoá mọi register còn lại về null như một frame mới
+            auto& regs = context_->registers_;
+            if (regs.size() < base + num_registers) regs.resize(base + num_registers);
+            auto src = regs.begin() + static_cast<std::ptrdiff_t>(base + arg_start);
+            auto dst = regs.begin() + static_cast<std::ptrdiff_t>(base + arg_offset);
+            if (dst <= src) std::move(src, src + static_cast<std::ptrdiff_t>(count), dst);
+            else std::move_backward(src, src + static_cast<std::ptrdiff_t>(count), dst + static_cast<std::ptrdiff_t>(count));
+            for (size_t i = 0; i < num_registers; ++i) {
+                if (i < arg_offset || i >= arg_offset + count) regs[base + i] = Value(null_t{});
+            }
+            if (arg_offset != 0) regs[base] = Value(self);
+            regs.resize(base + num_registers);
+
+            context_->current_frame_->function_ = closure_to_call;
+            ip = proto->get_chunk().get_code();
+            ENTER_FEEDBACK(proto);
+            TIER_UP();
             DISPATCH();
         }
-        op_RETURN: {
-            uint16_t ret_reg_idx = READ_U16();
-            Value return_value = (ret_reg_idx == 0xFFFF) ? Value(null_t{}) : REGISTER(ret_reg_idx);
+        BOTH_WIDTHS(RETURN_BODY, RETURN)
+        do_return: {
+            Value return_value = frame_result;
             CallFrame popped_frame = *context_->current_frame_;
             size_t old_base = popped_frame.start_reg_;
             close_upvalues(context_.get(), popped_frame.start_reg_);
@@ -544,86 +1120,36 @@ dispatch_start:
                 context_->registers_[context_->current_base_ + popped_frame.ret_reg_] = return_value;
             }
             context_->registers_.resize(old_base);
-            
+            // Frame gọi có thể đã được dịch trong lúc callee chạy, hoặc vừa rời mã máy ở lệnh CALL
+            ENTER_JIT();
             DISPATCH();
         }
 
         // --- Các Op Handler đã refactor ---
-        op_NEW_ARRAY: {
-            op_new_array(ip);
-            DISPATCH();
-        }
-        op_NEW_HASH: {
-            op_new_hash(ip);
-            DISPATCH();
-        }
-        op_GET_INDEX: {
-            op_get_index(ip);
-            DISPATCH();
-        }
-        op_SET_INDEX: {
-            op_set_index(ip);
-            DISPATCH();
-        }
-        op_GET_KEYS: {
-            op_get_keys(ip);
-            DISPATCH();
-        }
-        op_GET_VALUES: {
-            op_get_values(ip);
-            DISPATCH();
-        }
-        op_NEW_CLASS: {
-            op_new_class(ip);
-            DISPATCH();
-        }
-        op_NEW_INSTANCE: {
-            op_new_instance(ip);
-            DISPATCH();
-        }
-        op_GET_PROP: {
-            op_get_prop(ip);
-            DISPATCH();
-        }
-        op_SET_PROP: {
-            op_set_prop(ip);
-            DISPATCH();
-        }
-        op_SET_METHOD: {
-            op_set_method(ip);
-            DISPATCH();
-        }
-        op_INHERIT: {
-            op_inherit(ip);
-            DISPATCH();
-        }
-        op_GET_SUPER: {
-            op_get_super(ip);
-            DISPATCH();
-        }
+        HELPER_HANDLER(NEW_ARRAY, op_new_array)
+        HELPER_HANDLER(NEW_HASH, op_new_hash)
+        HELPER_HANDLER(GET_INDEX, op_get_index)
+        HELPER_HANDLER(SET_INDEX, op_set_index)
+        HELPER_HANDLER(GET_KEYS, op_get_keys)
+        HELPER_HANDLER(GET_VALUES, op_get_values)
+        HELPER_HANDLER(NEW_CLASS, op_new_class)
+        HELPER_HANDLER(NEW_INSTANCE, op_new_instance)
+        HELPER_HANDLER(GET_PROP, op_get_prop)
+        HELPER_HANDLER(SET_PROP, op_set_prop)
+        HELPER_HANDLER(SET_METHOD, op_set_method)
+        HELPER_HANDLER(INHERIT, op_inherit)
+        HELPER_HANDLER(GET_SUPER, op_get_super)
 
         // --- Các Op control flow (Giữ nguyên) ---
-        op_THROW: {
-            uint16_t reg = READ_U16(); // Sửa warning
-            // Sử dụng thanh ghi để tạo thông báo lỗi
-            throw_vm_error("Explicit throw: " + to_string(REGISTER(reg)));
-            DISPATCH(); // Sẽ không bao giờ đạt tới
-        }
-        op_SETUP_TRY: {
-            uint16_t target = READ_ADDRESS();
-            size_t catch_ip = target;
-            size_t frame_depth = context_->call_stack_.size() - 1;
-            size_t stack_depth = context_->registers_.size();
-            context_->exception_handlers_.emplace_back(catch_ip, frame_depth, stack_depth);
-            DISPATCH();
-        }
+        BOTH_WIDTHS(THROW_BODY, THROW)
+        BOTH_WIDTHS(SETUP_TRY_BODY, SETUP_TRY)
         op_POP_TRY: {
             op_pop_try();
             DISPATCH();
         }
-        op_IMPORT_MODULE: {
-            uint16_t dst = READ_U16();
-            uint16_t path_idx = READ_U16();
+        BOTH_WIDTHS(IMPORT_MODULE_BODY, IMPORT_MODULE)
+        do_import: {
+            uint16_t dst = import_dst, path_idx = import_path;
             string_t path = CONSTANT(path_idx).as_string();
             string_t importer_path = context_->current_frame_->module_->get_file_path();
             module_t mod = mod_manager_->load_module(path, importer_path);
@@ -646,22 +1172,28 @@ dispatch_start:
             context_->current_frame_ = &context_->call_stack_.back();
             ip = context_->current_frame_->ip_;
             context_->current_base_ = context_->current_frame_->start_reg_;
-            
+            ENTER_FEEDBACK(main_proto);
             DISPATCH();
         }
 
         // --- Các Op Handler đã refactor ---
-        op_EXPORT: {
-            op_export(ip);
-            DISPATCH();
-        }
-        op_GET_EXPORT: {
-            op_get_export(ip);
-            DISPATCH();
-        }
-        op_IMPORT_ALL: {
-            op_import_all(ip);
-            DISPATCH();
+        HELPER_HANDLER(EXPORT, op_export)
+        HELPER_HANDLER(GET_EXPORT, op_get_export)
+        HELPER_HANDLER(IMPORT_ALL, op_import_all)
+
+        // --- Superinstruction (sinh từ core/superinstructions.def) ---
+#define MEOW_SUPERINSTRUCTION(NAME, A, B) SUPERINSTRUCTION_HANDLER(NAME, A, B)
+#define MEOW_SUPERINSTRUCTION3(NAME, A, B, C) SUPERINSTRUCTION3_HANDLER(NAME, A, B, C)
+#include "core/superinstructions.def"
+#undef MEOW_SUPERINSTRUCTION
+#undef MEOW_SUPERINSTRUCTION3
+
+        // Tiền tố WIDE: lệnh kế tiếp đọc toán hạng 2 byte và khoảng nhảy 4 byte. ip_ của frame vẫn trỏ vào tiền tố
+        op_WIDE: {
+            uint8_t wide_instruction = READ_BYTE();
+            const void* wide_handler = wide_instruction < static_cast<uint8_t>(OpCode::TOTAL_OPCODES) ? wide_dispatch_table[wide_instruction] : nullptr;
+            if (wide_handler == nullptr) throw_vm_error("WIDE: Lệnh không có dạng rộng.");
+            goto *wide_handler;
         }
 
         // --- Op cuối cùng (Giữ nguyên) ---
@@ -676,27 +1208,10 @@ dispatch_start:
         }
 
     } catch (const VMError& e) {
-        printl("An execption was threw: {}", e.what());
-        if (context_->exception_handlers_.empty()) {
-            printl("No exception handler. Halting.");
+        if (!handle_error(e.what(), ip)) {
             return; // Thoát hàm run()
         }
 
-        ExceptionHandler handler = context_->exception_handlers_.back();
-        context_->exception_handlers_.pop_back();
-
-        while (context_->call_stack_.size() - 1 > handler.frame_depth_) {
-            close_upvalues(context_.get(), context_->call_stack_.back().start_reg_);
-            context_->call_stack_.pop_back();
-        }
-        context_->registers_.resize(handler.stack_depth_);
-        context_->current_frame_ = &context_->call_stack_.back();
-        ip = CURRENT_CHUNK().get_code() + handler.catch_ip_;
-        context_->current_base_ = context_->current_frame_->start_reg_;
-        if (context_->current_base_ < context_->registers_.size()) {
-            REGISTER(0) = Value(heap_->new_string(e.what()));
-        }
-        
         // --- SỬA LỖI 1: Nhảy về đầu dispatch, KHÔNG dùng DISPATCH() ---
         goto dispatch_start;
     }
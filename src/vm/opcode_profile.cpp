@@ -0,0 +1,37 @@
+#include "vm/opcode_profile.h"
+#include "debug/disassemble.h"
+
+namespace meow::vm {
+
+void OpcodeProfile::dump(std::ostream& os) const {
+    using meow::debug::opcode_to_string;
+    auto name = [](size_t op) { return opcode_to_string(static_cast<core::OpCode>(op)); };
+
+    std::vector<std::pair<uint64_t, size_t>> entries;
+    for (size_t i = 0; i < pairs_.size(); ++i) {
+        if (pairs_[i] != 0) entries.emplace_back(pairs_[i], i);
+    }
+    std::sort(entries.begin(), entries.end(), std::greater<>{});
+    os << "# meow opcode profile v1\n";
+    for (const auto& [count, index] : entries) {
+        os << "pair " << name(index / NUM_OPCODES) << ' ' << name(index % NUM_OPCODES) << ' ' << count << '\n';
+    }
+
+    entries.clear();
+    for (size_t i = 0; i < triples_.size(); ++i) {
+        if (triples_[i] != 0) entries.emplace_back(triples_[i], i);
+    }
+    std::sort(entries.begin(), entries.end(), std::greater<>{});
+    for (const auto& [count, index] : entries) {
+        os << "triple " << name(index / (NUM_OPCODES * NUM_OPCODES)) << ' ' << name(index / NUM_OPCODES % NUM_OPCODES) << ' '
+           << name(index % NUM_OPCODES) << ' ' << count << '\n';
+    }
+}
+
+void OpcodeProfile::flush() const {
+    const char* path = std::getenv("MEOW_OPCODE_PROFILE");
+    if (path == nullptr || *path == '\0') return;
+    std::ofstream file(path, std::ios::app);
+    if (file) dump(file);
+}
+}  // namespace meow::vm
@@ -0,0 +1,203 @@
+// Hồi quy cho các bảng kernel mảng: mọi bảng CPU đang chạy hỗ trợ (SSE2, AVX2) phải cho cùng kết quả với bảng scalar.
+// Độ dài không chia hết cho độ rộng vector để chạy cả vòng đuôi, dữ liệu float có NaN ở từng lane.
+
+#include "common/pch.h"
+#include "runtime/array_kernels.h"
+
+#include <numeric>
+
+namespace {
+using namespace meow::runtime;
+
+int failures = 0;
+
+void check(bool condition, const ArrayKernels& table, const char* kernel, size_t n, std::string_view detail = {}) {
+    if (condition) return;
+    std::cerr << "FAIL: " << table.name << "." << kernel << " (n = " << n << ")";
+    if (!detail.empty()) std::cerr << " " << detail;
+    std::cerr << std::endl;
+    ++failures;
+}
+
+// Hai NaN coi là cùng kết quả; -0.0 và 0.0 thì không
+bool same_double(double lhs, double rhs) noexcept {
+    if (std::isnan(lhs) || std::isnan(rhs)) return std::isnan(lhs) && std::isnan(rhs);
+    return std::bit_cast<uint64_t>(lhs) == std::bit_cast<uint64_t>(rhs);
+}
+
+bool same_doubles(const std::vector<double>& lhs, const std::vector<double>& rhs) noexcept {
+    if (lhs.size() != rhs.size()) return false;
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        if (!same_double(lhs[i], rhs[i])) return false;
+    }
+    return true;
+}
+
+struct Random {
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+
+    uint64_t next() noexcept {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return state >> 11;
+    }
+    // Số nguyên nhỏ lẫn số sát biên để cộng/nhân có tràn
+    int64_t next_int() noexcept {
+        uint64_t bits = next();
+        switch (bits % 8) {
+            case 0: return std::numeric_limits<int64_t>::max() - static_cast<int64_t>(bits % 5);
+            case 1: return std::numeric_limits<int64_t>::min() + static_cast<int64_t>(bits % 5);
+            default: return static_cast<int64_t>(bits % 2001) - 1000;
+        }
+    }
+    // Bội của 1/4 trong khoảng nhỏ: tổng và tích vô hướng chính xác nên thứ tự cộng của SIMD không làm lệch kết quả
+    double next_double() noexcept { return static_cast<double>(static_cast<int64_t>(next() % 801) - 400) / 4.0; }
+};
+
+constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+// 0..40 phủ mọi phần dư theo 2 và 4 phần tử, cộng vài độ dài lớn lẻ
+std::vector<size_t> test_lengths() {
+    std::vector<size_t> lengths;
+    for (size_t n = 0; n <= 40; ++n) lengths.push_back(n);
+    lengths.insert(lengths.end(), {63, 65, 127, 131, 1001});
+    return lengths;
+}
+
+// Chỗ đặt NaN trong mảng độ dài n: mảng ngắn thử mọi vị trí (mọi lane), mảng dài thử đầu, giữa, cuối
+std::vector<size_t> nan_positions(size_t n) {
+    if (n == 0) return {};
+    if (n <= 16) {
+        std::vector<size_t> positions(n);
+        std::iota(positions.begin(), positions.end(), size_t{0});
+        return positions;
+    }
+    std::vector<size_t> positions{0, n / 2, n - 1};
+    std::sort(positions.begin(), positions.end());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+    return positions;
+}
+
+void check_int_kernels(const ArrayKernels& table, const ArrayKernels& scalar, Random& random, size_t n) {
+    std::vector<int64_t> a(n), b(n);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = random.next_int();
+        b[i] = random.next_int();
+    }
+    int64_t scalar_value = random.next_int();
+
+    check(table.sum_i64(a.data(), n) == scalar.sum_i64(a.data(), n), table, "sum_i64", n);
+    check(table.dot_i64(a.data(), b.data(), n) == scalar.dot_i64(a.data(), b.data(), n), table, "dot_i64", n);
+    if (n > 0) {
+        check(table.min_i64(a.data(), n) == scalar.min_i64(a.data(), n), table, "min_i64", n);
+        check(table.max_i64(a.data(), n) == scalar.max_i64(a.data(), n), table, "max_i64", n);
+    }
+
+    std::vector<int64_t> filled(n + 1, -1), expected(n + 1, -1);
+    table.fill_i64(filled.data(), n, scalar_value);
+    scalar.fill_i64(expected.data(), n, scalar_value);
+    check(filled == expected, table, "fill_i64", n, "(also must not write past n)");
+
+    for (size_t at : nan_positions(n)) {
+        check(table.index_of_i64(a.data(), n, a[at]) == scalar.index_of_i64(a.data(), n, a[at]), table, "index_of_i64", n);
+    }
+    check(table.index_of_i64(a.data(), n, 1 << 20) == scalar.index_of_i64(a.data(), n, 1 << 20), table, "index_of_i64", n, "(absent)");
+
+    std::vector<int64_t> copy = a;
+    check(table.mismatch_i64(a.data(), copy.data(), n) == ArrayKernels::npos, table, "mismatch_i64", n, "(equal)");
+    for (size_t at : nan_positions(n)) {
+        copy = a;
+        copy[at] ^= 1;
+        check(table.mismatch_i64(a.data(), copy.data(), n) == scalar.mismatch_i64(a.data(), copy.data(), n), table, "mismatch_i64", n);
+    }
+
+    std::vector<int64_t> out(n + 1, -1), out_expected(n + 1, -1);
+    table.add_i64(out.data(), a.data(), n, scalar_value);
+    scalar.add_i64(out_expected.data(), a.data(), n, scalar_value);
+    check(out == out_expected, table, "add_i64", n);
+    table.mul_i64(out.data(), a.data(), n, scalar_value);
+    scalar.mul_i64(out_expected.data(), a.data(), n, scalar_value);
+    check(out == out_expected, table, "mul_i64", n);
+}
+
+void check_float_kernels(const ArrayKernels& table, const ArrayKernels& scalar, Random& random, size_t n) {
+    std::vector<double> a(n), b(n);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = random.next_double();
+        b[i] = random.next_double();
+    }
+    double scalar_value = random.next_double();
+
+    check(same_double(table.sum_f64(a.data(), n), scalar.sum_f64(a.data(), n)), table, "sum_f64", n);
+    check(same_double(table.dot_f64(a.data(), b.data(), n), scalar.dot_f64(a.data(), b.data(), n)), table, "dot_f64", n);
+    if (n > 0) {
+        check(same_double(table.min_f64(a.data(), n), scalar.min_f64(a.data(), n)), table, "min_f64", n);
+        check(same_double(table.max_f64(a.data(), n), scalar.max_f64(a.data(), n)), table, "max_f64", n);
+    }
+
+    std::vector<double> filled(n + 1, -1.0), expected(n + 1, -1.0);
+    table.fill_f64(filled.data(), n, scalar_value);
+    scalar.fill_f64(expected.data(), n, scalar_value);
+    check(same_doubles(filled, expected), table, "fill_f64", n, "(also must not write past n)");
+
+    std::vector<double> out(n + 1, -1.0), out_expected(n + 1, -1.0);
+    table.add_f64(out.data(), a.data(), n, scalar_value);
+    scalar.add_f64(out_expected.data(), a.data(), n, scalar_value);
+    check(same_doubles(out, out_expected), table, "add_f64", n);
+    table.mul_f64(out.data(), a.data(), n, scalar_value);
+    scalar.mul_f64(out_expected.data(), a.data(), n, scalar_value);
+    check(same_doubles(out, out_expected), table, "mul_f64", n);
+
+    // NaN không bằng gì kể cả chính nó: tìm NaN luôn là npos, hai mảng giống hệt nhau có NaN vẫn lệch ở chỗ NaN
+    check(table.index_of_f64(a.data(), n, NaN) == ArrayKernels::npos, table, "index_of_f64", n, "(searching NaN)");
+    for (size_t at : nan_positions(n)) {
+        std::vector<double> with_nan = a;
+        with_nan[at] = NaN;
+        std::string where = std::format("(NaN at {})", at);
+
+        check(same_double(table.min_f64(with_nan.data(), n), scalar.min_f64(with_nan.data(), n)), table, "min_f64", n, where);
+        check(same_double(table.max_f64(with_nan.data(), n), scalar.max_f64(with_nan.data(), n)), table, "max_f64", n, where);
+
+        double target = with_nan[n - 1 - at / 2];
+        check(table.index_of_f64(with_nan.data(), n, target) == scalar.index_of_f64(with_nan.data(), n, target), table, "index_of_f64", n, where);
+        check(table.index_of_f64(with_nan.data(), n, NaN) == ArrayKernels::npos, table, "index_of_f64", n, where);
+
+        std::vector<double> copy = with_nan;
+        check(table.mismatch_f64(with_nan.data(), copy.data(), n) == scalar.mismatch_f64(with_nan.data(), copy.data(), n), table, "mismatch_f64", n, where);
+        check(table.mismatch_f64(with_nan.data(), copy.data(), n) == at, table, "mismatch_f64", n, where);
+
+        // equals của mảng là mismatch == npos: NaN chỉ ở một bên cũng phải bị bắt
+        copy = a;
+        check(table.mismatch_f64(with_nan.data(), copy.data(), n) == scalar.mismatch_f64(with_nan.data(), copy.data(), n), table, "mismatch_f64", n, where + " (one side)");
+        check(table.mismatch_f64(copy.data(), with_nan.data(), n) == scalar.mismatch_f64(copy.data(), with_nan.data(), n), table, "mismatch_f64", n, where + " (other side)");
+    }
+
+    std::vector<double> copy = a;
+    check(table.mismatch_f64(a.data(), copy.data(), n) == ArrayKernels::npos, table, "mismatch_f64", n, "(equal)");
+    // 0.0 và -0.0 bằng nhau với ==, kernel không được so sánh theo bit
+    if (n > 0) {
+        std::vector<double> zeros(n, 0.0), negative_zeros(n, -0.0);
+        check(table.mismatch_f64(zeros.data(), negative_zeros.data(), n) == ArrayKernels::npos, table, "mismatch_f64", n, "(signed zero)");
+        check(table.index_of_f64(zeros.data(), n, -0.0) == 0, table, "index_of_f64", n, "(signed zero)");
+    }
+}
+}  // namespace
+
+int main() {
+    const ArrayKernels& scalar = get_scalar_array_kernels();
+    std::vector<const ArrayKernels*> tables = get_supported_array_kernels();
+    check(std::find(tables.begin(), tables.end(), &get_array_kernels()) != tables.end(), scalar, "get_array_kernels", 0,
+          "(selected table is not among the supported ones)");
+
+    for (const ArrayKernels* table : tables) {
+        Random random;
+        for (size_t n : test_lengths()) {
+            check_int_kernels(*table, scalar, random, n);
+            check_float_kernels(*table, scalar, random, n);
+        }
+        std::cout << "array_kernels_test: checked " << table->name << std::endl;
+    }
+
+    if (failures != 0) return 1;
+    std::cout << "array_kernels_test: ok" << std::endl;
+    return 0;
+}
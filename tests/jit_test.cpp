@@ -0,0 +1,472 @@
+// Hồi quy cho các tầng JIT: cùng một module .meowb chạy bằng interpreter (MEOW_NO_JIT=1) và bằng từng tầng mã máy
+// có trên máy này (assembler, stencils, trace), kết quả và lỗi phải giống hệt nhau.
+// Ngưỡng dịch đặt bằng 1 để mã máy vào ngay từ lần nhảy ngược đầu tiên của vòng lặp.
+
+#include "common/cast.h"
+#include "common/pch.h"
+#include "core/objects/array.h"
+#include "core/objects/function.h"
+#include "core/objects/module.h"
+#include "jit/baseline_jit.h"
+#include "jit/trace_jit.h"
+#include "memory/mark_sweep_gc.h"
+#include "memory/memory_manager.h"
+#include "module/loader/binary_writer.h"
+#include "runtime/builtin_registry.h"
+#include "runtime/bytecode.h"
+#include "runtime/chunk.h"
+#include "runtime/execution_context.h"
+#include "test_support.h"
+#include "vm/meow_vm.h"
+
+namespace {
+using namespace meow::core;
+using namespace meow::runtime;
+using namespace meow::test;
+
+// Kết quả của một lần chạy: các phần tử của mảng mà chương trình trả về, hoặc thông báo lỗi không ai bắt
+struct Outcome {
+    std::vector<Value> values;
+    std::optional<std::string> error;
+};
+
+bool same_value(const Value& lhs, const Value& rhs) noexcept {
+    if (lhs.index() != rhs.index()) return false;
+    if (lhs.is_int()) return lhs.as_int() == rhs.as_int();
+    if (lhs.is_float()) {
+        if (std::isnan(lhs.as_float()) || std::isnan(rhs.as_float())) return std::isnan(lhs.as_float()) && std::isnan(rhs.as_float());
+        return std::bit_cast<uint64_t>(lhs.as_float()) == std::bit_cast<uint64_t>(rhs.as_float());
+    }
+    if (lhs.is_bool()) return lhs.as_bool() == rhs.as_bool();
+    return lhs.is_null();
+}
+
+std::string describe(const Outcome& outcome) {
+    if (outcome.error) return "error \"" + *outcome.error + "\"";
+    std::string text = "[";
+    for (size_t i = 0; i < outcome.values.size(); ++i) {
+        if (i != 0) text += ", ";
+        text += meow::common::to_string(outcome.values[i]);
+    }
+    return text + "]";
+}
+
+bool same_outcome(const Outcome& lhs, const Outcome& rhs) noexcept {
+    if (lhs.error || rhs.error) return lhs.error == rhs.error;
+    return lhs.values.size() == rhs.values.size() && std::equal(lhs.values.begin(), lhs.values.end(), rhs.values.begin(), same_value);
+}
+
+// --- Các tầng thực thi ---
+
+constexpr const char* JIT_VARIABLES[] = {"MEOW_NO_JIT", "MEOW_JIT_BACKEND", "MEOW_JIT_THRESHOLD", "MEOW_OSR_THRESHOLD", "MEOW_NO_TRACE", "MEOW_TRACE_THRESHOLD"};
+
+struct Tier {
+    const char* name;
+    std::vector<std::pair<const char*, const char*>> environment;
+    bool baseline;  ///< Proto chính phải có mã baseline sau khi chạy
+};
+
+const std::vector<Tier> TIERS = {
+    {"interpreter", {{"MEOW_NO_JIT", "1"}}, false},
+    {"assembler", {{"MEOW_JIT_BACKEND", "assembler"}, {"MEOW_JIT_THRESHOLD", "1"}, {"MEOW_OSR_THRESHOLD", "1"}, {"MEOW_NO_TRACE", "1"}}, true},
+    {"stencils", {{"MEOW_JIT_BACKEND", "stencils"}, {"MEOW_JIT_THRESHOLD", "1"}, {"MEOW_OSR_THRESHOLD", "1"}, {"MEOW_NO_TRACE", "1"}}, true},
+    // Chỉ có trace: baseline không bao giờ đủ ngưỡng, mọi side exit trả về interpreter
+    {"trace", {{"MEOW_JIT_THRESHOLD", "4294967295"}, {"MEOW_OSR_THRESHOLD", "4294967295"}, {"MEOW_TRACE_THRESHOLD", "1"}}, false},
+    // Trace trên nền mã baseline: side exit trả về mã máy của proto
+    {"trace+assembler", {{"MEOW_JIT_BACKEND", "assembler"}, {"MEOW_JIT_THRESHOLD", "1"}, {"MEOW_OSR_THRESHOLD", "1"}, {"MEOW_TRACE_THRESHOLD", "1"}}, true},
+};
+
+void apply_environment(const Tier& tier) {
+    for (const char* name : JIT_VARIABLES) unsetenv(name);
+    for (const auto& [name, value] : tier.environment) setenv(name, value, 1);
+}
+
+// Tầng không dựng được trên máy này (không có x86-64, không có stencil, ...) thì bỏ qua thay vì chạy nhầm tầng khác
+bool is_available(const Tier& tier) {
+    apply_environment(tier);
+    meow::jit::JitOptions options = meow::jit::JitOptions::from_environment();
+    if (!options.enabled) return true;
+    auto jit = meow::jit::BaselineJit::create(options, nullptr, nullptr);
+    if (!jit) return false;
+    std::string_view name = tier.name;
+    if (name.ends_with("assembler") && jit->get_backend() != meow::jit::JitBackend::ASSEMBLER) return false;
+    if (name == "stencils" && jit->get_backend() != meow::jit::JitBackend::STENCILS) return false;
+    if (name.starts_with("trace") && !meow::jit::TraceJit::create(options)) return false;
+    return true;
+}
+
+Outcome run_in_tier(const Tier& tier, const std::filesystem::path& path) {
+    apply_environment(tier);
+    meow::vm::MeowVM vm(path.parent_path().string(), path.string(), 0, nullptr);
+    Outcome outcome;
+    try {
+        Value result = vm.run_module(path.string());
+        if (result.is_array()) {
+            for (size_t i = 0; i < result.as_array()->size(); ++i) outcome.values.push_back(result.as_array()->get(i));
+        } else {
+            outcome.values.push_back(result);
+        }
+    } catch (const meow::vm::VMError& e) {
+        outcome.error = e.what();
+    }
+    if (tier.baseline) {
+        check(vm.get_entry_module()->get_main_proto()->get_jit_code() != nullptr, std::string(tier.name) + ": main proto was compiled");
+    }
+    return outcome;
+}
+
+// --- Chương trình thử ---
+
+struct Program {
+    std::string name;
+    proto_t proto;
+    Outcome expected;  ///< Kết quả đúng, kiểm tra cả interpreter
+};
+
+// ADD int tràn qua 48 bit của payload, theo cả hai chiều và khi nhân đôi: mọi tầng phải wrap như Value(int_t).
+// Hằng số nạp trong thân vòng lặp để trace đủ thanh ghi máy (không có spill) và thật sự được dịch
+Program int_wraparound(meow::memory::MemoryManager& heap) {
+    constexpr int64_t TOP = (int64_t{1} << 47) - 4;
+    constexpr int64_t BOTTOM = -(int64_t{1} << 47) + 3;
+    constexpr int64_t DOUBLED_START = (int64_t{1} << 40) + 7;
+    Emitter e;
+    e.load_int(0, TOP).load_int(1, BOTTOM).load_int(2, DOUBLED_START);
+    e.load_int(6, 0).load_int(7, 7).load_int(8, 1);
+    size_t exit = e.jump(OpCode::FOR_PREP, {6});
+    uint32_t body = e.here();
+    e.load_int(4, 1).load_int(5, -1);
+    e.op(OpCode::ADD, {0, 0, 4}).op(OpCode::ADD, {1, 1, 5}).op(OpCode::ADD, {2, 2, 2});
+    e.op(OpCode::FOR_LOOP, {6, body});
+    e.land(exit);
+    e.op(OpCode::NEW_ARRAY, {10, 0, 3}).op(OpCode::RETURN, {10});
+
+    auto wrap_add = [](int64_t a, int64_t b) { return Value(static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b))).as_int(); };
+    int64_t top = TOP, bottom = BOTTOM, doubled = DOUBLED_START;
+    for (int i = 0; i < 8; ++i) {
+        top = wrap_add(top, 1);
+        bottom = wrap_add(bottom, -1);
+        doubled = wrap_add(doubled, doubled);
+    }
+    return {"int wraparound", heap.new_proto(11, 0, heap.new_string("int_wraparound"), e.finish()),
+            {{Value(top), Value(bottom), Value(doubled)}, std::nullopt}};
+}
+
+// So sánh có NaN: mọi compare-jump và opcode so sánh, NaN ở trái, phải và cả hai bên. Mỗi phép so sánh có một
+// trọng số riêng được cộng khi nhánh không nhảy (compare-jump) hoặc kết quả là true (opcode so sánh)
+Program nan_compares(meow::memory::MemoryManager& heap) {
+    constexpr uint16_t COUNT = 0, NAN_REG = 1, ONE = 2, TEST = 3, WEIGHTS = 4, LOOP = 60;
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const std::pair<uint16_t, uint16_t> operands[] = {{NAN_REG, ONE}, {ONE, NAN_REG}, {NAN_REG, NAN_REG}};
+
+    struct Compare {
+        OpCode op;
+        bool fused;
+        bool (*apply)(double, double);
+    };
+    const Compare compares[] = {
+        {OpCode::JUMP_IF_EQ, true, [](double a, double b) { return a == b; }},
+        {OpCode::JUMP_IF_NEQ, true, [](double a, double b) { return !(a == b); }},
+        {OpCode::JUMP_IF_LT, true, [](double a, double b) { return a < b; }},
+        {OpCode::JUMP_IF_LE, true, [](double a, double b) { return a <= b; }},
+        {OpCode::JUMP_IF_NOT_LT, true, [](double a, double b) { return !(a < b); }},
+        {OpCode::JUMP_IF_NOT_LE, true, [](double a, double b) { return !(a <= b); }},
+        {OpCode::EQ, false, [](double a, double b) { return a == b; }},
+        {OpCode::NEQ, false, [](double a, double b) { return a != b; }},
+        {OpCode::LT, false, [](double a, double b) { return a < b; }},
+        {OpCode::LE, false, [](double a, double b) { return a <= b; }},
+        {OpCode::GT, false, [](double a, double b) { return a > b; }},
+        {OpCode::GE, false, [](double a, double b) { return a >= b; }},
+    };
+
+    Emitter e;
+    e.load_int(COUNT, 0).load_float(NAN_REG, nan).load_float(ONE, 1.0);
+    uint16_t weight = WEIGHTS;
+    for (size_t i = 0; i < std::size(compares) * std::size(operands); ++i) e.load_int(weight++, int64_t{1} << i);
+    e.load_int(LOOP, 1).load_int(LOOP + 1, 4).load_int(LOOP + 2, 1);
+    size_t exit = e.jump(OpCode::FOR_PREP, {LOOP});
+    uint32_t body = e.here();
+
+    int64_t per_iteration = 0;
+    weight = WEIGHTS;
+    for (const Compare& compare : compares) {
+        for (auto [lhs, rhs] : operands) {
+            double a = lhs == NAN_REG ? nan : 1.0, b = rhs == NAN_REG ? nan : 1.0;
+            size_t skip;
+            if (compare.fused) {
+                skip = e.jump(compare.op, {lhs, rhs});
+                if (!compare.apply(a, b)) per_iteration += int64_t{1} << (weight - WEIGHTS);
+            } else {
+                e.op(compare.op, {TEST, lhs, rhs});
+                skip = e.jump(OpCode::JUMP_IF_FALSE, {TEST});
+                if (compare.apply(a, b)) per_iteration += int64_t{1} << (weight - WEIGHTS);
+            }
+            e.op(OpCode::ADD, {COUNT, COUNT, weight++});
+            e.land(skip);
+        }
+    }
+    e.op(OpCode::FOR_LOOP, {LOOP, body});
+    e.land(exit);
+    e.op(OpCode::RETURN, {COUNT});
+    return {"NaN compares", heap.new_proto(LOOP + 4, 0, heap.new_string("nan_compares"), e.finish()),
+            {{Value(per_iteration * 4)}, std::nullopt}};
+}
+
+// FOR_PREP/FOR_LOOP với bước âm: int (giới hạn âm), vòng không chạy lần nào, và float
+Program negative_step_loops(meow::memory::MemoryManager& heap) {
+    Emitter e;
+    e.load_int(0, 0).load_int(2, 1000).load_float(3, 0.0);
+    // int: 10, 7, 4, 1, -2, -5
+    e.load_int(10, 10).load_int(11, -5).load_int(12, -3);
+    size_t exit = e.jump(OpCode::FOR_PREP, {10});
+    uint32_t body = e.here();
+    e.op(OpCode::ADD, {0, 0, 0}).op(OpCode::ADD, {0, 0, 13});
+    e.op(OpCode::FOR_LOOP, {10, body});
+    e.land(exit);
+    // Bắt đầu đã vượt giới hạn theo chiều âm: không chạy lần nào
+    e.load_int(20, -1).load_int(21, 0).load_int(22, -1);
+    exit = e.jump(OpCode::FOR_PREP, {20});
+    body = e.here();
+    e.op(OpCode::ADD, {0, 0, 2});
+    e.op(OpCode::FOR_LOOP, {20, body});
+    e.land(exit);
+    // float: 1, 0.5, 0, -0.5, -1
+    e.load_float(30, 1.0).load_float(31, -1.0).load_float(32, -0.5);
+    exit = e.jump(OpCode::FOR_PREP, {30});
+    body = e.here();
+    e.op(OpCode::ADD, {3, 3, 3}).op(OpCode::ADD, {3, 3, 33});
+    e.op(OpCode::FOR_LOOP, {30, body});
+    e.land(exit);
+    e.op(OpCode::MOVE, {40, 0}).op(OpCode::MOVE, {41, 3}).op(OpCode::NEW_ARRAY, {42, 40, 2}).op(OpCode::RETURN, {42});
+
+    int64_t int_sum = 0;
+    for (int64_t i = 10; i >= -5; i -= 3) int_sum = int_sum * 2 + i;
+    double float_sum = 0.0;
+    for (double x = 1.0; x >= -1.0; x -= 0.5) float_sum = float_sum * 2.0 + x;
+    return {"negative step loops", heap.new_proto(43, 0, heap.new_string("negative_step_loops"), e.finish()),
+            {{Value(int_sum), Value(float_sum)}, std::nullopt}};
+}
+
+// GET_INDEX ra ngoài mảng trong vòng lặp: mã máy chạy lệnh này qua callout, lỗi phải về interpreter (PENDING_ERROR)
+// ở đúng lệnh đó, với các register mã máy đã ghi trước lỗi
+constexpr const char* OUT_OF_BOUNDS = "Array index out of bounds.";
+
+void emit_index_loop(Emitter& e) {
+    e.load_int(2, 7).load_int(3, 11).load_int(4, 13).op(OpCode::NEW_ARRAY, {1, 2, 3});
+    e.load_int(5, 0).load_int(6, 1).load_int(12, 0);
+    e.load_int(7, 0).load_int(8, 9).load_int(9, 1);
+    size_t exit = e.jump(OpCode::FOR_PREP, {7});
+    uint32_t body = e.here();
+    e.op(OpCode::ADD, {5, 5, 6}).op(OpCode::GET_INDEX, {11, 1, 10}).op(OpCode::ADD, {12, 12, 11});
+    e.op(OpCode::FOR_LOOP, {7, body});
+    e.land(exit);
+}
+
+Program uncaught_callout_error(meow::memory::MemoryManager& heap) {
+    Emitter e;
+    emit_index_loop(e);
+    e.op(OpCode::RETURN, {12});
+    return {"uncaught callout error", heap.new_proto(13, 0, heap.new_string("uncaught_callout_error"), e.finish()),
+            {{}, std::string(OUT_OF_BOUNDS)}};
+}
+
+Program caught_callout_error(meow::memory::MemoryManager& heap) {
+    Emitter e;
+    size_t handler = e.jump(OpCode::SETUP_TRY);
+    emit_index_loop(e);
+    e.op(OpCode::POP_TRY).op(OpCode::RETURN, {12});
+    // Handler (R0 là thông báo lỗi): trả về [số lần đã vào thân vòng lặp, tổng các phần tử đọc được]
+    e.land(handler);
+    e.op(OpCode::MOVE, {6, 12}).op(OpCode::NEW_ARRAY, {13, 5, 2}).op(OpCode::RETURN, {13});
+    return {"caught callout error", heap.new_proto(14, 0, heap.new_string("caught_callout_error"), e.finish()),
+            {{Value(int64_t{4}), Value(int64_t{7 + 11 + 13})}, std::nullopt}};
+}
+
+// Vòng lặp JUMP mà trace ghi ở những vòng đầu: ở i == 60 guard giữa thân thất bại (side exit) sau khi R0 đã được
+// cộng trong vòng đó, rồi hai register đổi từ int sang float nên các lần vào sau hỏng ngay ở guard kiểu lúc vào.
+// Cả hai lối ra phải đóng hộp lại đúng giá trị của mọi register còn sống
+Program trace_side_exits(meow::memory::MemoryManager& heap) {
+    Emitter e;
+    e.load_int(0, 0).load_int(1, 0).load_int(2, 1).load_int(3, 100).load_int(4, 70).load_int(5, 1000);
+    e.load_int(7, 60).load_int(8, 0).load_int(9, 1).load_float(10, 60.5).load_float(11, 1.0);
+    uint32_t loop = e.here();
+    size_t other_branch = e.jump(OpCode::JUMP_IF_NOT_LT, {1, 4});
+    e.op(OpCode::ADD, {0, 0, 2});
+    size_t join = e.jump(OpCode::JUMP);
+    e.land(other_branch);
+    e.op(OpCode::ADD, {0, 0, 5});
+    e.land(join);
+    size_t skip = e.jump(OpCode::JUMP_IF_NEQ, {1, 7});
+    e.op(OpCode::MOVE, {8, 10}).op(OpCode::MOVE, {9, 11});
+    e.land(skip);
+    e.op(OpCode::ADD, {8, 8, 9});
+    e.op(OpCode::ADD, {1, 1, 2});
+    e.op(OpCode::JUMP_IF_LT, {1, 3, loop});
+    e.op(OpCode::MOVE, {12, 0}).op(OpCode::MOVE, {13, 1}).op(OpCode::MOVE, {14, 8}).op(OpCode::NEW_ARRAY, {15, 12, 3}).op(OpCode::RETURN, {15});
+
+    // R8 đếm bằng int đến 60, lần lặp thứ 61 thành float 60.5 rồi đếm tiếp bằng float 1.0
+    return {"trace side exits", heap.new_proto(16, 0, heap.new_string("trace_side_exits"), e.finish()),
+            {{Value(int64_t{70 + 30 * 1000}), Value(int64_t{100}), Value(100.5)}, std::nullopt}};
+}
+
+// Thân FOR_LOOP ghi đè bước nhảy bằng float: mọi tầng phải báo lỗi như interpreter, không chạy tiếp bằng int
+Program clobbered_for_loop_step(meow::memory::MemoryManager& heap) {
+    Emitter e;
+    e.load_int(0, 0).load_int(1, 0).load_int(2, 9).load_int(3, 1).load_int(5, 3).load_float(6, 1.5);
+    size_t exit = e.jump(OpCode::FOR_PREP, {1});
+    uint32_t body = e.here();
+    e.op(OpCode::ADD, {0, 0, 4});
+    size_t keep = e.jump(OpCode::JUMP_IF_NEQ, {4, 5});
+    e.op(OpCode::MOVE, {3, 6});
+    e.land(keep);
+    e.op(OpCode::FOR_LOOP, {1, body});
+    e.land(exit);
+    e.op(OpCode::RETURN, {0});
+    return {"clobbered FOR_LOOP step", heap.new_proto(7, 0, heap.new_string("clobbered_for_loop_step"), e.finish()),
+            {{}, std::string("FOR_LOOP: Chỉ số, giới hạn và bước nhảy phải cùng là int hoặc cùng là float.")}};
+}
+
+// Thân vòng lặp hạ giới hạn 100 xuống -5 ngay lần lặp đầu: FOR_LOOP phải dừng sau đúng một lần lặp, không được tính
+// khoảng còn lại quay vòng thành 2^64. Vòng ngoài lặp lại 10 lần để tầng trace cũng ghi được FOR_LOOP trong
+Program lowered_for_loop_limit(meow::memory::MemoryManager& heap) {
+    Emitter e;
+    e.load_int(0, 0).load_int(5, 1).load_int(10, 0).load_int(11, 9).load_int(12, 1);
+    size_t exit = e.jump(OpCode::FOR_PREP, {10});
+    uint32_t outer = e.here();
+    e.load_int(1, 0).load_int(2, 100).load_int(3, 1);
+    uint32_t body = e.here();
+    e.op(OpCode::ADD, {0, 0, 5}).load_int(2, -5);
+    e.op(OpCode::FOR_LOOP, {1, body});
+    e.op(OpCode::FOR_LOOP, {10, outer});
+    e.land(exit);
+    e.op(OpCode::RETURN, {0});
+    return {"lowered FOR_LOOP limit", heap.new_proto(14, 0, heap.new_string("lowered_for_loop_limit"), e.finish()),
+            {{Value(int64_t{10})}, std::nullopt}};
+}
+
+// Vòng do-while khép bằng JUMP_IF_TRUE: cạnh quay lại này cũng phải được đếm để proto lên mã máy (OSR) và trace
+Program truthy_back_edge(meow::memory::MemoryManager& heap) {
+    Emitter e;
+    e.load_int(0, 0).load_int(1, 1).load_int(2, 50);
+    uint32_t loop = e.here();
+    e.op(OpCode::ADD, {0, 0, 1}).op(OpCode::LT, {3, 0, 2});
+    e.op(OpCode::JUMP_IF_TRUE, {3, loop});
+    e.op(OpCode::RETURN, {0});
+    return {"JUMP_IF_TRUE back edge", heap.new_proto(4, 0, heap.new_string("truthy_back_edge"), e.finish()),
+            {{Value(int64_t{50})}, std::nullopt}};
+}
+
+// Thân vòng ITER_NEXT thêm 20 key vào hash table đang duyệt: bảng rehash nên lần ITER_NEXT kế tiếp phải báo lỗi ở mọi
+// tầng, không được duyệt tiếp bằng vị trí bucket cũ
+Program rehash_during_iteration(meow::memory::MemoryManager& heap) {
+    constexpr int ADDED = 20;
+    Emitter e;
+    auto key = [&](int i) { return static_cast<uint32_t>(e.chunk.add_constant(Value(heap.new_string(std::format("k{}", i))))); };
+    e.op(OpCode::LOAD_CONST, {0, key(0)}).load_int(1, 0).op(OpCode::NEW_HASH, {2, 0, 1}).op(OpCode::ITER_NEW, {3, 2});
+    uint32_t loop = e.here();
+    size_t exit = e.jump(OpCode::ITER_NEXT, {3, 5, 0xFFFF});
+    for (int i = 1; i <= ADDED; ++i) e.op(OpCode::LOAD_CONST, {6, key(i)}).op(OpCode::SET_INDEX, {2, 6, 1});
+    e.op(OpCode::JUMP, {loop});
+    e.land(exit);
+    e.op(OpCode::RETURN, {1});
+    return {"rehash during iteration", heap.new_proto(7, 0, heap.new_string("rehash_during_iteration"), e.finish()),
+            {{}, std::string("ITER_NEXT: Collection bị thêm phần tử (rehash) trong lúc duyệt.")}};
+}
+
+// So sánh int với mảng không có toán tử nào: `a > b` gộp thành JUMP_IF_NOT_LT đảo toán hạng nên lệnh gộp không biết
+// toán tử đã viết, cả hai dạng phải báo cùng một lỗi. Vòng đầu so sánh hai int để mã máy kịp được dịch
+constexpr const char* UNSUPPORTED_COMPARE = "Unsupported comparison operands";
+
+Program unsupported_compare(meow::memory::MemoryManager& heap, bool fused) {
+    Emitter e;
+    e.load_int(0, 1).load_int(1, 0).op(OpCode::NEW_ARRAY, {3, 0, 0});
+    e.load_int(4, 0).load_int(5, 9).load_int(6, 1);
+    size_t exit = e.jump(OpCode::FOR_PREP, {4});
+    uint32_t body = e.here();
+    size_t skip;
+    if (fused) {
+        skip = e.jump(OpCode::JUMP_IF_NOT_LT, {1, 0});
+    } else {
+        e.op(OpCode::GT, {2, 0, 1});
+        skip = e.jump(OpCode::JUMP_IF_FALSE, {2});
+    }
+    e.land(skip);
+    e.op(OpCode::MOVE, {1, 3});
+    e.op(OpCode::FOR_LOOP, {4, body});
+    e.land(exit);
+    e.op(OpCode::RETURN, {0});
+    return {fused ? "unsupported fused compare" : "unsupported compare",
+            heap.new_proto(8, 0, heap.new_string("unsupported_compare"), e.finish()), {{}, std::string(UNSUPPORTED_COMPARE)}};
+}
+
+// Register từ 255 trở lên và thân vòng lặp dài hơn 32 KiB: các lệnh phải ra dạng WIDE, FOR_PREP/FOR_LOOP nhảy
+// bằng khoảng cách 32-bit và cả chunk vượt 64 KiB
+Program wide_operands(meow::memory::MemoryManager& heap) {
+    constexpr uint16_t ONE = 300, COPY = 301, LOOP = 400;
+    constexpr int MOVES = 12000;
+    Emitter e;
+    e.load_int(0, 0).load_int(255, 5).load_int(ONE, 1).load_int(COPY, 0);
+    e.load_int(LOOP, 0).load_int(LOOP + 1, 9).load_int(LOOP + 2, 1);
+    size_t exit = e.jump(OpCode::FOR_PREP, {LOOP});
+    uint32_t body = e.here();
+    e.op(OpCode::ADD, {0, 0, ONE}).op(OpCode::ADD, {255, 255, ONE});
+    for (int i = 0; i < MOVES; ++i) e.op(OpCode::MOVE, {COPY, ONE});
+    e.op(OpCode::FOR_LOOP, {LOOP, body});
+    e.land(exit);
+    e.op(OpCode::MOVE, {10, 0}).op(OpCode::MOVE, {11, 255}).op(OpCode::MOVE, {12, COPY}).op(OpCode::NEW_ARRAY, {13, 10, 3}).op(OpCode::RETURN, {13});
+
+    Chunk chunk = e.finish();
+    check(chunk.get_code_size() > 64 * 1024, "wide operands: chunk is larger than 64 KiB");
+    return {"wide operands", heap.new_proto(LOOP + 4, 0, heap.new_string("wide_operands"), std::move(chunk)),
+            {{Value(int64_t{10}), Value(int64_t{15}), Value(int64_t{1})}, std::nullopt}};
+}
+
+std::filesystem::path write_module(const Program& program, size_t index) {
+    std::vector<uint8_t> bytes = meow::loader::write_optimized_module(program.proto);
+    std::filesystem::path path = std::filesystem::temp_directory_path() / std::format("meow-jit-test-{}.meowb", index);
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return path;
+}
+}  // namespace
+
+int main() {
+    meow::runtime::ExecutionContext context;
+    meow::runtime::BuiltinRegistry builtins;
+    meow::memory::MemoryManager heap(std::make_unique<meow::memory::MarkSweepGC>(&context, &builtins));
+    heap.disable_gc();
+
+    std::vector<Program> programs;
+    programs.push_back(int_wraparound(heap));
+    programs.push_back(nan_compares(heap));
+    programs.push_back(negative_step_loops(heap));
+    programs.push_back(uncaught_callout_error(heap));
+    programs.push_back(caught_callout_error(heap));
+    programs.push_back(trace_side_exits(heap));
+    programs.push_back(clobbered_for_loop_step(heap));
+    programs.push_back(lowered_for_loop_limit(heap));
+    programs.push_back(truthy_back_edge(heap));
+    programs.push_back(rehash_during_iteration(heap));
+    programs.push_back(unsupported_compare(heap, false));
+    programs.push_back(unsupported_compare(heap, true));
+    programs.push_back(wide_operands(heap));
+
+    std::vector<std::filesystem::path> paths;
+    for (size_t i = 0; i < programs.size(); ++i) paths.push_back(write_module(programs[i], i));
+
+    for (const Tier& tier : TIERS) {
+        if (!is_available(tier)) {
+            std::cout << "jit_test: " << tier.name << " not available, skipped" << std::endl;
+            continue;
+        }
+        for (size_t i = 0; i < programs.size(); ++i) {
+            Outcome outcome = run_in_tier(tier, paths[i]);
+            check(same_outcome(outcome, programs[i].expected),
+                  std::format("{} in {}: got {}, expected {}", programs[i].name, tier.name, describe(outcome), describe(programs[i].expected)));
+        }
+        std::cout << "jit_test: checked " << tier.name << std::endl;
+    }
+
+    for (const auto& path : paths) std::filesystem::remove(path);
+    if (failures != 0) return 1;
+    std::cout << "jit_test: ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,208 @@
+// Hồi quy cho pipeline tối ưu lúc nạp: chạy optimize_proto trên các proto dựng tay rồi kiểm tra kết quả.
+// Nên chạy cả dưới -fsanitize=address: lỗi đọc quá cuối chunk chỉ lộ ra ở đó.
+
+#include "common/pch.h"
+#include "core/objects/function.h"
+#include "memory/mark_sweep_gc.h"
+#include "memory/memory_manager.h"
+#include "module/loader/binary_format.h"
+#include "module/loader/binary_loader.h"
+#include "module/loader/binary_writer.h"
+#include "runtime/builtin_registry.h"
+#include "runtime/bytecode.h"
+#include "runtime/execution_context.h"
+#include "runtime/optimizer.h"
+#include "test_support.h"
+
+namespace {
+using namespace meow::core;
+using namespace meow::runtime;
+using namespace meow::test;
+
+// Chunk kết thúc bằng lệnh không toán hạng: không pass nào được đọc toán hạng của nó
+void test_zero_operand_tail(meow::memory::MemoryManager& heap) {
+    Emitter halt;
+    halt.load_int(0, 7).op(OpCode::HALT);
+    proto_t proto = heap.new_proto(2, 0, heap.new_string("halt"), halt.finish());
+    check(!optimize_proto(proto, OptimizerOptions{}).reverted, "HALT-terminated chunk optimizes");
+
+    Emitter pop_try;
+    pop_try.load_int(0, 7).op(OpCode::SETUP_TRY, {3}).op(OpCode::POP_TRY).op(OpCode::HALT);
+    proto = heap.new_proto(2, 0, heap.new_string("pop_try"), pop_try.finish());
+    check(!optimize_proto(proto, OptimizerOptions{}).reverted, "POP_TRY; HALT chunk optimizes");
+}
+
+// Register chỉ có closure con dùng (qua upvalue) vẫn phải nằm trong frame và không bị register khác tô đè
+void test_captured_register_survives_compaction(meow::memory::MemoryManager& heap) {
+    constexpr uint16_t CAPTURED = 3;
+    auto closure_over = [&](const char* name, Emitter&& body) {
+        std::vector<objects::UpvalueDesc> descs{objects::UpvalueDesc(true, CAPTURED)};
+        return heap.new_proto(1, 1, heap.new_string(name), body.finish(), std::move(descs));
+    };
+    Emitter setter;
+    setter.load_int(0, 600).op(OpCode::SET_UPVALUE, {0, 0}).load_int(0, 99).op(OpCode::RETURN, {0});
+    Emitter getter;
+    getter.op(OpCode::GET_UPVALUE, {0, 0}).op(OpCode::RETURN, {0});
+
+    Emitter main;
+    (void)main.chunk.add_constant(Value(closure_over("set", std::move(setter))));
+    (void)main.chunk.add_constant(Value(closure_over("get", std::move(getter))));
+    main.op(OpCode::CLOSURE, {1, 0})
+        .op(OpCode::CLOSURE, {2, 1})
+        .op(OpCode::CALL, {5, 1, 5, 0})
+        .op(OpCode::CALL, {6, 2, 6, 0})
+        .op(OpCode::RETURN, {6});
+    proto_t proto = heap.new_proto(8, 0, heap.new_string("main"), main.finish());
+    optimize_proto(proto, OptimizerOptions{});
+
+    check(proto->get_num_registers() > CAPTURED, "frame keeps the captured register");
+    const Chunk& chunk = proto->get_chunk();
+    std::vector<size_t> offsets;
+    check(decode_instructions(chunk.get_code(), chunk.get_code_size(), offsets), "optimized chunk decodes");
+    for (size_t offset : offsets) {
+        Instruction instruction = decode_instruction(chunk.get_code(), offset);
+        for (size_t k = 0; k < instruction.layout().operand_count; ++k) {
+            OperandKind kind = instruction.layout().operands[k];
+            if (kind != OperandKind::REG && kind != OperandKind::DST) continue;
+            check(instruction.operand(k) != CAPTURED, "no temporary is renumbered onto the captured register");
+        }
+    }
+}
+
+// Chunk lớn hơn 64 KiB vẫn được tối ưu: LT + JUMP_IF_FALSE quanh thân dài vẫn gộp thành JUMP_IF_NOT_LT, nhảy bằng WIDE
+void test_large_chunk_fuses_compare_branch(meow::memory::MemoryManager& heap) {
+    constexpr uint32_t ADDS = 20000;
+    Emitter large;
+    large.load_int(0, 0).load_int(1, 3).load_int(3, 0).load_int(4, 1);
+    large.op(OpCode::LT, {2, 0, 1}).op(OpCode::JUMP_IF_FALSE, {2, 6 + ADDS + 2});
+    for (uint32_t i = 0; i < ADDS; ++i) large.op(OpCode::ADD, {3, 3, 0});
+    large.op(OpCode::ADD, {0, 0, 4}).op(OpCode::JUMP, {4});
+    large.op(OpCode::RETURN, {3});
+    proto_t proto = heap.new_proto(5, 0, heap.new_string("large"), large.finish());
+    check(!optimize_proto(proto, OptimizerOptions{}).reverted, "chunk larger than 64 KiB optimizes");
+
+    const Chunk& chunk = proto->get_chunk();
+    check(chunk.get_code_size() > 64 * 1024, "optimized chunk stays larger than 64 KiB");
+    std::vector<Instruction> code;
+    check(decode_code(chunk.get_code(), chunk.get_code_size(), code), "large chunk decodes");
+    bool fused = false, wide_jump = false;
+    for (const Instruction& instruction : code) {
+        fused |= instruction.op() == OpCode::JUMP_IF_NOT_LT;
+        wide_jump |= instruction.wide && get_jump_target(instruction).has_value();
+    }
+    check(fused, "compare and branch are fused past 64 KiB");
+    check(wide_jump, "jumps across the body are wide");
+}
+
+// Tệp .meowb v1 (toán hạng 16-bit cố định, nhảy tuyệt đối) vẫn nạp được: code được mã hoá lại sang dạng gọn
+void test_fixed_width_module_is_reencoded(meow::memory::MemoryManager& heap) {
+    std::vector<uint8_t> bytes;
+    auto u8 = [&](uint8_t value) { bytes.push_back(value); };
+    auto u16 = [&](uint16_t value) { for (int i = 0; i < 2; ++i) bytes.push_back(static_cast<uint8_t>(value >> (i * 8))); };
+    auto u32 = [&](uint32_t value) { for (int i = 0; i < 4; ++i) bytes.push_back(static_cast<uint8_t>(value >> (i * 8))); };
+    auto u64 = [&](uint64_t value) { for (int i = 0; i < 8; ++i) bytes.push_back(static_cast<uint8_t>(value >> (i * 8))); };
+
+    u32(meow::loader::MAGIC_NUMBER);
+    u32(1);
+    u32(0);  // main proto
+    u32(1);
+    u32(1);  // registers
+    u32(0);  // upvalues
+    u32(0);  // tên là hằng số 0
+    u32(1);
+    u8(static_cast<uint8_t>(meow::loader::ConstantTag::STRING_T));
+    u32(6);
+    for (char c : std::string_view("legacy")) u8(static_cast<uint8_t>(c));
+    u32(0);
+    // LOAD_INT R0, 1 @0; JUMP 25 @11; LOAD_INT R0, 2 @14; RETURN R0 @25
+    u32(28);
+    auto op = [&](OpCode code) { u8(static_cast<uint8_t>(code)); };
+    op(OpCode::LOAD_INT);
+    u16(0);
+    u64(1);
+    op(OpCode::JUMP);
+    u16(25);
+    op(OpCode::LOAD_INT);
+    u16(0);
+    u64(2);
+    op(OpCode::RETURN);
+    u16(0);
+
+    OptimizerOptions options;
+    options.enabled = false;
+    proto_t proto = meow::loader::BinaryLoader(&heap, bytes, options).load_module();
+    const Chunk& chunk = proto->get_chunk();
+    std::vector<Instruction> code;
+    check(decode_code(chunk.get_code(), chunk.get_code_size(), code), "re-encoded v1 code decodes");
+    check(code.size() == 4 && code[1].op() == OpCode::JUMP && code[1].address() == 3, "v1 jump lands on the same instruction");
+    check(code.size() == 4 && code[0].imm64() == 1 && code[3].op() == OpCode::RETURN, "v1 operands survive re-encoding");
+    check(chunk.get_code_size() < 28, "re-encoded v1 code is compact");
+}
+
+// Module ghi bởi write_optimized_module nạp lại y nguyên: code chạy thẳng trên tệp được map, không bị tối ưu lại
+void test_pre_optimized_module_maps_in_place(meow::memory::MemoryManager& heap) {
+    Emitter callee;
+    callee.load_int(0, 5).op(OpCode::RETURN, {0});
+    proto_t child = heap.new_proto(1, 0, heap.new_string("child"), callee.finish());
+
+    Emitter main;
+    (void)main.chunk.add_constant(Value(child));
+    main.load_int(0, 7)
+        .op(OpCode::SETUP_TRY, {6})
+        .op(OpCode::CLOSURE, {1, 0})
+        .op(OpCode::CALL, {2, 1, 2, 0})
+        .op(OpCode::POP_TRY)
+        .op(OpCode::RETURN, {2})
+        .load_int(2, -1)
+        .op(OpCode::RETURN, {2});
+    proto_t proto = heap.new_proto(4, 0, heap.new_string("main"), main.finish());
+    optimize_proto(child, OptimizerOptions{});
+    optimize_proto(proto, OptimizerOptions{});
+    check(!proto->get_exception_table().empty(), "try region becomes an exception table");
+
+    std::vector<uint8_t> bytes = meow::loader::write_optimized_module(proto);
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "meow-optimizer-test.meowb";
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+
+    auto same_code = [](proto_t lhs, proto_t rhs) {
+        const Chunk& a = lhs->get_chunk();
+        const Chunk& b = rhs->get_chunk();
+        return std::equal(a.get_code(), a.get_code() + a.get_code_size(), b.get_code(), b.get_code() + b.get_code_size());
+    };
+    for (bool lazy : {false, true}) {
+        auto file = meow::loader::MappedFile::open(path);
+        check(file != nullptr, "pre-optimized module opens");
+        if (!file) return;
+        proto_t loaded = meow::loader::BinaryLoader(&heap, file, OptimizerOptions{}, lazy).load_module();
+        check(loaded->get_chunk().is_code_borrowed(), "pre-optimized main runs on the mapped file");
+        check(same_code(loaded, proto), "pre-optimized main is not optimized again");
+        check(loaded->get_num_registers() == proto->get_num_registers(), "pre-optimized main keeps its frame size");
+        const auto& table = loaded->get_exception_table();
+        check(table.size() == proto->get_exception_table().size() && table.front().start_ == proto->get_exception_table().front().start_ &&
+                  table.front().end_ == proto->get_exception_table().front().end_ && table.front().handler_ == proto->get_exception_table().front().handler_,
+              "exception table round-trips");
+
+        proto_t loaded_child = loaded->get_chunk().get_constant(0).as_proto();
+        loaded_child->ensure_body();
+        check(loaded_child->get_chunk().is_code_borrowed() && same_code(loaded_child, child), "pre-optimized callee runs on the mapped file");
+    }
+    std::filesystem::remove(path);
+}
+}  // namespace
+
+int main() {
+    meow::runtime::ExecutionContext context;
+    meow::runtime::BuiltinRegistry builtins;
+    meow::memory::MemoryManager heap(std::make_unique<meow::memory::MarkSweepGC>(&context, &builtins));
+    heap.disable_gc();
+
+    test_zero_operand_tail(heap);
+    test_captured_register_survives_compaction(heap);
+    test_large_chunk_fuses_compare_branch(heap);
+    test_fixed_width_module_is_reencoded(heap);
+    test_pre_optimized_module_maps_in_place(heap);
+
+    if (failures != 0) return 1;
+    std::cout << "optimizer_test: ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,66 @@
+#pragma once
+// Phần dùng chung của các bài hồi quy dựng bytecode bằng tay (optimizer_test, jit_test)
+
+#include "common/pch.h"
+#include "runtime/bytecode.h"
+#include "runtime/chunk.h"
+
+namespace meow::test {
+
+inline int failures = 0;
+
+inline void check(bool condition, std::string_view what) {
+    if (condition) return;
+    std::cerr << "FAIL: " << what << std::endl;
+    ++failures;
+}
+
+/// @brief Builds code as Instructions (ADDR operands are instruction indices); finish() encodes it with encode_code
+struct Emitter {
+    runtime::Chunk chunk;
+    std::vector<runtime::Instruction> code;
+
+    [[nodiscard]] uint32_t here() const noexcept {
+        return static_cast<uint32_t>(code.size());
+    }
+    // Toán hạng theo thứ tự của layout, toán hạng ADDR là chỉ số lệnh đích
+    Emitter& op(core::OpCode opcode, std::initializer_list<uint32_t> operands = {}) {
+        runtime::Instruction& instruction = code.emplace_back(opcode);
+        size_t k = 0;
+        for (uint32_t operand : operands) {
+            if (instruction.layout().operands[k] == runtime::OperandKind::ADDR) {
+                instruction.set_address(operand);
+            } else {
+                instruction.set_operand(k, static_cast<uint16_t>(operand));
+            }
+            ++k;
+        }
+        return *this;
+    }
+    Emitter& load_int(uint16_t dst, int64_t value) {
+        op(core::OpCode::LOAD_INT, {dst});
+        code.back().set_imm64(std::bit_cast<uint64_t>(value));
+        return *this;
+    }
+    Emitter& load_float(uint16_t dst, double value) {
+        op(core::OpCode::LOAD_FLOAT, {dst});
+        code.back().set_imm64(std::bit_cast<uint64_t>(value));
+        return *this;
+    }
+    // Nhảy tới đích chưa biết: trả về chỉ số của lệnh nhảy để land() điền sau
+    size_t jump(core::OpCode opcode, std::initializer_list<uint32_t> operands = {}) {
+        op(opcode, operands);
+        return code.size() - 1;
+    }
+    void land(size_t jump) {
+        code[jump].set_address(here());
+    }
+    runtime::Chunk finish() {
+        std::vector<uint8_t> bytes;
+        check(runtime::encode_code(code, bytes), "test code encodes");
+        chunk.set_code(std::move(bytes));
+        return std::move(chunk);
+    }
+};
+
+}  // namespace meow::test
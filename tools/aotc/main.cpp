@@ -0,0 +1,129 @@
+// meow-aotc: dịch trước một tệp .meowb thành thư viện native mà ModuleManager nạp thay cho bytecode
+//
+//   meow-aotc <input.meowb> [-o <output>] [--emit-cpp <file.cpp>] [--emit-meowb <file.meowb>]
+//
+// Mặc định ghi ra <input> với đuôi thư viện của hệ điều hành (.so/.dylib/.dll), cạnh tệp .meowb, để
+// `import "input"` tìm thấy nó trước. Trình biên dịch lấy từ $CXX (mặc định là trình biên dịch đã build VM),
+// cờ thêm lấy từ $CXXFLAGS.
+//
+// --emit-meowb ghi bytecode đã qua optimizer thành một .meowb tối ưu sẵn: VM map tệp đó và chạy code ngay trên
+// page của tệp, không tối ưu (và không chép) lại lúc nạp. Chỉ có --emit-meowb thì không dịch ra mã native.
+
+#include "common/pch.h"
+#include "memory/mark_sweep_gc.h"
+#include "memory/memory_manager.h"
+#include "module/aot_compiler.h"
+#include "module/aot_module.h"
+#include "module/loader/binary_loader.h"
+#include "module/loader/binary_writer.h"
+#include "module/module_utils.h"
+#include "runtime/builtin_registry.h"
+#include "runtime/execution_context.h"
+
+#ifndef MEOW_AOT_CXX
+#define MEOW_AOT_CXX "c++"
+#endif
+#ifndef MEOW_AOT_INCLUDE_DIR
+#define MEOW_AOT_INCLUDE_DIR "include"
+#endif
+#ifndef MEOW_AOT_LINK_FLAGS
+#define MEOW_AOT_LINK_FLAGS ""
+#endif
+
+namespace {
+namespace fs = std::filesystem;
+
+[[noreturn]] void usage() {
+    std::cerr << "Usage: meow-aotc <input.meowb> [-o <output>] [--emit-cpp <file.cpp>] [--emit-meowb <file.meowb>]" << std::endl;
+    std::exit(2);
+}
+
+std::vector<uint8_t> read_file(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) throw std::runtime_error("Không thể mở tệp '" + path.string() + "'");
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void write_file(const fs::path& path, const std::string& text) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open() || !file.write(text.data(), static_cast<std::streamsize>(text.size()))) {
+        throw std::runtime_error("Không thể ghi tệp '" + path.string() + "'");
+    }
+}
+
+std::string quote(const std::string& text) {
+    std::string quoted = "'";
+    for (char c : text) {
+        if (c == '\'') quoted += "'\\''";
+        else quoted += c;
+    }
+    return quoted + "'";
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    fs::path input, output, emit_cpp, emit_meowb;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) output = argv[++i];
+        else if (arg == "--emit-cpp" && i + 1 < argc) emit_cpp = argv[++i];
+        else if (arg == "--emit-meowb" && i + 1 < argc) emit_meowb = argv[++i];
+        else if (!arg.empty() && arg[0] != '-' && input.empty()) input = argv[i];
+        else usage();
+    }
+    if (input.empty()) usage();
+    bool native = emit_meowb.empty() || !output.empty() || !emit_cpp.empty();
+    if (output.empty()) output = fs::path(input).replace_extension(meow::module::get_platform_library_extension());
+
+    try {
+        std::vector<uint8_t> bytecode = read_file(input);
+
+        // Heap riêng như của MeowVM; chỉ cần để BinaryLoader dựng proto, không chạy gì
+        meow::runtime::ExecutionContext context;
+        meow::runtime::BuiltinRegistry builtins;
+        meow::memory::MemoryManager heap(std::make_unique<meow::memory::MarkSweepGC>(&context, &builtins));
+        heap.disable_gc();
+
+        meow::core::proto_t main_proto = nullptr;
+        try {
+            meow::loader::BinaryLoader loader(&heap, bytecode, meow::module::aot_optimizer_options());
+            main_proto = loader.load_module();
+        } catch (const meow::loader::BinaryLoaderError& e) {
+            throw std::runtime_error("Tệp bytecode không hợp lệ: " + input.string() + " - Lỗi: " + e.what());
+        }
+
+        if (!emit_meowb.empty()) {
+            std::vector<uint8_t> optimized;
+            try {
+                optimized = meow::loader::write_optimized_module(main_proto);
+            } catch (const meow::loader::BinaryLoaderError& e) {
+                throw std::runtime_error("Không thể ghi bytecode tối ưu sẵn: " + std::string(e.what()));
+            }
+            write_file(emit_meowb, std::string(optimized.begin(), optimized.end()));
+            if (!native) return 0;
+        }
+
+        std::string source = meow::module::generate_aot_source(main_proto, bytecode, input.filename().string());
+        bool keep_cpp = !emit_cpp.empty();
+        if (!keep_cpp) emit_cpp = fs::temp_directory_path() / ("meow-aotc-" + std::to_string(std::hash<std::string>{}(fs::absolute(output).string())) + ".cpp");
+        write_file(emit_cpp, source);
+
+        const char* cxx = std::getenv("CXX");
+        const char* cxxflags = std::getenv("CXXFLAGS");
+        std::string include_dir = MEOW_AOT_INCLUDE_DIR;
+        // $CXX có thể là cả lệnh (vd. "ccache g++") nên không quote
+        std::string command = std::string(cxx != nullptr && *cxx != '\0' ? cxx : quote(MEOW_AOT_CXX)) + " -std=c++20 -O2 -fPIC -shared -fvisibility=hidden" +
+                              " -I " + quote(include_dir) + " -I " + quote(include_dir + "/common") + " " + (cxxflags != nullptr ? cxxflags : "") + " " +
+                              quote(emit_cpp.string()) + " " + MEOW_AOT_LINK_FLAGS + " -o " + quote(output.string());
+        int status = std::system(command.c_str());
+        if (!keep_cpp) fs::remove(emit_cpp);
+        if (status != 0) {
+            std::cerr << "meow-aotc: trình biên dịch C++ thất bại: " << command << std::endl;
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "meow-aotc: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}